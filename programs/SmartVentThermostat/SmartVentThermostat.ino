@@ -22,11 +22,19 @@
 #include "nonvolatileSettings.h"
 #include "temperature.h"
 #include "pinSettings.h"
+#include "smartVentControl.h"
+#include "scheduler.h"
+#include "loopProfiler.h"
+#include "lowPowerIdle.h"
+#include "telemetry.h"
+#include "deferredLog.h"
+#include "temperatureHistory.h"
 #include "screens.h"
 #include "screenAdvanced.h"
 #include "screenCalibration.h"
 #include "screenCleaning.h"
 #include "screenDebug.h"
+#include "screenHistory.h"
 #include "screenMain.h"
 #include "screenSettings.h"
 #include "screenSpecial.h"
@@ -53,20 +61,13 @@
 //  7 - test SPECIAL screen
 //  8 - test CALIBRATION screen
 //  9 - test DEBUG screen
+// 10 - test HISTORY screen
 #define TEST_MODE 0
 
 // *************************************************************************************** //
 // Constants.
 // *************************************************************************************** //
 
-// Amount of time to wait between each reading of indoor and outdoor temperatures.
-// The temperatures are stored in a buffer and the running average temperatures are
-// the values used to control SmartVent and to display on the screen. The number of
-// temperatures averaged is given in the temperature.h file and is currently 30.
-// If we read temperatures once every two seconds, then the running average is
-// flushed over a period of one minute. That seems reasonable.
-#define TEMPERATURE_READ_TIME_MS (2*1000)
-
 // Amount of time to wait after user exits Settings screen or touches the touchscreen,
 // before beginning to check for SmartVent on/off conditions.
 // Note: I want this to be less than LCD_BACKLIGHT_AUTO_OFF_MS so that the user can
@@ -78,48 +79,88 @@
 // Variables.
 // *************************************************************************************** //
 
+// True if the last touch event was TS_NO_TOUCH, so the CPU may sleep until the next touch.
+static bool lastTouchEventNone = true;
+
 // Millisecond time at the last transition from touching the touchscreen to not touching it.
 static uint32_t lastNoTouchTime;
 
-// This timer serves for turning off the LCD backlight a bit after the user finishes
-// using the touchscreen. Each time the user does a screen touch, the LCD backlight
-// is turned on if it was off. Each time the user releases his touch on the screen,
-// this variable is zeroed. At regular updates when the screen is not being touched,
-// this is counted upwards by milliseconds to LCD_BACKLIGHT_AUTO_OFF_MS, and when it
-// reaches that, the backlight is turned off and this stops counting and is not reset.
-static uint32_t MSsinceLastTouchBeforeBacklight;
-
-// In order to be able to update the value of MSsinceLastTouchBeforeBacklight
-// periodically, the following variable records the milliseconds time (millis())
-// at which the last update was made to it, so that when the next update time
-// occurs, the number of elapsed milliseconds can be determined and used to do
-// the update.
-static uint32_t MSatLastBacklightTimerUpdate;
-
-// Timer counting up to TEMPERATURE_READ_TIME_MS, at which time current indoor and
-// outdoor temperatures are read and the running average temperature is updated on
-// the display as needed. The timer is then restarted.
-static uint32_t MSsinceLastReadOfTemperatures;
-
-// Like MSatLastBacklightTimerUpdate but for MSsinceLastReadOfTemperatures.
-static uint32_t MSatLastTemperatureReadTimerUpdate;
+// This one-shot scheduler timer serves for turning off the LCD backlight a bit after the
+// user finishes using the touchscreen. Each time the user does a screen touch, the LCD
+// backlight is turned on if it was off. As long as the screen is touched and each time the
+// user releases his touch on the screen, this timer is restarted to expire in
+// LCD_BACKLIGHT_AUTO_OFF_MS, and when it expires, the backlight is turned off.
+static timerID backlightTimer;
+
+// One-shot scheduler timer that starts a read of current indoor and outdoor temperatures
+// when it expires. When the read finishes, the timer is restarted to expire after
+// temperatureReadIntervalMS(), and the filtered temperatures are updated on the display
+// as needed.
+static timerID temperatureReadTimer;
+
+// The delay in ms with which temperatureReadTimer was last started.
+static uint32_t temperatureReadDelayMS;
 
 // Thermostats seem to wait for a bit after the user fiddles with settings,
-// before starting any activity. We will do the same here. This variable is
-// zeroed each time the user does a screen touch, and at regular updates it
-// is counted upwards by milliseconds. User touches initially change the
-// settings in the "userSettings" variable. When this timer counts up to
-// USER_ACTIVITY_DELAY_MS, then the  "userSettings" variable is copied to
-// "activeSettings" and this stops counting and is not reset.
-static uint32_t MSsinceLastTouchBeforeUserSettingsActivated;
+// before starting any activity. We will do the same here. This one-shot scheduler
+// timer is restarted each time the user does a screen touch, to expire in
+// USER_ACTIVITY_DELAY_MS. User touches initially change the settings in the
+// "userSettings" variable. When this timer expires, the "userSettings" variable
+// is copied to "activeSettings".
+static timerID settingsActivationTimer;
+
+// *************************************************************************************** //
+// Temperature read scheduling.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the time in ms to wait before the next temperature read. While the backlight is on
+// and the screen shows current temperatures, they are read every TEMPERATURE_READ_TIME_MS,
+// else getTemperatureReadIntervalMS() sets the time.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t temperatureReadIntervalMS(void) {
+  if (getBacklight() && (currentScreen == SCREEN_MAIN || currentScreen == SCREEN_DEBUG ||
+      currentScreen == SCREEN_CALIBRATION))
+    return(TEMPERATURE_READ_TIME_MS);
+  return(getTemperatureReadIntervalMS());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start temperatureReadTimer to expire in delayMS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startTemperatureReadTimer(uint32_t delayMS) {
+  temperatureReadDelayMS = delayMS;
+  startTimer(temperatureReadTimer, delayMS);
+}
 
-// Like MSatLastBacklightTimerUpdate but for MSsinceLastTouchBeforeUserSettingsActivated.
-static uint32_t MSatLastActionTimerUpdate;
+/////////////////////////////////////////////////////////////////////////////////////////////
+// If the next temperature read was scheduled more than TEMPERATURE_READ_TIME_MS out, move it
+// to TEMPERATURE_READ_TIME_MS from now. This is called when the user touches the screen and
+// when the active settings change, since the read was scheduled using the old screen and
+// settings. If a read is in progress, the timer is not running and the next read will be
+// scheduled using the new ones when it finishes.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void hurryTemperatureRead(void) {
+  if (temperatureReadDelayMS > TEMPERATURE_READ_TIME_MS &&
+      isTimerRunning(temperatureReadTimer))
+    startTemperatureReadTimer(TEMPERATURE_READ_TIME_MS);
+}
 
 // *************************************************************************************** //
 // Touch screen processing.
 // *************************************************************************************** //
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Restart the backlight and settings activation timers after the user touches the screen,
+// and read the temperatures soon if the next read is far off, as they are now being looked
+// at.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void restartUserActivityTimers() {
+  startTimer(backlightTimer, LCD_BACKLIGHT_AUTO_OFF_MS);
+  startTimer(settingsActivationTimer, USER_ACTIVITY_DELAY_MS);
+  hurryTemperatureRead();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Master button press/release processing function. On press, start playing a tone, and on
 // release, end the tone.
@@ -136,58 +177,42 @@ static void buttonPressRelease(bool press) {
 void processTouchesAndReleases() {
   int16_t x, y, pres;
 
+  // The touchscreen shares the SPI bus with the LCD, so let any LCD DMA transfer finish.
+  waitLCDtransfers();
+
   // Check for a button press or release.
+  lastTouchEventNone = false;
   switch (ts_display->getTouchEvent(x, y, pres)) {
 
-  // When screen is not being touched or uncertain, update no-touch-since timers for backlight and settings activation.
+  // When screen is not being touched or uncertain, the backlight and settings activation
+  // timers run. When it is not being touched, the CPU may sleep until it is.
   case TS_NO_TOUCH:
+    lastTouchEventNone = true;
+    break;
   case TS_UNCERTAIN:
-    //monitor.printf("released\n");
-
-    // Update the LCD backlight timer when screen is not being touched.
-    // When backlight is turned off, we also exit the Cleaning screen if we are in it.
-    if (MSsinceLastTouchBeforeBacklight < LCD_BACKLIGHT_AUTO_OFF_MS) {
-      uint32_t MS = millis();
-      uint32_t elapsedMS = MS - MSatLastBacklightTimerUpdate;
-      MSatLastBacklightTimerUpdate = MS;
-      MSsinceLastTouchBeforeBacklight += elapsedMS;
-      if (MSsinceLastTouchBeforeBacklight >= LCD_BACKLIGHT_AUTO_OFF_MS) {
-        MSsinceLastTouchBeforeBacklight = LCD_BACKLIGHT_AUTO_OFF_MS;
-        setBacklight(false);
-        if (currentScreen == SCREEN_CLEANING) {
-          currentScreen = SCREEN_MAIN;
-          drawMainScreen();
-        }
-      }
-    }
+    //logPrintf("released\n");
     break;
 
-  // As long as a touch is present, reset timeout timers.
+  // As long as a touch is present, restart timeout timers.
   case TS_TOUCH_PRESENT:
-    //monitor.printf("pressed\n");
-    MSsinceLastTouchBeforeBacklight = 0;
-    MSatLastBacklightTimerUpdate = millis();
-    MSsinceLastTouchBeforeUserSettingsActivated = 0;
-    MSatLastActionTimerUpdate = millis();
+    //logPrintf("pressed\n");
+    restartUserActivityTimers();
     break;
 
   // Touch events turn on the backlight if off, else are processed as possible screen button presses.
   case TS_TOUCH_EVENT:
-    //monitor.printf("Button press: %d,%d pres=%d   isPressed: %d\n", x, y, pres, btn_OffAutoOn.isPressed());
+    //logPrintf("Button press: %d,%d pres=%d   isPressed: %d\n", x, y, pres, btn_OffAutoOn.isPressed());
     if (!getBacklight())
       setBacklight(true);
     else
       screenButtons->press(x, y);
     break;
 
-  // Release events reset the timeout timers and are also tested for possible
+  // Release events restart the timeout timers and are also tested for possible
   // screen button release.
   case TS_RELEASE_EVENT:
-    //monitor.printf("Button release   isPressed: %d\n", btn_OffAutoOn.isPressed());
-    MSsinceLastTouchBeforeBacklight = 0;
-    MSatLastBacklightTimerUpdate = millis();
-    MSsinceLastTouchBeforeUserSettingsActivated = 0;
-    MSatLastActionTimerUpdate = millis();
+    //logPrintf("Button release   isPressed: %d\n", btn_OffAutoOn.isPressed());
+    restartUserActivityTimers();
     screenButtons->release();
     break;
   }
@@ -245,10 +270,10 @@ static void showTouchesAndReleases() {
   int16_t x, y, pres;
   switch (ts_display->getTouchEvent(x, y, pres)) {
     case TS_TOUCH_EVENT:
-      monitor.printf("Touch at %d,%d\n", x, y);
+      logPrintf("Touch at %d,%d\n", x, y);
       break;
     case TS_RELEASE_EVENT:
-      monitor.printf("Release\n");
+      logPrintf("Release\n");
       break;
   }
 }
@@ -258,205 +283,53 @@ static void showTouchesAndReleases() {
 // *************************************************************************************** //
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Current temperature processing. If it is time to read temperatures, do it, updating the
-// running average in curIndoorTemperature and curOutdoorTemperature.
+// Backlight timer callback. Turn off the LCD backlight, and exit the Cleaning screen if we
+// are in it. The backlight is not turned off in the Calibration and Debug screens; instead,
+// the timer is restarted.
 /////////////////////////////////////////////////////////////////////////////////////////////
-void updateCurrentTemperatures(void) {
-  // Update read-temperatures timer and read the temperatures when the time arrives.
-  uint32_t MS = millis();
-  uint32_t elapsedMS = MS - MSatLastTemperatureReadTimerUpdate;
-  MSatLastTemperatureReadTimerUpdate = MS;
-  MSsinceLastReadOfTemperatures += elapsedMS;
-  if (MSsinceLastReadOfTemperatures >= TEMPERATURE_READ_TIME_MS) {
-    MSsinceLastReadOfTemperatures = 0;
-    readCurrentTemperatures();
+static void backlightTimerExpired(void) {
+  if (currentScreen == SCREEN_CALIBRATION || currentScreen == SCREEN_DEBUG) {
+    startTimer(backlightTimer, LCD_BACKLIGHT_AUTO_OFF_MS);
+    return;
   }
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-// Update RunTimeMS timer, turning off SmartVent when appropriate.
-// Note: maximum run time and new-day-reset of run time is handled below in
-// updateSmartVentOnOff() because it works with current temperatures.
-/////////////////////////////////////////////////////////////////////////////////////////////
-void updateSmartVentRunTimer(void) {
-
-  // Get elapsed time since last update.
-  uint32_t MS = millis();
-  uint32_t elapsedMS = MS - MSatLastRunTimerUpdate;
-  MSatLastRunTimerUpdate = MS;
-  uint32_t MaxRunTimeMS = activeSettings.MaxRunTimeHours * 3600000UL;
-
-  // If in OFF mode or if SmartVent is currently off (ON or AUTO mode), leave
-  // the run timer alone.
-  if (activeSettings.SmartVentMode != MODE_OFF && getSmartVent()) {
-    // Advance RunTimeMS, but don't let it exceed 99 hours, and if it reaches a
-    // set maximum run time limit, turn SmartVent off and change the mode and
-    // arm state appropriately.
-    RunTimeMS += elapsedMS;
-    if (RunTimeMS > 99*3600000UL)
-      RunTimeMS = 99*3600000UL;
-    if (MaxRunTimeMS > 0 && RunTimeMS >= MaxRunTimeMS) {
-      RunTimeMS = MaxRunTimeMS;
-      setSmartVent(false);
-      // If mode is ON, change ArmState to ARM_ON_TIMEOUT.
-      if (activeSettings.SmartVentMode == MODE_ON) {
-        setArmState(ARM_ON_TIMEOUT);
-        monitor.printf("Timer expire while running in ON, set to AWAIT_HOT\n");
-      // Else mode is AUTO. Change arm state to ARM_AWAIT_HOT. RunTimeMS remains
-      // non-zero and is shown on the display, allowing the user to see how much
-      // run time has occurred and see that it has hit his limit. It will be
-      // reset to 0 when the arm state exits ARM_AWAIT_HOT.
-      } else {
-        if (activeSettings.SmartVentMode == MODE_AUTO) {
-          setArmState(ARM_AWAIT_HOT);
-          monitor.printf("Timer expire while running in AUTO, set to AWAIT_HOT\n");
-        }
-      }
-    }
-  }
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-// Check the conditions to see if the SmartVent should be turned on/off.
-/////////////////////////////////////////////////////////////////////////////////////////////
-void updateSmartVentOnOff(void) {
-  uint32_t MaxRunTimeMS = activeSettings.MaxRunTimeHours * 3600000UL;
-  bool isTimeout;
-  float indoorTempAdjusted, outdoorTempAdjusted, hysteresis;
-
-  switch (activeSettings.SmartVentMode) {
-
-  //    - If mode is OFF and SmartVent is on, turn it off.
-  case MODE_OFF:
-    if (getSmartVent()) {
-      setSmartVent(false);
-      setArmState(ARM_OFF);
-    }
-    break;
-
-  //    - If mode is ON, check if run time has hit its limit and set SmartVent accordingly.
-  case MODE_ON:
-    isTimeout = (MaxRunTimeMS > 0 && RunTimeMS == MaxRunTimeMS);
-    if (isTimeout == getSmartVent()) {
-      // Timeout and SmartVent is on, or no timeout and SmartVent is off.
-      // Change SmartVent state to the proper one for the timeout state.
-      setSmartVent(!isTimeout);
-      setArmState(!isTimeout ? ARM_ON : ARM_ON_TIMEOUT);
-    }
-    break;
-
-  //    - Else mode is AUTO. Check the various AUTO-mode conditions to determine
-  //        whether SmartVent should be on or off, and change SmartVent state if
-  //        the conditions warrant.
-  case MODE_AUTO:
-    indoorTempAdjusted = curIndoorTemperature.Tf + (float)activeSettings.IndoorOffsetF;
-    outdoorTempAdjusted = curOutdoorTemperature.Tf + (float)activeSettings.OutdoorOffsetF;
-    hysteresis = (float)activeSettings.Hysteresis;
-
-    // If SmartVent is off and ArmState is ARM_AWAIT_ON and MaxRunTimeMS is 0 or is greater than
-    // RunTimeMS, evaluate whether or not to turn SmartVent on.
-    if (!getSmartVent() && ArmState == ARM_AWAIT_ON && (MaxRunTimeMS == 0 || MaxRunTimeMS > RunTimeMS)) {
-      // The condition to turn SmartVent on is: if the indoor temperature is above the indoor
-      // temperature setpoint plus hysteresis AND the outdoor temperature is at or below the
-      // indoor temperature minus the on-delta value required for activation minus hysteresis.
-      bool turnOn = (indoorTempAdjusted > ((float)activeSettings.TempSetpointOn + hysteresis)) &&
-        (outdoorTempAdjusted <= (indoorTempAdjusted - (float)activeSettings.DeltaTempForOn - hysteresis));
-      // If the turn-on condition was satisfied, turn SmartVent on and change ArmState to ARM_AUTO_ON.
-      if (turnOn) {
-        setSmartVent(true);
-        setArmState(ARM_AUTO_ON);
-      }
-    }
-
-    // If SmartVent is on, evaluate whether or not to keep it on or turn it off.
-    if (getSmartVent()) {
-      // The condition to keep SmartVent on is almost the same as the condition to turn it on,
-      // except that the hysteresis is reversed.
-      // Note that the hysteresis ensures that it doesn't flip-flop on and off repeatedly in a short time interval.
-      bool keepOn = (indoorTempAdjusted > ((float)activeSettings.TempSetpointOn - hysteresis)) &&
-        (outdoorTempAdjusted <= (indoorTempAdjusted - (float)activeSettings.DeltaTempForOn + hysteresis));
-      // If the keep-on condition was NOT satisfied, turn SmartVent off and change ArmState to ARM_AWAIT_ON.
-      // Note that SmartVent will turn on again if the turn-on condition is again met, and in that case, the
-      // total on-time accumulates up to the maximum on time, if one was set.
-      if (!keepOn) {
-        setSmartVent(false);
-        setArmState(ARM_AWAIT_ON);
-      }
-    // Else SmartVent is off. If the outdoor temperature is at or above the indoor
-    // temperature plus the delta value required for recognizing the start of a new
-    // day, clear RunTimeMS.
-    } else {
-      if (outdoorTempAdjusted >= indoorTempAdjusted + (int16_t) activeSettings.DeltaNewDayTemp) {
-        RunTimeMS = 0;
-        // If ArmState is ARM_AWAIT_HOT, change to ARM_AWAIT_ON.
-        if (ArmState == ARM_AWAIT_HOT)
-          setArmState(ARM_AWAIT_ON);
-      }
-    }
-    break;
+  setBacklight(false);
+  if (currentScreen == SCREEN_CLEANING) {
+    currentScreen = SCREEN_MAIN;
+    drawMainScreen();
   }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// ArmState must change if activeSettings.SmartVentMode changes. Call this each time that
-// might have happened.
-// All the interactions between mode, state, and run timer are complex and it is hard to
-// get this right for all situations. I've continued to work on it.
+// Settings activation timer callback, called when sufficient time has elapsed since last
+// screen touch. Update active settings from user settings. Note that the only time
+// userSettings itself changes is when user hits the Save button to exit from the Settings
+// screen. If the mode or any threshold changed, the next temperature read is moved up.
 /////////////////////////////////////////////////////////////////////////////////////////////
-void updateArmState(void) {
-  switch (activeSettings.SmartVentMode) {
-  case MODE_OFF:
-    // In OFF mode, the arm state should always be ARM_OFF.
-    setArmState(ARM_OFF);
-    break;
-  case MODE_ON:
-    // In ON mode, only change the arm state if it isn't already one of the arm
-    // states used in ON mode. If in ARM_AWAIT_HOT state, the run timer has
-    // timed out, so go to the ARM_ON_TIMEOUT state to maintain timed-out timer.
-    // User can clear timer by tapping the arm button.
-    if (ArmState == ARM_OFF || ArmState == ARM_AUTO_ON || ArmState == ARM_AWAIT_ON)
-      setArmState(ARM_ON);
-    else if (ArmState == ARM_AWAIT_HOT)
-      setArmState(ARM_ON_TIMEOUT);
-    break;
-  case MODE_AUTO:
-    // In AUTO mode, only change the arm state if it isn't already one of the
-    // arm states used in AUTO mode. If coming from OFF (where timer was zeroed),
-    // go to ARM_AWAIT_ON. If coming from ARM_ON_TIMEOUT, go to ARM_AWAIT_HOT to
-    // maintain timed-out timer. User can clear timer by tapping the arm button.
-    if (ArmState == ARM_OFF)
-      setArmState(ARM_AWAIT_ON);
-    else if (ArmState == ARM_ON_TIMEOUT)
-      setArmState(ARM_AWAIT_HOT);
-    else if (ArmState == ARM_ON)
-      setArmState(ARM_AUTO_ON);
-    break;
-  }
+static void activateUserSettings(void) {
+  if (writeNonvolatileSettingsIfChanged(userSettings))
+    logPrintf("Wrote settings to non-volatile memory\n");
+  // User settings become the active settings.
+  bool changed = memcmp(&activeSettings, &userSettings, sizeof(nonvolatileSettings)) != 0;
+  activeSettings = userSettings;
+  updateArmState();
+  if (changed)
+    hurryTemperatureRead();
 }
 
+#if USE_TEMPERATURE_HISTORY
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Check for time to update active settings from user settings, after sufficient time has
-// elapsed since last screen touch.
+// History timer callback. Add the current temperatures, as displayed, and SmartVent state to
+// the history.
 /////////////////////////////////////////////////////////////////////////////////////////////
-void updateActiveSettings() {
-  // Update the user settings activation timer. (It is reset to 0 each time screen is touched).
-  // Note that the only time userSettings itself changes is when user hits the Save button to
-  // exit from the Settings screen.
-  if (MSsinceLastTouchBeforeUserSettingsActivated < USER_ACTIVITY_DELAY_MS) {
-    uint32_t MS = millis();
-    uint32_t elapsedMS = MS - MSatLastActionTimerUpdate;
-    MSatLastActionTimerUpdate = MS;
-    MSsinceLastTouchBeforeUserSettingsActivated += elapsedMS;
-    if (MSsinceLastTouchBeforeUserSettingsActivated >= USER_ACTIVITY_DELAY_MS) {
-      MSsinceLastTouchBeforeUserSettingsActivated = USER_ACTIVITY_DELAY_MS;
-      if (writeNonvolatileSettingsIfChanged(userSettings))
-        monitor.printf("Wrote settings to non-volatile memory\n");
-      // User settings become the active settings.
-      activeSettings = userSettings;
-      updateArmState();
-    }
-  }
+static void recordHistory(void) {
+  historySample S;
+  S.indoorTenthsF = lroundf((curIndoorTemperature.Tf + activeSettings.IndoorOffsetF) * 10);
+  S.outdoorTenthsF = lroundf((curOutdoorTemperature.Tf + activeSettings.OutdoorOffsetF) * 10);
+  S.relayOn = getSmartVent();
+  S.armState = ArmState;
+  addHistorySample(S);
 }
+#endif
 
 // *************************************************************************************** //
 // Standard Arduino setup function.
@@ -464,7 +337,16 @@ void updateActiveSettings() {
 void setup() {
   // Initialize for using the Arduino IDE serial monitor.
   monitor.begin(MONITOR_PORT);
-  monitor.printf("**************** RESET ****************\n");
+  #if USE_DEFERRED_LOG
+  initDeferredLog(MONITOR_PORT != NULL);
+  #endif
+  logPrintf("**************** RESET ****************\n");
+
+  // Initialize for sending binary telemetry on the same port.
+  #if USE_TELEMETRY
+  Serial.begin(115200);
+  initTelemetry(&Serial);
+  #endif
 
   // Initialize watchdog timer. It must be reset every 16K clock cycles. Does this mean the
   // main system clock?  And what is it running at?  Actually, testing shows that it is
@@ -475,34 +357,49 @@ void setup() {
   #endif
 
   // Initialize some hardware pins: SmartVent relay off, backlight on.
-  monitor.printf("initPins()\n");
+  logPrintf("initPins()\n");
   initPins();
 
   // Initialize for reading temperatures. This also initializes the ADC.
-  monitor.printf("Temperature\n");
+  logPrintf("Temperature\n");
   initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, wdt_reset);
 
   // Initialize timers.
-  monitor.printf("Timers\n");
-  // Initialize timer for next read of temperatures.
-  MSsinceLastReadOfTemperatures = 0;
-  MSatLastTemperatureReadTimerUpdate = millis();
-  // Initialize action-on-new-settings timer.
-  MSsinceLastTouchBeforeUserSettingsActivated = USER_ACTIVITY_DELAY_MS;
-  MSatLastActionTimerUpdate = millis();
-  // Initialize backlight timer.
-  MSsinceLastTouchBeforeBacklight = 0;
-  MSatLastBacklightTimerUpdate = millis();
+  logPrintf("Timers\n");
+  // Start timer for reading temperatures.
+  temperatureReadTimer = addTimer(startReadCurrentTemperatures);
+  startTemperatureReadTimer(TEMPERATURE_READ_TIME_MS);
+  // Add action-on-new-settings timer. It is not started until the screen is touched.
+  settingsActivationTimer = addTimer(activateUserSettings);
+  // Start backlight timer.
+  backlightTimer = addTimer(backlightTimerExpired);
+  startTimer(backlightTimer, LCD_BACKLIGHT_AUTO_OFF_MS);
+  // Start timer for recording temperature history.
+  #if USE_TEMPERATURE_HISTORY
+  startTimer(addTimer(recordHistory, HISTORY_INTERVAL_MS), HISTORY_INTERVAL_MS);
+  #endif
+  // Start timer for showing the loop() profile.
+  #if USE_LOOP_PROFILER
+  initLoopProfiler();
+  #endif
+  // Sleep between timer events.
+  #if USE_IDLE_SLEEP
+  initLowPowerIdle();
+  #endif
   // Initial no-touch timer.
   lastNoTouchTime = millis();
 
+  // Initialize SmartVent arm state and run timer.
+  logPrintf("SmartVent control\n");
+  initSmartVentControl();
+
   // Initialize screen objects.
-  monitor.printf("Screen objects\n");
+  logPrintf("Screen objects\n");
   initScreens();
 
-  // Read settings from flash-based EEPROM into activeSettings, then copy them to userSettings.
+  // Read settings from flash memory into activeSettings, then copy them to userSettings.
   // Initialize touchscreen calibration parameter defaults from current settings in ts_display.
-  monitor.printf("Nonvolatile\n");
+  logPrintf("Nonvolatile\n");
   ts_display->getTS_calibration(&settingDefaults.TS_LR_X, &settingDefaults.TS_LR_Y,
     &settingDefaults.TS_UL_X, &settingDefaults.TS_UL_Y);
   readNonvolatileSettings(activeSettings, settingDefaults);
@@ -512,7 +409,7 @@ void setup() {
   updateArmState();
 
   // Initialize all screens.
-  monitor.printf("all screens\n");
+  logPrintf("all screens\n");
   initMainScreen();
   initSettingsScreen();
   initAdvancedScreen();
@@ -520,11 +417,14 @@ void setup() {
   initSpecialScreen();
   initCalibrationScreen();
   initDebugScreen();
+  #if USE_TEMPERATURE_HISTORY
+  initHistoryScreen();
+  #endif
   // Register master button press/release processing function.
   screenButtons->registerMasterProcessFunc(buttonPressRelease);
 
   // Show screen indicated by TEST_MODE.
-  monitor.printf("show screen   TEST_MODE: %d\n", TEST_MODE);
+  logPrintf("show screen   TEST_MODE: %d\n", TEST_MODE);
   #if TEST_MODE == 3  // Touchscreen testing.
   lcd->fillScreen(WHITE);
   setBacklight(true);
@@ -546,12 +446,18 @@ void setup() {
   #elif TEST_MODE == 9
   currentScreen = SCREEN_DEBUG;
   drawDebugScreen();
+  #elif TEST_MODE == 10 && USE_TEMPERATURE_HISTORY
+  currentScreen = SCREEN_HISTORY;
+  drawHistoryScreen();
   #else
   currentScreen = SCREEN_MAIN;
   drawMainScreen();
   #endif
 
-  monitor.printf("Initialization done, setup() returning\n");
+  logPrintf("Initialization done, setup() returning\n");
+  #if USE_DEFERRED_LOG
+  flushDeferredLog();
+  #endif
 }
 
 // *************************************************************************************** //
@@ -570,22 +476,42 @@ void loop() {
 
   #else // normal operating mode
 
-  // Process button presses/releases on current screen. This also handles the LCD backlight
-  // auto on/off and the storing of userSettings in EEPROM and copying it to activeSettings,
-  // all after no user activity for a while.
-  processTouchesAndReleases();
-
-  // Update active settings from user settings.
-  updateActiveSettings();
+  // Time each phase of loop() if the loop profiler is enabled.
+  PROFILE_LOOP_START();
 
-  // Update current temperatures.
-  updateCurrentTemperatures();
-
-  // Update SmartVent timers.
-  updateSmartVentRunTimer();
+  // Process button presses/releases on current screen. This also restarts the timers for
+  // the LCD backlight auto off and the storing of userSettings in flash and copying it to
+  // activeSettings, both after no user activity for a while. If this switches screens, show
+  // the LCD SPI traffic caused by drawing the new screen.
+  #if COUNT_LCD_TRAFFIC
+  eScreen prevScreen = currentScreen;
+  lcdTraffic start = LCDtraffic;
+  processTouchesAndReleases();
+  if (currentScreen != prevScreen)
+    logPrintf("Screen %d -> %d: %lu LCD bytes, %lu by DMA\n", prevScreen, currentScreen,
+      getLCDbytesSince(start), getLCDqueuedBytesSince(start));
+  #else
+  processTouchesAndReleases();
+  #endif
+  PROFILE_PHASE(PHASE_TOUCH);
+
+  // Call the callbacks of expired timers: start reading temperatures, turn off the LCD
+  // backlight, update active settings from user settings, and advance the SmartVent run
+  // timer and statistics.
+  runDueTimers();
+  PROFILE_PHASE(PHASE_TIMERS);
+
+  // Advance any temperature read in progress, which eventually updates the running average
+  // in curIndoorTemperature and curOutdoorTemperature. The read is spread over several passes
+  // through loop() so that loop() is not stalled waiting for AREF and the ADC. When it
+  // finishes, schedule the next read.
+  if (serviceReadCurrentTemperatures())
+    startTemperatureReadTimer(temperatureReadIntervalMS());
+  PROFILE_PHASE(PHASE_TEMPERATURES);
 
   // Check the conditions to see if the SmartVent should be turned on/off:
   updateSmartVentOnOff();
+  PROFILE_PHASE(PHASE_ON_OFF);
 
   // Call function to process things according to which screen is currently displayed.
   switch (currentScreen) {
@@ -606,18 +532,40 @@ void loop() {
     break;
   case SCREEN_CALIBRATION:
     loopCalibrationScreen();
-    // Don't turn off backlight in calibration mode.
-    MSsinceLastTouchBeforeBacklight = 0;
     break;
   case SCREEN_DEBUG:
     loopDebugScreen();
-    // Don't turn off backlight in debug mode.
-    MSsinceLastTouchBeforeBacklight = 0;
     break;
+  #if USE_TEMPERATURE_HISTORY
+  case SCREEN_HISTORY:
+    loopHistoryScreen();
+    break;
+  #endif
   }
+  PROFILE_PHASE(PHASE_SCREEN);
+
+  // Finish timing loop().
+  PROFILE_LOOP_END();
+
+  // Write the serial monitor output stored by logPrintf(), unless a touch is in progress.
+  #if USE_DEFERRED_LOG
+  if (lastTouchEventNone)
+    serviceDeferredLog();
+  #endif
+
+  // Sleep until the next timer expires or the screen is touched, if nothing needs loop() to
+  // keep polling.
+  #if USE_IDLE_SLEEP
+  idleUntilNextEvent(lastTouchEventNone);
+  #endif
 
   #endif // TEST_MODE
 
+  // In the testing modes, write the serial monitor output right away.
+  #if USE_DEFERRED_LOG && TEST_MODE >= 1 && TEST_MODE <= 3
+  flushDeferredLog();
+  #endif
+
   // Finally, reset the watchdog timer.
   wdt_reset();
 }
@@ -0,0 +1,56 @@
+/*
+  crc16.h - CRC-16 checksum used to protect data stored in flash or sent over serial.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef crc16_h
+#define crc16_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Initial CRC value.
+#define CRC16_INIT 0xFFFF
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the CRC-16/CCITT-FALSE (polynomial 0x1021, not reflected) of len bytes of data,
+// continuing from CRC value crc. Pass CRC16_INIT for crc to start a new CRC, or the value
+// returned by a previous call to continue it.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint16_t crc16(const void* data, size_t len, uint16_t crc = CRC16_INIT);
+
+#endif // crc16_h
@@ -0,0 +1,222 @@
+/*
+  deferredLog.cpp - Deferred formatting of SmartVent Thermostat serial monitor output.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include "deferredLog.h"
+
+#if USE_DEFERRED_LOG
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// True if messages are to be stored.
+static bool logEnabled;
+
+// Ring buffer of stored messages. Each message is stored in consecutive words:
+//  - the format string pointer,
+//  - the number of words of the message, plus the number of arguments times 0x10000,
+//  - the arguments, with string arguments pointing to their copy, if any,
+//  - the copied strings.
+// A message that doesn't fit before the end of the buffer is stored at its start, and a 0
+// is stored in place of its format string pointer at the end to mark that.
+static uintptr_t logRing[LOG_RING_WORDS];
+
+// Index of the next word to store into (written only by storeLogMessage()) and of the next
+// word to write to the serial monitor (written only by the servicing functions). The buffer
+// is empty when they are equal. As each index is written by only one side, storing never
+// waits for servicing.
+static volatile uint16_t logHead;
+static volatile uint16_t logTail;
+
+// Deferred log counts, and the number of messages dropped since that was last reported.
+static deferredLogStats logCounts;
+static uint32_t droppedSinceReport;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if string s is a constant that need not be copied.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline bool isConstString(const char* s) {
+  #ifdef ARDUINO_ARCH_SAMD
+  return((uintptr_t) s < 0x20000000); // Flash is below SRAM, which starts at 0x20000000.
+  #else
+  return(false);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Format and write the oldest stored message to the serial monitor. The ring buffer must
+// not be empty.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void writeOldestMessage() {
+  uint16_t t = logTail;
+  if (logRing[t] == 0)
+    t = 0;
+  uint16_t numWords = logRing[t+1] & 0xFFFF;
+  uint8_t numArgs = logRing[t+1] >> 16;
+  uintptr_t A[LOG_MAX_ARGS] = { 0 };
+  for (uint8_t i = 0; i < numArgs; i++)
+    A[i] = logRing[t+2+i];
+  monitor.printf((const char*) logRing[t], A[0], A[1], A[2], A[3], A[4], A[5], A[6], A[7]);
+  t += numWords;
+  logTail = (t == LOG_RING_WORDS) ? 0 : t;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write the number of messages dropped since the last time this was called, if any.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void reportDroppedMessages() {
+  uint32_t n = droppedSinceReport;
+  if (n > 0) {
+    droppedSinceReport -= n;
+    monitor.printf("*** %lu log messages dropped\n", n);
+  }
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the deferred log.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initDeferredLog(bool enabled) {
+  logEnabled = enabled;
+  logHead = logTail = 0;
+  memset(&logCounts, 0, sizeof(logCounts));
+  droppedSinceReport = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Store a message.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void storeLogMessage(const char* fmt, const logArg* args, uint8_t numArgs) {
+  if (!logEnabled)
+    return;
+
+  // Find the size of the message, including strings to copy.
+  if (numArgs > LOG_MAX_ARGS)
+    numArgs = LOG_MAX_ARGS;
+  uint8_t strLen[LOG_MAX_ARGS];
+  uint16_t numWords = 2 + numArgs;
+  for (uint8_t i = 0; i < numArgs; i++) {
+    strLen[i] = 0;
+    if (args[i].str != NULL && !isConstString(args[i].str)) {
+      strLen[i] = strnlen(args[i].str, LOG_MAX_STRING);
+      numWords += (strLen[i] + sizeof(uintptr_t)) / sizeof(uintptr_t);
+    }
+  }
+
+  // Find room for it, at the head if it fits before the end of the buffer, else at the start.
+  // The buffer must not become full, as the head would then equal the tail.
+  uint16_t h = logHead;
+  uint16_t t = logTail;
+  uint16_t pos = h;
+  bool fits;
+  if (h >= t) {
+    fits = (h + numWords < LOG_RING_WORDS) || (h + numWords == LOG_RING_WORDS && t != 0);
+    if (!fits && numWords < t) {
+      logRing[h] = 0;
+      pos = 0;
+      fits = true;
+    }
+  } else
+    fits = (h + numWords < t);
+  if (!fits) {
+    logCounts.dropped++;
+    droppedSinceReport++;
+    return;
+  }
+
+  // Store it.
+  logRing[pos] = (uintptr_t) fmt;
+  logRing[pos+1] = numWords + ((uintptr_t) numArgs << 16);
+  char* S = (char*) &logRing[pos+2+numArgs];
+  for (uint8_t i = 0; i < numArgs; i++) {
+    if (args[i].str == NULL)
+      logRing[pos+2+i] = args[i].value;
+    else if (strLen[i] == 0 && isConstString(args[i].str))
+      logRing[pos+2+i] = (uintptr_t) args[i].str;
+    else {
+      memcpy(S, args[i].str, strLen[i]);
+      S[strLen[i]] = 0;
+      logRing[pos+2+i] = (uintptr_t) S;
+      S += (strLen[i] + sizeof(uintptr_t)) / sizeof(uintptr_t) * sizeof(uintptr_t);
+    }
+  }
+
+  // Make the message visible to the servicing functions only once it is complete.
+  __sync_synchronize();
+  pos += numWords;
+  logHead = (pos == LOG_RING_WORDS) ? 0 : pos;
+
+  logCounts.stored++;
+  uint16_t used = (logHead + LOG_RING_WORDS - t) % LOG_RING_WORDS;
+  if (used > logCounts.maxUsedWords)
+    logCounts.maxUsedWords = used;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write up to LOG_MAX_WRITES_PER_SERVICE stored messages to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void serviceDeferredLog() {
+  reportDroppedMessages();
+  for (uint8_t n = 0; n < LOG_MAX_WRITES_PER_SERVICE && logTail != logHead; n++)
+    writeOldestMessage();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write all stored messages to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void flushDeferredLog() {
+  reportDroppedMessages();
+  while (logTail != logHead)
+    writeOldestMessage();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the deferred log counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getDeferredLogStats(deferredLogStats& S) {
+  S = logCounts;
+}
+
+#endif // USE_DEFERRED_LOG
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,139 @@
+/*
+  deferredLog.h - Deferred formatting of SmartVent Thermostat serial monitor output.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef deferredLog_h
+#define deferredLog_h
+
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <type_traits>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to have logPrintf() store its format string and arguments in a ring buffer,
+// to be formatted and written to the serial monitor later, by serviceDeferredLog() at the end
+// of loop(). Set this to 0 to have logPrintf() call monitor.printf() directly.
+#define USE_DEFERRED_LOG 1
+
+// Size of the ring buffer in words (uintptr_t, 4 bytes on the SAMD21). A message takes
+// 2 words plus 1 word per argument plus any copied strings. When the buffer is full,
+// messages are dropped and counted, and the count is written with the next message written.
+#define LOG_RING_WORDS 256
+
+// Maximum number of arguments of a message.
+#define LOG_MAX_ARGS 8
+
+// Maximum length of a string argument copied into the ring buffer. Longer ones are cut.
+#define LOG_MAX_STRING 47
+
+// Maximum number of messages serviceDeferredLog() writes per call.
+#define LOG_MAX_WRITES_PER_SERVICE 4
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// One logPrintf() argument. String arguments are copied when the message is stored (unless
+// they are constants in flash), since they are often in local buffers.
+struct logArg {
+  uintptr_t value;
+  const char* str;        // String argument, or NULL if value holds the argument.
+};
+
+// Deferred log counts.
+struct deferredLogStats {
+  uint32_t stored;        // Messages stored in the ring buffer.
+  uint32_t dropped;       // Messages dropped because the ring buffer was full.
+  uint16_t maxUsedWords;  // Most words of the ring buffer ever in use.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+#if USE_DEFERRED_LOG
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the deferred log. If enabled is false, as when there is no serial monitor
+// port, logPrintf() discards its messages without storing them.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void initDeferredLog(bool enabled);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Store a message with format fmt, which must be a string constant, and numArgs arguments.
+// This is called by logPrintf().
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void storeLogMessage(const char* fmt, const logArg* args, uint8_t numArgs);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call this from loop() when it has nothing else to do, to format and write up to
+// LOG_MAX_WRITES_PER_SERVICE stored messages to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void serviceDeferredLog();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Format and write all stored messages to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void flushDeferredLog();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the deferred log counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getDeferredLogStats(deferredLogStats& S);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Convert a logPrintf() argument to a logArg. Only integers, enums, pointers, and strings
+// are supported, not floats (use floatToString()).
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline logArg toLogArg(const char* s) { return(logArg{ 0, s }); }
+inline logArg toLogArg(char* s) { return(logArg{ 0, s }); }
+template<typename T> inline logArg toLogArg(T v) {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value ||
+    std::is_pointer<T>::value, "logPrintf() arguments must be integers or strings");
+  return(logArg{ (uintptr_t) v, NULL });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Log a message like monitor.printf(), but store it to be formatted and written later.
+// fmt must be a string constant.
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<typename... Args> inline void logPrintf(const char* fmt, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many logPrintf() arguments");
+  const logArg A[sizeof...(Args) + 1] = { toLogArg(args)... };
+  storeLogMessage(fmt, A, sizeof...(Args));
+}
+#else
+#define logPrintf monitor.printf
+#endif
+
+#endif // deferredLog_h
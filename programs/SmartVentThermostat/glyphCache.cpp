@@ -0,0 +1,174 @@
+/*
+  glyphCache.cpp - Pre-rasterized glyphs for quickly drawing numeric fields on the
+  SmartVent Thermostat LCD.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <Adafruit_GFX.h>
+#include "glyphCache.h"
+#include "deferredLog.h"
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Number of characters cached per font.
+#define NUM_CACHED_CHARS (sizeof(GLYPH_CACHE_CHARS)-1)
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// A cached font and its cached glyphs, in the order of GLYPH_CACHE_CHARS.
+struct cachedFont {
+  const GFXfont* font;
+  cachedGlyph glyphs[NUM_CACHED_CHARS];
+};
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Cached fonts.
+static cachedFont cachedFonts[GLYPH_CACHE_FONTS];
+static uint8_t numCachedFonts = 0;
+
+// Pool of rectangles of cached glyphs.
+static glyphRect glyphRects[GLYPH_CACHE_RECTS];
+static uint16_t numGlyphRects = 0;
+
+// Number of glyphs that did not fit in the pool.
+static uint8_t numUncachedGlyphs = 0;
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add the horizontal run of foreground pixels (x,y,w) to glyph G, extending a rectangle
+// that ends on the row above if it has the same x and w. Return false if out of room.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool addGlyphRun(cachedGlyph& G, int16_t x, int16_t y, int16_t w) {
+  for (uint16_t i = G.firstRect; i < G.firstRect+G.numRects; i++) {
+    glyphRect& R = glyphRects[i];
+    if (R.x == x && R.w == w && R.y+R.h == y && R.h < 255) {
+      R.h++;
+      return(true);
+    }
+  }
+  if (numGlyphRects == GLYPH_CACHE_RECTS || x < -128 || x > 127 || y < -128 || y > 127)
+    return(false);
+  glyphRects[numGlyphRects++] = { (int8_t) x, (int8_t) y, (uint8_t) w, 1 };
+  G.numRects++;
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Rasterize character c of font into glyph G. Leave G not cached if it doesn't fit.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void rasterizeGlyph(const GFXfont* font, uint8_t c, cachedGlyph& G) {
+  G.cached = false;
+  G.firstRect = numGlyphRects;
+  G.numRects = 0;
+  if (c < font->first || c > font->last)
+    return;
+  const GFXglyph* glyph = &font->glyph[c - font->first];
+  const uint8_t* bitmap = font->bitmap + glyph->bitmapOffset;
+  G.xAdvance = glyph->xAdvance;
+
+  // Walk the bitmap the same way Adafruit_GFX::drawChar() does, collecting runs.
+  uint16_t bit = 0;
+  uint8_t bits = 0;
+  for (int16_t yy = 0; yy < glyph->height; yy++) {
+    int16_t runStart = -1;
+    for (int16_t xx = 0; xx <= glyph->width; xx++) {
+      bool set = false;
+      if (xx < glyph->width) {
+        if (!(bit++ & 7))
+          bits = *bitmap++;
+        set = (bits & 0x80) != 0;
+        bits <<= 1;
+      }
+      if (set && runStart < 0)
+        runStart = xx;
+      else if (!set && runStart >= 0) {
+        if (!addGlyphRun(G, glyph->xOffset + runStart, glyph->yOffset + yy, xx - runStart)) {
+          numGlyphRects = G.firstRect;
+          G.numRects = 0;
+          return;
+        }
+        runStart = -1;
+      }
+    }
+  }
+  G.cached = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Rasterize the GLYPH_CACHE_CHARS characters of font into the glyph cache.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void addFontToGlyphCache(const GFXfont* font) {
+  if (font == NULL || numCachedFonts == GLYPH_CACHE_FONTS)
+    return;
+  cachedFont& F = cachedFonts[numCachedFonts++];
+  F.font = font;
+  for (uint8_t i = 0; i < NUM_CACHED_CHARS; i++) {
+    rasterizeGlyph(font, GLYPH_CACHE_CHARS[i], F.glyphs[i]);
+    if (!F.glyphs[i].cached)
+      numUncachedGlyphs++;
+  }
+  logPrintf("Glyph cache: %d of %d rectangles used, %d glyphs not cached\n", numGlyphRects,
+    GLYPH_CACHE_RECTS, numUncachedGlyphs);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the cached glyph of character c in font, or NULL if it is not cached.
+/////////////////////////////////////////////////////////////////////////////////////////////
+const cachedGlyph* getCachedGlyph(const GFXfont* font, uint8_t c, const glyphRect** rects) {
+  const char* p = (c == 0) ? NULL : strchr(GLYPH_CACHE_CHARS, c);
+  if (p == NULL || font == NULL)
+    return(NULL);
+  for (uint8_t i = 0; i < numCachedFonts; i++) {
+    if (cachedFonts[i].font == font) {
+      const cachedGlyph* G = &cachedFonts[i].glyphs[p - GLYPH_CACHE_CHARS];
+      if (!G->cached)
+        return(NULL);
+      *rects = &glyphRects[G->firstRect];
+      return(G);
+    }
+  }
+  return(NULL);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,98 @@
+/*
+  glyphCache.h - Pre-rasterized glyphs for quickly drawing numeric fields on the
+  SmartVent Thermostat LCD.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef glyphCache_h
+#define glyphCache_h
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to draw the characters of numeric fields from the glyph cache, as a few
+// filled rectangles each, instead of pixel by pixel as Adafruit_GFX does it. Each pixel
+// costs an LCD address window, so this greatly reduces the SPI traffic of numeric updates.
+// Set to 0 to draw all characters with Adafruit_GFX.
+#define USE_GLYPH_CACHE 1
+
+// Characters that are cached for each cached font.
+#define GLYPH_CACHE_CHARS "0123456789-:"
+
+// Maximum number of fonts whose glyphs are cached: font24B, font18B and mono12B.
+#define GLYPH_CACHE_FONTS 3
+
+// Total number of rectangles available for cached glyphs, 4 bytes each. A glyph that does
+// not fit is not cached, and is drawn by Adafruit_GFX. The three fonts need about 310, 230
+// and 140 rectangles (estimated by rasterizing similar fonts at the same sizes), so this
+// leaves about 15% to spare. The numbers used and glyphs not cached are logged at startup.
+#define GLYPH_CACHE_RECTS 800
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// A rectangle of foreground pixels of a glyph, relative to the text cursor position.
+struct glyphRect {
+  int8_t x, y;
+  uint8_t w, h;
+};
+
+// A cached glyph: its rectangles in the rectangle pool, and how far it advances the cursor.
+struct cachedGlyph {
+  uint16_t firstRect;
+  uint16_t numRects;
+  uint8_t xAdvance;
+  bool cached;
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Rasterize the GLYPH_CACHE_CHARS characters of font into the glyph cache. Each glyph's
+// bitmap is run-length encoded into horizontal runs of foreground pixels, and runs with
+// the same position and length on consecutive rows are merged into one rectangle.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void addFontToGlyphCache(const GFXfont* font);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the cached glyph of character c in font, or NULL if it is not cached. Set *rects
+// to the glyph's rectangles.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern const cachedGlyph* getCachedGlyph(const GFXfont* font, uint8_t c,
+  const glyphRect** rects);
+
+#endif // glyphCache_h
@@ -0,0 +1,197 @@
+/*
+  loopProfiler.cpp - Timing of the phases of the SmartVent Thermostat loop() function.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include "loopProfiler.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "deferredLog.h"
+
+#if USE_LOOP_PROFILER
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Times of one loop() phase.
+struct loopPhaseTimes {
+  uint32_t count;     // Number of times recorded.
+  uint64_t sumUS;     // Sum of times.
+  uint32_t minUS;
+  uint32_t maxUS;
+  uint16_t buckets[LOOP_PROFILE_BUCKETS]; // Histogram, halved whenever a bucket would overflow.
+};
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Times of each loop() phase.
+static loopPhaseTimes phaseTimes[NUM_LOOP_PHASES];
+
+// Names of loop() phases.
+static const char* phaseNames[NUM_LOOP_PHASES] = {
+  "touch", "timers", "temps", "onoff", "screen", "loop"
+};
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the histogram bucket index of time US.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint8_t bucketIndex(uint32_t US) {
+  if (US < 8)
+    return(US);
+  uint8_t e = 31 - __builtin_clz(US);
+  if (e > LOOP_PROFILE_MAX_EXP)
+    return(LOOP_PROFILE_BUCKETS-1);
+  return(8 + 4*(e-3) + ((US >> (e-2)) & 3));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the smallest time above those in histogram bucket index idx.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t bucketLimit(uint8_t idx) {
+  if (idx < 8)
+    return(idx+1);
+  if (idx == LOOP_PROFILE_BUCKETS-1)
+    return(UINT32_MAX);
+  uint8_t e = 3 + (idx-8)/4;
+  return((uint32_t) (5 + (idx-8)%4) << (e-2));
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Record the time of a loop() phase and return the current micros() time.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t profileLoopPhase(eLoopPhase phase, uint32_t startUS) {
+  uint32_t nowUS = micros();
+  uint32_t US = nowUS - startUS;
+  loopPhaseTimes& T = phaseTimes[phase];
+  if (T.count == 0 || US < T.minUS)
+    T.minUS = US;
+  if (US > T.maxUS)
+    T.maxUS = US;
+  T.count++;
+  T.sumUS += US;
+  uint16_t& bucket = T.buckets[bucketIndex(US)];
+  if (bucket == UINT16_MAX)
+    for (uint8_t i = 0; i < LOOP_PROFILE_BUCKETS; i++)
+      T.buckets[i] = (T.buckets[i]+1) >> 1;
+  bucket++;
+  return(nowUS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the statistics of loop() phase.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getLoopPhaseStats(eLoopPhase phase, loopPhaseStats& S) {
+  const loopPhaseTimes& T = phaseTimes[phase];
+  S.count = T.count;
+  S.minUS = T.minUS;
+  S.maxUS = T.maxUS;
+  S.meanUS = (T.count == 0) ? 0 : (uint32_t) (T.sumUS / T.count);
+
+  // Find the bucket where the cumulative count reaches 99% of the histogram total.
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < LOOP_PROFILE_BUCKETS; i++)
+    total += T.buckets[i];
+  uint32_t need = (total*99 + 99)/100;
+  uint32_t sum = 0;
+  uint8_t i;
+  for (i = 0; i < LOOP_PROFILE_BUCKETS-1; i++) {
+    sum += T.buckets[i];
+    if (sum >= need)
+      break;
+  }
+  S.p99US = (total == 0) ? 0 : min(bucketLimit(i)-1, T.maxUS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return a short name for loop() phase.
+/////////////////////////////////////////////////////////////////////////////////////////////
+const char* getLoopPhaseName(eLoopPhase phase) {
+  return(phaseNames[phase]);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clear all loop() phase statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void clearLoopProfile() {
+  memset(phaseTimes, 0, sizeof(phaseTimes));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the loop() phase statistics on the serial monitor, or send them as telemetry.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void showLoopProfile() {
+  #if USE_TELEMETRY
+  for (uint8_t i = 0; i < NUM_LOOP_PHASES; i++) {
+    loopPhaseStats S;
+    getLoopPhaseStats((eLoopPhase) i, S);
+    telemetryLoopPhase T = { i, S.count, S.minUS, S.meanUS, S.maxUS, S.p99US };
+    sendTelemetry(TLM_LOOP_PHASE, &T, sizeof(T));
+  }
+  #else
+  // One message per table row, each taking 8 words of the deferred log.
+  logPrintf("loop() profile (us):   count    min   mean    max    p99\n");
+  for (uint8_t i = 0; i < NUM_LOOP_PHASES; i++) {
+    loopPhaseStats S;
+    getLoopPhaseStats((eLoopPhase) i, S);
+    logPrintf("  %-10s %10lu %6lu %6lu %6lu %6lu\n", phaseNames[i], S.count, S.minUS,
+      S.meanUS, S.maxUS, S.p99US);
+  }
+  logPrintf("  worst loop() is %lu%% of the watchdog timeout\n",
+    phaseTimes[PHASE_LOOP].maxUS / (LOOP_PROFILE_WDT_US/100));
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start the timer that shows the loop() profile every LOOP_PROFILE_DUMP_MS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initLoopProfiler() {
+  #if LOOP_PROFILE_DUMP_MS > 0
+  startTimer(addTimer(showLoopProfile, LOOP_PROFILE_DUMP_MS), LOOP_PROFILE_DUMP_MS);
+  #endif
+}
+
+#endif // USE_LOOP_PROFILER
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,142 @@
+/*
+  loopProfiler.h - Timing of the phases of the SmartVent Thermostat loop() function.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef loopProfiler_h
+#define loopProfiler_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to time each phase of loop() and keep a histogram of the times, shown on the
+// Debug screen and periodically on the serial monitor. Set this to 0 to remove all of it.
+#define USE_LOOP_PROFILER 1
+
+// Interval in ms between dumps of the loop() profile to the serial monitor. 0 = never.
+#define LOOP_PROFILE_DUMP_MS (10*60*1000UL)
+
+// Watchdog timeout in µs (WDT_CONFIG_PER_4K is 4096 cycles of the 1.024 kHz WDT clock),
+// against which the worst loop() time is compared.
+#define LOOP_PROFILE_WDT_US 4000000UL
+
+// Histogram buckets. Times below 8 µs each have their own bucket. Above that, each power of
+// two up to 2^LOOP_PROFILE_MAX_EXP is split into 4 buckets, so a bucket spans at most 25% of
+// its lower bound. The last bucket also holds all longer times.
+#define LOOP_PROFILE_MAX_EXP 21
+#define LOOP_PROFILE_BUCKETS (8 + 4*(LOOP_PROFILE_MAX_EXP-2))
+
+// *************************************************************************************** //
+// Enums.
+// *************************************************************************************** //
+
+// Phases of loop().
+typedef enum _eLoopPhase {
+  PHASE_TOUCH,        // processTouchesAndReleases()
+  PHASE_TIMERS,       // runDueTimers()
+  PHASE_TEMPERATURES, // serviceReadCurrentTemperatures()
+  PHASE_ON_OFF,       // updateSmartVentOnOff()
+  PHASE_SCREEN,       // Per-screen loop function
+  PHASE_LOOP,         // All of loop()
+  NUM_LOOP_PHASES
+} eLoopPhase;
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Statistics of the times of one loop() phase, in µs.
+struct loopPhaseStats {
+  uint32_t count;     // Number of times timed.
+  uint32_t minUS;
+  uint32_t meanUS;
+  uint32_t maxUS;
+  uint32_t p99US;     // Upper bound of the histogram bucket holding the 99th percentile.
+};
+
+// *************************************************************************************** //
+// Macros.
+// *************************************************************************************** //
+
+#if USE_LOOP_PROFILER
+// Start timing loop() and its first phase.
+#define PROFILE_LOOP_START() uint32_t loopStartUS = micros(); uint32_t phaseStartUS = loopStartUS
+// End timing a phase of loop() and start timing the next one.
+#define PROFILE_PHASE(phase) phaseStartUS = profileLoopPhase(phase, phaseStartUS)
+// End timing loop().
+#define PROFILE_LOOP_END() profileLoopPhase(PHASE_LOOP, loopStartUS)
+#else
+#define PROFILE_LOOP_START()
+#define PROFILE_PHASE(phase)
+#define PROFILE_LOOP_END()
+#endif
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+#if USE_LOOP_PROFILER
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Record the time of loop() phase that started at micros() time startUS, and return the
+// current micros() time.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t profileLoopPhase(eLoopPhase phase, uint32_t startUS);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the statistics of loop() phase.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getLoopPhaseStats(eLoopPhase phase, loopPhaseStats& S);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return a short name for loop() phase.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern const char* getLoopPhaseName(eLoopPhase phase);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clear all loop() phase statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void clearLoopProfile();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the loop() phase statistics on the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void showLoopProfile();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call this from setup() to start a scheduler timer that shows the loop() profile on the
+// serial monitor every LOOP_PROFILE_DUMP_MS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void initLoopProfiler();
+#endif
+
+#endif // loopProfiler_h
@@ -0,0 +1,121 @@
+/*
+  lowPowerIdle.cpp - Put the SmartVent Thermostat CPU to sleep between scheduled events.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <wdt_samd21.h>
+#include "temperature.h"
+#include "pinSettings.h"
+#include "scheduler.h"
+#include "screens.h"
+#include "lowPowerIdle.h"
+#include "deferredLog.h"
+
+#if USE_IDLE_SLEEP
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Duty cycle statistics, and micros() time at which they were last cleared.
+static idleStats stats;
+static uint32_t statsStartUS;
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the SAMD21 sleep mode and start the duty cycle report timer.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initLowPowerIdle() {
+  SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+  PM->SLEEP.reg = PM_SLEEP_IDLE_CPU;
+  memset(&stats, 0, sizeof(stats));
+  statsStartUS = micros();
+  #if IDLE_REPORT_MS > 0
+  startTimer(addTimer(showIdleStats, IDLE_REPORT_MS), IDLE_REPORT_MS);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Sleep the CPU until there is something for loop() to do.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void idleUntilNextEvent(bool canSleep) {
+  stats.loopPasses++;
+  if (!canSleep || isReadCurrentTemperaturesBusy() || isLCDtransferBusy())
+    return;
+  if (msUntilNextTimer() == 0 || digitalRead(TOUCH_IRQ) == LOW)
+    return;
+
+  // Sleep. Any interrupt wakes the CPU: SysTick every ms, the touchscreen library's
+  // TOUCH_IRQ interrupt, USB. Sleep again until a timer is due or the screen is touched.
+  wdt_reset();
+  uint32_t startMS = millis();
+  uint32_t startUS = micros();
+  do {
+    __WFI();
+  } while (msUntilNextTimer() > 0 && digitalRead(TOUCH_IRQ) == HIGH &&
+    millis() - startMS < IDLE_MAX_MS);
+  stats.idleUS += micros() - startUS;
+  stats.sleeps++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the duty cycle statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getIdleStats(idleStats& S) {
+  S = stats;
+  S.totalUS = micros() - statsStartUS;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the duty cycle statistics on the serial monitor and clear them.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void showIdleStats() {
+  idleStats S;
+  getIdleStats(S);
+  if (S.totalUS < 1000)
+    return;
+  uint32_t activeUS = S.totalUS - S.idleUS;
+  logPrintf("Duty cycle: active %lu ms of %lu s (%lu.%lu%%), %lu loop() passes, %lu sleeps\n",
+    activeUS/1000, S.totalUS/1000000, activeUS/(S.totalUS/100),
+    (activeUS/(S.totalUS/1000)) % 10, S.loopPasses, S.sleeps);
+  memset(&stats, 0, sizeof(stats));
+  statsStartUS = micros();
+}
+
+#endif // USE_IDLE_SLEEP
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
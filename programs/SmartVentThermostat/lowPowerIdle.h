@@ -0,0 +1,107 @@
+/*
+  lowPowerIdle.h - Put the SmartVent Thermostat CPU to sleep between scheduled events.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef lowPowerIdle_h
+#define lowPowerIdle_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Define this as 1 to sleep the SAMD21 CPU at the end of each pass through loop() until the
+// next scheduler timer expires or the touchscreen is touched, instead of spinning loop().
+// Define it as 0 to spin loop() continuously.
+#ifdef ARDUINO_ARCH_SAMD
+#define USE_IDLE_SLEEP 1
+#else
+#define USE_IDLE_SLEEP 0
+#endif
+
+// Longest time in ms to sleep before returning to loop(), so that the watchdog timer (reset
+// before sleeping) can't expire while asleep.
+#define IDLE_MAX_MS 1000
+
+// Interval in ms between reports of the duty cycle to the serial monitor. 0 = never.
+#define IDLE_REPORT_MS (10*60*1000UL)
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Duty cycle statistics since they were last cleared.
+struct idleStats {
+  uint32_t totalUS;     // Total time.
+  uint32_t idleUS;      // Time spent asleep.
+  uint32_t loopPasses;  // Number of passes through loop().
+  uint32_t sleeps;      // Number of times the CPU went to sleep.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+#if USE_IDLE_SLEEP
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the SAMD21 sleep mode and start the duty cycle report timer. The CPU sleeps in
+// IDLE mode, where only the CPU clock stops. STANDBY mode is not used because it would stop
+// SysTick, which drives millis(), and the beeper PWM and SPI peripherals.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void initLowPowerIdle();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call this at the end of each pass through loop(). If nothing needs loop() to keep polling,
+// reset the watchdog timer and sleep the CPU until the next scheduler timer expires, the
+// touchscreen is touched (TOUCH_IRQ goes low), or IDLE_MAX_MS elapses. The CPU also wakes
+// on each 1 ms SysTick interrupt, but goes right back to sleep without returning to loop().
+// Nothing needs loop() to keep polling when:
+//  - the last touch event was TS_NO_TOUCH (canSleep argument), so no touch or release is
+//    in progress,
+//  - no temperature read is in progress, since it steps through AREF_STABLE_DELAY and the
+//    ADC conversions from loop(), and leaves AREF off when done, and
+//  - no LCD DMA transfer is in progress.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void idleUntilNextEvent(bool canSleep);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the duty cycle statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getIdleStats(idleStats& S);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the duty cycle statistics on the serial monitor and clear them.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void showIdleStats();
+#endif
+
+#endif // lowPowerIdle_h
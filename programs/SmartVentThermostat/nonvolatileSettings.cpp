@@ -31,28 +31,83 @@
   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 */
-// It appears (page 29 of Atmel SAM D21E / SAM D21G / SAM D21J data sheet) that the page size is 64,
-// and 4 pages must be erased at one time, giving an effective page size of 4*64 = 256.  This seems
-// to be confirmed by the fact that FlashStorage_SAMD.hpp aligns the PPCAT variable to 256 bytes.
+// The settings are stored in a log of records in flash memory, rather than with FlashStorage_SAMD's
+// EEPROM emulation, which erases and rewrites its whole flash row on every change. It appears
+// (page 29 of Atmel SAM D21E / SAM D21G / SAM D21J data sheet) that the page size is 64, and 4
+// pages must be erased at one time, giving an effective page size of 4*64 = 256.  Each record
+// is written to its own 64-byte page, the next free one after the latest record, so a row is
+// only erased when the log wraps around to it, once every SETTINGS_LOG_ROWS*4 writes.
+#define FLASH_PAGE_SIZE           64
+#define FLASH_ROW_SIZE            (4 * FLASH_PAGE_SIZE)
+
+// Number of flash rows used for the settings log.
+#define SETTINGS_LOG_ROWS         8
+
+// Number of record slots in a row and in the log.
+#define SETTINGS_SLOTS_PER_ROW    (FLASH_ROW_SIZE / FLASH_PAGE_SIZE)
+#define SETTINGS_LOG_SLOTS        (SETTINGS_LOG_ROWS * SETTINGS_SLOTS_PER_ROW)
+
+// Value in the first word of a settings record.
+#define SETTINGS_RECORD_MAGIC     0x5356
+
+// Version of the layout of nonvolatileSettings. Increment this when it changes, so that
+// records written with the old layout are ignored and the defaults are used.
+#define SETTINGS_RECORD_VERSION   1
+
+// Earlier versions stored the settings with FlashStorage_SAMD's EEPROM emulation, as
+// LEGACY_SIGNATURE at address 0 followed by the settings. When the log has no valid record,
+// the settings are read from there and written as the first record, so that they survive
+// the upgrade. EEPROM_EMULATION_SIZE must stay as it was for the emulation to find them.
 #define EEPROM_EMULATION_SIZE     (4 * 64)
+#define LEGACY_SIGNATURE          0xBEEFDEED
 
 // Use 0-2. Larger for more debugging messages
 #define FLASH_DEBUG       0
 
-// To be included only in one file to avoid `Multiple Definitions` Linker Error
+// To be included only in one file to avoid `Multiple Definitions` Linker Error. This defines
+// FlashClass, used for the log, and the EEPROM object, used to read the legacy settings.
 #include <FlashStorage_SAMD.h>
 
+#include <monitor_printf.h>
+#include "crc16.h"
 #include "nonvolatileSettings.h"
+#include "deferredLog.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Structs.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// A settings record in the flash log. Erased flash reads as all 1 bits, so a slot whose
+// magic word is 0xFFFF has not been written since its row was erased.
+struct settingsRecord {
+  uint16_t magic;               // SETTINGS_RECORD_MAGIC.
+  uint8_t version;              // SETTINGS_RECORD_VERSION.
+  uint8_t size;                 // sizeof(nonvolatileSettings).
+  uint32_t sequence;            // One more than the sequence number of the previous record.
+  nonvolatileSettings settings;
+  uint16_t crc;                 // crc16() of all of the above.
+};
+
+static_assert(sizeof(settingsRecord) <= FLASH_PAGE_SIZE, "settingsRecord must fit in a flash page");
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Variables.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// Signature used at start of a flash memory block to mark the block as containing
-// valid data written by the application.
-const int WRITTEN_SIGNATURE = 0xBEEFDEED;
+// The settings log, aligned to a flash row, and the object used to erase and write it.
+// Sketch upload overwrites it with zeros, which are not valid records.
+__attribute__((__aligned__(FLASH_ROW_SIZE)))
+static const uint8_t settingsLog[SETTINGS_LOG_ROWS * FLASH_ROW_SIZE] = { };
+static FlashClass settingsFlash(settingsLog, sizeof(settingsLog));
+
+// Slot of the latest valid record in the log, or -1 if none, and its sequence number.
+static int16_t latestSlot = -1;
+static uint32_t latestSequence = 0;
 
-// The currently active settings (initialized from flash-based EEPROM).
+// The settings most recently read from or written to the log.
+static nonvolatileSettings storedSettings;
+
+// The currently active settings (initialized from flash memory).
 nonvolatileSettings activeSettings;
 
 // The current settings seen by the user, held here until
@@ -60,7 +115,7 @@ nonvolatileSettings activeSettings;
 // at which time this is copied to "activeSettings".
 nonvolatileSettings userSettings;
 
-// The default settings, used to initialize empty flash-based EEPROM.
+// The default settings, used when flash memory has no valid settings.
 nonvolatileSettings settingDefaults = {
   MODE_OFF,   // SmartVentMode: SmartVent mode
   76,         // TempSetpointOn: Indoor temperature setpoint in °F for SmartVent to turn on.
@@ -74,43 +129,137 @@ nonvolatileSettings settingDefaults = {
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Functions.
+// Local functions.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return a pointer to the record in log slot.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline const settingsRecord* slotRecord(int16_t slot) {
+  return((const settingsRecord*) &settingsLog[slot * FLASH_PAGE_SIZE]);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if the record in log slot is a valid record of the current version.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool isValidRecord(int16_t slot) {
+  const settingsRecord* R = slotRecord(slot);
+  return(R->magic == SETTINGS_RECORD_MAGIC && R->version == SETTINGS_RECORD_VERSION &&
+    R->size == sizeof(nonvolatileSettings) &&
+    R->crc == crc16(R, offsetof(settingsRecord, crc)));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if log slot has not been written since it was erased.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool isBlankSlot(int16_t slot) {
+  const uint8_t* p = (const uint8_t*) slotRecord(slot);
+  for (uint8_t i = 0; i < sizeof(settingsRecord); i++)
+    if (p[i] != 0xFF)
+      return(false);
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the slot following the latest record that can be written, erasing its row if the
+// slot is the first one in a row. Slots that are not blank, because a write was interrupted
+// or failed, are skipped.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int16_t nextFreeSlot(int16_t slot) {
+  for (int16_t i = 0; i < SETTINGS_LOG_SLOTS; i++) {
+    slot = (slot + 1) % SETTINGS_LOG_SLOTS;
+    if (slot % SETTINGS_SLOTS_PER_ROW == 0) {
+      settingsFlash.erase(slotRecord(slot), FLASH_ROW_SIZE);
+      return(slot);
+    }
+    if (isBlankSlot(slot))
+      return(slot);
+  }
+  return(slot);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Append a record holding settings to the log. The record is read back and checked, and if
+// it is bad, it is written again in the next slot. Return true if it was written.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool appendSettingsRecord(const nonvolatileSettings& settings) {
+  settingsRecord R;
+  memset(&R, 0, sizeof(R));
+  R.magic = SETTINGS_RECORD_MAGIC;
+  R.version = SETTINGS_RECORD_VERSION;
+  R.size = sizeof(nonvolatileSettings);
+  R.sequence = latestSequence + 1;
+  R.settings = settings;
+  R.crc = crc16(&R, offsetof(settingsRecord, crc));
+
+  int16_t slot = latestSlot;
+  for (uint8_t tries = 0; tries < SETTINGS_SLOTS_PER_ROW + 1; tries++) {
+    slot = nextFreeSlot(slot);
+    settingsFlash.write(slotRecord(slot), &R, sizeof(R));
+    if (isValidRecord(slot) && memcmp(&slotRecord(slot)->settings, &settings,
+        sizeof(nonvolatileSettings)) == 0) {
+      latestSlot = slot;
+      latestSequence = R.sequence;
+      storedSettings = settings;
+      return(true);
+    }
+    logPrintf("Settings write to flash slot %d failed\n", slot);
+  }
+  return(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Read the settings stored by earlier versions with EEPROM emulation into settings. Return
+// false if there are none.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool readLegacySettings(nonvolatileSettings& settings) {
+  uint32_t signature;
+  EEPROM.get(0, signature);
+  if (signature != LEGACY_SIGNATURE)
+    return(false);
+  EEPROM.get(sizeof(signature), settings);
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Global functions.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read non-volatile settings from flash memory into settings.
+// Read non-volatile settings from flash memory into settings. The latest record is the
+// valid one with the highest sequence number.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void readNonvolatileSettings(nonvolatileSettings& settings, const nonvolatileSettings& defaults) {
-  // Initialize flash-based EEPROM to only commit data when we call the commit function.
-  EEPROM.setCommitASAP(false);
-  // Check signature at address 0
-  int signature;
-  uint16_t storedAddress = 0;
-  EEPROM.get(storedAddress, signature);
-  // If flash-based EEPROM is empty, write WRITTEN_SIGNATURE and defaults data to it.
-  if (signature != WRITTEN_SIGNATURE) {
-    EEPROM.put(storedAddress, WRITTEN_SIGNATURE);
-    EEPROM.put(storedAddress + sizeof(signature), defaults);
-    EEPROM.commit();
+  latestSlot = -1;
+  for (int16_t slot = 0; slot < SETTINGS_LOG_SLOTS; slot++) {
+    if (isValidRecord(slot) && (latestSlot < 0 || slotRecord(slot)->sequence > latestSequence)) {
+      latestSlot = slot;
+      latestSequence = slotRecord(slot)->sequence;
+    }
   }
 
-  // Read settings data from flash-based EEPROM.
-  EEPROM.get(storedAddress + sizeof(signature), settings);
+  // If the log has no valid record, move the legacy settings into it, or if there are none,
+  // use the defaults. They are written on the first change.
+  if (latestSlot >= 0)
+    storedSettings = slotRecord(latestSlot)->settings;
+  else if (readLegacySettings(storedSettings)) {
+    logPrintf("Moving settings from EEPROM emulation to the settings log\n");
+    appendSettingsRecord(storedSettings);
+  } else {
+    logPrintf("No settings in flash, using defaults\n");
+    storedSettings = defaults;
+  }
+  settings = storedSettings;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Write non-volatile settings to flash memory IF IT HAS CHANGED.
+// Write non-volatile settings to flash memory IF IT HAS CHANGED, by appending a record to
+// the log.
 /////////////////////////////////////////////////////////////////////////////////////////////
 bool writeNonvolatileSettingsIfChanged(nonvolatileSettings& settings) {
-  int signature;
-  uint16_t storedAddress = 0;
-  nonvolatileSettings tmp;
-  EEPROM.get(storedAddress + sizeof(signature), tmp);
-  if (memcmp(&settings, &tmp, sizeof(nonvolatileSettings)) == 0)
+  if (memcmp(&settings, &storedSettings, sizeof(nonvolatileSettings)) == 0)
     return(false);
-  EEPROM.put(storedAddress + sizeof(signature), settings);
-  EEPROM.commit();
-  return(true);
+  return(appendSettingsRecord(settings));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -107,17 +107,17 @@ struct nonvolatileSettings {
 // Variables.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// The currently active settings (initialized from flash-based EEPROM and stored in EEPROM
+// The currently active settings (initialized from flash memory and stored in flash memory
 // each time the data changes via copy from userSettings).
 extern nonvolatileSettings activeSettings;
 
 // The current settings seen by the user, held here until
 // USER_ACTIVITY_DELAY_SECONDS has elapsed with no screen touches,
 // at which time this is copied to "activeSettings" and the latter
-// is then stored in EEPROM.
+// is then stored in flash memory.
 extern nonvolatileSettings userSettings;
 
-// The default settings, used to initialize empty flash-based EEPROM.
+// The default settings, used when flash memory has no valid settings.
 // Touchscreen calibration parameters are 0 and must be set by caller.
 extern nonvolatileSettings settingDefaults;
 
@@ -126,8 +126,10 @@ extern nonvolatileSettings settingDefaults;
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read non-volatile settings from flash memory into settings.  If flash memory has not yet
-// been initialized, initialize it with defaults.
+// Read non-volatile settings from flash memory into settings.  If flash memory has no valid
+// settings (never written, or written by a version with a different settings layout), use
+// the settings stored by earlier versions with EEPROM emulation, writing them as the first
+// valid settings, or if there are none, use defaults.
 /////////////////////////////////////////////////////////////////////////////////////////////
 extern void readNonvolatileSettings(nonvolatileSettings& settings,
   const nonvolatileSettings& defaults);
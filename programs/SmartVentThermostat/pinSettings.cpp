@@ -33,6 +33,7 @@
 */
 #include <Arduino.h>
 #include "pinSettings.h"
+#include "telemetry.h"
 
 // *************************************************************************************** //
 // Variables.
@@ -77,9 +78,15 @@ bool getSmartVent() {
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Set a new value for smartVentOn.
+// Set a new value for smartVentOn. If USE_TELEMETRY, send a change as telemetry.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void setSmartVent(bool on) {
+  #if USE_TELEMETRY
+  if (on != smartVentOn) {
+    telemetryRelay T = { on };
+    sendTelemetry(TLM_RELAY, &T, sizeof(T));
+  }
+  #endif
   smartVentOn = on;
   digitalWrite(SMARTVENT_RELAY, on ? SMARTVENT_ON : SMARTVENT_OFF);
 }
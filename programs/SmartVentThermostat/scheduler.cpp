@@ -0,0 +1,226 @@
+/*
+  scheduler.cpp - Timers with callbacks for the SmartVent Thermostat, run from loop().
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "scheduler.h"
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Heap index of a timer that is not running.
+#define NOT_IN_HEAP 0xFF
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// A timer.
+struct schedTimer {
+  timerCallback callback;
+  uint32_t periodMS;    // 0 for one-shot timer.
+  uint32_t deadline;    // millis() time at which it next expires, if running.
+  uint8_t heapIdx;      // Index in timerHeap, or NOT_IN_HEAP if not running.
+  bool expired;         // True from the time runDueTimers() finds it expired until it is run.
+};
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Timers.
+static schedTimer timers[MAX_TIMERS];
+static uint8_t numTimers = 0;
+
+// Min-heap of the IDs of running timers, ordered by deadline.
+static timerID timerHeap[MAX_TIMERS];
+static uint8_t heapSize = 0;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if millis() time A is before millis() time B.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline bool isBefore(uint32_t A, uint32_t B) {
+  return((int32_t) (A - B) < 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Put timer ID at heap index i.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline void setHeap(uint8_t i, timerID ID) {
+  timerHeap[i] = ID;
+  timers[ID].heapIdx = i;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Move the timer at heap index i up or down to its place in the heap.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void fixHeap(uint8_t i) {
+  timerID ID = timerHeap[i];
+  uint32_t deadline = timers[ID].deadline;
+  while (i > 0 && isBefore(deadline, timers[timerHeap[(i-1)/2]].deadline)) {
+    setHeap(i, timerHeap[(i-1)/2]);
+    i = (i-1)/2;
+  }
+  while (true) {
+    uint8_t child = 2*i+1;
+    if (child >= heapSize)
+      break;
+    if (child+1 < heapSize &&
+        isBefore(timers[timerHeap[child+1]].deadline, timers[timerHeap[child]].deadline))
+      child++;
+    if (!isBefore(timers[timerHeap[child]].deadline, deadline))
+      break;
+    setHeap(i, timerHeap[child]);
+    i = child;
+  }
+  setHeap(i, ID);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Remove timer ID from the heap.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void removeFromHeap(timerID ID) {
+  uint8_t i = timers[ID].heapIdx;
+  timers[ID].heapIdx = NOT_IN_HEAP;
+  if (i != --heapSize) {
+    setHeap(i, timerHeap[heapSize]);
+    fixHeap(i);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Put timer ID in the heap with the given deadline, or move it if it is already there.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void scheduleTimer(timerID ID, uint32_t deadline) {
+  timers[ID].deadline = deadline;
+  if (timers[ID].heapIdx == NOT_IN_HEAP)
+    setHeap(heapSize++, ID);
+  fixHeap(timers[ID].heapIdx);
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add a timer.
+/////////////////////////////////////////////////////////////////////////////////////////////
+timerID addTimer(timerCallback callback, uint32_t periodMS) {
+  if (numTimers == MAX_TIMERS)
+    return(NO_TIMER);
+  schedTimer& T = timers[numTimers];
+  T.callback = callback;
+  T.periodMS = periodMS;
+  T.heapIdx = NOT_IN_HEAP;
+  T.expired = false;
+  return(numTimers++);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start (or restart) a timer.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void startTimer(timerID ID, uint32_t delayMS) {
+  if (ID >= numTimers)
+    return;
+  timers[ID].expired = false;
+  scheduleTimer(ID, millis() + delayMS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Stop a timer.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void stopTimer(timerID ID) {
+  if (ID >= numTimers)
+    return;
+  timers[ID].expired = false;
+  if (timers[ID].heapIdx != NOT_IN_HEAP)
+    removeFromHeap(ID);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if a timer is running.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool isTimerRunning(timerID ID) {
+  return(ID < numTimers && timers[ID].heapIdx != NOT_IN_HEAP);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call the callback of each timer that has expired.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t runDueTimers() {
+  // First take all expired timers off the heap, then put periodic ones back on with their
+  // next deadline, so that each runs once per call and callbacks are free to start and stop
+  // timers, including their own.
+  uint32_t MS = millis();
+  timerID expired[MAX_TIMERS];
+  uint8_t numExpired = 0;
+  while (heapSize > 0 && !isBefore(MS, timers[timerHeap[0]].deadline)) {
+    timerID ID = timerHeap[0];
+    timers[ID].expired = true;
+    expired[numExpired++] = ID;
+    removeFromHeap(ID);
+  }
+  for (uint8_t i = 0; i < numExpired; i++) {
+    schedTimer& T = timers[expired[i]];
+    if (T.periodMS != 0)
+      scheduleTimer(expired[i], T.deadline + T.periodMS);
+  }
+
+  // Run them in deadline order, skipping any that a callback stopped or restarted.
+  for (uint8_t i = 0; i < numExpired; i++) {
+    schedTimer& T = timers[expired[i]];
+    if (T.expired) {
+      T.expired = false;
+      T.callback();
+    }
+  }
+  return(msUntilNextTimer());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of ms until the next timer expires.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t msUntilNextTimer() {
+  if (heapSize == 0)
+    return(UINT32_MAX);
+  uint32_t MS = millis();
+  uint32_t deadline = timers[timerHeap[0]].deadline;
+  return(isBefore(MS, deadline) ? deadline - MS : 0);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,105 @@
+/*
+  scheduler.h - Timers with callbacks for the SmartVent Thermostat, run from loop().
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef scheduler_h
+#define scheduler_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Maximum number of timers that can be added. The sketch adds up to 9.
+#define MAX_TIMERS 10
+
+// Timer ID returned by addTimer() when no more timers can be added.
+#define NO_TIMER 0xFF
+
+// *************************************************************************************** //
+// Types.
+// *************************************************************************************** //
+
+// Timer ID.
+typedef uint8_t timerID;
+
+// Function called when a timer expires.
+typedef void (*timerCallback)();
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add a timer that calls callback when it expires, and return its ID, or NO_TIMER if there
+// are already MAX_TIMERS timers. If periodMS is 0, the timer is a one-shot timer, which
+// stops when it expires. Otherwise it is a periodic timer, which expires every periodMS
+// once started. The timer is initially stopped. The functions below that take a timer ID
+// do nothing (or return false) if given NO_TIMER or any other ID that addTimer() did not
+// return, so a failed addTimer() can't corrupt the timer table.
+//
+// Timer deadlines are kept in a min-heap ordered by millis() time, and comparisons are done
+// on time differences, so they work across millis() wraparound as long as no timer is
+// started with a delay or period of more than 2^31 ms (24.8 days).
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern timerID addTimer(timerCallback callback, uint32_t periodMS = 0);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start (or restart) timer ID so that it first expires delayMS from now.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void startTimer(timerID ID, uint32_t delayMS);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Stop timer ID. It won't expire until started again.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void stopTimer(timerID ID);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if timer ID is running.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool isTimerRunning(timerID ID);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call the callback of each timer that has expired. A periodic timer's next deadline is one
+// period after its last deadline, so it does not drift. If it has fallen more than a period
+// behind, it catches up by expiring on each subsequent call until it is on time again.
+// Return the number of ms until the next timer expires (see msUntilNextTimer()).
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t runDueTimers();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of ms until the next timer expires, 0 if one has already expired, or
+// UINT32_MAX if no timer is running.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t msUntilNextTimer();
+
+#endif // scheduler_h
@@ -234,49 +234,51 @@ void initAdvancedScreen(void) {
 // Draw the advanced screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawAdvancedScreen() {
+  beginScreenDraw(drawAdvancedScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
-  label_Advanced.drawButton();
+  drawScreenWidget(label_Advanced);
 
-  lcd->drawRoundRect(2, 46, 236, 53, 5, BLACK);
+  drawScreenFrame(2, 46, 236, 53, 5, BLACK);
 
-  label_DeltaNewDayTemp.drawButton();
-  btn_DeltaNewDayTempLeft.drawButton();
-  btn_DeltaNewDayTempRight.drawButton();
+  drawScreenWidget(label_DeltaNewDayTemp);
+  drawScreenWidget(btn_DeltaNewDayTempLeft);
+  drawScreenWidget(btn_DeltaNewDayTempRight);
   screenButtons->registerButton(btn_DeltaNewDayTempLeft, btnTap_DeltaNewDayTemp);
   screenButtons->registerButton(btn_DeltaNewDayTempRight, btnTap_DeltaNewDayTemp);
   showDeltaNewDayTemp(true);
 
-  lcd->drawRoundRect(2, 110, 236, 102, 5, BLACK);
+  drawScreenFrame(2, 110, 236, 102, 5, BLACK);
 
-  label_IndoorOffset1.drawButton();
-  label_IndoorOffset2.drawButton();
-  btn_IndoorOffsetLeft.drawButton();
-  btn_IndoorOffsetRight.drawButton();
+  drawScreenWidget(label_IndoorOffset1);
+  drawScreenWidget(label_IndoorOffset2);
+  drawScreenWidget(btn_IndoorOffsetLeft);
+  drawScreenWidget(btn_IndoorOffsetRight);
   screenButtons->registerButton(btn_IndoorOffsetLeft, btnTap_IndoorOffset);
   screenButtons->registerButton(btn_IndoorOffsetRight, btnTap_IndoorOffset);
   showIndoorOffset(true);
 
-  label_Outdoor.drawButton();
-  label_OutdoorOffset.drawButton();
-  btn_OutdoorOffsetLeft.drawButton();
-  btn_OutdoorOffsetRight.drawButton();
+  drawScreenWidget(label_Outdoor);
+  drawScreenWidget(label_OutdoorOffset);
+  drawScreenWidget(btn_OutdoorOffsetLeft);
+  drawScreenWidget(btn_OutdoorOffsetRight);
   screenButtons->registerButton(btn_OutdoorOffsetLeft, btnTap_OutdoorOffset);
   screenButtons->registerButton(btn_OutdoorOffsetRight, btnTap_OutdoorOffset);
   showOutdoorOffset(true);
 
-  btn_Cleaning.drawButton();
+  drawScreenWidget(btn_Cleaning);
   screenButtons->registerButton(btn_Cleaning, btnTap_Cleaning);
 
-  btn_Special.drawButton();
+  drawScreenWidget(btn_Special);
   screenButtons->registerButton(btn_Special, btnTap_Special);
 
-  btn_AdvancedCancel.drawButton();
+  drawScreenWidget(btn_AdvancedCancel);
   screenButtons->registerButton(btn_AdvancedCancel, btnTap_AdvancedCancel);
-  btn_AdvancedSave.drawButton();
+  drawScreenWidget(btn_AdvancedSave);
   screenButtons->registerButton(btn_AdvancedSave, btnTap_AdvancedSave);
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
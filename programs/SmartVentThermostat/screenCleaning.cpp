@@ -88,15 +88,17 @@ void initCleaningScreen(void) {
 // Draw the cleaning screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawCleaningScreen() {
+  beginScreenDraw(drawCleaningScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
 
-  label_Cleaning.drawButton();
-  label_CleanTheScreen.drawButton();
-  label_EndsAfter.drawButton();
-  label_NoActivity.drawButton();
+  drawScreenWidget(label_Cleaning);
+  drawScreenWidget(label_CleanTheScreen);
+  drawScreenWidget(label_EndsAfter);
+  drawScreenWidget(label_NoActivity);
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
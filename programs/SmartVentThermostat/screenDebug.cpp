@@ -46,6 +46,8 @@
 #include "screens.h"
 #include "screenDebug.h"
 #include "screenSpecial.h"
+#include "loopProfiler.h"
+#include "scheduler.h"
 
 // *************************************************************************************** //
 // Constants.
@@ -58,6 +60,19 @@
 #define NUM_ROWS_DEBUG_AREA ((uint8_t)(HEIGHT_DEBUG_AREA/DEBUG_ROW_Y_SPACING))
 #define SPRINTF_FORMAT_THERMISTOR_R_ROW "%5d in:A=%-5d R=%-6d T=%-4s out:A=%-5d R=%-6d T=%-4s" // 60 + \0
 #define LEN_THERMISTOR_R_ROW (5+1+5+5+1+2+6+1+2+4+1+6+5+1+2+6+1+2+4+1) // 60 + \0
+#define SPRINTF_FORMAT_PROFILE_ROW "%-8s %8lu %6lu %6lu %7lu %7lu" // 47 + \0
+#define LEN_PROFILE_ROW 48
+#define DEBUG_PROFILE_UPDATE_MS 1000 // Interval between updates of loop() profile page.
+
+// *************************************************************************************** //
+// Enums.
+// *************************************************************************************** //
+
+// Pages of the Debug screen.
+typedef enum _eDebugPage {
+  DEBUG_PAGE_THERMISTORS,   // Thermistor readings as they are made.
+  DEBUG_PAGE_PROFILE        // loop() profile.
+} eDebugPage;
 
 // *************************************************************************************** //
 // Variables.
@@ -66,10 +81,13 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 // DEBUG SCREEN buttons and fields.
 //
-// The Debug screen shows debug info (currently, indoor temperature resistance values) with a
-// "Done" button at the bottom.
+// The Debug screen shows debug info (thermistor readings, or, if USE_LOOP_PROFILER, the
+// loop() profile, selected with the "Page" button) with a "Done" button at the bottom.
 /////////////////////////////////////////////////////////////////////////////////////////////
 static Button_TT_label label_Debug("DebugScreen");
+#if USE_LOOP_PROFILER
+static Button_TT_label btn_DebugPage("DebugPage");
+#endif
 static Button_TT_label btn_DebugDone("DebugDone");
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,40 +98,119 @@ static Button_TT_label* fields_DebugArea[NUM_ROWS_DEBUG_AREA];
 static uint8_t rowIdx_DebugArea;
 static uint16_t lastReadCount_DebugArea;
 
+#if USE_LOOP_PROFILER
+// Page being shown, and the timer that updates the loop() profile page while it is shown.
+static eDebugPage debugPage = DEBUG_PAGE_THERMISTORS;
+static timerID profilePageTimer = NO_TIMER;
+#endif
+
 // *************************************************************************************** //
 // Local functions.
 // *************************************************************************************** //
 
+#if USE_LOOP_PROFILER
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the loop() profile in the fields_DebugArea rows.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void updateProfilePage() {
+  char S[LEN_PROFILE_ROW];
+  fields_DebugArea[0]->setLabelAndDrawIfChanged("phase       count    min   mean     max     p99");
+  for (uint8_t i = 0; i < NUM_LOOP_PHASES; i++) {
+    loopPhaseStats stats;
+    getLoopPhaseStats((eLoopPhase) i, stats);
+    snprintf_P(S, LEN_PROFILE_ROW, SPRINTF_FORMAT_PROFILE_ROW, getLoopPhaseName((eLoopPhase) i),
+      stats.count, stats.minUS, stats.meanUS, stats.maxUS, stats.p99US);
+    fields_DebugArea[i+1]->setLabelAndDrawIfChanged(S);
+  }
+  loopPhaseStats stats;
+  getLoopPhaseStats(PHASE_LOOP, stats);
+  snprintf_P(S, LEN_PROFILE_ROW, "worst loop() is %lu%% of watchdog timeout",
+    stats.maxUS / (LOOP_PROFILE_WDT_US/100));
+  fields_DebugArea[NUM_LOOP_PHASES+1]->setLabelAndDrawIfChanged(S);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Called by profilePageTimer every DEBUG_PROFILE_UPDATE_MS. Update the loop() profile page,
+// or stop the timer if the page is no longer shown.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void profilePageTimerExpired() {
+  if (currentScreen == SCREEN_DEBUG && debugPage == DEBUG_PAGE_PROFILE)
+    updateProfilePage();
+  else
+    stopTimer(profilePageTimer);
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Check to see if there is a new indoor thermistor R value available, and if so, add it to
 // text_DebugArea and set the new label for field_DebugArea and draw the label if changed.
+// The indoor values are those of the first indoor zone. On the loop() profile page, do
+// nothing, as profilePageTimer updates the page.
 /////////////////////////////////////////////////////////////////////////////////////////////
 static void updateDebugScreen() {
+  #if USE_LOOP_PROFILER
+  if (debugPage == DEBUG_PAGE_PROFILE)
+    return;
+  #endif
   if (lastReadCount_DebugArea != NtempReads) {
     lastReadCount_DebugArea = NtempReads;
     char S[LEN_THERMISTOR_R_ROW];
     char Tin[8];
     char Tout[8];
-    floatToString(degCtoF(TlastIndoorTempRead), Tin, sizeof(Tin), 1);
-    floatToString(degCtoF(TlastOutdoorTempRead), Tout, sizeof(Tout), 1);
+    floatToString(degCtoF(TempSensors.TlastRead[0]), Tin, sizeof(Tin), 1);
+    floatToString(degCtoF(TempSensors.TlastRead[OUTDOOR_SENSOR]), Tout, sizeof(Tout), 1);
     snprintf_P(S, LEN_THERMISTOR_R_ROW, SPRINTF_FORMAT_THERMISTOR_R_ROW,
       lastReadCount_DebugArea,
-      ADClastIndoorTempRead, RlastIndoorTempRead, Tin,
-      ADClastOutdoorTempRead, RlastOutdoorTempRead, Tout);
+      TempSensors.ADClastRead[0], TempSensors.RlastRead[0], Tin,
+      TempSensors.ADClastRead[OUTDOOR_SENSOR], TempSensors.RlastRead[OUTDOOR_SENSOR], Tout);
     fields_DebugArea[rowIdx_DebugArea]->setLabelAndDrawIfChanged(S);
     if (++rowIdx_DebugArea == NUM_ROWS_DEBUG_AREA)
       rowIdx_DebugArea = 0;
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start showing the current page of the debug screen from scratch.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void restartDebugArea() {
+  lastReadCount_DebugArea = NtempReads-1;
+  rowIdx_DebugArea = 0;
+  #if USE_LOOP_PROFILER
+  if (debugPage == DEBUG_PAGE_PROFILE) {
+    updateProfilePage();
+    startTimer(profilePageTimer, DEBUG_PROFILE_UPDATE_MS);
+  } else
+    stopTimer(profilePageTimer);
+  #endif
+  updateDebugScreen();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Button press handlers for the Debug screen.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+#if USE_LOOP_PROFILER
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Handle press of Page button in Debug screen. We switch to the other page.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void btnTap_DebugPage(Button_TT& btn) {
+  if (debugPage == DEBUG_PAGE_THERMISTORS)
+    debugPage = DEBUG_PAGE_PROFILE;
+  else
+    debugPage = DEBUG_PAGE_THERMISTORS;
+  for (uint8_t i = 0; i < NUM_ROWS_DEBUG_AREA; i++)
+    fields_DebugArea[i]->setLabelAndDrawIfChanged("");
+  restartDebugArea();
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Handle press of Done button in Debug screen. We switch to Special screen.
 /////////////////////////////////////////////////////////////////////////////////////////////
 static void btnTap_DebugDone(Button_TT& btn) {
+  #if USE_LOOP_PROFILER
+  stopTimer(profilePageTimer);
+  #endif
   currentScreen = SCREEN_SPECIAL;
   drawSpecialScreen();
 }
@@ -137,26 +234,38 @@ void initDebugScreen(void) {
     y += DEBUG_ROW_Y_SPACING;
   }
 
+  #if USE_LOOP_PROFILER
+  profilePageTimer = addTimer(profilePageTimerExpired, DEBUG_PROFILE_UPDATE_MS);
+  btn_DebugPage.initButton(lcd, "BL", 5, 313, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
+    "C", "Page", false, &font12, RAD);
+  btn_DebugDone.initButton(lcd, "BR", 235, 313, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
+    "C", "Done", false, &font12, RAD);
+  #else
   btn_DebugDone.initButton(lcd, "BC", 120, 313, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
     "C", "Done", false, &font12, RAD);
+  #endif
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Draw the debug screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawDebugScreen() {
+  beginScreenDraw(drawDebugScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
-  label_Debug.drawButton();
+  drawScreenWidget(label_Debug);
 
-  lastReadCount_DebugArea = NtempReads-1;
-  rowIdx_DebugArea = 0;
-  updateDebugScreen();
+  restartDebugArea();
 
-  btn_DebugDone.drawButton();
+  #if USE_LOOP_PROFILER
+  drawScreenWidget(btn_DebugPage);
+  screenButtons->registerButton(btn_DebugPage, btnTap_DebugPage);
+  #endif
+  drawScreenWidget(btn_DebugDone);
   screenButtons->registerButton(btn_DebugDone, btnTap_DebugDone);
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
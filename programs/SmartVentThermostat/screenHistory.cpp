@@ -0,0 +1,378 @@
+/*
+  screenHistory.cpp - Implement temperature history screen for SmartVent Thermostat.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_ILI9341.h>
+#include <XPT2046_Touchscreen_TT.h>
+#include <TS_Display.h>
+#include <Button_TT.h>
+#include <Button_TT_collection.h>
+#include <Button_TT_label.h>
+#include "temperatureHistory.h"
+#include "screens.h"
+#include "screenHistory.h"
+#include "screenSpecial.h"
+#include "deferredLog.h"
+
+#if USE_TEMPERATURE_HISTORY
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// The graph is a strip chart with time running down the LCD, one LCD row per
+// HISTORY_GRAPH_SAMPLES_PER_ROW history samples, newest at the bottom. Temperature runs
+// across the LCD from HISTORY_GRAPH_MIN_F to HISTORY_GRAPH_MIN_F + 80°F, 3 pixels per °F.
+#define HISTORY_GRAPH_SAMPLES_PER_ROW 10
+#define HISTORY_GRAPH_MIN_F 30
+#define HISTORY_GRAPH_PIXELS_PER_F 3
+#define HISTORY_GRAPH_GRID_F 10
+
+// The graph is drawn in the ILI9341 vertical scrolling area, which is the LCD rows between
+// HISTORY_GRAPH_TOP and HISTORY_GRAPH_BOTTOM. The rows above and below it stay fixed.
+#define HISTORY_GRAPH_TOP 45
+#define HISTORY_GRAPH_BOTTOM 247
+#define HISTORY_GRAPH_ROWS (HISTORY_GRAPH_BOTTOM-HISTORY_GRAPH_TOP)
+#define HISTORY_GRAPH_WIDTH 240
+
+// Number of LCD frame memory lines. With setRotation(2), LCD row y is written to frame
+// memory line LCD_LINES-1-y, and the scroll registers count frame memory lines, so the
+// fixed area at the top of the LCD is the bottom fixed area of the frame memory.
+#define LCD_LINES 320
+#define FIRST_GRAPH_LINE (LCD_LINES-HISTORY_GRAPH_BOTTOM)
+#define LAST_GRAPH_LINE (LCD_LINES-1-HISTORY_GRAPH_TOP)
+
+// Colors of the graph.
+#define HISTORY_INDOOR_COLOR RED
+#define HISTORY_OUTDOOR_COLOR BLUE
+#define HISTORY_RELAY_ON_COLOR 0xCFFF  // Pale cyan background where the SmartVent was on.
+#define HISTORY_GRID_COLOR 0xDEFB      // Pale grey
+
+#define LEN_HISTORY_TIMING 40
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// One row of the graph, accumulated from its history samples.
+struct graphRow {
+  uint32_t rowNum;        // Sample index / HISTORY_GRAPH_SAMPLES_PER_ROW.
+  int32_t indoorSum;      // Sum of the indoor temperatures in tenths of a °F.
+  int32_t outdoorSum;     // Sum of the outdoor temperatures in tenths of a °F.
+  uint8_t numSamples;     // Number of samples summed.
+  bool relayOn;           // True if the SmartVent relay was on in any sample.
+};
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// HISTORY SCREEN buttons and fields.
+//
+// The History screen shows a graph of the indoor and outdoor temperature history, shaded
+// where the SmartVent was on, with the time taken to draw it and a "Done" button at the
+// bottom.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static Button_TT_label label_History("HistoryScreen");
+static Button_TT_label label_HistoryScale40("HistoryScale40");
+static Button_TT_label label_HistoryScale60("HistoryScale60");
+static Button_TT_label label_HistoryScale80("HistoryScale80");
+static Button_TT_label label_HistoryScale100("HistoryScale100");
+static Button_TT_label field_HistoryTiming("HistoryTiming");
+static Button_TT_label label_HistoryIndoor("HistoryIndoor");
+static Button_TT_label label_HistoryOutdoor("HistoryOutdoor");
+static Button_TT_label btn_HistoryDone("HistoryDone");
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Variables for drawing the graph. Each new graph row is drawn on the frame memory line
+// above the previous one, which holds the oldest row shown, and the scroll start is moved
+// to it, so that the LCD shows it at the bottom of the graph and every other row one row
+// higher. Adding a sample thus redraws one row, never the whole graph.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static historyIterator graphIterator;   // Returns the samples not yet added to the graph.
+static graphRow curRow;                 // Newest graph row.
+static bool haveRow;                    // True if curRow holds a row.
+static int16_t prevIndoorX;             // x of the row before curRow, or -1 if none.
+static int16_t prevOutdoorX;
+static uint16_t newestLine;             // Frame memory line of curRow.
+
+// Times in µs of the last full replot of the graph and of adding the last sample.
+static uint32_t replotUS;
+static uint32_t sampleUS;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the graph x-coordinate of the average temperature sum/N in tenths of a °F.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int16_t graphX(int32_t sum, uint8_t N) {
+  int32_t x = (sum/N - HISTORY_GRAPH_MIN_F*10) * HISTORY_GRAPH_PIXELS_PER_F / 10;
+  return(constrain(x, 0, HISTORY_GRAPH_WIDTH-1));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the graph scrolling area and scroll it to show frame memory line newestLine at the
+// bottom of the graph.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void scrollGraph() {
+  waitLCDtransfers();
+  lcd->setScrollMargins(FIRST_GRAPH_LINE, HISTORY_GRAPH_TOP);
+  lcd->scrollTo(newestLine);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Turn off scrolling, returning the LCD to showing frame memory unscrolled.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void unscrollGraph() {
+  waitLCDtransfers();
+  lcd->setScrollMargins(0, 0);
+  lcd->scrollTo(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start a new graph row for rowNum, on the frame memory line above that of the current row.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startGraphRow(uint32_t rowNum) {
+  if (haveRow) {
+    prevIndoorX = graphX(curRow.indoorSum, curRow.numSamples);
+    prevOutdoorX = graphX(curRow.outdoorSum, curRow.numSamples);
+  }
+  newestLine = (newestLine == FIRST_GRAPH_LINE) ? LAST_GRAPH_LINE : newestLine-1;
+  curRow = { rowNum, 0, 0, 0, false };
+  haveRow = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw a line of the graph from the previous row's x-coordinate to x, or just at x if there
+// is no previous row.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void drawGraphTrace(int16_t y, int16_t prevX, int16_t x, uint16_t color) {
+  if (prevX < 0)
+    prevX = x;
+  int16_t x0 = min(prevX, x);
+  int16_t x1 = max(prevX, x);
+  lcd->writeFastHLine(x0, y, x1-x0+2, color);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw curRow on its frame memory line, which is the LCD row given by the unscrolled
+// y-coordinate of that line.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void drawGraphRow() {
+  int16_t y = LCD_LINES-1-newestLine;
+  lcd->startWrite();
+  lcd->writeFastHLine(0, y, HISTORY_GRAPH_WIDTH,
+    curRow.relayOn ? HISTORY_RELAY_ON_COLOR : WHITE);
+  for (int16_t x = HISTORY_GRAPH_GRID_F*HISTORY_GRAPH_PIXELS_PER_F; x < HISTORY_GRAPH_WIDTH;
+      x += HISTORY_GRAPH_GRID_F*HISTORY_GRAPH_PIXELS_PER_F)
+    lcd->writePixel(x, y, HISTORY_GRID_COLOR);
+  drawGraphTrace(y, prevOutdoorX, graphX(curRow.outdoorSum, curRow.numSamples),
+    HISTORY_OUTDOOR_COLOR);
+  drawGraphTrace(y, prevIndoorX, graphX(curRow.indoorSum, curRow.numSamples),
+    HISTORY_INDOOR_COLOR);
+  lcd->endWrite();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add history sample S to the graph rows, starting a new row if it belongs to the next one,
+// and return true if it did.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool addGraphSample(const historySample& S) {
+  uint32_t rowNum = S.index / HISTORY_GRAPH_SAMPLES_PER_ROW;
+  bool newRow = (!haveRow || rowNum != curRow.rowNum);
+  if (newRow)
+    startGraphRow(rowNum);
+  curRow.indoorSum += S.indoorTenthsF;
+  curRow.outdoorSum += S.outdoorTenthsF;
+  curRow.numSamples++;
+  if (S.relayOn)
+    curRow.relayOn = true;
+  return(newRow);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Show the graph drawing times.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void showGraphTiming() {
+  char S[LEN_HISTORY_TIMING];
+  snprintf_P(S, LEN_HISTORY_TIMING, "sample %lu us, replot %lu us", sampleUS, replotUS);
+  field_HistoryTiming.setLabelAndDrawIfChanged(S);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clear the graph and draw it again from the history, as many rows as fit on the LCD. One
+// more row is drawn first and then overwritten, so that the top row joins the one before it
+// just as it did when it was added.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void replotGraph() {
+  uint32_t startUS = micros();
+  lcd->fillRect(0, HISTORY_GRAPH_TOP, HISTORY_GRAPH_WIDTH, HISTORY_GRAPH_ROWS, WHITE);
+  haveRow = false;
+  prevIndoorX = -1;
+  prevOutdoorX = -1;
+  newestLine = FIRST_GRAPH_LINE;
+
+  historyStats stats;
+  getHistoryStats(stats);
+  uint32_t fromIndex = 0;
+  if (stats.numSamples > 0) {
+    uint32_t lastRowNum = (stats.oldestIndex + stats.numSamples - 1) /
+      HISTORY_GRAPH_SAMPLES_PER_ROW;
+    if (lastRowNum > HISTORY_GRAPH_ROWS)
+      fromIndex = (lastRowNum - HISTORY_GRAPH_ROWS) * HISTORY_GRAPH_SAMPLES_PER_ROW;
+  }
+  startHistoryIterator(graphIterator, fromIndex);
+  historySample S;
+  while (nextHistorySample(graphIterator, S)) {
+    if (haveRow && S.index / HISTORY_GRAPH_SAMPLES_PER_ROW != curRow.rowNum)
+      drawGraphRow();
+    addGraphSample(S);
+  }
+  if (haveRow)
+    drawGraphRow();
+  scrollGraph();
+
+  replotUS = micros() - startUS;
+  logPrintf("History graph replotted in %lu us\n", replotUS);
+  showGraphTiming();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Button press handlers for the History screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Handle press of Done button in History screen. We turn off scrolling and switch to
+// Special screen, which erases the graph.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void btnTap_HistoryDone(Button_TT& btn) {
+  unscrollGraph();
+  currentScreen = SCREEN_SPECIAL;
+  drawSpecialScreen();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw the history screen's fixed widgets and register its buttons with the screenButtons
+// object.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void drawHistoryWidgets() {
+  beginScreenDraw(drawHistoryWidgets);
+  screenButtons->clear();
+
+  lcd->setTextSize(1);
+  drawScreenWidget(label_History);
+  drawScreenWidget(label_HistoryScale40);
+  drawScreenWidget(label_HistoryScale60);
+  drawScreenWidget(label_HistoryScale80);
+  drawScreenWidget(label_HistoryScale100);
+  drawScreenWidget(field_HistoryTiming);
+  drawScreenWidget(label_HistoryIndoor);
+  drawScreenWidget(label_HistoryOutdoor);
+
+  drawScreenWidget(btn_HistoryDone);
+  screenButtons->registerButton(btn_HistoryDone, btnTap_HistoryDone);
+
+  endScreenDraw();
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the history screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initHistoryScreen(void) {
+  label_History.initButton(lcd, "TC", 120, 5, TEW, TEW, CLEAR, CLEAR, DARKGREEN,
+    "C", "History", false, &font18B);
+
+  // Temperature scale, centered on the 40, 60, 80, and 100°F grid lines.
+  label_HistoryScale40.initButton(lcd, "TC", 30, 30, TEW, TEW, CLEAR, CLEAR, BLACK,
+    "C", "40", false, &font9);
+  label_HistoryScale60.initButton(lcd, "TC", 90, 30, TEW, TEW, CLEAR, CLEAR, BLACK,
+    "C", "60", false, &font9);
+  label_HistoryScale80.initButton(lcd, "TC", 150, 30, TEW, TEW, CLEAR, CLEAR, BLACK,
+    "C", "80", false, &font9);
+  label_HistoryScale100.initButton(lcd, "TC", 210, 30, TEW, TEW, CLEAR, CLEAR, BLACK,
+    "C", "100", false, &font9);
+
+  field_HistoryTiming.initButton(lcd, "TC", 120, HISTORY_GRAPH_BOTTOM+5, 230, 8, WHITE, WHITE,
+    NAVY, "C", "", false, &fontTom);
+
+  label_HistoryIndoor.initButton(lcd, "BL", 5, 303, TEW, TEW, CLEAR, CLEAR,
+    HISTORY_INDOOR_COLOR, "C", "Indoor", false, &font9);
+  label_HistoryOutdoor.initButton(lcd, "BR", 235, 303, TEW, TEW, CLEAR, CLEAR,
+    HISTORY_OUTDOOR_COLOR, "C", "Outdoor", false, &font9);
+
+  btn_HistoryDone.initButton(lcd, "BC", 120, 313, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
+    "C", "Done", false, &font12, RAD);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw the history screen and register its buttons with the screenButtons object. The
+// graph is drawn after the screen's widgets, so that it is not drawn twice by
+// beginScreenDraw(). It is erased like other drawing outside widgets by the next screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void drawHistoryScreen() {
+  drawHistoryWidgets();
+  replotGraph();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Perform loop() function processing for the history screen when it is displayed. Each new
+// history sample redraws only the newest graph row, scrolling the graph up one row when it
+// starts a new one.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void loopHistoryScreen() {
+  historySample S;
+  if (!nextHistorySample(graphIterator, S))
+    return;
+  uint32_t startUS = micros();
+  bool newRow = addGraphSample(S);
+  drawGraphRow();
+  if (newRow)
+    scrollGraph();
+  sampleUS = micros() - startUS;
+  logPrintf("History sample %lu added to graph in %lu us\n", S.index, sampleUS);
+  showGraphTiming();
+}
+
+#endif // USE_TEMPERATURE_HISTORY
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
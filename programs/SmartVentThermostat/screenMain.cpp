@@ -49,6 +49,7 @@
 #include "screenMain.h"
 #include "screenAdvanced.h"
 #include "screenSettings.h"
+#include "deferredLog.h"
 
 // *************************************************************************************** //
 // Constants.
@@ -63,6 +64,14 @@
 #define STR_AWAIT_HOT   "Wait Hot"    // For state ARM_AWAIT_HOT
 #define STR_AWAIT_ON    "Wait On"     // For state ARM_AWAIT_ON
 
+// Bits of dirtyMainFields identifying the Main screen fields whose displayed values may have
+// changed and must be flushed to the screen.
+#define DIRTY_TEMPERATURES  0x01
+#define DIRTY_VENT_ON_OFF   0x02
+#define DIRTY_MODE_BUTTON   0x04
+#define DIRTY_RUN_TIMER     0x08
+#define DIRTY_ARM_STATE     0x10
+
 // *************************************************************************************** //
 // Variables.
 // *************************************************************************************** //
@@ -94,18 +103,35 @@ static Button_TT_label btn_ArmState("ArmState");
 static Button_TT_label btn_Settings("Settings");
 static Button_TT_label btn_Advanced("Advanced");
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Variables for tracking which Main screen fields must be redrawn. shownMain holds the
+// values the displayed fields were last drawn from, and dirtyMainFields has a DIRTY_* bit
+// set for each field whose value has changed since then.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static struct {
+  int16_t indoorTemp;
+  int16_t outdoorTemp;
+  bool smartVentOn;
+  eSmartVentMode userMode;
+  eSmartVentMode activeMode;
+  uint32_t runTimeSecs;
+  eArmState armState;
+} shownMain;
+static uint8_t dirtyMainFields;
+
 // *************************************************************************************** //
 // Local functions.
 // *************************************************************************************** //
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Set the fields for the indoor and output temperatures to new current values and draw them.
+// These are the temperatures that SmartVent control acts on (see getShownTemperatures()).
 /////////////////////////////////////////////////////////////////////////////////////////////
 static void showTemperatures(bool forceDraw = false) {
-  field_IndoorTemp.setValueAndDrawIfChanged(
-    curIndoorTemperature.Tf_int16+activeSettings.IndoorOffsetF, forceDraw);
-  field_OutdoorTemp.setValueAndDrawIfChanged(
-    curOutdoorTemperature.Tf_int16+activeSettings.OutdoorOffsetF, forceDraw);
+  int16_t indoorTemp, outdoorTemp;
+  getShownTemperatures(indoorTemp, outdoorTemp);
+  field_IndoorTemp.setValueAndDrawIfChanged(indoorTemp, forceDraw);
+  field_OutdoorTemp.setValueAndDrawIfChanged(outdoorTemp, forceDraw);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -188,7 +214,7 @@ static void showHideSmartVentArmStateButton(bool forceDraw = false) {
       break;
     default:
       S = "Error";
-      monitor.printf("ArmState is %d, wrong!\n", ArmState);
+      logPrintf("ArmState is %d, wrong!\n", ArmState);
       break;
     }
     btn_ArmState.setLabelAndDrawIfChanged(S, forceDraw);
@@ -196,6 +222,68 @@ static void showHideSmartVentArmStateButton(bool forceDraw = false) {
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Compare the values shown by the Main screen fields with their current values, setting
+// the DIRTY_* bits in dirtyMainFields for fields that changed and updating shownMain.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void markDirtyMainFields() {
+  int16_t indoorTemp, outdoorTemp;
+  getShownTemperatures(indoorTemp, outdoorTemp);
+  if (indoorTemp != shownMain.indoorTemp || outdoorTemp != shownMain.outdoorTemp) {
+    shownMain.indoorTemp = indoorTemp;
+    shownMain.outdoorTemp = outdoorTemp;
+    dirtyMainFields |= DIRTY_TEMPERATURES;
+  }
+  if (getSmartVent() != shownMain.smartVentOn) {
+    shownMain.smartVentOn = getSmartVent();
+    dirtyMainFields |= DIRTY_VENT_ON_OFF;
+  }
+  if (userSettings.SmartVentMode != shownMain.userMode) {
+    shownMain.userMode = userSettings.SmartVentMode;
+    dirtyMainFields |= DIRTY_MODE_BUTTON | DIRTY_ARM_STATE;
+  }
+  if (activeSettings.SmartVentMode != shownMain.activeMode) {
+    shownMain.activeMode = activeSettings.SmartVentMode;
+    dirtyMainFields |= DIRTY_RUN_TIMER | DIRTY_ARM_STATE;
+  }
+  if (RunTimeMS/1000 != shownMain.runTimeSecs) {
+    shownMain.runTimeSecs = RunTimeMS/1000;
+    dirtyMainFields |= DIRTY_RUN_TIMER;
+  }
+  if (ArmState != shownMain.armState) {
+    shownMain.armState = ArmState;
+    dirtyMainFields |= DIRTY_ARM_STATE;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Redraw the Main screen fields marked dirty in dirtyMainFields (only if their displayed
+// text actually changed), and clear dirtyMainFields. When the temperatures are redrawn, the
+// LCD SPI traffic it caused is written to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void flushDirtyMainFields() {
+  if (dirtyMainFields & DIRTY_TEMPERATURES) {
+    #if COUNT_LCD_TRAFFIC
+    lcdTraffic start = LCDtraffic;
+    uint32_t startUS = micros();
+    showTemperatures();
+    logPrintf("Temperature update: %lu LCD bytes, %lu us\n", getLCDbytesSince(start),
+      micros() - startUS);
+    #else
+    showTemperatures();
+    #endif
+  }
+  if (dirtyMainFields & DIRTY_VENT_ON_OFF)
+    showSmartVentOnOff();
+  if (dirtyMainFields & DIRTY_MODE_BUTTON)
+    showSmartVentModeButton();
+  if (dirtyMainFields & DIRTY_RUN_TIMER)
+    showHideSmartVentRunTimer();
+  if (dirtyMainFields & DIRTY_ARM_STATE)
+    showHideSmartVentArmStateButton();
+  dirtyMainFields = 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Button press handlers for the Main screen.
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -323,19 +411,19 @@ void initMainScreen(void) {
 // Draw the main screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawMainScreen() {
+  beginScreenDraw(drawMainScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
 
-  label_Smart.drawButton();
-  label_Vent.drawButton();
+  drawScreenWidget(label_Smart);
+  drawScreenWidget(label_Vent);
 
-  label_IndoorTemp.drawButton();
-  label_OutdoorTemp.drawButton();
-  btn_Settings.drawButton();
+  drawScreenWidget(label_IndoorTemp);
+  drawScreenWidget(label_OutdoorTemp);
+  drawScreenWidget(btn_Settings);
   screenButtons->registerButton(btn_Settings, btnTap_Settings);
-  btn_Advanced.drawButton();
+  drawScreenWidget(btn_Advanced);
   screenButtons->registerButton(btn_Advanced, btnTap_Advanced);
 
   showTemperatures(true);
@@ -344,29 +432,25 @@ void drawMainScreen() {
   screenButtons->registerButton(btn_OffAutoOn, btnTap_OffAutoOn);
   showHideSmartVentRunTimer(true);
   showHideSmartVentArmStateButton(true);
+
+  // All fields now show current values.
+  markDirtyMainFields();
+  dirtyMainFields = 0;
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Perform loop() function processing for the main screen when it is displayed.
 //
 // Elements of the main screen that can change are redrawn here (only if they
-// have actually changed).
+// have actually changed). The values each field is drawn from are checked for changes
+// (indoor and outdoor temperatures, SmartVent ON/OFF, SmartVent mode, run timer, and
+// ArmState), and then only the fields whose values changed are redrawn, in one step.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void loopMainScreen() {
-  // Update current indoor and outdoor temperatures on the screen.
-  showTemperatures();
-
-  // Update SmartVent ON/OFF on the screen.
-  showSmartVentOnOff();
-
-  // Update SmartVent mode button text.
-  showSmartVentModeButton();
-
-  // Update SmartVent run timer on the screen.
-  showHideSmartVentRunTimer();
-
-  // Update ArmState/DisArmState button on the screen.
-  showHideSmartVentArmStateButton();
+  markDirtyMainFields();
+  flushDirtyMainFields();
 }
 
 // *************************************************************************************** //
@@ -243,52 +243,54 @@ void initSettingsScreen(void) {
 // Draw the settings screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawSettingsScreen() {
+  beginScreenDraw(drawSettingsScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
-  label_Settings.drawButton();
+  drawScreenWidget(label_Settings);
 
-  lcd->drawRoundRect(2, 46, 236, 149, 5, BLACK);
+  drawScreenFrame(2, 46, 236, 149, 5, BLACK);
 
-  label_TempSetpointOn.drawButton();
-  btn_TempSetpointOnLeft.drawButton();
-  btn_TempSetpointOnRight.drawButton();
+  drawScreenWidget(label_TempSetpointOn);
+  drawScreenWidget(btn_TempSetpointOnLeft);
+  drawScreenWidget(btn_TempSetpointOnRight);
   screenButtons->registerButton(btn_TempSetpointOnLeft, btnTap_TempSetpointOn);
   screenButtons->registerButton(btn_TempSetpointOnRight, btnTap_TempSetpointOn);
   showTemperatureSetpoint(true);
 
-  label1_DeltaTempForOn.drawButton();
-  label2_DeltaTempForOn.drawButton();
-  btn_DeltaTempForOnLeft.drawButton();
-  btn_DeltaTempForOnRight.drawButton();
+  drawScreenWidget(label1_DeltaTempForOn);
+  drawScreenWidget(label2_DeltaTempForOn);
+  drawScreenWidget(btn_DeltaTempForOnLeft);
+  drawScreenWidget(btn_DeltaTempForOnRight);
   screenButtons->registerButton(btn_DeltaTempForOnLeft, btnTap_DeltaTempForOn);
   screenButtons->registerButton(btn_DeltaTempForOnRight, btnTap_DeltaTempForOn);
 
-  label_Hysteresis1.drawButton();
-  label_Hysteresis2.drawButton();
-  btn_HysteresisLeft.drawButton();
-  btn_HysteresisRight.drawButton();
+  drawScreenWidget(label_Hysteresis1);
+  drawScreenWidget(label_Hysteresis2);
+  drawScreenWidget(btn_HysteresisLeft);
+  drawScreenWidget(btn_HysteresisRight);
   screenButtons->registerButton(btn_HysteresisLeft, btnTap_Hysteresis);
   screenButtons->registerButton(btn_HysteresisRight, btnTap_Hysteresis);
 
   showTemperatureDifferentials(true);
 
-  lcd->drawRoundRect(2, 209, 236, 53, 5, BLACK);
+  drawScreenFrame(2, 209, 236, 53, 5, BLACK);
 
-  label_MaxRun1.drawButton();
-  label_MaxRun2.drawButton();
-  btn_MaxRunTimeLeft.drawButton();
-  btn_MaxRunTimeRight.drawButton();
+  drawScreenWidget(label_MaxRun1);
+  drawScreenWidget(label_MaxRun2);
+  drawScreenWidget(btn_MaxRunTimeLeft);
+  drawScreenWidget(btn_MaxRunTimeRight);
   screenButtons->registerButton(btn_MaxRunTimeLeft, btnTap_MaxRunTime);
   screenButtons->registerButton(btn_MaxRunTimeRight, btnTap_MaxRunTime);
-  label_MaxRun3.drawButton();
+  drawScreenWidget(label_MaxRun3);
   showMaxRunTime(true);
 
-  btn_SettingsCancel.drawButton();
+  drawScreenWidget(btn_SettingsCancel);
   screenButtons->registerButton(btn_SettingsCancel, btnTap_SettingsCancel);
-  btn_SettingsSave.drawButton();
+  drawScreenWidget(btn_SettingsSave);
   screenButtons->registerButton(btn_SettingsSave, btnTap_SettingsSave);
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +46,7 @@
 #include "screenAdvanced.h"
 #include "screenCalibration.h"
 #include "screenDebug.h"
+#include "screenHistory.h"
 
 // *************************************************************************************** //
 // Variables.
@@ -55,11 +56,14 @@
 // SPECIAL SCREEN buttons and fields.
 //
 // The Special screen shows more buttons to enter additional specialized screens, currently
-// the calibration screen and debug screen.
+// the calibration screen, debug screen, and history screen.
 /////////////////////////////////////////////////////////////////////////////////////////////
 static Button_TT_label label_Special("SpecialScreen");
 static Button_TT_label btn_Calibration("Calibration");
 static Button_TT_label btn_Debug("Debug");
+#if USE_TEMPERATURE_HISTORY
+static Button_TT_label btn_History("History");
+#endif
 static Button_TT_label btn_SpecialDone("SpecialDone");
 
 // *************************************************************************************** //
@@ -86,6 +90,16 @@ static void btnTap_Debug(Button_TT& btn) {
   drawDebugScreen();
 }
 
+#if USE_TEMPERATURE_HISTORY
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Handle press of History button in Special screen. We switch to History screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void btnTap_History(Button_TT& btn) {
+  currentScreen = SCREEN_HISTORY;
+  drawHistoryScreen();
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Handle press of Done button in Special screen. We switch (back) to Advanced screen.
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +123,10 @@ void initSpecialScreen(void) {
     "C", "Calibrate", false, &font12, RAD);
   btn_Debug.initButton(lcd, "TR", 235, 223, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
     "C", "Debug", false, &font12, RAD);
+  #if USE_TEMPERATURE_HISTORY
+  btn_History.initButton(lcd, "TC", 120, 163, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
+    "C", "History", false, &font12, RAD);
+  #endif
 
   btn_SpecialDone.initButton(lcd, "BC", 120, 313, BTN_WIDTH, BTN_HEIGHT, BLACK, PINK, BLACK,
     "C", "Done", false, &font12, RAD);
@@ -118,20 +136,27 @@ void initSpecialScreen(void) {
 // Draw the special screen and register its buttons with the screenButtons object.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void drawSpecialScreen() {
+  beginScreenDraw(drawSpecialScreen);
   screenButtons->clear();
 
-  lcd->fillScreen(WHITE);
   lcd->setTextSize(1);
-  label_Special.drawButton();
+  drawScreenWidget(label_Special);
 
-  btn_Calibration.drawButton();
+  drawScreenWidget(btn_Calibration);
   screenButtons->registerButton(btn_Calibration, btnTap_Calibration);
 
-  btn_Debug.drawButton();
+  drawScreenWidget(btn_Debug);
   screenButtons->registerButton(btn_Debug, btnTap_Debug);
 
-  btn_SpecialDone.drawButton();
+  #if USE_TEMPERATURE_HISTORY
+  drawScreenWidget(btn_History);
+  screenButtons->registerButton(btn_History, btnTap_History);
+  #endif
+
+  drawScreenWidget(btn_SpecialDone);
   screenButtons->registerButton(btn_SpecialDone, btnTap_SpecialDone);
+
+  endScreenDraw();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,7 +40,9 @@
 #include <Button_TT.h>
 #include <Button_TT_collection.h>
 #include "pinSettings.h"
+#include "glyphCache.h"
 #include "screens.h"
+#include "deferredLog.h"
 
 // Default for _PWM_LOGLEVEL_ if not defined is 1, SAMD_PWM tries to log stuff to serial monitor.
 // If USE_MONITOR_PORT is defined as 0, we define _PWM_LOGLEVEL_ as 0 too.
@@ -50,6 +52,9 @@
 #define _PWM_LOGLEVEL_ 1
 #endif
 #include <SAMD_PWM.h>
+#if USE_LCD_DMA
+#include <Adafruit_ZeroDMA.h>
+#endif
 
 // *************************************************************************************** //
 // Constants.
@@ -60,6 +65,489 @@
 // Duty cycle of "tone" (a square wave) in percent.  0 turns it off.
 #define TS_TONE_DUTY    50
 
+// SPI bytes it takes to set up an LCD address window (CASET, RASET, and RAMWR commands with
+// their parameters).
+#define LCD_WINDOW_BYTES        11
+
+#if USE_LCD_DMA
+// SERCOM used by the SPI bus on the Nano 33 IoT, and its DMA trigger for transmit.
+#define LCD_SPI_SERCOM          SERCOM1
+#define LCD_SPI_DMAC_ID_TX      SERCOM1_DMAC_ID_TX
+#endif
+
+#if INCREMENTAL_SCREEN_DRAW
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Rectangle on the LCD, given by its inclusive corner coordinates. Empty if x0 > x1.
+struct lcdRect {
+  int16_t x0, y0, x1, y1;
+};
+
+// A widget drawn on a screen by drawScreenWidget() or drawScreenFrame().
+struct screenWidget {
+  lcdRect box;      // Bounding box of everything the widget drew.
+  uint32_t sig;     // Hash of the drawing operations of the widget, identifies its look.
+  bool keep;        // True if it is already on the LCD in a screen transition.
+};
+
+// *************************************************************************************** //
+// Enums.
+// *************************************************************************************** //
+
+// Passes made over a screen draw function by beginScreenDraw().
+typedef enum _eDrawPass {
+  DRAW_PASS_IDLE,   // Not drawing a screen.
+  DRAW_PASS_PLAN,   // Collecting widgets with LCD output suppressed.
+  DRAW_PASS_DRAW    // Drawing the screen.
+} eDrawPass;
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Current pass of screen drawing.
+static eDrawPass drawPass = DRAW_PASS_IDLE;
+
+// True once the LCD has been cleared, so its contents are known.
+static bool lcdKnown = false;
+
+// Widgets on the LCD now, and widgets of the screen being drawn.
+static screenWidget shownWidgets[MAX_SCREEN_WIDGETS];
+static uint8_t numShownWidgets = 0;
+static screenWidget newWidgets[MAX_SCREEN_WIDGETS];
+static uint8_t numNewWidgets = 0;
+
+// Index of the next widget of the screen being drawn, and number of its widgets kept from
+// the previous screen.
+static uint8_t widgetIdx;
+static uint8_t numKeptWidgets;
+
+// Bounding boxes of drawing on the LCD outside of widgets since the LCD was last cleared or
+// erased. This includes drawing done after a screen was drawn, such as value updates.
+static lcdRect looseRects[MAX_LOOSE_RECTS];
+static uint8_t numLooseRects = 0;
+
+// Regions of the LCD marked dirty, to be erased by the next flushDirtyRects().
+static lcdRect dirtyRects[MAX_DIRTY_RECTS];
+static uint8_t numDirtyRects = 0;
+
+// True while a widget is being drawn, and during DRAW_PASS_PLAN its bounding box and hash.
+static bool inWidget = false;
+static lcdRect widgetBox;
+static uint32_t widgetSig;
+#endif
+
+#if USE_LCD_DMA
+// *************************************************************************************** //
+// LCD DMA.
+// *************************************************************************************** //
+
+// DMA channel and its descriptor for sending pixels to the LCD, and true if they were
+// successfully allocated.
+static Adafruit_ZeroDMA lcdDMA;
+static DmacDescriptor* lcdDMAdesc;
+static bool lcdDMAready = false;
+
+// Buffer of pixels (byte-swapped fill color) sent by DMA, and the color it holds.
+static uint16_t lcdDMAbuf[LCD_DMA_BUF_PIXELS];
+static uint16_t lcdDMAbufColor;
+static bool lcdDMAbufValid = false;
+
+// True while a DMA fill is in progress (until waitLCDtransfers() ends its SPI transaction),
+// true when all its bytes have been sent by DMA, and number of bytes still to be queued.
+static bool lcdDMAactive = false;
+static volatile bool lcdDMAdone;
+static volatile uint32_t lcdDMAbytesLeft;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start a DMA transfer of the next chunk of the current fill from lcdDMAbuf to the SPI bus.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startLCDDMAchunk() {
+  uint32_t N = lcdDMAbytesLeft;
+  if (N > sizeof(lcdDMAbuf))
+    N = sizeof(lcdDMAbuf);
+  lcdDMAbytesLeft -= N;
+  lcdDMA.changeDescriptor(lcdDMAdesc, lcdDMAbuf, (void*) &LCD_SPI_SERCOM->SPI.DATA.reg, N);
+  lcdDMA.startJob();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// DMA transfer complete interrupt callback: start the next chunk, if any.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void lcdDMAcallback(Adafruit_ZeroDMA* dma) {
+  if (lcdDMAbytesLeft > 0)
+    startLCDDMAchunk();
+  else
+    lcdDMAdone = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start filling rectangle (x,y,w,h) with color by DMA and return true, or return false if
+// it is too small to be worth it, or DMA is unavailable. The caller must have waited for
+// any previous DMA fill to finish.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool fillRectDMA(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  // Clip to the LCD, as Adafruit_SPITFT::fillRect() does.
+  if (w < 0) { x += w+1; w = -w; }
+  if (h < 0) { y += h+1; h = -h; }
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x+w > lcd->width()) w = lcd->width()-x;
+  if (y+h > lcd->height()) h = lcd->height()-y;
+  if (!lcdDMAready || w <= 0 || h <= 0 || (uint32_t) w*h < LCD_DMA_MIN_PIXELS)
+    return(false);
+
+  // The LCD takes the most significant byte of each pixel first.
+  if (!lcdDMAbufValid || lcdDMAbufColor != color) {
+    uint16_t swapped = (color << 8) | (color >> 8);
+    for (uint16_t i = 0; i < LCD_DMA_BUF_PIXELS; i++)
+      lcdDMAbuf[i] = swapped;
+    lcdDMAbufColor = color;
+    lcdDMAbufValid = true;
+  }
+
+  // Set the address window with the CPU, then turn off the SPI receiver so that it doesn't
+  // overflow while DMA sends the pixels, and start sending them.
+  lcd->Adafruit_ILI9341::startWrite();
+  lcd->setAddrWindow(x, y, w, h);
+  LCD_SPI_SERCOM->SPI.CTRLB.bit.RXEN = 0;
+  while (LCD_SPI_SERCOM->SPI.SYNCBUSY.bit.CTRLB)
+    ;
+  lcdDMAbytesLeft = 2 * (uint32_t) w * (uint32_t) h;
+  lcdDMAdone = false;
+  lcdDMAactive = true;
+  startLCDDMAchunk();
+  return(true);
+}
+#endif
+
+// *************************************************************************************** //
+// Classes.
+// *************************************************************************************** //
+
+#if INCREMENTAL_SCREEN_DRAW
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if rectangles A and B overlap or are adjacent.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool rectsTouch(const lcdRect& A, const lcdRect& B) {
+  return(A.x0 <= A.x1 && B.x0 <= B.x1 && A.x0 <= B.x1+1 && B.x0 <= A.x1+1 &&
+    A.y0 <= B.y1+1 && B.y0 <= A.y1+1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if rectangles A and B overlap.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool rectsOverlap(const lcdRect& A, const lcdRect& B) {
+  return(A.x0 <= A.x1 && B.x0 <= B.x1 && A.x0 <= B.x1 && B.x0 <= A.x1 &&
+    A.y0 <= B.y1 && B.y0 <= A.y1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Enlarge rectangle A to include rectangle B.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void uniteRect(lcdRect& A, const lcdRect& B) {
+  if (A.x0 > A.x1) {
+    A = B;
+    return;
+  }
+  if (B.x0 < A.x0) A.x0 = B.x0;
+  if (B.y0 < A.y0) A.y0 = B.y0;
+  if (B.x1 > A.x1) A.x1 = B.x1;
+  if (B.y1 > A.y1) A.y1 = B.y1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Fill rectangle R on the LCD with white.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void eraseRect(const lcdRect& R) {
+  if (R.x0 <= R.x1)
+    lcd->fillRect(R.x0, R.y0, R.x1-R.x0+1, R.y1-R.y0+1, WHITE);
+}
+
+#if COALESCE_DIRTY_RECTS
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of pixels in rectangle R.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t rectArea(const lcdRect& R) {
+  if (R.x0 > R.x1 || R.y0 > R.y1)
+    return(0);
+  return((uint32_t) (R.x1-R.x0+1) * (uint32_t) (R.y1-R.y0+1));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of SPI bytes it takes to fill rectangle R.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t rectBytes(const lcdRect& R) {
+  return(LCD_WINDOW_BYTES + 2*rectArea(R));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of pixels in both rectangle A and rectangle B.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t overlapArea(const lcdRect& A, const lcdRect& B) {
+  if (!rectsOverlap(A, B))
+    return(0);
+  lcdRect I = { max(A.x0, B.x0), max(A.y0, B.y0), min(A.x1, B.x1), min(A.y1, B.y1) };
+  return(rectArea(I));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if rectangle R overlaps a widget of the screen being drawn that is kept on
+// the LCD, and so must not be erased.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool overlapsKeptWidget(const lcdRect& R) {
+  for (uint8_t j = 0; j < numNewWidgets; j++)
+    if (newWidgets[j].keep && rectsOverlap(newWidgets[j].box, R))
+      return(true);
+  return(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Replace dirtyRects[j] by the parts of it outside of dirtyRects[i], which it overlaps, and
+// return the number of rectangles that replaced it (0 to 4), or leave it as it is and
+// return 1 if dirtyRects[] has no room for the parts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint8_t splitDirtyRect(uint8_t j, uint8_t i) {
+  const lcdRect A = dirtyRects[i];
+  const lcdRect B = dirtyRects[j];
+  int16_t y0 = max(A.y0, B.y0);
+  int16_t y1 = min(A.y1, B.y1);
+  lcdRect parts[4] = { B, B, B, B };
+  uint8_t n = 0;
+  if (B.y0 < A.y0)
+    parts[n++].y1 = A.y0-1;
+  if (B.y1 > A.y1)
+    parts[n++].y0 = A.y1+1;
+  if (B.x0 < A.x0) {
+    parts[n].y0 = y0; parts[n].y1 = y1; parts[n++].x1 = A.x0-1;
+  }
+  if (B.x1 > A.x1) {
+    parts[n].y0 = y0; parts[n].y1 = y1; parts[n++].x0 = A.x1+1;
+  }
+  if (n > 1 && numDirtyRects + n-1 > MAX_DIRTY_RECTS)
+    return(1);
+
+  if (n == 0)
+    dirtyRects[j] = dirtyRects[--numDirtyRects];
+  else {
+    dirtyRects[j] = parts[0];
+    for (uint8_t k = 1; k < n; k++)
+      dirtyRects[numDirtyRects++] = parts[k];
+  }
+  return(n);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Coalesce dirtyRects[] into fewer SPI bytes: merge pairs of rectangles whose bounding box
+// takes no more bytes to fill than the two of them without their overlap, unless the box
+// would erase a kept widget, then split the remaining overlapping rectangles so that no
+// pixel is sent twice.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void coalesceDirtyRects() {
+  bool merged;
+  do {
+    merged = false;
+    for (uint8_t i = 0; i < numDirtyRects; i++)
+      for (uint8_t j = i+1; j < numDirtyRects; j++) {
+        lcdRect U = dirtyRects[i];
+        uniteRect(U, dirtyRects[j]);
+        if (rectBytes(U) + 2*overlapArea(dirtyRects[i], dirtyRects[j]) <=
+            rectBytes(dirtyRects[i]) + rectBytes(dirtyRects[j]) && !overlapsKeptWidget(U)) {
+          dirtyRects[i] = U;
+          dirtyRects[j--] = dirtyRects[--numDirtyRects];
+          merged = true;
+        }
+      }
+  } while (merged);
+
+  for (uint8_t i = 0; i < numDirtyRects; i++)
+    for (uint8_t j = i+1; j < numDirtyRects; j++)
+      if (rectsOverlap(dirtyRects[i], dirtyRects[j]) && splitDirtyRect(j, i) == 0)
+        j--;
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Mark rectangle R of the LCD to be erased by the next flushDirtyRects(), or erase it now
+// if too many rectangles are marked.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void markDirtyRect(const lcdRect& R) {
+  if (R.x0 > R.x1)
+    return;
+  if (numDirtyRects < MAX_DIRTY_RECTS)
+    dirtyRects[numDirtyRects++] = R;
+  else
+    eraseRect(R);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Erase the rectangles marked dirty, each pixel once, with as few address windows as pays.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void flushDirtyRects() {
+  #if COALESCE_DIRTY_RECTS
+  coalesceDirtyRects();
+  #endif
+  for (uint8_t i = 0; i < numDirtyRects; i++)
+    eraseRect(dirtyRects[i]);
+  numDirtyRects = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Record drawing of rectangle R outside of widgets, merging it with a touching rectangle
+// if there is one.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void addLooseRect(const lcdRect& R) {
+  uint8_t i;
+  for (i = 0; i < numLooseRects && !rectsTouch(looseRects[i], R); i++)
+    ;
+  if (i == numLooseRects) {
+    if (numLooseRects < MAX_LOOSE_RECTS) {
+      looseRects[numLooseRects++] = R;
+      return;
+    }
+    i = numLooseRects-1;
+  }
+  uniteRect(looseRects[i], R);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Track a drawing operation of the given rectangle and color, and return true if it should
+// actually be sent to the LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool trackScreenDrawing(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w < 0) { x += w+1; w = -w; }
+  if (h < 0) { y += h+1; h = -h; }
+  lcdRect R = { max(x, (int16_t) 0), max(y, (int16_t) 0),
+    min((int16_t) (x+w-1), (int16_t) (lcd->width()-1)),
+    min((int16_t) (y+h-1), (int16_t) (lcd->height()-1)) };
+  if (R.x0 <= R.x1 && R.y0 <= R.y1) {
+    if (inWidget) {
+      if (drawPass == DRAW_PASS_PLAN) {
+        uniteRect(widgetBox, R);
+        // FNV-1a hash of the operation.
+        uint16_t v[5] = { (uint16_t) x, (uint16_t) y, (uint16_t) w, (uint16_t) h, color };
+        for (uint8_t i = 0; i < 5; i++)
+          widgetSig = (widgetSig ^ v[i]) * 16777619UL;
+      }
+    } else if (drawPass != DRAW_PASS_PLAN) {
+      // Clearing the entire LCD to white forgets everything drawn on it.
+      if (color == WHITE && R.x0 == 0 && R.y0 == 0 && R.x1 == lcd->width()-1 &&
+          R.y1 == lcd->height()-1) {
+        numShownWidgets = 0;
+        numLooseRects = 0;
+        lcdKnown = true;
+      } else
+        addLooseRect(R);
+    }
+  }
+  return(drawPass != DRAW_PASS_PLAN);
+}
+#endif
+
+#if COUNT_LCD_TRAFFIC || INCREMENTAL_SCREEN_DRAW || USE_LCD_DMA || USE_GLYPH_CACHE
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Adafruit_ILI9341 that tracks what is drawn for incremental screen drawing, counts, in
+// LCDtraffic, the pixels it writes and the address windows it sets up, sends large fills by
+// DMA, and draws characters from the glyph cache. All drawing, including text and buttons,
+// goes through these functions, and each of them first waits for any DMA fill to finish.
+/////////////////////////////////////////////////////////////////////////////////////////////
+class Adafruit_ILI9341_tracked : public Adafruit_ILI9341 {
+public:
+  Adafruit_ILI9341_tracked(int8_t cs, int8_t dc) : Adafruit_ILI9341(cs, dc) {}
+
+  void startWrite(void) {
+    if (sending()) {
+      waitLCDtransfers();
+      Adafruit_ILI9341::startWrite();
+    }
+  }
+  void endWrite(void) {
+    if (sending())
+      Adafruit_ILI9341::endWrite();
+  }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (track(x, y, 1, 1, color))
+      Adafruit_ILI9341::drawPixel(x, y, color);
+  }
+  void writePixel(int16_t x, int16_t y, uint16_t color) {
+    if (track(x, y, 1, 1, color))
+      Adafruit_ILI9341::writePixel(x, y, color);
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (!track(x, y, w, h, color))
+      return;
+    #if COUNT_LCD_TRAFFIC
+    if ((uint32_t) abs(w) * (uint32_t) abs(h) >= LCD_DMA_MIN_PIXELS)
+      LCDtraffic.queuedPixels += (uint32_t) abs(w) * (uint32_t) abs(h);
+    #endif
+    #if USE_LCD_DMA
+    if (fillRectDMA(x, y, w, h, color))
+      return;
+    #endif
+    Adafruit_ILI9341::fillRect(x, y, w, h, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (track(x, y, w, h, color))
+      Adafruit_ILI9341::writeFillRect(x, y, w, h, color);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    if (track(x, y, w, 1, color))
+      Adafruit_ILI9341::drawFastHLine(x, y, w, color);
+  }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    if (track(x, y, w, 1, color))
+      Adafruit_ILI9341::writeFastHLine(x, y, w, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    if (track(x, y, 1, h, color))
+      Adafruit_ILI9341::drawFastVLine(x, y, h, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    if (track(x, y, 1, h, color))
+      Adafruit_ILI9341::writeFastVLine(x, y, h, color);
+  }
+  #if USE_GLYPH_CACHE
+  // Draw a cached character as its rectangles, and any other character with Adafruit_GFX.
+  size_t write(uint8_t c) {
+    const glyphRect* R;
+    const cachedGlyph* G;
+    if (textsize_x != 1 || textsize_y != 1 || wrap ||
+        (G = getCachedGlyph(gfxFont, c, &R)) == NULL)
+      return(Adafruit_ILI9341::write(c));
+    startWrite();
+    for (uint16_t i = 0; i < G->numRects; i++, R++)
+      writeFillRect(cursor_x + R->x, cursor_y + R->y, R->w, R->h, textcolor);
+    endWrite();
+    cursor_x += G->xAdvance;
+    return(1);
+  }
+  #endif
+
+private:
+  bool sending() {
+    #if INCREMENTAL_SCREEN_DRAW
+    return(drawPass != DRAW_PASS_PLAN);
+    #else
+    return(true);
+    #endif
+  }
+  bool track(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    #if INCREMENTAL_SCREEN_DRAW
+    if (!trackScreenDrawing(x, y, w, h, color))
+      return(false);
+    #endif
+    waitLCDtransfers();
+    #if COUNT_LCD_TRAFFIC
+    LCDtraffic.pixels += (uint32_t) abs(w) * (uint32_t) abs(h);
+    LCDtraffic.windows++;
+    #endif
+    return(true);
+  }
+};
+#endif
+
 // *************************************************************************************** //
 // Local variables.
 // *************************************************************************************** //
@@ -67,10 +555,16 @@
 // PWM object for sound from beeper.
 static SAMD_PWM* sound;
 
+// millis() when drawing of the current screen started.
+static uint32_t screenDrawStartMS;
+
 // *************************************************************************************** //
 // Global variables.
 // *************************************************************************************** //
 
+// LCD SPI traffic counts.
+lcdTraffic LCDtraffic;
+
 // LCD object.
 Adafruit_ILI9341* lcd;
 
@@ -83,17 +577,10 @@ TS_Display* ts_display;
 // Button collection object to manage the buttons of the currently displayed screen.
 Button_TT_collection* screenButtons;
 
-// SmartVent run timer.
-uint32_t RunTimeMS;
-uint32_t MSatLastRunTimerUpdate;
-
 // *************************************************************************************** //
 // Enums.
 // *************************************************************************************** //
 
-// SmartVent arm state.
-eArmState ArmState;
-
 // Current screen.
 eScreen currentScreen;
 
@@ -105,57 +592,263 @@ eScreen currentScreen;
 // Initialize variables used by screens.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void initScreens() {
-  monitor.printf("initScreens()\n");
-
-  // Initialize ArmState OFF.
-  monitor.printf("ArmState\n");
-  ArmState = ARM_OFF;
-
-  // Initialize SmartVent runtime timer.
-  monitor.printf("RunTimeMS\n");
-  RunTimeMS = 0;
-  MSatLastRunTimerUpdate = millis();
+  logPrintf("initScreens()\n");
 
   // Create PWM object for sound from beeper.
-  monitor.printf("sound object\n");
+  logPrintf("sound object\n");
   sound = new SAMD_PWM(BEEPER_PIN, TS_TONE_FREQ, 0);
 
   // Create LCD object, initialize its backlight and timers, and initialize actual displayed data.
-  monitor.printf("lcd object\n");
+  logPrintf("lcd object\n");
+  #if COUNT_LCD_TRAFFIC || INCREMENTAL_SCREEN_DRAW || USE_LCD_DMA || USE_GLYPH_CACHE
+  lcd = new Adafruit_ILI9341_tracked(LCD_CS, LCD_DC);
+  #else
   lcd = new Adafruit_ILI9341(LCD_CS, LCD_DC);
+  #endif
   lcd->begin();
   lcd->setRotation(2);   // portrait mode
   lcd->setTextColor(BLUE);
   lcd->setTextSize(1);
   lcd->setTextWrap(false);
 
+  // Rasterize the digits of the fonts used by numeric fields.
+  #if USE_GLYPH_CACHE
+  addFontToGlyphCache(font24B.getFont());
+  addFontToGlyphCache(font18B.getFont());
+  addFontToGlyphCache(mono12B.getFont());
+  #endif
+
+  // Allocate a DMA channel for sending fills to the LCD over SPI.
+  #if USE_LCD_DMA
+  logPrintf("lcd DMA\n");
+  lcdDMA.setTrigger(LCD_SPI_DMAC_ID_TX);
+  lcdDMA.setAction(DMA_TRIGGER_ACTON_BEAT);
+  if (lcdDMA.allocate() == DMA_STATUS_OK) {
+    lcdDMAdesc = lcdDMA.addDescriptor(lcdDMAbuf, (void*) &LCD_SPI_SERCOM->SPI.DATA.reg,
+      sizeof(lcdDMAbuf), DMA_BEAT_SIZE_BYTE, true, false);
+    lcdDMA.setCallback(lcdDMAcallback);
+    lcdDMAready = (lcdDMAdesc != NULL);
+  }
+  #endif
+
   // Create touchscreen object and initialize it.
-  monitor.printf("touch object\n");
+  logPrintf("touch object\n");
   touch = new XPT2046_Touchscreen(TOUCH_CS, TOUCH_IRQ);
   touch->setRotation(lcd->getRotation());
   touch->setThresholds(Z_THRESHOLD/3);
   touch->begin();
 
   // Create and initialize touchscreen-LCD object.
-  monitor.printf("ts_display object\n");
+  logPrintf("ts_display object\n");
   ts_display = new(TS_Display);
   ts_display->begin(touch, lcd);
 
   // Create button collection object to manage currently displayed screen buttons.
-  monitor.printf("screenButtons object\n");
+  logPrintf("screenButtons object\n");
   screenButtons = new Button_TT_collection;
 
-  monitor.printf("initScreens() done\n");
+  logPrintf("initScreens() done\n");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the estimated number of SPI bytes sent to the LCD since LCDtraffic was Start.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t getLCDbytesSince(const lcdTraffic& Start) {
+  return(2*(LCDtraffic.pixels - Start.pixels) +
+    LCD_WINDOW_BYTES*(LCDtraffic.windows - Start.windows));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Set a new value for ArmState.
+// Return the number of SPI pixel bytes sent (or sendable) by DMA since LCDtraffic was Start.
 /////////////////////////////////////////////////////////////////////////////////////////////
-void setArmState(eArmState newState) {
-  if (ArmState != newState) {
-    ArmState = newState;
-    monitor.printf("ArmState changed to %d\n", ArmState);
+uint32_t getLCDqueuedBytesSince(const lcdTraffic& Start) {
+  return(2*(LCDtraffic.queuedPixels - Start.queuedPixels));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if a DMA transfer to the LCD is still in progress.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool isLCDtransferBusy() {
+  #if USE_LCD_DMA
+  if (lcdDMAactive && lcdDMAdone)
+    waitLCDtransfers();
+  return(lcdDMAactive);
+  #else
+  return(false);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Wait for any DMA transfer to the LCD to finish and end its SPI transaction.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void waitLCDtransfers() {
+  #if USE_LCD_DMA
+  if (!lcdDMAactive)
+    return;
+  while (!lcdDMAdone)
+    ;
+  // Wait for the last byte to be shifted out, then turn the SPI receiver back on.
+  while (!LCD_SPI_SERCOM->SPI.INTFLAG.bit.TXC)
+    ;
+  LCD_SPI_SERCOM->SPI.CTRLB.bit.RXEN = 1;
+  while (LCD_SPI_SERCOM->SPI.SYNCBUSY.bit.CTRLB)
+    ;
+  lcdDMAactive = false;
+  lcd->Adafruit_ILI9341::endWrite();
+  #endif
+}
+
+#if INCREMENTAL_SCREEN_DRAW
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start the widget about to be drawn during a screen draw, and return true if it should be
+// drawn.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool beginWidget() {
+  if (drawPass == DRAW_PASS_PLAN) {
+    inWidget = true;
+    widgetBox = { 1, 1, 0, 0 };
+    widgetSig = 2166136261UL;
+    return(true);
+  }
+  if (drawPass == DRAW_PASS_DRAW && widgetIdx < numNewWidgets) {
+    inWidget = true;
+    return(!newWidgets[widgetIdx].keep);
+  }
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// End the widget started by beginWidget().
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void endWidget() {
+  if (drawPass == DRAW_PASS_PLAN && widgetIdx < MAX_SCREEN_WIDGETS) {
+    newWidgets[widgetIdx].box = widgetBox;
+    newWidgets[widgetIdx].sig = widgetSig;
+    newWidgets[widgetIdx].keep = false;
+    numNewWidgets = widgetIdx+1;
+  }
+  if (drawPass != DRAW_PASS_IDLE)
+    widgetIdx++;
+  inWidget = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Decide which of the new screen's widgets are already on the LCD, and erase everything
+// else that is on the LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void planScreenTransition() {
+  // A shown widget is kept if the new screen draws an identical widget in the same place.
+  // shownWidgets[].keep marks the shown widgets that were matched.
+  for (uint8_t i = 0; i < numShownWidgets; i++) {
+    screenWidget& S = shownWidgets[i];
+    S.keep = false;
+    for (uint8_t j = 0; j < numNewWidgets && !S.keep; j++) {
+      screenWidget& N = newWidgets[j];
+      if (!N.keep && N.sig == S.sig && N.box.x0 == S.box.x0 && N.box.y0 == S.box.y0 &&
+          N.box.x1 == S.box.x1 && N.box.y1 == S.box.y1)
+        N.keep = S.keep = true;
+    }
   }
+
+  // A kept widget must still be drawn if part of it is about to be erased. Since all drawing
+  // outside widgets is erased, this also catches widgets that were drawn over after their
+  // screen was drawn.
+  numKeptWidgets = 0;
+  for (uint8_t j = 0; j < numNewWidgets; j++) {
+    screenWidget& N = newWidgets[j];
+    for (uint8_t i = 0; i < numShownWidgets && N.keep; i++)
+      if (!shownWidgets[i].keep && rectsOverlap(shownWidgets[i].box, N.box))
+        N.keep = false;
+    for (uint8_t k = 0; k < numLooseRects && N.keep; k++)
+      if (rectsOverlap(looseRects[k], N.box))
+        N.keep = false;
+    if (N.keep)
+      numKeptWidgets++;
+  }
+
+  // Erase the shown widgets that were not matched and everything drawn outside widgets,
+  // in one flush. The erasing itself is recorded as loose drawing, so discard that
+  // afterwards.
+  for (uint8_t i = 0; i < numShownWidgets; i++)
+    if (!shownWidgets[i].keep)
+      markDirtyRect(shownWidgets[i].box);
+  for (uint8_t k = 0; k < numLooseRects; k++)
+    markDirtyRect(looseRects[k]);
+  flushDirtyRects();
+  numLooseRects = 0;
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Begin drawing a screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void beginScreenDraw(void (*drawFunc)()) {
+  #if INCREMENTAL_SCREEN_DRAW
+  if (drawPass == DRAW_PASS_PLAN)
+    return;
+  screenDrawStartMS = millis();
+  if (!lcdKnown)
+    lcd->fillScreen(WHITE);
+
+  // Run the draw function with LCD output suppressed to collect the new screen's widgets.
+  drawPass = DRAW_PASS_PLAN;
+  widgetIdx = 0;
+  numNewWidgets = 0;
+  drawFunc();
+
+  // Erase what is not wanted, and let the caller draw the rest.
+  drawPass = DRAW_PASS_DRAW;
+  planScreenTransition();
+  widgetIdx = 0;
+  #else
+  screenDrawStartMS = millis();
+  lcd->fillScreen(WHITE);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Finish drawing a screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void endScreenDraw() {
+  #if INCREMENTAL_SCREEN_DRAW
+  if (drawPass == DRAW_PASS_PLAN)
+    return;
+  memcpy(shownWidgets, newWidgets, numNewWidgets*sizeof(screenWidget));
+  numShownWidgets = numNewWidgets;
+  drawPass = DRAW_PASS_IDLE;
+  logPrintf("Screen %d drawn in %lu ms, %d of %d widgets kept\n", currentScreen,
+    millis() - screenDrawStartMS, numKeptWidgets, numNewWidgets);
+  #else
+  logPrintf("Screen %d drawn in %lu ms\n", currentScreen, millis() - screenDrawStartMS);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw widget btn as part of drawing a screen, unless it is already on the LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void drawScreenWidget(Button_TT& btn) {
+  #if INCREMENTAL_SCREEN_DRAW
+  if (beginWidget())
+    btn.drawButton();
+  endWidget();
+  #else
+  btn.drawButton();
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw a rounded rectangle frame as part of drawing a screen, unless it is already on the
+// LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void drawScreenFrame(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+    uint16_t color) {
+  #if INCREMENTAL_SCREEN_DRAW
+  if (beginWidget())
+    lcd->drawRoundRect(x, y, w, h, r, color);
+  endWidget();
+  #else
+  lcd->drawRoundRect(x, y, w, h, r, color);
+  #endif
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
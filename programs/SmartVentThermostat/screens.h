@@ -44,6 +44,7 @@
 #include <Button_TT_collection.h>
 #include "buttonConstants.h"
 #include "fontsAndColors.h"
+#include "smartVentControl.h"
 
 // *************************************************************************************** //
 // Constants.
@@ -54,14 +55,76 @@
 // ****** IF THERMOSTAT WON'T DISPLAY ANYTHING, DID YOU SET THIS TO 0 IF NO MONITOR PORT? ******
 #define USE_MONITOR_PORT 0
 
+// Set this to 1 to count the pixels written to the LCD and the address windows set up to
+// write them, in LCDtraffic, to measure the SPI traffic of screen updates. The SPI bytes of
+// each screen switch and each Main screen temperature update are then written to the
+// serial monitor.
+#define COUNT_LCD_TRAFFIC 0
+
+// Set this to 1 to draw screens incrementally: when switching screens, only the parts of the
+// old screen that the new screen does not draw identically are erased, and widgets that are
+// already on the LCD are not redrawn. Set to 0 to clear the LCD and redraw everything.
+#define INCREMENTAL_SCREEN_DRAW 1
+
+// Maximum number of widgets tracked per screen when INCREMENTAL_SCREEN_DRAW is 1. Widgets
+// beyond this are simply drawn each time.
+#define MAX_SCREEN_WIDGETS 40
+
+// Maximum number of rectangles used to track drawing done outside of widgets when
+// INCREMENTAL_SCREEN_DRAW is 1. Beyond this, the rectangles are merged.
+#define MAX_LOOSE_RECTS 24
+
+// Set this to 1 to coalesce the regions erased in a screen transition when
+// INCREMENTAL_SCREEN_DRAW is 1: regions are merged when one fill of their bounding box takes
+// fewer SPI bytes than filling them separately, and the remaining overlaps are split off so
+// that no pixel is sent twice. Set to 0 to erase each region by itself.
+#define COALESCE_DIRTY_RECTS 1
+
+// Maximum number of regions erased in a screen transition, after splitting. Overlaps that
+// would need more are erased twice.
+#define MAX_DIRTY_RECTS (MAX_SCREEN_WIDGETS + MAX_LOOSE_RECTS + 16)
+
+// Define this as 1 to send large rectangle fills (fillRect(), fillScreen(), and screen
+// erasing) to the LCD using the SAMD21 DMA controller, so that the CPU returns to loop()
+// while the pixels are sent. Define it as 0 to send them with the CPU. Either way, when
+// COUNT_LCD_TRAFFIC is 1, the pixels that are (or would be) sent by DMA are counted in
+// LCDtraffic.queuedPixels.
+#ifdef ARDUINO_ARCH_SAMD
+#define USE_LCD_DMA 1
+#else
+#define USE_LCD_DMA 0
+#endif
+
+// Smallest fillRect(), in pixels, to send by DMA. Smaller fills are sent by the CPU, which
+// is faster than setting up a DMA transfer for them.
+#define LCD_DMA_MIN_PIXELS 256
+
+// Size of buffer holding pixels for DMA transfers, in pixels. Larger fills are sent as
+// several DMA transfers from this buffer, each started by the interrupt of the previous one.
+#define LCD_DMA_BUF_PIXELS 256
+
 // Names to use on the display for indoors and outdoors.
 #define INDOOR_NAME "Indoor"
 #define OUTDOOR_NAME "Outdoor"
 
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Structure for holding counts of LCD SPI traffic.
+struct lcdTraffic {
+  uint32_t pixels;        // Number of pixels written.
+  uint32_t windows;       // Number of address windows set up to write pixels.
+  uint32_t queuedPixels;  // Number of those pixels sent (or sendable) by DMA.
+};
+
 // *************************************************************************************** //
 // Variables.
 // *************************************************************************************** //
 
+// LCD SPI traffic counts, maintained when COUNT_LCD_TRAFFIC is 1.
+extern lcdTraffic LCDtraffic;
+
 // LCD object.
 extern Adafruit_ILI9341* lcd;
 
@@ -74,51 +137,10 @@ extern TS_Display* ts_display;
 // Button collection object to manage the buttons of the currently displayed screen.
 extern Button_TT_collection* screenButtons;
 
-// SmartVent run timer. This counts by milliseconds whenever SmartVent is on (via
-// ON or AUTO mode). The count is clamped at a maximum of 99 hours, which should
-// only happen if mode is ON and SmartVent is allowed to run for over 4 days straight.
-// This resets back to zero when SmartVent mode is OFF or when the user's maximum
-// SmartVent run time is reached in AUTO or ON mode.
-extern uint32_t RunTimeMS;
-
-// In order to be able to update the value of RunTimeMS periodically, the
-// following variable records the milliseconds time (millis()) at which the last
-// update was made to it, so that when the next update time occurs, the number
-// of elapsed milliseconds can be determined and used to do the update.
-extern uint32_t MSatLastRunTimerUpdate;
-
 // *************************************************************************************** //
 // Enums.
 // *************************************************************************************** //
 
-// Arm states for SmartVent AUTO mode.
-//  ARM_OFF: whenever SmartVent mode is OFF.
-//  ARM_ON: whenever SmartVent mode is ON and the run timer has not timed out.
-//  ARM_ON_TIMEOUT: whenever SmartVent mode is ON and the run timer HAS timed out.
-//  ARM_AWAIT_ON: initial arming state when the AUTO mode is activated (which can
-//    occur simply by cycling modes through OFF, ON, AUTO, but may change immediately
-//    to ARM_AUTO_ON if the outdoor temperature is low enough). This state also
-//    occurs when state is ARM_AWAIT_HOT and outdoor temperature is hot enough.
-//  ARM_AUTO_ON: occurs when state is ARM_AWAIT_ON and indoor temperature becomes
-//    >= SmartVent setpoint temperature and outdoor temperature becomes <= indoor
-//    temperature - DeltaTempForOn. At that time, SmartVent is turned ON and a
-//    run-time timer is started.
-//  ARM_AWAIT_HOT occurs when the state is ARM_AUTO_ON and a maximum SmartVent
-//    run time is set and the SmartVent run timer reaches that value. At that time,
-//    SmartVent is turned off. Exit from this state to ARM_AWAIT_ON when outdoor
-//    temperature becomes >= indoor temperature + DeltaNewDayTemp.
-typedef enum _eArmState {
-  ARM_OFF,          // SmartVent is off in OFF mode.
-  ARM_ON,           // SmartVent is on in ON mode.
-  ARM_ON_TIMEOUT,   // SmartVent is off in ON mode.
-  ARM_AUTO_ON,      // SmartVent is on in AUTO mode
-  ARM_AWAIT_HOT,    // Timed out running in auto, SmartVent now off in AUTO mode and waiting till outdoor temp >= indoor temp + DeltaNewDayTemp
-  ARM_AWAIT_ON      // SmartVent now off in AUTO mode and waiting till indoor temp >= setpoint temp and outdoor temp <= indoor temp - DeltaTempForOn
-} eArmState;
-
-// SmartVent arm state.
-extern eArmState ArmState;
-
 // Screens.
 typedef enum _eScreen {
   SCREEN_MAIN,
@@ -127,7 +149,8 @@ typedef enum _eScreen {
   SCREEN_CLEANING,
   SCREEN_SPECIAL,
   SCREEN_CALIBRATION,
-  SCREEN_DEBUG
+  SCREEN_DEBUG,
+  SCREEN_HISTORY
 } eScreen;
 
 // Current screen.
@@ -143,9 +166,61 @@ extern eScreen currentScreen;
 extern void initScreens();
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Set a new value for ArmState.
+// Return the estimated number of SPI bytes sent to the LCD between the time LCDtraffic had
+// the value Start and now. Each pixel is 2 bytes, and each address window is 11 bytes (CASET
+// and PASET commands with 4 data bytes each, and a RAMWR command).
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t getLCDbytesSince(const lcdTraffic& Start);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of SPI pixel bytes sent to the LCD by DMA (or that would be if
+// USE_LCD_DMA were 1) between the time LCDtraffic had the value Start and now.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t getLCDqueuedBytesSince(const lcdTraffic& Start);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if a DMA transfer to the LCD is still in progress. If one has finished, this
+// ends its SPI transaction.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool isLCDtransferBusy();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Wait for any DMA transfer to the LCD to finish and end its SPI transaction. All LCD
+// drawing functions do this first, so it is only needed before using other devices on the
+// SPI bus (the touchscreen), or before changing data a transfer might be sending from.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void waitLCDtransfers();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Begin drawing a screen. Call this first in a screen's draw function, passing that draw
+// function as drawFunc, and call endScreenDraw() last. Draw the screen's fixed widgets
+// with drawScreenWidget() and drawScreenFrame().
+//
+// When INCREMENTAL_SCREEN_DRAW is 0, this clears the LCD. Otherwise, this first calls
+// drawFunc() with LCD output suppressed, to learn what widgets the new screen draws and
+// what they look like. It then erases only those parts of the LCD that the new screen
+// does not draw identically, and the draw function that called this goes on to draw the
+// new screen, skipping the widgets that are already on the LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void beginScreenDraw(void (*drawFunc)());
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Finish drawing a screen started with beginScreenDraw(), and show the time it took on the
+// serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void endScreenDraw();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw widget btn as part of drawing a screen, unless it is already on the LCD.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void drawScreenWidget(Button_TT& btn);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Draw a rounded rectangle frame as part of drawing a screen, unless it is already on the
+// LCD. The arguments are those of Adafruit_GFX::drawRoundRect().
 /////////////////////////////////////////////////////////////////////////////////////////////
-extern void setArmState(eArmState newState);
+extern void drawScreenFrame(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+  uint16_t color);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Play (true) or stop playing (false) a sound for touchscreen feedback.
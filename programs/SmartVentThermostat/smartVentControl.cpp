@@ -0,0 +1,412 @@
+/*
+  smartVentControl.cpp - SmartVent Thermostat control logic: the SmartVent arm state, run
+  timer, and on/off decisions. This has no dependence on the display or touchscreen.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include "nonvolatileSettings.h"
+#include "temperature.h"
+#include "temperatureTrend.h"
+#include "pinSettings.h"
+#include "smartVentControl.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "deferredLog.h"
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+#if USE_ADAPTIVE_READ_INTERVAL && !(USE_TEMPERATURE_TREND && USE_TREND_FOR_CONTROL) && \
+  TEMPERATURE_FILTER != 3
+#error "USE_ADAPTIVE_READ_INTERVAL requires USE_TREND_FOR_CONTROL or TEMPERATURE_FILTER 3"
+#endif
+
+// Period of the scheduler timers that advance the run timer and the statistics.
+#define RUN_TIMER_UPDATE_MS 1000
+#define STATISTICS_UPDATE_MS 1000
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+// SmartVent arm state.
+eArmState ArmState;
+
+// SmartVent run timer.
+uint32_t RunTimeMS;
+
+// SmartVent operating statistics.
+smartVentStatistics SmartVentStats;
+
+// SmartVent relay state at last statistics update.
+static bool statisticsRelayWasOn;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler callback, called every RUN_TIMER_UPDATE_MS. Advance RunTimeMS, turning off
+// SmartVent when appropriate.
+// Note: maximum run time and new-day-reset of run time is handled below in
+// updateSmartVentOnOff() because it works with current temperatures.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void updateSmartVentRunTimer(void) {
+  uint32_t MaxRunTimeMS = activeSettings.MaxRunTimeHours * 3600000UL;
+
+  // If in OFF mode or if SmartVent is currently off (ON or AUTO mode), leave
+  // the run timer alone.
+  if (activeSettings.SmartVentMode != MODE_OFF && getSmartVent()) {
+    // Advance RunTimeMS, but don't let it exceed 99 hours, and if it reaches a
+    // set maximum run time limit, turn SmartVent off and change the mode and
+    // arm state appropriately.
+    RunTimeMS += RUN_TIMER_UPDATE_MS;
+    if (RunTimeMS > 99*3600000UL)
+      RunTimeMS = 99*3600000UL;
+    if (MaxRunTimeMS > 0 && RunTimeMS >= MaxRunTimeMS) {
+      RunTimeMS = MaxRunTimeMS;
+      setSmartVent(false);
+      // If mode is ON, change ArmState to ARM_ON_TIMEOUT.
+      if (activeSettings.SmartVentMode == MODE_ON) {
+        setArmState(ARM_ON_TIMEOUT);
+        logPrintf("Timer expire while running in ON, set to AWAIT_HOT\n");
+      // Else mode is AUTO. Change arm state to ARM_AWAIT_HOT. RunTimeMS remains
+      // non-zero and is shown on the display, allowing the user to see how much
+      // run time has occurred and see that it has hit his limit. It will be
+      // reset to 0 when the arm state exits ARM_AWAIT_HOT.
+      } else {
+        if (activeSettings.SmartVentMode == MODE_AUTO) {
+          setArmState(ARM_AWAIT_HOT);
+          logPrintf("Timer expire while running in AUTO, set to AWAIT_HOT\n");
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler callback, called every STATISTICS_UPDATE_MS. Update SmartVentStats according
+// to the current SmartVent relay state, indoor temperature, and ArmState. Each time the
+// relay turns off, the statistics are written to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void updateSmartVentStatistics(void) {
+  uint32_t elapsedSecs = STATISTICS_UPDATE_MS / 1000;
+
+  // Accumulate times.
+  bool relayOn = getSmartVent();
+  if (relayOn)
+    SmartVentStats.relayOnSecs += elapsedSecs;
+  float indoorTempAdjusted, outdoorTempAdjusted;
+  getAdjustedTemperatures(indoorTempAdjusted, outdoorTempAdjusted);
+  if (indoorTempAdjusted > (float)activeSettings.TempSetpointOn)
+    SmartVentStats.aboveSetpointSecs += elapsedSecs;
+  SmartVentStats.armStateSecs[ArmState] += elapsedSecs;
+
+  // Count relay cycles, and show the statistics each time the relay turns off.
+  if (relayOn && !statisticsRelayWasOn)
+    SmartVentStats.relayCycles++;
+  else if (!relayOn && statisticsRelayWasOn)
+    showSmartVentStatistics();
+  statisticsRelayWasOn = relayOn;
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize ArmState, and start the scheduler timers that advance the SmartVent run timer
+// and accumulate SmartVentStats.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initSmartVentControl() {
+  // Initialize ArmState OFF.
+  ArmState = ARM_OFF;
+
+  // Initialize SmartVent runtime timer.
+  RunTimeMS = 0;
+  startTimer(addTimer(updateSmartVentRunTimer, RUN_TIMER_UPDATE_MS), RUN_TIMER_UPDATE_MS);
+
+  // Initialize statistics.
+  clearSmartVentStatistics();
+  statisticsRelayWasOn = false;
+  startTimer(addTimer(updateSmartVentStatistics, STATISTICS_UPDATE_MS), STATISTICS_UPDATE_MS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the indoor and outdoor temperatures that updateSmartVentOnOff() acts on.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getAdjustedTemperatures(float& indoorTempAdjusted, float& outdoorTempAdjusted) {
+  #if USE_TEMPERATURE_TREND && USE_TREND_FOR_CONTROL
+  indoorTempAdjusted = getTrendTf(IndoorTrend) + (float)activeSettings.IndoorOffsetF;
+  outdoorTempAdjusted = getTrendTf(OutdoorTrend) + (float)activeSettings.OutdoorOffsetF;
+  #else
+  indoorTempAdjusted = curIndoorTemperature.Tf + (float)activeSettings.IndoorOffsetF;
+  outdoorTempAdjusted = curOutdoorTemperature.Tf + (float)activeSettings.OutdoorOffsetF;
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the temperatures that updateSmartVentOnOff() acts on, rounded for display.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getShownTemperatures(int16_t& indoorTemp, int16_t& outdoorTemp) {
+  #if USE_TEMPERATURE_TREND && USE_TREND_FOR_CONTROL
+  static int16_t shown[2];
+  static bool goingUp[2];
+  float adjusted[2];
+  getAdjustedTemperatures(adjusted[0], adjusted[1]);
+  for (uint8_t i = 0; i < 2; i++) {
+    int16_t rounded = roundTemperature(adjusted[i], goingUp[i], false);
+    if (rounded != shown[i]) {
+      goingUp[i] = (rounded > shown[i]);
+      shown[i] = rounded;
+    }
+  }
+  indoorTemp = shown[0];
+  outdoorTemp = shown[1];
+  #else
+  indoorTemp = curIndoorTemperature.Tf_int16 + activeSettings.IndoorOffsetF;
+  outdoorTemp = curOutdoorTemperature.Tf_int16 + activeSettings.OutdoorOffsetF;
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set a new value for ArmState, and report a change on the serial monitor or as telemetry.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void setArmState(eArmState newState) {
+  if (ArmState != newState) {
+    ArmState = newState;
+    #if USE_TELEMETRY
+    telemetryArmState T = { (uint8_t) ArmState };
+    sendTelemetry(TLM_ARM_STATE, &T, sizeof(T));
+    #else
+    logPrintf("ArmState changed to %d\n", ArmState);
+    #endif
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Check the conditions to see if the SmartVent should be turned on/off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void updateSmartVentOnOff(void) {
+  uint32_t MaxRunTimeMS = activeSettings.MaxRunTimeHours * 3600000UL;
+  bool isTimeout;
+  float indoorTempAdjusted, outdoorTempAdjusted, hysteresis;
+
+  switch (activeSettings.SmartVentMode) {
+
+  //    - If mode is OFF and SmartVent is on, turn it off.
+  case MODE_OFF:
+    if (getSmartVent()) {
+      setSmartVent(false);
+      setArmState(ARM_OFF);
+    }
+    break;
+
+  //    - If mode is ON, check if run time has hit its limit and set SmartVent accordingly.
+  case MODE_ON:
+    isTimeout = (MaxRunTimeMS > 0 && RunTimeMS == MaxRunTimeMS);
+    if (isTimeout == getSmartVent()) {
+      // Timeout and SmartVent is on, or no timeout and SmartVent is off.
+      // Change SmartVent state to the proper one for the timeout state.
+      setSmartVent(!isTimeout);
+      setArmState(!isTimeout ? ARM_ON : ARM_ON_TIMEOUT);
+    }
+    break;
+
+  //    - Else mode is AUTO. Check the various AUTO-mode conditions to determine
+  //        whether SmartVent should be on or off, and change SmartVent state if
+  //        the conditions warrant.
+  case MODE_AUTO:
+    getAdjustedTemperatures(indoorTempAdjusted, outdoorTempAdjusted);
+    hysteresis = (float)activeSettings.Hysteresis;
+
+    // If SmartVent is off and ArmState is ARM_AWAIT_ON and MaxRunTimeMS is 0 or is greater than
+    // RunTimeMS, evaluate whether or not to turn SmartVent on.
+    if (!getSmartVent() && ArmState == ARM_AWAIT_ON && (MaxRunTimeMS == 0 || MaxRunTimeMS > RunTimeMS)) {
+      // The condition to turn SmartVent on is: if the indoor temperature is above the indoor
+      // temperature setpoint plus hysteresis AND the outdoor temperature is at or below the
+      // indoor temperature minus the on-delta value required for activation minus hysteresis.
+      bool turnOn = (indoorTempAdjusted > ((float)activeSettings.TempSetpointOn + hysteresis)) &&
+        (outdoorTempAdjusted <= (indoorTempAdjusted - (float)activeSettings.DeltaTempForOn - hysteresis));
+      // If the turn-on condition was satisfied, turn SmartVent on and change ArmState to ARM_AUTO_ON.
+      if (turnOn) {
+        setSmartVent(true);
+        setArmState(ARM_AUTO_ON);
+      }
+    }
+
+    // If SmartVent is on, evaluate whether or not to keep it on or turn it off.
+    if (getSmartVent()) {
+      // The condition to keep SmartVent on is almost the same as the condition to turn it on,
+      // except that the hysteresis is reversed.
+      // Note that the hysteresis ensures that it doesn't flip-flop on and off repeatedly in a short time interval.
+      bool keepOn = (indoorTempAdjusted > ((float)activeSettings.TempSetpointOn - hysteresis)) &&
+        (outdoorTempAdjusted <= (indoorTempAdjusted - (float)activeSettings.DeltaTempForOn + hysteresis));
+      // If the keep-on condition was NOT satisfied, turn SmartVent off and change ArmState to ARM_AWAIT_ON.
+      // Note that SmartVent will turn on again if the turn-on condition is again met, and in that case, the
+      // total on-time accumulates up to the maximum on time, if one was set.
+      if (!keepOn) {
+        setSmartVent(false);
+        setArmState(ARM_AWAIT_ON);
+      }
+    // Else SmartVent is off. If the outdoor temperature is at or above the indoor
+    // temperature plus the delta value required for recognizing the start of a new
+    // day, clear RunTimeMS.
+    } else {
+      if (outdoorTempAdjusted >= indoorTempAdjusted + (int16_t) activeSettings.DeltaNewDayTemp) {
+        RunTimeMS = 0;
+        // If ArmState is ARM_AWAIT_HOT, change to ARM_AWAIT_ON.
+        if (ArmState == ARM_AWAIT_HOT)
+          setArmState(ARM_AWAIT_ON);
+      }
+    }
+    break;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the time in ms to wait before the next temperature read. This is the time the
+// adjusted temperatures used by updateSmartVentOnOff() in AUTO mode could take to reach the
+// nearest threshold, divided by ADAPTIVE_READS_TO_THRESHOLD. The indoor temperature is
+// compared to TempSetpointOn ± Hysteresis, and the indoor minus outdoor temperature to
+// DeltaTempForOn ± Hysteresis and to -DeltaNewDayTemp.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t getTemperatureReadIntervalMS(void) {
+  #if USE_ADAPTIVE_READ_INTERVAL
+  // Only AUTO mode uses the temperatures.
+  if (activeSettings.SmartVentMode != MODE_AUTO)
+    return(TEMPERATURE_READ_MAX_TIME_MS);
+
+  // Distances in °F of the indoor temperature and the indoor minus outdoor temperature from
+  // their nearest thresholds.
+  float indoorTempAdjusted, outdoorTempAdjusted;
+  getAdjustedTemperatures(indoorTempAdjusted, outdoorTempAdjusted);
+  float diff = indoorTempAdjusted - outdoorTempAdjusted;
+  float hysteresis = (float)activeSettings.Hysteresis;
+  float setpoint = (float)activeSettings.TempSetpointOn;
+  float deltaOn = (float)activeSettings.DeltaTempForOn;
+  float indoorDist = min(fabs(indoorTempAdjusted - (setpoint + hysteresis)),
+    fabs(indoorTempAdjusted - (setpoint - hysteresis)));
+  float diffDist = min(fabs(diff - (deltaOn + hysteresis)), fabs(diff - (deltaOn - hysteresis)));
+  diffDist = min(diffDist, fabs(diff + (float)activeSettings.DeltaNewDayTemp));
+
+  // Rates in °F/hour at which they could approach the thresholds.
+  float indoorRate = ADAPTIVE_READ_RATE_F_PER_HOUR;
+  float diffRate = ADAPTIVE_READ_RATE_F_PER_HOUR;
+  #if USE_TEMPERATURE_TREND
+  indoorRate = max(indoorRate, fabs(getTrendTfPerHour(IndoorTrend)));
+  diffRate = max(diffRate, fabs(getTrendTfPerHour(IndoorTrend) -
+    getTrendTfPerHour(OutdoorTrend)));
+  #endif
+
+  // Divide the time to the nearest threshold into reads.
+  float MS = min(indoorDist/indoorRate, diffDist/diffRate) *
+    (3600000.0f/ADAPTIVE_READS_TO_THRESHOLD);
+  if (MS >= TEMPERATURE_READ_MAX_TIME_MS)
+    return(TEMPERATURE_READ_MAX_TIME_MS);
+  if (MS < TEMPERATURE_READ_TIME_MS)
+    return(TEMPERATURE_READ_TIME_MS);
+  return((uint32_t)MS - (uint32_t)MS % TEMPERATURE_READ_TIME_MS);
+  #else
+  return(TEMPERATURE_READ_TIME_MS);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ArmState must change if activeSettings.SmartVentMode changes. Call this each time that
+// might have happened.
+// All the interactions between mode, state, and run timer are complex and it is hard to
+// get this right for all situations. I've continued to work on it.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void updateArmState(void) {
+  switch (activeSettings.SmartVentMode) {
+  case MODE_OFF:
+    // In OFF mode, the arm state should always be ARM_OFF.
+    setArmState(ARM_OFF);
+    break;
+  case MODE_ON:
+    // In ON mode, only change the arm state if it isn't already one of the arm
+    // states used in ON mode. If in ARM_AWAIT_HOT state, the run timer has
+    // timed out, so go to the ARM_ON_TIMEOUT state to maintain timed-out timer.
+    // User can clear timer by tapping the arm button.
+    if (ArmState == ARM_OFF || ArmState == ARM_AUTO_ON || ArmState == ARM_AWAIT_ON)
+      setArmState(ARM_ON);
+    else if (ArmState == ARM_AWAIT_HOT)
+      setArmState(ARM_ON_TIMEOUT);
+    break;
+  case MODE_AUTO:
+    // In AUTO mode, only change the arm state if it isn't already one of the
+    // arm states used in AUTO mode. If coming from OFF (where timer was zeroed),
+    // go to ARM_AWAIT_ON. If coming from ARM_ON_TIMEOUT, go to ARM_AWAIT_HOT to
+    // maintain timed-out timer. User can clear timer by tapping the arm button.
+    if (ArmState == ARM_OFF)
+      setArmState(ARM_AWAIT_ON);
+    else if (ArmState == ARM_ON_TIMEOUT)
+      setArmState(ARM_AWAIT_HOT);
+    else if (ArmState == ARM_ON)
+      setArmState(ARM_AUTO_ON);
+    break;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Zero all SmartVentStats values.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void clearSmartVentStatistics(void) {
+  memset(&SmartVentStats, 0, sizeof(SmartVentStats));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write SmartVentStats to the serial monitor, or send them as telemetry.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void showSmartVentStatistics(void) {
+  #if USE_TELEMETRY
+  telemetryStatistics T;
+  T.relayOnSecs = SmartVentStats.relayOnSecs;
+  T.relayCycles = SmartVentStats.relayCycles;
+  T.aboveSetpointSecs = SmartVentStats.aboveSetpointSecs;
+  memcpy(T.armStateSecs, SmartVentStats.armStateSecs, sizeof(T.armStateSecs));
+  sendTelemetry(TLM_STATISTICS, &T, sizeof(T));
+  #else
+  logPrintf("SmartVent on: %lu s in %lu cycles   above setpoint: %lu s\n",
+    SmartVentStats.relayOnSecs, SmartVentStats.relayCycles, SmartVentStats.aboveSetpointSecs);
+  static_assert(NUM_ARM_STATES == 6, "Revise the ArmState seconds message");
+  const uint32_t* secs = SmartVentStats.armStateSecs;
+  logPrintf("ArmState seconds: 0=%lu 1=%lu 2=%lu 3=%lu 4=%lu 5=%lu\n", secs[0], secs[1],
+    secs[2], secs[3], secs[4], secs[5]);
+  #endif
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,184 @@
+/*
+  smartVentControl.h - Definitions for SmartVent Thermostat control logic: the SmartVent
+  arm state, run timer, and on/off decisions.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef smartVentControl_h
+#define smartVentControl_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to read the temperatures less often when they are far from all thresholds
+// at which updateSmartVentOnOff() turns SmartVent on or off in AUTO mode, and more often as
+// they approach one, at intervals from TEMPERATURE_READ_TIME_MS (see temperature.h) up to
+// TEMPERATURE_READ_MAX_TIME_MS. Each read turns on AREF, which warms the thermistors, and
+// uses the ADC. Set this to 0 to read the temperatures every TEMPERATURE_READ_TIME_MS.
+// Either way, the sketch reads them every TEMPERATURE_READ_TIME_MS while a screen showing
+// them is lit, and moves the next read up when the screen is touched or the settings change.
+// When reads are far apart, each one stands for many periods in the temperature filters, so
+// an ADC spike would move the filtered temperature a lot. Therefore this requires that the
+// control uses the trend estimates (USE_TREND_FOR_CONTROL), which ignore spikes, or a
+// temperature filter with Hampel outlier rejection (TEMPERATURE_FILTER 3).
+#define USE_ADAPTIVE_READ_INTERVAL 1
+
+// Longest time between temperature reads in ms, a multiple of TEMPERATURE_READ_TIME_MS.
+#define TEMPERATURE_READ_MAX_TIME_MS (30*1000UL)
+
+// The read interval is chosen so that at least ADAPTIVE_READS_TO_THRESHOLD reads are done
+// in the time the temperatures could take to reach the nearest threshold, if they approached
+// it at ADAPTIVE_READ_RATE_F_PER_HOUR, or at their estimated trend rate if that is faster.
+#define ADAPTIVE_READS_TO_THRESHOLD 10
+#define ADAPTIVE_READ_RATE_F_PER_HOUR 20
+
+// *************************************************************************************** //
+// Enums.
+// *************************************************************************************** //
+
+// Arm states for SmartVent AUTO mode.
+//  ARM_OFF: whenever SmartVent mode is OFF.
+//  ARM_ON: whenever SmartVent mode is ON and the run timer has not timed out.
+//  ARM_ON_TIMEOUT: whenever SmartVent mode is ON and the run timer HAS timed out.
+//  ARM_AWAIT_ON: initial arming state when the AUTO mode is activated (which can
+//    occur simply by cycling modes through OFF, ON, AUTO, but may change immediately
+//    to ARM_AUTO_ON if the outdoor temperature is low enough). This state also
+//    occurs when state is ARM_AWAIT_HOT and outdoor temperature is hot enough.
+//  ARM_AUTO_ON: occurs when state is ARM_AWAIT_ON and indoor temperature becomes
+//    >= SmartVent setpoint temperature and outdoor temperature becomes <= indoor
+//    temperature - DeltaTempForOn. At that time, SmartVent is turned ON and a
+//    run-time timer is started.
+//  ARM_AWAIT_HOT occurs when the state is ARM_AUTO_ON and a maximum SmartVent
+//    run time is set and the SmartVent run timer reaches that value. At that time,
+//    SmartVent is turned off. Exit from this state to ARM_AWAIT_ON when outdoor
+//    temperature becomes >= indoor temperature + DeltaNewDayTemp.
+typedef enum _eArmState {
+  ARM_OFF,          // SmartVent is off in OFF mode.
+  ARM_ON,           // SmartVent is on in ON mode.
+  ARM_ON_TIMEOUT,   // SmartVent is off in ON mode.
+  ARM_AUTO_ON,      // SmartVent is on in AUTO mode
+  ARM_AWAIT_HOT,    // Timed out running in auto, SmartVent now off in AUTO mode and waiting till outdoor temp >= indoor temp + DeltaNewDayTemp
+  ARM_AWAIT_ON      // SmartVent now off in AUTO mode and waiting till indoor temp >= setpoint temp and outdoor temp <= indoor temp - DeltaTempForOn
+} eArmState;
+
+// Number of arm states.
+#define NUM_ARM_STATES (ARM_AWAIT_ON+1)
+
+// SmartVent arm state.
+extern eArmState ArmState;
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Statistics about SmartVent operation, accumulated since the last reset or the last call
+// to clearSmartVentStatistics(), for evaluating how well the settings are working. Times
+// are in seconds.
+struct smartVentStatistics {
+  uint32_t relayOnSecs;               // Time SmartVent relay was on.
+  uint32_t relayCycles;               // Number of times SmartVent relay turned on.
+  uint32_t aboveSetpointSecs;         // Time control indoor temp was above TempSetpointOn.
+  uint32_t armStateSecs[NUM_ARM_STATES]; // Time spent in each arm state.
+};
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+// SmartVent run timer. This counts by milliseconds, in steps of one scheduler timer period,
+// whenever SmartVent is on (via ON or AUTO mode). The count is clamped at a maximum of 99 hours, which should
+// only happen if mode is ON and SmartVent is allowed to run for over 4 days straight.
+// This resets back to zero when SmartVent mode is OFF or when the user's maximum
+// SmartVent run time is reached in AUTO or ON mode.
+extern uint32_t RunTimeMS;
+
+// SmartVent operating statistics.
+extern smartVentStatistics SmartVentStats;
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize ArmState, and start the scheduler timers that advance the SmartVent run timer
+// and accumulate SmartVentStats.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void initSmartVentControl();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set a new value for ArmState.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void setArmState(eArmState newState);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the indoor and outdoor temperatures in °F, adjusted by the user's offsets, that
+// updateSmartVentOnOff() compares to its thresholds: the trend estimates if
+// USE_TREND_FOR_CONTROL, else the filtered temperatures.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getAdjustedTemperatures(float& indoorTempAdjusted, float& outdoorTempAdjusted);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the temperatures of getAdjustedTemperatures() rounded to whole °F for display, with
+// the hysteresis of roundTemperature() so that the values shown don't flicker. This is what
+// the Main screen shows, so that the relay switches at the displayed temperatures.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getShownTemperatures(int16_t& indoorTemp, int16_t& outdoorTemp);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Check the conditions to see if the SmartVent should be turned on/off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void updateSmartVentOnOff(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the time in ms to wait before the next temperature read, a multiple of
+// TEMPERATURE_READ_TIME_MS (see USE_ADAPTIVE_READ_INTERVAL).
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t getTemperatureReadIntervalMS(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ArmState must change if activeSettings.SmartVentMode changes. Call this each time that
+// might have happened.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void updateArmState(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Zero all SmartVentStats values.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void clearSmartVentStatistics(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write SmartVentStats to the serial monitor.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void showSmartVentStatistics(void);
+
+#endif // smartVentControl_h
@@ -0,0 +1,140 @@
+/*
+  telemetry.cpp - Binary telemetry records for SmartVent Thermostat.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "crc16.h"
+#include "smartVentControl.h"
+#include "telemetry.h"
+
+#if USE_TELEMETRY
+
+static_assert(sizeof(telemetryStatistics::armStateSecs) == NUM_ARM_STATES*sizeof(uint32_t),
+  "telemetryStatistics must have one armStateSecs entry per arm state");
+static_assert(sizeof(telemetryStatistics) <= TELEMETRY_MAX_BODY_BYTES &&
+  sizeof(telemetryLoopPhase) <= TELEMETRY_MAX_BODY_BYTES,
+  "TELEMETRY_MAX_BODY_BYTES is too small");
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// Port to send telemetry on, or NULL if not initialized.
+static Print* telemetryPort;
+
+// Sequence number of the next record.
+static uint8_t telemetrySeq;
+
+// Telemetry counts.
+static telemetryStats telemetryCounts;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// COBS-encode the len bytes at src into dst, which must have room for len+1 bytes, and
+// return the number of bytes stored in dst. len must be less than 254.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint8_t encodeCOBS(const uint8_t* src, uint8_t len, uint8_t* dst) {
+  uint8_t codeIdx = 0;
+  uint8_t n = 1;
+  for (uint8_t i = 0; i < len; i++) {
+    if (src[i] == 0) {
+      dst[codeIdx] = n;
+      codeIdx = n + codeIdx;
+      n = 1;
+    } else
+      dst[codeIdx + n++] = src[i];
+  }
+  dst[codeIdx] = n;
+  return(codeIdx + n);
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize telemetry.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void initTelemetry(Print* port) {
+  telemetryPort = port;
+  telemetrySeq = 0;
+  memset(&telemetryCounts, 0, sizeof(telemetryCounts));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send a telemetry record.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void sendTelemetry(eTelemetryRecord recType, const void* body, uint8_t len) {
+  if (telemetryPort == NULL || len > TELEMETRY_MAX_BODY_BYTES)
+    return;
+
+  // Build the record.
+  uint8_t rec[TELEMETRY_HEADER_BYTES + TELEMETRY_MAX_BODY_BYTES + 2];
+  uint32_t ms = millis();
+  rec[0] = recType;
+  rec[1] = telemetrySeq++;
+  memcpy(&rec[2], &ms, sizeof(ms));
+  memcpy(&rec[TELEMETRY_HEADER_BYTES], body, len);
+  uint8_t recLen = TELEMETRY_HEADER_BYTES + len;
+  uint16_t crc = crc16(rec, recLen);
+  rec[recLen++] = crc & 0xFF;
+  rec[recLen++] = crc >> 8;
+
+  // Frame it.
+  uint8_t frame[TELEMETRY_MAX_FRAME_BYTES];
+  frame[0] = 0;
+  uint8_t frameLen = 1 + encodeCOBS(rec, recLen, &frame[1]);
+  frame[frameLen++] = 0;
+
+  if (telemetryPort->availableForWrite() < frameLen) {
+    telemetryCounts.dropped++;
+    return;
+  }
+  telemetryPort->write(frame, frameLen);
+  telemetryCounts.records++;
+  telemetryCounts.bytes += frameLen;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the telemetry counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getTelemetryStats(telemetryStats& S) {
+  S = telemetryCounts;
+}
+
+#endif // USE_TELEMETRY
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,147 @@
+/*
+  telemetry.h - Binary telemetry records for SmartVent Thermostat.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef telemetry_h
+#define telemetry_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to send temperature reads, SmartVent relay and ArmState changes, SmartVent
+// statistics, and the loop() profile as binary telemetry records on the serial port, in place
+// of the text those write to the serial monitor. Set this to 0 to write the text instead.
+// The records are decoded into CSV files on a host computer by the Python program in
+// programs/decodeTelemetry.
+#define USE_TELEMETRY 0
+
+// Each record is sent as a frame:
+//  - 0x00 delimiter, so that a frame following text output is still found,
+//  - COBS (Consistent Overhead Byte Stuffing) encoding, which contains no 0x00 bytes, of:
+//      - record type (1 byte),
+//      - sequence number (1 byte), incremented for each record, including ones dropped,
+//      - millis() time (4 bytes),
+//      - record body (fixed layout per record type, see below),
+//      - CRC-16/CCITT-FALSE of the above (2 bytes),
+//  - 0x00 delimiter.
+// All multi-byte values are little-endian. A frame is dropped rather than waiting for room
+// in the serial port's transmit buffer, which for the USB serial port is 63 bytes.
+#define TELEMETRY_HEADER_BYTES 6
+#define TELEMETRY_MAX_BODY_BYTES 48
+#define TELEMETRY_MAX_FRAME_BYTES (1 + 1 + TELEMETRY_HEADER_BYTES + TELEMETRY_MAX_BODY_BYTES + 2 + 1)
+
+// *************************************************************************************** //
+// Enums.
+// *************************************************************************************** //
+
+// Telemetry record types.
+typedef enum _eTelemetryRecord {
+  TLM_TEMPERATURES = 1,   // telemetryTemperatures
+  TLM_RELAY,              // telemetryRelay
+  TLM_ARM_STATE,          // telemetryArmState
+  TLM_STATISTICS,         // telemetryStatistics
+  TLM_LOOP_PHASE          // telemetryLoopPhase
+} eTelemetryRecord;
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Record bodies. Temperatures are in hundredths of a °C.
+
+// Temperatures just read. With several indoor zones, the indoor temperature is the zones
+// combined as selected by INDOOR_REDUCTION, and the indoor ADC value and resistance are
+// those of the zone closest to it.
+struct __attribute__((packed)) telemetryTemperatures {
+  int16_t indoorCentiC;
+  int16_t outdoorCentiC;
+  uint16_t indoorADC;
+  uint16_t outdoorADC;
+  uint16_t indoorR;       // Thermistor resistances in ohms.
+  uint16_t outdoorR;
+};
+
+struct __attribute__((packed)) telemetryRelay {
+  uint8_t on;
+};
+
+struct __attribute__((packed)) telemetryArmState {
+  uint8_t armState;
+};
+
+struct __attribute__((packed)) telemetryStatistics {
+  uint32_t relayOnSecs;
+  uint32_t relayCycles;
+  uint32_t aboveSetpointSecs;
+  uint32_t armStateSecs[6];
+};
+
+struct __attribute__((packed)) telemetryLoopPhase {
+  uint8_t phase;          // eLoopPhase
+  uint32_t count;
+  uint32_t minUS;
+  uint32_t meanUS;
+  uint32_t maxUS;
+  uint32_t p99US;
+};
+
+// Telemetry counts.
+struct telemetryStats {
+  uint32_t records;       // Records sent.
+  uint32_t bytes;         // Bytes sent.
+  uint32_t dropped;       // Records dropped for lack of room in the transmit buffer.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+#if USE_TELEMETRY
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize telemetry to be sent on port, which must already have been started.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void initTelemetry(Print* port);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send a record of type recType with the len bytes of body.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void sendTelemetry(eTelemetryRecord recType, const void* body, uint8_t len);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the telemetry counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getTelemetryStats(telemetryStats& S);
+#endif
+
+#endif // telemetry_h
@@ -35,60 +35,689 @@
 #include <floatToString.h>
 #include <monitor_printf.h>
 #include "temperature.h"
+#include "temperatureTrend.h"
+#include "telemetry.h"
+#include "deferredLog.h"
 #if USE_ANALOG_SAMD
 #include <wiring_analog_SAMD_TT.h>
 #endif
 #include <calibSAMD_ADC_withPWM.h>
+#if USE_NONBLOCKING_ADC
+#include <wiring_private.h>
+#endif
+#if USE_ADC_INPUT_SCAN
+#include <Adafruit_ZeroDMA.h>
+#endif
+
+#if USE_ADC_INPUT_SCAN && !USE_NONBLOCKING_ADC
+#error "USE_ADC_INPUT_SCAN requires USE_NONBLOCKING_ADC"
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Variables.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// Thermistor parameters.
+// ADC to Celsius conversion tables for the thermistors, filled by initReadTemperature().
+#if USE_TEMPERATURE_TABLE
+static tempValue TcTables[NUM_TEMP_SENSORS][TEMP_TABLE_SIZE];
+#define TC_TABLE(i) TcTables[i]
+#else
+#define TC_TABLE(i) nullptr
+#endif
+
+// Thermistor parameters: NUM_INDOOR_SENSORS indoor zone thermistors, then the outdoor one.
+const thermistor Thermistors[] = {
 #if USE_ANALOG_SAMD
-// Note: AZ Touch MKR A4 is Nano 33 IoT A1
-//const thermistor IndoorThermistor = { A1, 10000, 0.001009, 0.0002378, 2.0192e-07 }; // Frequent sample code values for Arduino kit thermistor
-//const thermistor IndoorThermistor = { A1, 10000, 0.001237, 0.000216, 1.634e-07 }; // Chinese data sheet for Arduino kit thermistor
-//const thermistor IndoorThermistor = { A1, 10000, 0.0008162, 0.0002019, 1.395e-07 }; // MF52B 3950 100K NTC
-//const thermistor IndoorThermistor = { A1, 10000, 0.001283, 0.0002079, 2.005e-07 }; // M52B 3435 10K NTC
-//const thermistor IndoorThermistor = { A1, 10000, 0.0007609, 0.0002752, 6.933e-08 }; // M52B 3435 10K NTC, my calibration measurements
-const thermistor IndoorThermistor = { A1, 10000, 0.001125, 0.0002347, 8.563e-08 }; // EPCOS B57862S103F, NTC 10K Ohms 1% 3988K 60mW
+  // Note: AZ Touch MKR A4 is Nano 33 IoT A1
+  //{ A1, 10000, 0.001009, 0.0002378, 2.0192e-07, TC_TABLE(0) }, // Frequent sample code values for Arduino kit thermistor
+  //{ A1, 10000, 0.001237, 0.000216, 1.634e-07, TC_TABLE(0) }, // Chinese data sheet for Arduino kit thermistor
+  //{ A1, 10000, 0.0008162, 0.0002019, 1.395e-07, TC_TABLE(0) }, // MF52B 3950 100K NTC
+  //{ A1, 10000, 0.001283, 0.0002079, 2.005e-07, TC_TABLE(0) }, // M52B 3435 10K NTC
+  //{ A1, 10000, 0.0007609, 0.0002752, 6.933e-08, TC_TABLE(0) }, // M52B 3435 10K NTC, my calibration measurements
+  { A1, 10000, 0.001125, 0.0002347, 8.563e-08, TC_TABLE(0) }, // EPCOS B57862S103F, NTC 10K Ohms 1% 3988K 60mW
 #else
 #error "Indoor thermistor's current analog input needs to be revised.
 #endif
 
-// Note: A6 refers to Nano 33 IoT A6, not AZ Touch MKR A6.
-const thermistor OutdoorThermistor = { A6, 10000, 0.001127, 0.0002344, 8.675e-08 };  // 10K type 2
-//const thermistor OutdoorThermistor = { A6, 10000, 0.001029, 0.0002391, 1.566e-07 };// 10K type 3
+  // Note: A6 refers to Nano 33 IoT A6, not AZ Touch MKR A6.
+  { A6, 10000, 0.001127, 0.0002344, 8.675e-08, TC_TABLE(OUTDOOR_SENSOR) },  // 10K type 2
+  //{ A6, 10000, 0.001029, 0.0002391, 1.566e-07, TC_TABLE(OUTDOOR_SENSOR) },// 10K type 3
+};
+static_assert(sizeof(Thermistors)/sizeof(Thermistors[0]) == NUM_TEMP_SENSORS,
+  "Thermistors[] needs NUM_INDOOR_SENSORS indoor entries followed by the outdoor entry");
 
-// Buffers for buffering last several temperatures that were read, for computing running average.
-temperatureBuf IndoorTempBuf;
-temperatureBuf OutdoorTempBuf;
+// Filters, filtered temperatures, and last reads of the thermistors.
+temperatureSensors TempSensors;
 
-// Current indoor and outdoor temperatures (result of running averages).
+// Current indoor and outdoor temperatures (indoor zones combined by INDOOR_REDUCTION).
 temperature curIndoorTemperature;
 temperature curOutdoorTemperature;
 
 // Number of times indoor and outdoor temperatures have been read, for debugging.
 uint16_t NtempReads;
 
-// Values of ADC on last indoor and outdoor temperature reads, for debugging.
-uint16_t ADClastIndoorTempRead;
-uint16_t ADClastOutdoorTempRead;
-
-// Values of computed thermistor resistances on last indoor and outdoor temperature reads,
-// for debugging.
-uint16_t RlastIndoorTempRead;
-uint16_t RlastOutdoorTempRead;
-
-// Values of computed temperatures on last indoor and outdoor temperature reads,
-// for debugging.
+// Indoor (combined) and outdoor temperatures computed on the last read, before filtering.
 float TlastIndoorTempRead;
 float TlastOutdoorTempRead;
 
 // pinAREF_OUT
 static pin_size_t PIN_AREF_OUT;
 
+// States of the non-blocking state machine that reads the thermistors for
+// readCurrentTemperatures().
+typedef enum _eTempReadState {
+  TREAD_IDLE,         // No read in progress.
+  TREAD_AREF_SETTLE,  // AREF was turned on, waiting AREF_STABLE_DELAY for it to stabilize.
+  TREAD_CONVERT       // ADC conversion of thermistor Thermistors[TreadIdx] in progress.
+} eTempReadState;
+
+// State machine state, index into Thermistors[] of thermistor being read, micros()
+// time at which AREF was turned on, and ADC values read so far.
+static eTempReadState TreadState = TREAD_IDLE;
+static uint8_t TreadIdx;
+static uint32_t TreadArefOnUS;
+static uint16_t TreadADC[NUM_TEMP_SENSORS];
+
+// micros() times at which the first ADC conversion of the current read was started and the
+// last one finished.
+static uint32_t TreadADCstartUS;
+static uint32_t TreadADCdoneUS;
+
+// Timing of the reads done by the state machine, and sum of their ADC busy times.
+static tempReadTiming TreadTiming;
+static uint64_t TreadSumBusyUS;
+
+#if USE_ADC_INPUT_SCAN
+// Largest number of ADC inputs in one input scan (INPUTCTRL.INPUTSCAN+1).
+#define ADC_SCAN_MAX_INPUTS 16
+
+// Time in us after which an input scan whose DMA complete callback has not run is given up,
+// and the thermistors are converted one at a time instead. A full scan takes under 8 ms.
+#define ADC_SCAN_TIMEOUT_US 20000UL
+
+// DMA channel and its descriptor for copying the ADC input scan results to ADCscanResults[],
+// and true if they were allocated and the thermistor inputs span at most ADC_SCAN_MAX_INPUTS.
+static Adafruit_ZeroDMA ADCscanDMA;
+static DmacDescriptor* ADCscanDesc;
+static bool ADCscanReady = false;
+
+// First ADC input of the scan and number of inputs in it, and index in ADCscanResults[] of
+// the result of each of Thermistors[]. The first result after enabling the ADC is
+// discarded, so the scan does one more conversion than it has inputs, wrapping around to
+// convert the first input again last.
+static uint8_t ADCscanFirstInput;
+static uint8_t ADCscanNumInputs;
+static uint8_t ADCscanResultIdx[NUM_TEMP_SENSORS];
+static uint16_t ADCscanResults[ADC_SCAN_MAX_INPUTS+1];
+
+// True when DMA has copied all the scan results, and micros() time at which it did.
+static volatile bool ADCscanDone;
+static volatile uint32_t ADCscanDoneUS;
+
+// True while the current read is converting the thermistors with an input scan.
+static bool TreadScanning;
+#endif
+
+// millis() time at which the state machine last finished a read.
+static uint32_t MSlastTempRead;
+
+#if TEMPERATURE_LOG_INTERVAL > 0
+// Number of temperature reads since temperatures were last written to the serial monitor.
+static uint16_t readsSinceTemperatureLog;
+#endif
+
+#if USE_NONBLOCKING_ADC
+// True if the ADC conversion in progress is the first one after changing the input and
+// its result must be discarded.
+static bool ADCdiscardResult;
+#else
+// Result of the last (blocking) ADC conversion.
+static uint16_t ADCresult;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Local functions.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Convert a float Celsius temperature to a tempValue.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline tempValue toTempValue(float Tc) {
+  #if USE_FIXED_POINT_TEMPS
+  return(floatToFixedTemp(Tc));
+  #else
+  return(Tc);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the Celsius temperature of Temp as a tempValue.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline tempValue getTc(const temperature& Temp) {
+  #if USE_FIXED_POINT_TEMPS
+  return(Temp.Tc_fixed);
+  #else
+  return(Temp.Tc);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the Celsius temperature of Temp to Tc and compute its other temperatures from that.
+// Temp must contain valid "goingUpC" and "goingUpF" values for use in rounding.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void setTc(temperature& Temp, tempValue Tc) {
+  #if USE_FIXED_POINT_TEMPS
+  Temp.Tc_fixed = Tc;
+  Temp.Tc_int16 = roundFixedTemperature(Tc, Temp.goingUpC, true);
+  Temp.Tf_fixed = fixedDegCtoF(Tc);
+  Temp.Tf_int16 = roundFixedTemperature(Temp.Tf_fixed, Temp.goingUpF, false);
+  Temp.Tc = fixedTempToFloat(Tc);
+  Temp.Tf = fixedTempToFloat(Temp.Tf_fixed);
+  #else
+  Temp.Tc = Tc;
+  Temp.Tc_int16 = roundTemperature(Tc, Temp.goingUpC, true);
+  Temp.Tf = degCtoF(Tc);
+  Temp.Tf_int16 = roundTemperature(Temp.Tf, Temp.goingUpF, false);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the thermistor resistance corresponding to ADC reading Vo, which must be > 0.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t thermistorResistance(const thermistor& Thermistor, uint16_t Vo) {
+  uint16_t analogMax = (uint16_t) ADC_MAX;
+  return((uint32_t)Thermistor.seriesResistor * (analogMax - Vo) / Vo);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Compute the Celsius temperature corresponding to ADC reading Vo using the Steinhart–Hart
+// equation. Vo must be > 0 and < ADC_MAX.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static float computeTemperature(const thermistor& Thermistor, uint16_t Vo) {
+  uint16_t analogMax = (uint16_t) ADC_MAX;
+  float R2 = (float)Thermistor.seriesResistor * ((float)analogMax / (float)Vo - 1.0);
+  float logR2 = log(R2);
+  float Tk = (1.0 / (Thermistor.A + Thermistor.B*logR2 + Thermistor.C*logR2*logR2*logR2));
+  return(degKtoC(Tk));
+}
+
+#if USE_TEMPERATURE_TABLE
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Fill the ADC to Celsius conversion table of Thermistor. ADC readings at the extreme ends
+// of the range are clamped the same way readTemperature() clamps them.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void buildTemperatureTable(const thermistor& Thermistor) {
+  uint16_t analogMax = (uint16_t) ADC_MAX;
+  for (uint16_t i = 0; i < TEMP_TABLE_SIZE; i++) {
+    uint32_t Vo = (uint32_t)i << TEMP_TABLE_SHIFT;
+    if (Vo <= 5) Vo = 5;
+    if (Vo >= analogMax) Vo = analogMax-1;
+    Thermistor.TcTable[i] = toTempValue(computeTemperature(Thermistor, Vo));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Look up the Celsius temperature corresponding to ADC reading Vo in the conversion table of
+// Thermistor, interpolating linearly between table entries.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static tempValue lookupTemperature(const thermistor& Thermistor, uint16_t Vo) {
+  uint16_t idx = Vo >> TEMP_TABLE_SHIFT;
+  uint16_t frac = Vo & ((1 << TEMP_TABLE_SHIFT) - 1);
+  tempValue T0 = Thermistor.TcTable[idx];
+  tempValue T1 = Thermistor.TcTable[idx+1];
+  #if USE_FIXED_POINT_TEMPS
+  return(T0 + (((T1 - T0) * (fixedTemp)frac) >> TEMP_TABLE_SHIFT));
+  #else
+  return(T0 + (T1 - T0) * (float)frac * (1.0f / (1 << TEMP_TABLE_SHIFT)));
+  #endif
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Compute the temperatures of Temp from ADC reading Vo of Thermistor. Temp must contain valid
+// "goingUpC" and "goingUpF" values for use in rounding.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void setTemperatureFromADC(const thermistor& Thermistor, temperature& Temp, uint16_t Vo) {
+  // Compute temperature from voltage.
+  if (Vo <= 5) Vo = 5; // Avoid ridiculously small Vo.
+  // Other temperatures are computed from Tc.
+  #if USE_TEMPERATURE_TABLE
+  tempValue Tc = lookupTemperature(Thermistor, Vo);
+  #else
+  tempValue Tc = toTempValue(computeTemperature(Thermistor, Vo));
+  #endif
+
+  // Force an indoor temperature for debugging.
+  #if FORCE_INDOOR_TEMP != 9999
+  if (&Thermistor != &Thermistors[OUTDOOR_SENSOR])
+    Tc = toTempValue(FORCE_INDOOR_TEMP);
+  #endif
+
+  // Force an outdoor temperature for debugging.
+  #if FORCE_OUTDOOR_TEMP != 9999
+  if (&Thermistor == &Thermistors[OUTDOOR_SENSOR])
+    Tc = toTempValue(FORCE_OUTDOOR_TEMP);
+  #endif
+
+  // Compute other temperatures from Tc.
+  setTc(Temp, Tc);
+  Temp.ADCvalue = Vo;
+  Temp.Rthermistor = (uint16_t) thermistorResistance(Thermistor, Vo);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the absolute value of temperature T.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline tempValue absTempValue(tempValue T) {
+  return((T < 0) ? -T : T);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the temperatures of NewTemp (which must have been initialized as a copy of Temp) from
+// Tc, update its goingUpC and goingUpF from the change in its rounded temperatures, and set
+// Temp to it.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void moveTemperature(temperature& Temp, temperature& NewTemp, tempValue Tc) {
+  // Compute integer temperatures, rounded.
+  setTc(NewTemp, Tc);
+  if (NewTemp.Tc_int16 < Temp.Tc_int16)
+    NewTemp.goingUpC = false;
+  else if (NewTemp.Tc_int16 > Temp.Tc_int16)
+    NewTemp.goingUpC = true;
+  if (NewTemp.Tf_int16 < Temp.Tf_int16)
+    NewTemp.goingUpF = false;
+  else if (NewTemp.Tf_int16 > Temp.Tf_int16)
+    NewTemp.goingUpF = true;
+  // Set argument Temp (a reference) to the new temperature.
+  Temp = NewTemp;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Pass newly read temperature NewTemp (which must have been initialized as a copy of Temp
+// before its temperatures were set) through filter TempBuf, and set Temp to the filtered
+// temperature. periods is the number of TEMPERATURE_READ_TIME_MS periods since the previous
+// read. Also, update goingUpC and goingUpF.
+//
+// This returns the new temperature that was read (in Celsius) and passed to the filter.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static float updateFilteredTemperature(temperatureBuf& TempBuf, temperature& Temp,
+  temperature& NewTemp, uint16_t periods) {
+
+  // Filter NewTemp.
+  float returnT = NewTemp.Tc;
+  tempValue filteredTc = TempBuf.update(getTc(NewTemp), periods);
+
+  // (NewTemp.ADCvalue was set to last ADC value by setTemperatureFromADC).
+  // (NewTemp.Rthermistor was set to last thermistor resistance by setTemperatureFromADC).
+  moveTemperature(Temp, NewTemp, filteredTc);
+  return(returnT);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Combine the indoor zone temperatures Temps[0..NUM_INDOOR_SENSORS-1] as selected by
+// INDOOR_REDUCTION and set Temp to the result, updating goingUpC and goingUpF. ADCvalue and
+// Rthermistor are set to those of the zone whose temperature is closest to the result.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void reduceIndoorTemperatures(const temperature* Temps, temperature& Temp) {
+  #if INDOOR_REDUCTION == 0
+  tempValue Tc = 0;
+  for (uint8_t i = 0; i < NUM_INDOOR_SENSORS; i++)
+    Tc += getTc(Temps[i]);
+  Tc /= NUM_INDOOR_SENSORS;
+  #elif INDOOR_REDUCTION == 1
+  tempValue Tc = getTc(Temps[0]);
+  for (uint8_t i = 1; i < NUM_INDOOR_SENSORS; i++)
+    if (getTc(Temps[i]) > Tc) Tc = getTc(Temps[i]);
+  #elif INDOOR_REDUCTION == 2
+  tempValue Tc = getTc(Temps[0]);
+  for (uint8_t i = 1; i < NUM_INDOOR_SENSORS; i++)
+    if (getTc(Temps[i]) < Tc) Tc = getTc(Temps[i]);
+  #else
+  tempValue Tc = getTc(Temps[INDOOR_CONTROL_ZONE]);
+  #endif
+
+  // Find the zone closest to Tc.
+  uint8_t closest = 0;
+  for (uint8_t i = 1; i < NUM_INDOOR_SENSORS; i++)
+    if (absTempValue(getTc(Temps[i]) - Tc) < absTempValue(getTc(Temps[closest]) - Tc))
+      closest = i;
+
+  temperature NewTemp = Temp;
+  NewTemp.ADCvalue = Temps[closest].ADCvalue;
+  NewTemp.Rthermistor = Temps[closest].Rthermistor;
+  moveTemperature(Temp, NewTemp, Tc);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the name of thermistor index i for the serial monitor: "Indoor" if there is only
+// one indoor zone, else "Zone n", or "Outdoor". S is a buffer for building the name.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static const char* sensorName(uint8_t i, char* S, size_t size) {
+  if (i == OUTDOOR_SENSOR)
+    return("Outdoor");
+  if (NUM_INDOOR_SENSORS == 1)
+    return("Indoor");
+  snprintf(S, size, "Zone %d", i+1);
+  return(S);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start an ADC conversion of analog input pin.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startADCconversion(pin_size_t pin) {
+  #if USE_NONBLOCKING_ADC
+  // Select the input and start a conversion, without waiting for it. The ADC reference,
+  // resolution, averaging, and calibration set by calibSAMD_ADC_withPWM() are unchanged.
+  // As in the Arduino core analogRead(), the first conversion after changing the input is
+  // discarded.
+  pinPeripheral(pin, PIO_ANALOG);
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->INPUTCTRL.bit.MUXPOS = g_APinDescription[pin].ulADCChannelNumber;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->CTRLA.bit.ENABLE = 1;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  ADC->SWTRIG.bit.START = 1;
+  ADCdiscardResult = true;
+  #elif USE_ANALOG_SAMD
+  ADCresult = analogRead_SAMD_TT(pin);
+  #else
+  ADCresult = analogRead(pin);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Check whether the ADC conversion started by startADCconversion() is done. If so, store its
+// result in Vo and return true, else return false.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool pollADCconversion(uint16_t& Vo) {
+  #if USE_NONBLOCKING_ADC
+  if (!ADC->INTFLAG.bit.RESRDY)
+    return(false);
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  if (ADCdiscardResult) {
+    ADCdiscardResult = false;
+    while (ADC->STATUS.bit.SYNCBUSY);
+    ADC->SWTRIG.bit.START = 1;
+    return(false);
+  }
+  Vo = ADC->RESULT.reg;
+  #else
+  Vo = ADCresult;
+  #endif
+  return(true);
+}
+
+#if USE_ADC_INPUT_SCAN
+/////////////////////////////////////////////////////////////////////////////////////////////
+// DMA transfer complete interrupt callback: all scan results are in, so stop the ADC. The
+// disable is synchronized before ADCscanDone is set, so pollADCscan() finds the ADC stopped.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void ADCscanCallback(Adafruit_ZeroDMA* dma) {
+  ADCscanDoneUS = micros();
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->CTRLA.bit.ENABLE = 0;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADCscanDone = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set up the ADC input scan of the thermistors, if their inputs are close enough together
+// and a DMA channel is free. The inputs in between are converted too, but their pins are
+// left as they are and their results are ignored.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void initADCscan(void) {
+  uint8_t inputs[NUM_TEMP_SENSORS];
+  uint8_t lowest = UINT8_MAX, highest = 0;
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++) {
+    pin_size_t pin = Thermistors[i].inputPin;
+    pinPeripheral(pin, PIO_ANALOG);
+    inputs[i] = g_APinDescription[pin].ulADCChannelNumber;
+    if (inputs[i] < lowest) lowest = inputs[i];
+    if (inputs[i] > highest) highest = inputs[i];
+  }
+  if (highest - lowest + 1 > ADC_SCAN_MAX_INPUTS)
+    return;
+  ADCscanFirstInput = lowest;
+  ADCscanNumInputs = highest - lowest + 1;
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++) {
+    uint8_t offset = inputs[i] - lowest;
+    ADCscanResultIdx[i] = (offset == 0) ? ADCscanNumInputs : offset;
+  }
+
+  ADCscanDMA.setTrigger(ADC_DMAC_ID_RESRDY);
+  ADCscanDMA.setAction(DMA_TRIGGER_ACTON_BEAT);
+  if (ADCscanDMA.allocate() == DMA_STATUS_OK) {
+    ADCscanDesc = ADCscanDMA.addDescriptor((void*) &ADC->RESULT.reg, ADCscanResults,
+      ADCscanNumInputs+1, DMA_BEAT_SIZE_HWORD, false, true);
+    ADCscanDMA.setCallback(ADCscanCallback);
+    ADCscanReady = (ADCscanDesc != NULL);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start a free-running ADC input scan of the thermistors, with DMA copying each result to
+// ADCscanResults[]. The ADC reference, resolution, averaging, and calibration set by
+// calibSAMD_ADC_withPWM() are unchanged.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startADCscan(void) {
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->CTRLA.bit.ENABLE = 0;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->INPUTCTRL.reg = (ADC->INPUTCTRL.reg & ~(ADC_INPUTCTRL_MUXPOS_Msk |
+    ADC_INPUTCTRL_INPUTSCAN_Msk | ADC_INPUTCTRL_INPUTOFFSET_Msk)) |
+    ADC_INPUTCTRL_MUXPOS(ADCscanFirstInput) | ADC_INPUTCTRL_INPUTSCAN(ADCscanNumInputs-1);
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->CTRLB.bit.FREERUN = 1;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  ADCscanDone = false;
+  ADCscanDMA.startJob();
+  ADC->CTRLA.bit.ENABLE = 1;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->SWTRIG.bit.START = 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Stop the ADC input scan started by startADCscan(), if the DMA complete callback has not
+// already, and restore the ADC to single conversions of one input.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void stopADCscan(void) {
+  if (!ADCscanDone) {
+    ADCscanDMA.abort();
+    while (ADC->STATUS.bit.SYNCBUSY);
+    ADC->CTRLA.bit.ENABLE = 0;
+  }
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->CTRLB.bit.FREERUN = 0;
+  while (ADC->STATUS.bit.SYNCBUSY);
+  ADC->INPUTCTRL.reg &= ~(ADC_INPUTCTRL_INPUTSCAN_Msk | ADC_INPUTCTRL_INPUTOFFSET_Msk);
+  while (ADC->STATUS.bit.SYNCBUSY);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Check whether the ADC input scan started by startADCscan() is done. If so, restore the ADC
+// to single conversions of one input, store the thermistor results in TreadADC[], and return
+// true, else return false.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool pollADCscan(void) {
+  if (!ADCscanDone)
+    return(false);
+  stopADCscan();
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++)
+    TreadADC[i] = ADCscanResults[ADCscanResultIdx[i]];
+  return(true);
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start the ADC conversions of the current read: an input scan of all the thermistors, or a
+// conversion of the first one.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startTreadConversions(void) {
+  TreadIdx = 0;
+  TreadADCstartUS = micros();
+  #if USE_ADC_INPUT_SCAN
+  TreadScanning = ADCscanReady;
+  if (TreadScanning) {
+    startADCscan();
+    return;
+  }
+  #endif
+  startADCconversion(Thermistors[TreadIdx].inputPin);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Check whether the ADC conversions started by startTreadConversions() are done, starting
+// the conversion of the next thermistor when one finishes. If all are done, their results
+// are in TreadADC[], TreadADCdoneUS is set, and this returns true, else false.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool pollTreadConversions(void) {
+  #if USE_ADC_INPUT_SCAN
+  if (TreadScanning) {
+    if (pollADCscan()) {
+      TreadADCdoneUS = ADCscanDoneUS;
+      return(true);
+    }
+    // If the scan has not finished in time, its DMA interrupt was lost, so stop it and
+    // convert the thermistors one at a time. Without this, readCurrentTemperatures() would
+    // wait forever.
+    if (micros() - TreadADCstartUS < ADC_SCAN_TIMEOUT_US)
+      return(false);
+    stopADCscan();
+    TreadScanning = false;
+    startADCconversion(Thermistors[TreadIdx].inputPin);
+    return(false);
+  }
+  #endif
+  if (!pollADCconversion(TreadADC[TreadIdx]))
+    return(false);
+  if (++TreadIdx < NUM_TEMP_SENSORS) {
+    startADCconversion(Thermistors[TreadIdx].inputPin);
+    return(false);
+  }
+  TreadADCdoneUS = micros();
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add the ADC busy time and AREF on time of the read just finished to TreadTiming. AREF was
+// just turned off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void recordTempReadTiming(void) {
+  tempReadTiming& T = TreadTiming;
+  uint32_t busyUS = TreadADCdoneUS - TreadADCstartUS;
+  uint32_t arefOnUS = micros() - TreadArefOnUS;
+  if (T.count == 0 || busyUS < T.minBusyUS)
+    T.minBusyUS = busyUS;
+  if (busyUS > T.maxBusyUS)
+    T.maxBusyUS = busyUS;
+  if (arefOnUS > T.maxArefOnUS)
+    T.maxArefOnUS = arefOnUS;
+  T.lastBusyUS = busyUS;
+  T.lastArefOnUS = arefOnUS;
+  T.count++;
+  TreadSumBusyUS += busyUS;
+}
+
+#if TEMPERATURE_LOG_INTERVAL > 0 && USE_TELEMETRY
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the Celsius temperature of Temp in hundredths of a degree.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int16_t centiDegC(const temperature& Temp) {
+  #if USE_FIXED_POINT_TEMPS
+  return((int16_t) ((Temp.Tc_fixed*100 + FIXED_TEMP_ONE/2) >> FIXED_TEMP_SHIFT));
+  #else
+  return((int16_t) lroundf(Temp.Tc*100));
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send the temperatures just read as a telemetry record.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void sendTemperatureTelemetry(const temperature& Indoor, const temperature& Outdoor) {
+  telemetryTemperatures T;
+  T.indoorCentiC = centiDegC(Indoor);
+  T.outdoorCentiC = centiDegC(Outdoor);
+  T.indoorADC = Indoor.ADCvalue;
+  T.outdoorADC = Outdoor.ADCvalue;
+  T.indoorR = Indoor.Rthermistor;
+  T.outdoorR = Outdoor.Rthermistor;
+  sendTelemetry(TLM_TEMPERATURES, &T, sizeof(T));
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Update the current temperatures from the ADC values read by the state machine.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void finishReadCurrentTemperatures(void) {
+  // Count the TEMPERATURE_READ_TIME_MS periods since the last read, to which the filters
+  // will add the temperatures as though read once per period.
+  uint32_t MS = millis();
+  uint32_t periods = (MS - MSlastTempRead + TEMPERATURE_READ_TIME_MS/2) /
+    TEMPERATURE_READ_TIME_MS;
+  if (periods == 0)
+    periods = 1;
+  else if (periods > UINT8_MAX)
+    periods = UINT8_MAX;
+  MSlastTempRead = MS;
+
+  // Compute the temperature of each thermistor and pass it through its filter.
+  temperature Read[NUM_TEMP_SENSORS];
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++) {
+    temperature NewTemp = TempSensors.curTemperature[i];
+    setTemperatureFromADC(Thermistors[i], NewTemp, TreadADC[i]);
+    Read[i] = NewTemp;
+    TempSensors.TlastRead[i] = updateFilteredTemperature(TempSensors.TempBuf[i],
+      TempSensors.curTemperature[i], NewTemp, periods);
+    TempSensors.ADClastRead[i] = NewTemp.ADCvalue;
+    TempSensors.RlastRead[i] = NewTemp.Rthermistor;
+  }
+
+  // Combine the indoor zones, both the temperatures just read and the filtered ones.
+  temperature IndoorRead = curIndoorTemperature;
+  reduceIndoorTemperatures(Read, IndoorRead);
+  reduceIndoorTemperatures(TempSensors.curTemperature, curIndoorTemperature);
+  const temperature& OutdoorRead = Read[OUTDOOR_SENSOR];
+  curOutdoorTemperature = TempSensors.curTemperature[OUTDOOR_SENSOR];
+  TlastIndoorTempRead = IndoorRead.Tc;
+  TlastOutdoorTempRead = OutdoorRead.Tc;
+
+  // Update the trend estimates from the temperatures just read.
+  #if USE_TEMPERATURE_TREND
+  updateTemperatureTrend(IndoorTrend, TlastIndoorTempRead, MS);
+  updateTemperatureTrend(OutdoorTrend, TlastOutdoorTempRead, MS);
+  #endif
+
+  NtempReads++;
+
+  // Periodically write the temperatures just read (not the averages) and the trend
+  // estimates to the serial monitor, or send the temperatures as telemetry.
+  #if TEMPERATURE_LOG_INTERVAL > 0
+  if (++readsSinceTemperatureLog >= TEMPERATURE_LOG_INTERVAL) {
+    readsSinceTemperatureLog = 0;
+    #if USE_TELEMETRY
+    sendTemperatureTelemetry(IndoorRead, OutdoorRead);
+    #else
+    #if NUM_INDOOR_SENSORS > 1
+    for (uint8_t i = 0; i < NUM_INDOOR_SENSORS; i++) {
+      char S[8];
+      showTemperature(Read[i], sensorName(i, S, sizeof(S)));
+    }
+    #endif
+    showTemperature(IndoorRead, "Indoor");
+    showTemperature(OutdoorRead, "Outdoor");
+    #if USE_TEMPERATURE_TREND
+    showTemperatureTrend(IndoorTrend, "Indoor");
+    showTemperatureTrend(OutdoorTrend, "Outdoor");
+    #endif
+    logPrintf("ADC busy: %lu us  AREF on: %lu us\n", TreadTiming.lastBusyUS,
+      TreadTiming.lastArefOnUS);
+    #endif
+  }
+  #endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 // Initialize for reading indoor and outdoor temperatures. Currently this also initializes
 // the ADC converter, which is currently used in this project only for reading thermistors.
@@ -103,9 +732,21 @@ void initReadTemperature(int pinADC_CALIB, int pinPWM_CALIB, int pinAREF_OUT,
   // NOTE: 12-bit ADC resolution is set.
   calibSAMD_ADC_withPWM(pinADC_CALIB, pinPWM_CALIB, pinAREF_OUT, cfgADCmultSampAvg);
 
+  // Build the ADC to temperature conversion tables.
+  #if USE_TEMPERATURE_TABLE
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++)
+    buildTemperatureTable(Thermistors[i]);
+  #endif
+
   // Initialize pins.
-  pinMode(IndoorThermistor.inputPin, INPUT);
-  pinMode(OutdoorThermistor.inputPin, INPUT);
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++)
+    pinMode(Thermistors[i].inputPin, INPUT);
+
+  // Set up the ADC input scan used by the state machine to read the thermistors. This
+  // switches their pins to analog, so it must follow pinMode().
+  #if USE_ADC_INPUT_SCAN
+  initADCscan();
+  #endif
 
   // Count total number of temperature reads, for debugging.
   NtempReads = 0;
@@ -114,40 +755,38 @@ void initReadTemperature(int pinADC_CALIB, int pinPWM_CALIB, int pinAREF_OUT,
   temperature Temp;
   Temp.goingUpC = Temp.goingUpF = true;
 
-  // Read indoor temperature.
-  readTemperature(IndoorThermistor, Temp, false);
-
-  // Force an indoor initialization temperature for debugging.
-  #if FORCE_INDOOR_TEMP != 9999
-  Temp.Tc = Temp.Tc_int16 = (FORCE_INDOOR_TEMP + DEBUG_TEMP_OFFSET);
-  Temp.Tf = Temp.Tf_int16 = degCtoF(Temp.Tc_int16);
-  #endif
-
-  // Fill the indoor running average buffer with the initial value.
-  for (uint8_t i = 0; i < NUM_TEMPS_RUNNING_AVG; i++)
-    IndoorTempBuf.Tc[i] = Temp.Tc;
-  IndoorTempBuf.idxLatest = 0;
-  curIndoorTemperature = Temp;
-  ADClastIndoorTempRead = Temp.ADCvalue;
-  RlastIndoorTempRead = Temp.Rthermistor;
-
-  // Read outdoor temperature.
-  readTemperature(OutdoorThermistor, Temp, true);
+  // Read each thermistor with AREF left on until the last, and reset its filter to the
+  // temperature read.
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++) {
+    readTemperature(Thermistors[i], Temp, i == NUM_TEMP_SENSORS-1);
+
+    // Force an indoor or outdoor initialization temperature for debugging.
+    #if FORCE_INDOOR_TEMP != 9999
+    if (i != OUTDOOR_SENSOR)
+      setTc(Temp, toTempValue(FORCE_INDOOR_TEMP + DEBUG_TEMP_OFFSET));
+    #endif
+    #if FORCE_OUTDOOR_TEMP != 9999
+    if (i == OUTDOOR_SENSOR)
+      setTc(Temp, toTempValue(FORCE_OUTDOOR_TEMP + DEBUG_TEMP_OFFSET));
+    #endif
+
+    TempSensors.TempBuf[i].reset(getTc(Temp));
+    TempSensors.curTemperature[i] = Temp;
+    TempSensors.ADClastRead[i] = Temp.ADCvalue;
+    TempSensors.RlastRead[i] = Temp.Rthermistor;
+    TempSensors.TlastRead[i] = Temp.Tc;
+  }
 
-  // Force an outdoor initialization temperature for debugging.
-  #if FORCE_OUTDOOR_TEMP != 9999
-  Temp.Tc = Temp.Tc_int16 = (FORCE_OUTDOOR_TEMP + DEBUG_TEMP_OFFSET);
-  Temp.Tf = Temp.Tf_int16 = degCtoF(Temp.Tc_int16);
+  // Combine the indoor zones and reset the trend estimates to the initial values.
+  curIndoorTemperature = TempSensors.curTemperature[0];
+  reduceIndoorTemperatures(TempSensors.curTemperature, curIndoorTemperature);
+  curOutdoorTemperature = TempSensors.curTemperature[OUTDOOR_SENSOR];
+  #if USE_TEMPERATURE_TREND
+  resetTemperatureTrend(IndoorTrend, curIndoorTemperature.Tc, millis());
+  resetTemperatureTrend(OutdoorTrend, curOutdoorTemperature.Tc, millis());
   #endif
-
-  // Fill the outdoor running average buffer with the initial value.
-  for (uint8_t i = 0; i < NUM_TEMPS_RUNNING_AVG; i++)
-    OutdoorTempBuf.Tc[i] = Temp.Tc;
-  OutdoorTempBuf.idxLatest = 0;
-  curOutdoorTemperature = Temp;
+  MSlastTempRead = millis();
   readCurrentTemperatures();
-  ADClastOutdoorTempRead = Temp.ADCvalue;
-  RlastOutdoorTempRead = Temp.Rthermistor;
 
   // We've now read temperatures one time.
   NtempReads = 1;
@@ -194,6 +833,19 @@ int16_t roundTemperature(float Temp, bool goingUp, bool isCelsius) {
   return((int16_t) floor(Temp + 0.5 - (goingUp ? -halfHysteresis : +halfHysteresis)));
   }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Compute rounded version of a fixed-point temperature value (rounded to an integer).
+/////////////////////////////////////////////////////////////////////////////////////////////
+int16_t roundFixedTemperature(fixedTemp Temp, bool goingUp, bool isCelsius) {
+  // This is the same computation as roundTemperature(). The arithmetic right shift is the
+  // fixed-point floor() operation.
+  const fixedTemp halfHysteresisC = (fixedTemp)(TEMP_HYST_C*FIXED_TEMP_ONE/2);
+  const fixedTemp halfHysteresisF = (fixedTemp)(TEMP_HYST_F*FIXED_TEMP_ONE/2);
+  fixedTemp halfHysteresis = isCelsius ? halfHysteresisC : halfHysteresisF;
+  return((int16_t) ((Temp + FIXED_TEMP_ONE/2 - (goingUp ? -halfHysteresis : +halfHysteresis))
+    >> FIXED_TEMP_SHIFT));
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Read temperature from the specified thermistor and return results in Temp.
 // On call, Temp contains valid "goingUpC" and "goingUpF" values that are used by
@@ -219,33 +871,8 @@ void readTemperature(const thermistor& Thermistor, temperature& Temp, bool turnA
   if (turnAREFoff)
     digitalWrite(PIN_AREF_OUT, LOW);
 
-  // Compute temperature from voltage.
-  uint16_t analogMax = (uint16_t) ADC_MAX;
-  if (Vo <= 5) Vo = 5; // Avoid ridiculously small Vo.
-  float R2 = (float)Thermistor.seriesResistor * ((float)analogMax / (float)Vo - 1.0);
-  float logR2 = log(R2);
-  float Tk = (1.0 / (Thermistor.A + Thermistor.B*logR2 + Thermistor.C*logR2*logR2*logR2));
-  // Other temperatures are computed from Tc.
-  Temp.Tc = degKtoC(Tk);
-
-  // Force an indoor temperature for debugging.
-  #if FORCE_INDOOR_TEMP != 9999
-  if (&Thermistor == &IndoorThermistor)
-    Temp.Tc = FORCE_INDOOR_TEMP;
-  #endif
-
-  // Force an outdoor temperature for debugging.
-  #if FORCE_OUTDOOR_TEMP != 9999
-  if (&Thermistor == &OutdoorThermistor)
-    Temp.Tc = FORCE_OUTDOOR_TEMP;
-  #endif
-
-  // Compute other temperatures from Temp.Tc.
-  Temp.Tc_int16 = roundTemperature(Temp.Tc, Temp.goingUpC, true);
-  Temp.Tf = degCtoF(Temp.Tc);
-  Temp.Tf_int16 = roundTemperature(Temp.Tf, Temp.goingUpF, false);
-  Temp.ADCvalue = Vo;
-  Temp.Rthermistor = (uint16_t) R2;
+  // Compute temperatures from voltage.
+  setTemperatureFromADC(Thermistor, Temp, Vo);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -259,85 +886,110 @@ float readTemperatureRunningAverage(const thermistor& Thermistor,
 
   temperature NewTemp = Temp;
 
-  // Read current temperature and add it to TempBuf.
+  // Read current temperature and pass it through TempBuf.
   readTemperature(Thermistor, NewTemp, turnAREFoff);
-  float returnT = NewTemp.Tc;
-  uint8_t idxNewTemp = TempBuf.idxLatest + 1;
-  if (idxNewTemp >= NUM_TEMPS_RUNNING_AVG)
-    idxNewTemp = 0;
-  TempBuf.Tc[idxNewTemp] = NewTemp.Tc;
-  TempBuf.idxLatest = idxNewTemp;
-
-  // Compute new running average.
-  float TcSum = 0.0;
-  for (uint8_t i = 0; i < NUM_TEMPS_RUNNING_AVG; i++)
-    TcSum += TempBuf.Tc[i];
-  NewTemp.Tc = TcSum/NUM_TEMPS_RUNNING_AVG;
-
-  // Compute integer temperatures, rounded.
-  NewTemp.Tc_int16 = roundTemperature(NewTemp.Tc, NewTemp.goingUpC, true);
-  NewTemp.Tf = degCtoF(NewTemp.Tc);
-  NewTemp.Tf_int16 = roundTemperature(NewTemp.Tf, NewTemp.goingUpF, false);
-  if (NewTemp.Tc_int16 < Temp.Tc_int16)
-    NewTemp.goingUpC = false;
-  else if (NewTemp.Tc_int16 > Temp.Tc_int16)
-    NewTemp.goingUpC = true;
-  if (NewTemp.Tf_int16 < Temp.Tf_int16)
-    NewTemp.goingUpF = false;
-  else if (NewTemp.Tf_int16 > Temp.Tf_int16)
-    NewTemp.goingUpF = true;
-  // (NewTemp.ADCvalue was set to last ADC value by readTemperature).
-  // (NewTemp.Rthermistor was set to last thermistor resistance by readTemperature).
-  // Set argument Temp (a reference) to the new average temperature.
-  Temp = NewTemp;
-  return(returnT);
+  return(updateFilteredTemperature(TempBuf, Temp, NewTemp, 1));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read indoor and outdoor temperatures, updating the running averages and storing them in
-// curIndoorTemperature and curOutdoorTemperature. NtempReads is incremented,
-// ADClastIndoorTempRead and ADClastOutdoorTempRead are set to the most recent ADC value,
-// RlastIndoorTempRead and RlastOutdoorTempRead are set to the most recent computed
-// Rthermistor value, and TlastIndoorTempRead and TlastOutdoorTempRead are set to the most
-// recent computed temperature in Fahrenheit.
+// Read all the thermistors with AREF on once, updating their filters and TempSensors, and
+// storing the combined indoor and the outdoor temperatures in curIndoorTemperature and
+// curOutdoorTemperature. NtempReads is incremented, and TlastIndoorTempRead and
+// TlastOutdoorTempRead are set to the most recent computed temperature (Celsius).
 /////////////////////////////////////////////////////////////////////////////////////////////
 void readCurrentTemperatures(void) {
-  TlastIndoorTempRead = readTemperatureRunningAverage(IndoorThermistor, IndoorTempBuf,
-    curIndoorTemperature, false);
-  ADClastIndoorTempRead = curIndoorTemperature.ADCvalue;
-  RlastIndoorTempRead = curIndoorTemperature.Rthermistor;
+  startReadCurrentTemperatures();
+  while (!serviceReadCurrentTemperatures())
+    ;
+}
 
-  TlastOutdoorTempRead = readTemperatureRunningAverage(OutdoorThermistor, OutdoorTempBuf,
-    curOutdoorTemperature, true);
-  ADClastOutdoorTempRead = curOutdoorTemperature.ADCvalue;
-  RlastOutdoorTempRead = curOutdoorTemperature.Rthermistor;
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start reading indoor and outdoor temperatures without waiting for the read to finish.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void startReadCurrentTemperatures(void) {
+  if (TreadState != TREAD_IDLE)
+    return;
+  TreadArefOnUS = micros();
+  // Skip waiting for AREF to stabilize if it was left on.
+  if (digitalRead(PIN_AREF_OUT) == LOW) {
+    digitalWrite(PIN_AREF_OUT, HIGH);
+    TreadState = TREAD_AREF_SETTLE;
+  } else {
+    startTreadConversions();
+    TreadState = TREAD_CONVERT;
+  }
+}
 
-  NtempReads++;
-  readAndShowCurrentTemperatures();
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Advance the temperature read state machine started by startReadCurrentTemperatures().
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool serviceReadCurrentTemperatures(void) {
+  switch (TreadState) {
+
+  case TREAD_IDLE:
+    break;
+
+  // When AREF has had time to stabilize, start converting the thermistors.
+  case TREAD_AREF_SETTLE:
+    if (micros() - TreadArefOnUS >= AREF_STABLE_DELAY*1000UL) {
+      startTreadConversions();
+      TreadState = TREAD_CONVERT;
+    }
+    break;
+
+  // When all thermistors have been read, turn off AREF to not warm the thermistors and
+  // update the current temperatures.
+  case TREAD_CONVERT:
+    if (pollTreadConversions()) {
+      digitalWrite(PIN_AREF_OUT, LOW);
+      recordTempReadTiming();
+      TreadState = TREAD_IDLE;
+      finishReadCurrentTemperatures();
+      return(true);
+    }
+    break;
+  }
+  return(false);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if a read started by startReadCurrentTemperatures() has not yet finished.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool isReadCurrentTemperaturesBusy(void) {
+  return(TreadState != TREAD_IDLE);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the timing of the reads done by the state machine since initReadTemperature().
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getTempReadTiming(tempReadTiming& T) {
+  T = TreadTiming;
+  T.meanBusyUS = (T.count == 0) ? 0 : (uint32_t) (TreadSumBusyUS / T.count);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Display a temperature on the Arduino IDE serial monitor, with a prefix description string.
 /////////////////////////////////////////////////////////////////////////////////////////////
-void showTemperature(const temperature Temp, char* Desc) {
+void showTemperature(const temperature Temp, const char* Desc) {
   // By default printf does not include floating point support, and I can't figure out how to enable it.
   //printf("Temperature: %4.1f°F   %4.1f°C\n", Tf, Tc);
   char TfS[9], TcS[9];
   floatToString(Temp.Tf, TfS, sizeof(TfS), 1);
   floatToString(Temp.Tc, TcS, sizeof(TcS), 1);
-  monitor.printf("%s Temperature: %s°F  %s°C   Rthermistor: %ld\n", Desc, TfS, TcS, Temp.Rthermistor);
+  logPrintf("%s Temperature: %s°F  %s°C   Rthermistor: %ld\n", Desc, TfS, TcS, Temp.Rthermistor);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read indoor and outdoor temperatures using readCurrentTemperatures() and write them to the
-// serial monitor.
+// Read the temperatures of all the thermistors using readTemperature() and write them to
+// the serial monitor.
 /////////////////////////////////////////////////////////////////////////////////////////////
 void readAndShowCurrentTemperatures(void) {
   temperature Temp;
-  readTemperature(IndoorThermistor, Temp, false);
-  showTemperature(Temp, "Indoor");
-  readTemperature(OutdoorThermistor, Temp, true);
-  showTemperature(Temp, "Outdoor");
+  for (uint8_t i = 0; i < NUM_TEMP_SENSORS; i++) {
+    char S[8];
+    readTemperature(Thermistors[i], Temp, i == NUM_TEMP_SENSORS-1);
+    showTemperature(Temp, sensorName(i, S, sizeof(S)));
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
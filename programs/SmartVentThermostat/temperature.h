@@ -228,16 +228,74 @@
 //    3. Select 12-bit ADC resolution.
 //    4. Load the ADC with gain and offset error correction values if desired.
 //    5. Configure multiple sampling and averaging, if desired.
-// The actual pin numbers used by this module are set in the .cpp file definitions of
-// IndoorThermistor and OutdoorThermistor, as well as in the constants defined in
-// calibSAMD_ADC_withPWM.h.
+// The actual pin numbers used by this module are set in the .cpp file definition of
+// Thermistors[], as well as in the constants defined in calibSAMD_ADC_withPWM.h.
 #define USE_ANALOG_SAMD 1
 
+// Number of indoor thermistors, one per zone. Thermistors[] in the .cpp file lists the
+// indoor thermistors first, then the outdoor thermistor.
+#define NUM_INDOOR_SENSORS 1
+
+// Number of thermistors, and index of the outdoor thermistor in Thermistors[] and in the
+// arrays of TempSensors.
+#define NUM_TEMP_SENSORS (NUM_INDOOR_SENSORS+1)
+#define OUTDOOR_SENSOR NUM_INDOOR_SENSORS
+
+// How the indoor zone temperatures are combined into the indoor temperature that is used
+// for control and shown on the screen (curIndoorTemperature):
+//   0: mean of the zones
+//   1: warmest zone
+//   2: coolest zone
+//   3: zone INDOOR_CONTROL_ZONE only (0 is the first)
+// With one indoor thermistor, they are all the same.
+#define INDOOR_REDUCTION 0
+#define INDOOR_CONTROL_ZONE 0
+
+// Amount of time to wait between each reading of indoor and outdoor temperatures, or when
+// the read interval is adaptive (see USE_ADAPTIVE_READ_INTERVAL in smartVentControl.h), the
+// shortest time, of which all read intervals are multiples. The temperatures are passed
+// through a filter (by default, the running average of NUM_TEMPS_RUNNING_AVG of them) and
+// the filtered temperatures are the values used to control SmartVent and to display on the
+// screen. If we read temperatures once every two seconds, then the running average is
+// flushed over a period of one minute. That seems reasonable. The filters measure time in
+// units of this period.
+#define TEMPERATURE_READ_TIME_MS (2*1000)
+
 // Number of temperature readings to buffer and compute running average, for reduction of
 // jitter in thermistor readings.  Note: we also enable the ADC converter to internally
 // take a number of samples and average them, each time we tell it to do a conversion.
 #define NUM_TEMPS_RUNNING_AVG 30
 
+// Define this as 1 to keep a running sum of the temperatures in each temperatureBuf, updated
+// on each read by subtracting the temperature being replaced and adding the new one, so that
+// computing the running average costs the same no matter how large NUM_TEMPS_RUNNING_AVG is.
+// Define it as 0 to instead sum the entire buffer on every read.
+#define USE_RUNNING_SUM 1
+
+// When USE_RUNNING_SUM is 1, the running sum slowly accumulates floating point round-off
+// error from the repeated subtract/add. To bound that error, the sum is recomputed exactly
+// from the buffer contents once every this many reads.
+#define RUNNING_SUM_RESUM_INTERVAL 1000
+
+// Filter used to smooth the temperatures read from each thermistor (see temperatureFilter.h
+// and the temperatureBuf typedef below):
+//   0: boxcar running average of NUM_TEMPS_RUNNING_AVG reads
+//   1: exponential moving average with time constant TEMP_EMA_TAU reads
+//   2: sliding median of TEMP_MEDIAN_WINDOW reads followed by the EMA
+//   3: Hampel outlier rejection over TEMP_MEDIAN_WINDOW reads followed by the EMA
+#define TEMPERATURE_FILTER 0
+
+// Time constant in reads of the exponential moving average filter.
+#define TEMP_EMA_TAU 8
+
+// Window size in reads (odd) of the median and Hampel filters.
+#define TEMP_MEDIAN_WINDOW 5
+
+// Hampel filter outlier threshold, in tenths of a standard deviation and, at least, in
+// hundredths of a degree.
+#define TEMP_HAMPEL_K_TENTHS 30
+#define TEMP_HAMPEL_MIN_DEV_CENTI 25
+
 // Hysteresis used by roundTemperature. Refer to its comments for an explanation.
 // Separate values are used for C and F degrees, but generally it makes sense for the
 // Fahrenheit value to be 9/5 times the Celsius value. A value of 0 turns off hysteresis.
@@ -248,6 +306,55 @@
 // may have considerable capacitance. On mine a scope shows 1 ms is too little.
 #define AREF_STABLE_DELAY 3
 
+// Define this as 1 to convert ADC readings to temperature using a table built by
+// initReadTemperature() for each thermistor, with linear interpolation between table
+// entries. This avoids the floating point divide, log(), and Steinhart–Hart cubic on every
+// read, which are slow on the Cortex-M0+ because it has no FPU. Define it as 0 to evaluate
+// the Steinhart–Hart equation directly on each read.
+#define USE_TEMPERATURE_TABLE 1
+
+// When USE_TEMPERATURE_TABLE is 1, the table has one entry every 2^TEMP_TABLE_SHIFT ADC
+// codes over the 12-bit ADC range, plus a final entry at the top of the range. Each table
+// takes TEMP_TABLE_SIZE*4 bytes of RAM. With a shift of 5 the interpolation error is about
+// 0.01°C between -20°C and 60°C.
+#define TEMP_TABLE_SHIFT 5
+#define TEMP_TABLE_SIZE ((4096 >> TEMP_TABLE_SHIFT) + 1)
+
+// Define this as 1 to carry temperatures through the read, running average, rounding, and
+// hysteresis steps as fixed-point integers (fixedTemp, 1/4096 degree units) rather than as
+// floats, avoiding the Cortex-M0+ software floating point library in that chain. The float
+// members Tc and Tf of struct temperature are still set from the fixed-point results, once
+// per read, for use by code outside this module. Define this as 0 to use floats throughout.
+#define USE_FIXED_POINT_TEMPS 1
+
+// Each time this many reads of the current temperatures have been done, the temperatures
+// that were just read are written to the serial monitor. Set this to 0 to never write them.
+#define TEMPERATURE_LOG_INTERVAL 1
+
+// Define this as 1 to have startReadCurrentTemperatures() and
+// serviceReadCurrentTemperatures() program the SAMD21 ADC registers directly, so that they
+// start an ADC conversion and later poll for its result instead of waiting for it. Define
+// it as 0 to have them use the blocking analogRead_SAMD_TT() (or analogRead()).
+#if defined(ARDUINO_ARCH_SAMD) && USE_ANALOG_SAMD
+#define USE_NONBLOCKING_ADC 1
+#else
+#define USE_NONBLOCKING_ADC 0
+#endif
+
+// Define this as 1 (requires USE_NONBLOCKING_ADC) to have the state machine convert all the
+// thermistors in one SAMD21 ADC input scan (INPUTCTRL.INPUTSCAN), free-running, with DMA
+// copying each result to a buffer, so the CPU is not involved until the last result is in.
+// Define it as 0 to convert the thermistors one at a time, each started and polled by
+// loop(). A scan converts every ADC input from the lowest to the highest thermistor input,
+// each with the full 2^CFG_ADC_MULT_SAMP_AVG samples, so it pays off most when the
+// thermistors are on adjacent inputs. With the indoor thermistor on A1 (AIN10) and the
+// outdoor one on A6 (AIN17), a scan is 9 conversions (one discarded) instead of 4 (two
+// discarded), which only saves time when loop() takes long compared to a conversion. If the
+// inputs span more than 16 ADC inputs, or no DMA channel is free, the thermistors are
+// converted one at a time, as they are for a read whose scan does not finish within 20 ms.
+// Use getTempReadTiming() to compare the ADC busy time of the two.
+#define USE_ADC_INPUT_SCAN 0
+
 // Force indoor or outdoor temperature to this value in °C, for debugging. Set these to 9999
 // to not do this and use the measured temperature. Note: 30°C = 86°F.
 #define FORCE_INDOOR_TEMP   9999
@@ -257,22 +364,60 @@
 // temperatures in the temperature buffer. Used only when they are not 9999. Note: 10°C = 18°F.
 #define DEBUG_TEMP_OFFSET   (-10)
 
+// Number of fraction bits in a fixedTemp value, and the fixedTemp value of one degree.
+#define FIXED_TEMP_SHIFT 12
+#define FIXED_TEMP_ONE (1L << FIXED_TEMP_SHIFT)
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Types.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Fixed-point temperature in units of 1/FIXED_TEMP_ONE degree.
+typedef int32_t fixedTemp;
+
+// Type of the Celsius temperatures held in temperature buffers and conversion tables.
+#if USE_FIXED_POINT_TEMPS
+typedef fixedTemp tempValue;
+#else
+typedef float tempValue;
+#endif
+
+// Filter of Celsius temperatures read from a thermistor, holding whatever state it needs,
+// selected by TEMPERATURE_FILTER. Any filter built from the stages in temperatureFilter.h
+// can be used here.
+#include "temperatureFilter.h"
+#if TEMPERATURE_FILTER == 0
+typedef BoxcarFilter<NUM_TEMPS_RUNNING_AVG> temperatureBuf;
+#elif TEMPERATURE_FILTER == 1
+typedef EMAFilter<TEMP_EMA_TAU> temperatureBuf;
+#elif TEMPERATURE_FILTER == 2
+typedef FilterCascade<MedianFilter<TEMP_MEDIAN_WINDOW>, EMAFilter<TEMP_EMA_TAU>>
+  temperatureBuf;
+#elif TEMPERATURE_FILTER == 3
+typedef FilterCascade<HampelFilter<TEMP_MEDIAN_WINDOW, TEMP_HAMPEL_K_TENTHS,
+  TEMP_HAMPEL_MIN_DEV_CENTI>, EMAFilter<TEMP_EMA_TAU>> temperatureBuf;
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Structs.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// Structure for holding thermistor parameters.
+// Structure for holding thermistor parameters. TcTable points to the thermistor's ADC to
+// Celsius conversion table (TEMP_TABLE_SIZE entries) when USE_TEMPERATURE_TABLE is 1, and is
+// nullptr otherwise.
 struct thermistor {
   pin_size_t inputPin;
   uint16_t seriesResistor;
   float A;
   float B;
   float C;
+  tempValue* TcTable;
 };
 
 // Structure for holding temperature computation results. For explanation of goingUpC and
 // goingUpF, see roundTemperature(). ADC is the ADC reading and Rthermistor is the computed
-// thermistor resistance (both for debugging).
+// thermistor resistance (both for debugging). When USE_FIXED_POINT_TEMPS is 1, Tc_fixed and
+// Tf_fixed are the fixed-point temperatures from which all the other temperatures are derived.
 struct temperature {
   float Tc;
   int16_t Tc_int16;
@@ -282,47 +427,61 @@ struct temperature {
   bool goingUpF;
   uint16_t ADCvalue;
   uint16_t Rthermistor;
+  #if USE_FIXED_POINT_TEMPS
+  fixedTemp Tc_fixed;
+  fixedTemp Tf_fixed;
+  #endif
 };
 
-// Structure for holding circular temperature buffer of Celsius temperatures for computing
-// running average.
-struct temperatureBuf {
-  float Tc[NUM_TEMPS_RUNNING_AVG];
-  uint8_t idxLatest;
+// State of the thermistors, each member an array indexed like Thermistors[].
+struct temperatureSensors {
+  // Filters of the temperatures that were read, and their outputs.
+  temperatureBuf TempBuf[NUM_TEMP_SENSORS];
+  temperature curTemperature[NUM_TEMP_SENSORS];
+  // ADC values, computed thermistor resistances, and computed temperatures (Celsius) of the
+  // last read, for debugging.
+  uint16_t ADClastRead[NUM_TEMP_SENSORS];
+  uint16_t RlastRead[NUM_TEMP_SENSORS];
+  float TlastRead[NUM_TEMP_SENSORS];
 };
 
+// Timing of the reads of the thermistors by the state machine, in microseconds. The ADC busy
+// time of a read is from starting the first ADC conversion to having the last result. With
+// an input scan, the DMA interrupt marks the last result. Otherwise loop() polls for it, so
+// the time includes loop() latency. The AREF on time is from turning AREF on (or starting
+// the read, if it was already on) to turning it off, including AREF_STABLE_DELAY.
+struct tempReadTiming {
+  uint32_t count;       // Number of reads timed.
+  uint32_t lastBusyUS;
+  uint32_t minBusyUS;
+  uint32_t meanBusyUS;
+  uint32_t maxBusyUS;
+  uint32_t lastArefOnUS;
+  uint32_t maxArefOnUS;
+};
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Variables.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
-// Thermistor parameters.
+// Thermistor parameters, NUM_TEMP_SENSORS of them: the indoor zones, then outdoor.
 // Note: Series resistors were measured with an ohmmeter
-extern const thermistor IndoorThermistor;
-extern const thermistor OutdoorThermistor;
+extern const thermistor Thermistors[];
 
-// Buffers for buffering last several temperatures that were read, for computing running
-// average.
-extern temperatureBuf IndoorTempBuf;
-extern temperatureBuf OutdoorTempBuf;
+// Filters, filtered temperatures, and last reads of the thermistors.
+extern temperatureSensors TempSensors;
 
-// Current indoor and outdoor temperatures (result of running averages).
+// Current indoor and outdoor temperatures: the filtered indoor zone temperatures combined
+// as selected by INDOOR_REDUCTION, and the filtered outdoor temperature.
 extern temperature curIndoorTemperature;
 extern temperature curOutdoorTemperature;
 
 // Number of times indoor and outdoor temperatures have been read, for debugging.
 extern uint16_t NtempReads;
 
-// Values of computed thermistor resistances on last indoor and outdoor temperature reads,
-// for debugging.
-extern uint16_t RlastIndoorTempRead;
-extern uint16_t RlastOutdoorTempRead;
-
-// Values of ADC on last indoor and outdoor temperature reads, for debugging.
-extern uint16_t ADClastIndoorTempRead;
-extern uint16_t ADClastOutdoorTempRead;
-
-// Values of computed temperatures on last indoor and outdoor temperature reads,
-// for debugging.
+// Indoor and outdoor temperatures (Celsius) computed on the last read, before filtering,
+// the indoor one combined from the zones as selected by INDOOR_REDUCTION.
 extern float TlastIndoorTempRead;
 extern float TlastOutdoorTempRead;
 
@@ -352,6 +511,14 @@ inline float degFtoC(float TF) { return((TF-32.0)*5.0/9.0); }
 inline float degCtoK(float TC) { return(TC+273.15); }
 inline float degKtoC(float TK) { return(TK-273.15); }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Convert between float and fixedTemp temperatures, and convert fixedTemp degrees C to
+// fixedTemp degrees F.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline fixedTemp floatToFixedTemp(float T) { return((fixedTemp) floor(T*FIXED_TEMP_ONE + 0.5)); }
+inline float fixedTempToFloat(fixedTemp T) { return((float)T * (1.0f/FIXED_TEMP_ONE)); }
+inline fixedTemp fixedDegCtoF(fixedTemp TC) { return(TC*9/5 + 32*FIXED_TEMP_ONE); }
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Compute rounded version of a floating point temperature value (rounded to an integer).
 // Temp is the temperature to be rounded, goingUp is true if the last time the rounded
@@ -379,6 +546,11 @@ inline float degKtoC(float TK) { return(TK-273.15); }
 /////////////////////////////////////////////////////////////////////////////////////////////
 extern int16_t roundTemperature(float Temp, bool goingUp, bool isCelsius);
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Same as roundTemperature() but for a fixed-point temperature, using only integer math.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern int16_t roundFixedTemperature(fixedTemp Temp, bool goingUp, bool isCelsius);
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Read temperature from the specified thermistor and return results in Temp.  Results
 // include Temp.Rthermistor, the measured resistance of the thermistor.
@@ -393,13 +565,13 @@ extern int16_t roundTemperature(float Temp, bool goingUp, bool isCelsius);
 extern void readTemperature(const thermistor& Thermistor, temperature& Temp, bool turnAREFoff=true);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Nano 33 IoT has problems with stable ADC, it jitters a lot. This function updates TempBuf
-// by reading the current temperature and adding it to TempBuf (replacing the oldest in the
-// buffer), then recomputes the running average of the buffer values and returns the average
-// in Temp. A running average is only computed for the Tc member of the temperature struct,
-// and Tc_uint16, Tf, and Tf_uint16 are computed directly from the average Tc. The Rthermistor
-// member of Temp is set to the last measured Rthermistor value, no running average is
-// computed for it. turnAREFoff is passed to readTemperature().
+// Nano 33 IoT has problems with stable ADC, it jitters a lot. This function reads the
+// current temperature and passes it through filter TempBuf (for the default boxcar filter,
+// adding it to the buffer in place of the oldest and recomputing the running average), and
+// returns the filter output in Temp. Only the Tc member of the temperature struct is
+// filtered, and Tc_uint16, Tf, and Tf_uint16 are computed directly from the filtered Tc.
+// The Rthermistor member of Temp is set to the last measured Rthermistor value, no running
+// average is computed for it. turnAREFoff is passed to readTemperature().
 //
 // IMPORTANT: On call to this function, Temp must contain the PREVIOUS TEMPERATURE from the
 // same thermistor, so its "goingUpC" and "goingUpF" values can be used to determine by
@@ -414,23 +586,45 @@ extern float readTemperatureRunningAverage(const thermistor& Thermistor,
   temperatureBuf& TempBuf, temperature& Temp, bool turnAREFoff=true);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read indoor and outdoor temperatures, updating the running averages and storing them in
-// curIndoorTemperature and curOutdoorTemperature. NtempReads is incremented,
-// ADClastIndoorTempRead and ADClastOutdoorTempRead are set to the most recent ADC value,
-// RlastIndoorTempRead and RlastOutdoorTempRead are set to the most recent computed
-// Rthermistor value, and TlastIndoorTempRead and TlastOutdoorTempRead are set to the most
-// recent computed temperature (Celsius).
+// Read all the thermistors with AREF on once, updating their filters and TempSensors, and
+// storing the combined indoor and the outdoor temperatures in curIndoorTemperature and
+// curOutdoorTemperature. NtempReads is incremented, and TlastIndoorTempRead and
+// TlastOutdoorTempRead are set to the most recent computed temperature (Celsius). Every
+// TEMPERATURE_LOG_INTERVAL reads, the temperatures just read are also written to the
+// serial monitor.
 /////////////////////////////////////////////////////////////////////////////////////////////
 extern void readCurrentTemperatures(void);
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Non-blocking version of readCurrentTemperatures(), for use from loop(). Call
+// startReadCurrentTemperatures() to begin a read of all thermistors (it does nothing if a
+// read is already in progress), then call serviceReadCurrentTemperatures() on every pass
+// through loop(). Each call advances the read by at most one step (turn AREF on, wait
+// AREF_STABLE_DELAY, start an ADC conversion or input scan, poll for its result, turn AREF
+// off) without waiting, and returns true on the call that finishes the read and updates the
+// current temperatures and debug values as readCurrentTemperatures() does, else false.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void startReadCurrentTemperatures(void);
+extern bool serviceReadCurrentTemperatures(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if a read started by startReadCurrentTemperatures() has not yet finished.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool isReadCurrentTemperaturesBusy(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the timing of the reads done by the state machine since initReadTemperature().
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getTempReadTiming(tempReadTiming& T);
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // Display a temperature on the Arduino IDE serial monitor, with a prefix description string.
 /////////////////////////////////////////////////////////////////////////////////////////////
-extern void showTemperature(const temperature Temp, char* Desc);
+extern void showTemperature(const temperature Temp, const char* Desc);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
-// Read indoor and outdoor temperatures using readCurrentTemperatures() and write them to the
-// serial monitor.
+// Read the temperatures of all the thermistors using readTemperature() and write them to
+// the serial monitor.
 /////////////////////////////////////////////////////////////////////////////////////////////
 extern void readAndShowCurrentTemperatures(void);
 
@@ -0,0 +1,279 @@
+/*
+  temperatureFilter.h - Filter stages for smoothing the temperatures read from thermistors.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef temperatureFilter_h
+#define temperatureFilter_h
+
+/*
+  This file is included by temperature.h after it defines tempValue, and it uses that
+  file's USE_FIXED_POINT_TEMPS, FIXED_TEMP_ONE, USE_RUNNING_SUM, and
+  RUNNING_SUM_RESUM_INTERVAL. Do not include it anywhere else.
+
+  Each filter stage is a class with these two member functions:
+
+    void reset(tempValue Tc)
+        Reset the stage's state as if temperature Tc had been read forever.
+
+    tempValue update(tempValue Tc, uint16_t periods = 1)
+        Add newly read temperature Tc to the stage and return the filtered temperature.
+        periods is the number of TEMPERATURE_READ_TIME_MS periods since the previous read.
+
+  A stage's parameters are template arguments, and stages are combined with
+  FilterCascade<>, so the filter is chosen at compile time (see temperatureBuf in
+  temperature.h), there are no virtual calls, and the code and RAM of stages that are not
+  used cost nothing. Stage sizes and time constants are in TEMPERATURE_READ_TIME_MS periods.
+  When reads are further apart than that, the boxcar and EMA filters treat the temperature
+  read as having been read once every period since the previous read, so they still
+  average over the same time. The Hampel filter works on reads, not time.
+*/
+
+// *************************************************************************************** //
+// Helper functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Convert a temperature difference in hundredths of a degree to a tempValue.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline tempValue centiDegToTempValue(int32_t centiDeg) {
+  #if USE_FIXED_POINT_TEMPS
+  return((tempValue) (centiDeg*FIXED_TEMP_ONE/100));
+  #else
+  return(centiDeg * 0.01f);
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return T*num/den. For fixed-point temperatures, T*num must fit in 32 bits, which avoids
+// the slow 64-bit divide on the Cortex-M0+.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline tempValue scaleTempValue(tempValue T, int32_t num, int32_t den) {
+  return(T*num/den);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Sort the N temperatures in T into increasing order. Insertion sort is fastest for the
+// small N used here.
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<uint8_t N> inline void sortTempValues(tempValue* T) {
+  for (uint8_t i = 1; i < N; i++) {
+    tempValue x = T[i];
+    uint8_t j = i;
+    for (; j > 0 && T[j-1] > x; j--)
+      T[j] = T[j-1];
+    T[j] = x;
+  }
+}
+
+// *************************************************************************************** //
+// Filter stages.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Boxcar filter: the running average of the last N periods of temperatures. A step in
+// temperature reaches the output linearly over N periods (N/2 periods of lag). RAM is N+2
+// tempValues.
+//
+// When USE_RUNNING_SUM is 1, TcSum is the sum of all Tc[] values and readsSinceResum
+// counts reads since TcSum was last recomputed exactly from Tc[] (which is only necessary
+// when the values are floats).
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<uint16_t N> class BoxcarFilter {
+public:
+  void reset(tempValue Tc) {
+    for (uint16_t i = 0; i < N; i++)
+      this->Tc[i] = Tc;
+    idxLatest = 0;
+    #if USE_RUNNING_SUM
+    TcSum = sum();
+    readsSinceResum = 0;
+    #endif
+  }
+
+  tempValue update(tempValue Tc, uint16_t periods = 1) {
+    if (periods > N)
+      periods = N;
+    for (uint16_t i = 0; i < periods; i++)
+      add(Tc);
+    #if USE_RUNNING_SUM
+    return(TcSum/N);
+    #else
+    return(sum()/N);
+    #endif
+  }
+
+private:
+  // Replace the oldest temperature in Tc[] with Tc.
+  void add(tempValue Tc) {
+    uint16_t idxNewTemp = idxLatest + 1;
+    if (idxNewTemp >= N)
+      idxNewTemp = 0;
+    #if USE_RUNNING_SUM
+    tempValue oldTc = this->Tc[idxNewTemp];
+    #endif
+    this->Tc[idxNewTemp] = Tc;
+    idxLatest = idxNewTemp;
+
+    // With a running sum, replace the oldest temperature in the sum with the new one. Float
+    // sums are periodically recomputed from scratch to discard accumulated round-off error,
+    // fixed-point sums are exact and never need that.
+    #if USE_RUNNING_SUM
+    TcSum += Tc - oldTc;
+    #if !USE_FIXED_POINT_TEMPS
+    if (++readsSinceResum >= RUNNING_SUM_RESUM_INTERVAL) {
+      readsSinceResum = 0;
+      TcSum = sum();
+    }
+    #endif
+    #endif
+  }
+
+  // Return the sum of all temperatures in Tc[], computed from scratch.
+  tempValue sum() const {
+    tempValue TcSum = 0;
+    for (uint16_t i = 0; i < N; i++)
+      TcSum += Tc[i];
+    return(TcSum);
+  }
+
+  tempValue Tc[N];
+  uint16_t idxLatest;
+  #if USE_RUNNING_SUM
+  tempValue TcSum;
+  uint16_t readsSinceResum;
+  #endif
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Exponential moving average filter with a time constant of TAU periods: each period moves
+// the output 1/TAU of the way to the new temperature. A step reaches 63% of its size after
+// TAU periods. For the same noise reduction as BoxcarFilter<N>, TAU is about N/2, and it has
+// about the same lag, but it needs just one tempValue of RAM. TcSum is TAU times the output,
+// which keeps the fraction bits that dividing by TAU on every period would lose.
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<uint16_t TAU> class EMAFilter {
+public:
+  void reset(tempValue Tc) {
+    TcSum = Tc*TAU;
+  }
+
+  tempValue update(tempValue Tc, uint16_t periods = 1) {
+    if (periods > 8*TAU)
+      periods = 8*TAU;
+    for (uint16_t i = 0; i < periods; i++)
+      TcSum += Tc - TcSum/TAU;
+    return(TcSum/TAU);
+  }
+
+private:
+  tempValue TcSum;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Hampel filter: outlier rejection using the median and median absolute deviation (MAD) of
+// the last N temperatures (N odd). A temperature further than K_TENTHS/10 standard
+// deviations (estimated as 1.48*MAD) from the median, and at least MIN_DEV_CENTI
+// hundredths of a degree from it, is an outlier and is replaced by the median. Other
+// temperatures pass through unchanged. MIN_DEV_CENTI keeps quantized ADC readings, whose
+// MAD is often 0, from being rejected. With K_TENTHS = 0, this is a sliding median filter
+// that always outputs the median. RAM is N tempValues, plus N more on the stack in update().
+// With fixed-point temperatures, a MAD over 100 degrees overflows when K_TENTHS is over 35.
+//
+// Spikes up to N/2 reads long are removed completely. A step is delayed by (N+1)/2 reads.
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<uint8_t N, uint8_t K_TENTHS = 30, uint16_t MIN_DEV_CENTI = 25> class HampelFilter {
+  static_assert(N % 2 == 1, "HampelFilter window size must be odd");
+public:
+  void reset(tempValue Tc) {
+    for (uint8_t i = 0; i < N; i++)
+      this->Tc[i] = Tc;
+    idxLatest = 0;
+  }
+
+  tempValue update(tempValue Tc, uint16_t /* periods */ = 1) {
+    if (++idxLatest >= N)
+      idxLatest = 0;
+    this->Tc[idxLatest] = Tc;
+
+    // Find the median.
+    tempValue T[N];
+    memcpy(T, this->Tc, sizeof(T));
+    sortTempValues<N>(T);
+    tempValue median = T[N/2];
+    if (K_TENTHS == 0)
+      return(median);
+
+    // Find the MAD and from it the outlier threshold.
+    for (uint8_t i = 0; i < N; i++)
+      T[i] = (this->Tc[i] > median) ? this->Tc[i] - median : median - this->Tc[i];
+    sortTempValues<N>(T);
+    tempValue threshold = scaleTempValue(T[N/2], K_TENTHS*148, 1000);
+    if (threshold < centiDegToTempValue(MIN_DEV_CENTI))
+      threshold = centiDegToTempValue(MIN_DEV_CENTI);
+
+    tempValue dev = (Tc > median) ? Tc - median : median - Tc;
+    return((dev > threshold) ? median : Tc);
+  }
+
+private:
+  tempValue Tc[N];
+  uint8_t idxLatest;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Sliding median filter of the last N temperatures (N odd).
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<uint8_t N> using MedianFilter = HampelFilter<N, 0, 0>;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Cascade of filter stages: each temperature goes through the stages in order, e.g.
+// FilterCascade<HampelFilter<5>, EMAFilter<8>> rejects outliers and then smooths.
+/////////////////////////////////////////////////////////////////////////////////////////////
+template<typename First, typename... Rest> class FilterCascade {
+public:
+  void reset(tempValue Tc) {
+    first.reset(Tc);
+    rest.reset(Tc);
+  }
+
+  tempValue update(tempValue Tc, uint16_t periods = 1) {
+    return(rest.update(first.update(Tc, periods), periods));
+  }
+
+private:
+  First first;
+  FilterCascade<Rest...> rest;
+};
+
+// The last stage of a cascade.
+template<typename Last> class FilterCascade<Last> : public Last {};
+
+#endif // temperatureFilter_h
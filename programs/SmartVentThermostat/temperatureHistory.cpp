@@ -0,0 +1,355 @@
+/*
+  temperatureHistory.cpp - Compressed in-memory history of SmartVent Thermostat temperatures
+  and SmartVent state.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "temperatureHistory.h"
+
+#if USE_TEMPERATURE_HISTORY
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Bytes of block header, before the bit-packed samples.
+#define HISTORY_HEADER_BYTES 13
+
+// A temperature changing by at least this many tenths of a °F over an interval is
+// predicted to change by the same amount over the next interval.
+#define HISTORY_TREND_TENTHS 2
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// A history block.
+struct historyBlock {
+  uint32_t firstIndex;    // Index of the first sample in the block.
+  int16_t indoor;         // First sample, uncompressed.
+  int16_t outdoor;
+  uint16_t numSamples;    // Number of samples in the block, 0 if unused.
+  uint16_t numBits;       // Number of bits used in bits[].
+  uint8_t state;          // Relay state and ArmState of the first sample.
+  uint8_t bits[HISTORY_BLOCK_BYTES - HISTORY_HEADER_BYTES];
+};
+
+static_assert(sizeof(historyBlock) == HISTORY_BLOCK_BYTES, "HISTORY_BLOCK_BYTES must be a multiple of 4");
+
+// *************************************************************************************** //
+// Local variables.
+// *************************************************************************************** //
+
+// History blocks, the block being added to, and the number of blocks used so far.
+static historyBlock blocks[HISTORY_BLOCKS];
+static uint8_t headBlock;
+static uint8_t numBlocksUsed;
+
+// Number of samples added since the history was cleared.
+static uint32_t numSamplesAdded;
+
+// Encoding state: the last sample added.
+static historyChannel lastIndoor, lastOutdoor;
+static uint8_t lastState;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the relay state and ArmState of S packed in 4 bits.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline uint8_t packState(const historySample& S) {
+  return((S.relayOn ? 8 : 0) | (S.armState & 7));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the predicted next value of temperature channel C.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline int32_t predict(const historyChannel& C) {
+  if (C.delta >= HISTORY_TREND_TENTHS || C.delta <= -HISTORY_TREND_TENTHS)
+    return(C.value + C.delta);
+  return(C.value);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the value of temperature channel C.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline void setChannel(historyChannel& C, int16_t value) {
+  C.delta = value - C.value;
+  C.value = value;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of bits needed to encode value in temperature channel C:
+//  0                   value equals the prediction
+//  10 s                prediction +1 (s=0) or -1 (s=1)
+//  110 xxxx            prediction + 4-bit signed difference
+//  1110 xxxxxxxx       prediction + 8-bit signed difference
+//  1111 x*16           16-bit value
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint8_t valueBits(const historyChannel& C, int16_t value) {
+  int32_t diff = value - predict(C);
+  if (diff == 0)
+    return(1);
+  if (diff == 1 || diff == -1)
+    return(3);
+  if (diff >= -8 && diff <= 7)
+    return(7);
+  if (diff >= -128 && diff <= 127)
+    return(12);
+  return(20);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Append the low n bits of value to block B.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void putBits(historyBlock& B, uint32_t value, uint8_t n) {
+  while (n-- > 0) {
+    uint8_t mask = 0x80 >> (B.numBits & 7);
+    if (value & (1UL << n))
+      B.bits[B.numBits >> 3] |= mask;
+    else
+      B.bits[B.numBits >> 3] &= ~mask;
+    B.numBits++;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the n bits of block B at bit position pos, and advance pos.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t getBits(const historyBlock& B, uint16_t& pos, uint8_t n) {
+  uint32_t value = 0;
+  while (n-- > 0) {
+    value = (value << 1) | ((B.bits[pos >> 3] >> (7 - (pos & 7))) & 1);
+    pos++;
+  }
+  return(value);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the n-bit two's complement value v sign-extended.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline int32_t signExtend(uint32_t v, uint8_t n) {
+  return((int32_t) (v << (32 - n)) >> (32 - n));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Append value of temperature channel C to block B (see valueBits()) and update C.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void putValue(historyBlock& B, historyChannel& C, int16_t value) {
+  int32_t diff = value - predict(C);
+  if (diff == 0)
+    putBits(B, 0, 1);
+  else if (diff == 1 || diff == -1)
+    putBits(B, diff < 0 ? 0x5 : 0x4, 3);
+  else if (diff >= -8 && diff <= 7)
+    putBits(B, (0x6 << 4) | (diff & 0xF), 7);
+  else if (diff >= -128 && diff <= 127)
+    putBits(B, (0xEUL << 8) | (diff & 0xFF), 12);
+  else
+    putBits(B, (0xFUL << 16) | (uint16_t) value, 20);
+  setChannel(C, value);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Decode the next value of temperature channel C from block B at bit position pos.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void getValue(const historyBlock& B, uint16_t& pos, historyChannel& C) {
+  int32_t value = predict(C);
+  if (getBits(B, pos, 1) != 0) {
+    if (getBits(B, pos, 1) == 0)
+      value += getBits(B, pos, 1) ? -1 : 1;
+    else if (getBits(B, pos, 1) == 0)
+      value += signExtend(getBits(B, pos, 4), 4);
+    else if (getBits(B, pos, 1) == 0)
+      value += signExtend(getBits(B, pos, 8), 8);
+    else
+      value = (int16_t) getBits(B, pos, 16);
+  }
+  setChannel(C, value);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the index of the oldest used block.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static inline uint8_t oldestBlock() {
+  return(numBlocksUsed < HISTORY_BLOCKS ? 0 : (headBlock + 1) % HISTORY_BLOCKS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Position iterator it at the start of the block holding sample it.nextIndex, or of the
+// oldest block if that sample has been overwritten.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void seekHistoryIterator(historyIterator& it) {
+  uint8_t block = oldestBlock();
+  if (it.nextIndex < blocks[block].firstIndex)
+    it.nextIndex = blocks[block].firstIndex;
+  for (uint8_t i = 1; i < numBlocksUsed; i++) {
+    uint8_t next = (block + 1) % HISTORY_BLOCKS;
+    if (it.nextIndex < blocks[next].firstIndex)
+      break;
+    block = next;
+  }
+  it.block = block;
+  it.blockFirstIndex = blocks[block].firstIndex;
+  it.numDecoded = 0;
+  it.bitPos = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Decode the next sample of the iterator's block into the iterator.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void decodeNext(historyIterator& it) {
+  const historyBlock& B = blocks[it.block];
+  if (it.numDecoded == 0) {
+    it.indoor.value = B.indoor;
+    it.indoor.delta = 0;
+    it.outdoor.value = B.outdoor;
+    it.outdoor.delta = 0;
+    it.state = B.state;
+  } else {
+    getValue(B, it.bitPos, it.indoor);
+    getValue(B, it.bitPos, it.outdoor);
+    if (getBits(B, it.bitPos, 1) != 0)
+      it.state = getBits(B, it.bitPos, 4);
+  }
+  it.numDecoded++;
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clear the history.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void clearHistory() {
+  headBlock = 0;
+  numBlocksUsed = 0;
+  numSamplesAdded = 0;
+  blocks[0].numSamples = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add a sample to the history. If it doesn't fit in the head block, start a new block with
+// it, reusing the oldest block if all are used.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void addHistorySample(historySample& S) {
+  S.index = numSamplesAdded++;
+  uint8_t state = packState(S);
+
+  if (numBlocksUsed > 0) {
+    historyBlock& B = blocks[headBlock];
+    uint16_t bits = valueBits(lastIndoor, S.indoorTenthsF) +
+      valueBits(lastOutdoor, S.outdoorTenthsF) + (state == lastState ? 1 : 5);
+    if (B.numBits + bits <= 8 * sizeof(B.bits)) {
+      putValue(B, lastIndoor, S.indoorTenthsF);
+      putValue(B, lastOutdoor, S.outdoorTenthsF);
+      if (state == lastState)
+        putBits(B, 0, 1);
+      else
+        putBits(B, 0x10 | state, 5);
+      lastState = state;
+      B.numSamples++;
+      return;
+    }
+    headBlock = (headBlock + 1) % HISTORY_BLOCKS;
+  }
+
+  if (numBlocksUsed < HISTORY_BLOCKS)
+    numBlocksUsed++;
+  historyBlock& B = blocks[headBlock];
+  B.firstIndex = S.index;
+  B.indoor = S.indoorTenthsF;
+  B.outdoor = S.outdoorTenthsF;
+  B.state = state;
+  B.numSamples = 1;
+  B.numBits = 0;
+  lastIndoor.value = S.indoorTenthsF;
+  lastIndoor.delta = 0;
+  lastOutdoor.value = S.outdoorTenthsF;
+  lastOutdoor.delta = 0;
+  lastState = state;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get history statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void getHistoryStats(historyStats& stats) {
+  stats.numSamples = 0;
+  stats.oldestIndex = numSamplesAdded;
+  stats.bytesUsed = 0;
+  if (numBlocksUsed == 0)
+    return;
+  stats.oldestIndex = blocks[oldestBlock()].firstIndex;
+  stats.numSamples = numSamplesAdded - stats.oldestIndex;
+  for (uint8_t i = 0; i < numBlocksUsed; i++)
+    stats.bytesUsed += HISTORY_HEADER_BYTES + (blocks[i].numBits + 7) / 8;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start an iterator.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void startHistoryIterator(historyIterator& it, uint32_t fromIndex) {
+  it.nextIndex = fromIndex;
+  it.block = 0;
+  it.blockFirstIndex = UINT32_MAX;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the next sample from an iterator.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool nextHistorySample(historyIterator& it, historySample& S) {
+  if (numBlocksUsed == 0 || it.nextIndex >= numSamplesAdded)
+    return(false);
+
+  // If the iterator's block has been reused or is finished, find the block holding the next
+  // sample. Then decode up to that sample.
+  if (blocks[it.block].firstIndex != it.blockFirstIndex ||
+      it.nextIndex >= it.blockFirstIndex + blocks[it.block].numSamples)
+    seekHistoryIterator(it);
+  while (it.blockFirstIndex + it.numDecoded <= it.nextIndex)
+    decodeNext(it);
+
+  S.index = it.nextIndex++;
+  S.indoorTenthsF = it.indoor.value;
+  S.outdoorTenthsF = it.outdoor.value;
+  S.relayOn = (it.state & 8) != 0;
+  S.armState = it.state & 7;
+  return(true);
+}
+
+#endif // USE_TEMPERATURE_HISTORY
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,136 @@
+/*
+  temperatureHistory.h - Compressed in-memory history of SmartVent Thermostat temperatures
+  and SmartVent state.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef temperatureHistory_h
+#define temperatureHistory_h
+
+#include <Arduino.h>
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to keep a history of the indoor and outdoor temperatures, SmartVent relay
+// state, and ArmState. Set this to 0 to remove all of it.
+#define USE_TEMPERATURE_HISTORY 1
+
+// Interval in ms between history samples.
+#define HISTORY_INTERVAL_MS (60*1000UL)
+
+// The history is stored in a ring of HISTORY_BLOCKS blocks of HISTORY_BLOCK_BYTES bytes
+// each (a multiple of 4). When all blocks are full, the oldest one is reused. Each block
+// holds its first sample uncompressed, followed by the rest bit-packed. A temperature sample
+// is stored as its difference from a prediction, which is the previous value plus, if the
+// temperature changed by at least 0.2°F over the previous interval, that same change again
+// (delta-of-delta), else just the previous value (delta). Steady temperatures take 1 bit,
+// changes of ±0.1°F from the prediction 3 bits, and an unchanged relay and ArmState 1 bit.
+// Typically a sample takes 5-8 bits, so 32 blocks of 128 bytes (4 KB) hold about 3 days
+// of 1-minute samples (4-5 days if temperatures are steady, 1.5 days if very noisy). Each
+// block added holds about 2 more hours if RAM allows.
+#define HISTORY_BLOCKS 32
+#define HISTORY_BLOCK_BYTES 128
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// One history sample.
+struct historySample {
+  uint32_t index;         // Sample number, 0 for the first sample after reset. The sample
+                          // was taken index*HISTORY_INTERVAL_MS after the first one.
+  int16_t indoorTenthsF;  // Indoor temperature in tenths of a °F.
+  int16_t outdoorTenthsF; // Outdoor temperature in tenths of a °F.
+  bool relayOn;           // SmartVent relay state.
+  uint8_t armState;       // ArmState (0-7).
+};
+
+// Decoding state of one temperature.
+struct historyChannel {
+  int16_t value;          // Last value.
+  int16_t delta;          // Last value minus the one before it.
+};
+
+// Iterator for reading history samples, oldest first. It stays valid while samples are
+// added, even across passes through loop(). If the samples it would return next have been
+// overwritten, it skips ahead to the oldest sample still in the history.
+struct historyIterator {
+  uint32_t nextIndex;     // Index of the next sample to return.
+  uint32_t blockFirstIndex; // Index of the first sample in the block being decoded.
+  uint8_t block;          // Block being decoded.
+  uint16_t numDecoded;    // Number of samples decoded from the block so far.
+  uint16_t bitPos;        // Position of the next bits to decode in the block.
+  historyChannel indoor, outdoor;
+  uint8_t state;          // Relay state and ArmState of the last sample decoded.
+};
+
+// History statistics.
+struct historyStats {
+  uint32_t numSamples;    // Number of samples in the history.
+  uint32_t oldestIndex;   // Index of the oldest sample in the history.
+  uint32_t bytesUsed;     // Bytes of the blocks used so far, excluding their unused ends.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+#if USE_TEMPERATURE_HISTORY
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clear the history.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void clearHistory();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add sample S to the history. Its index is set to the next sample number.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void addHistorySample(historySample& S);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get history statistics.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getHistoryStats(historyStats& stats);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start iterator it at the sample with index fromIndex, or at the oldest sample in the
+// history if that is later.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void startHistoryIterator(historyIterator& it, uint32_t fromIndex = 0);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the next sample from iterator it into S and return true, or return false if there
+// are no more samples.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool nextHistorySample(historyIterator& it, historySample& S);
+#endif
+
+#endif // temperatureHistory_h
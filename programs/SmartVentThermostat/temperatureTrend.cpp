@@ -0,0 +1,133 @@
+/*
+  temperatureTrend.cpp - Kalman estimates of the indoor and outdoor temperatures and their
+  rates of change.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <floatToString.h>
+#include "temperatureTrend.h"
+#include "deferredLog.h"
+
+#if USE_TEMPERATURE_TREND
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Variance of the noise of one read, °C².
+#define READ_VAR (TREND_READ_SD_C*TREND_READ_SD_C)
+
+// Spectral density of the random drift of the rate, (°C/second)² per second, which makes
+// the rate's variance grow by RATE_CHANGE² each hour.
+#define RATE_CHANGE (TREND_RATE_CHANGE_C_PER_HOUR/3600.0)
+#define RATE_DRIFT_Q (RATE_CHANGE*RATE_CHANGE/3600.0)
+
+// Variance of the rate at reset, (°C/second)².
+#define INITIAL_RATE_SD (TREND_INITIAL_RATE_SD_C_PER_HOUR/3600.0)
+#define INITIAL_RATE_VAR (INITIAL_RATE_SD*INITIAL_RATE_SD)
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+// Trend estimates of the indoor and outdoor temperatures.
+temperatureTrend IndoorTrend;
+temperatureTrend OutdoorTrend;
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Reset Trend to temperature Tc (°C) read at millis() time MS, with an unknown rate.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void resetTemperatureTrend(temperatureTrend& Trend, float Tc, uint32_t MS) {
+  Trend.Tc = Tc;
+  Trend.rate = 0;
+  Trend.P00 = READ_VAR;
+  Trend.P01 = 0;
+  Trend.P11 = INITIAL_RATE_VAR;
+  Trend.MSlastUpdate = MS;
+  Trend.numGated = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Update Trend with temperature Tc (°C) read at millis() time MS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void updateTemperatureTrend(temperatureTrend& Trend, float Tc, uint32_t MS) {
+  float dt = (MS - Trend.MSlastUpdate) * 0.001f;
+  Trend.MSlastUpdate = MS;
+
+  // Predict the state at time MS: the temperature moves at the estimated rate, and both
+  // grow more uncertain, the rate by its random drift over dt (integrated into the
+  // temperature too).
+  float q = (float) RATE_DRIFT_Q * dt;
+  Trend.Tc += Trend.rate*dt;
+  Trend.P00 += dt*(2*Trend.P01 + dt*Trend.P11) + q*dt*dt*(1.0f/3.0f);
+  Trend.P01 += dt*Trend.P11 + q*dt*0.5f;
+  Trend.P11 += q;
+
+  // Ignore a read too far from the predicted temperature, but not too many in a row.
+  float innovation = Tc - Trend.Tc;
+  float S = Trend.P00 + (float) READ_VAR;
+  if (innovation*innovation > (TREND_GATE_SD*TREND_GATE_SD)*S &&
+      Trend.numGated < TREND_MAX_GATED) {
+    Trend.numGated++;
+    return;
+  }
+  Trend.numGated = 0;
+
+  // Correct the prediction towards the read by the Kalman gains, and shrink the covariance.
+  float K0 = Trend.P00/S;
+  float K1 = Trend.P01/S;
+  Trend.Tc += K0*innovation;
+  Trend.rate += K1*innovation;
+  Trend.P11 -= K1*Trend.P01;
+  Trend.P01 -= K0*Trend.P01;
+  Trend.P00 -= K0*Trend.P00;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write the estimated temperature and rate of Trend to the serial monitor, with a prefix
+// description string.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void showTemperatureTrend(const temperatureTrend& Trend, const char* Desc) {
+  char TfS[9], rateS[9];
+  floatToString(getTrendTf(Trend), TfS, sizeof(TfS), 1);
+  floatToString(getTrendTfPerHour(Trend), rateS, sizeof(rateS), 1);
+  logPrintf("%s Trend: %s°F  %s°F/hour\n", Desc, TfS, rateS);
+}
+
+#endif // USE_TEMPERATURE_TREND
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
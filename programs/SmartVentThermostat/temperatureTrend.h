@@ -0,0 +1,136 @@
+/*
+  temperatureTrend.h - Kalman estimates of the indoor and outdoor temperatures and their
+  rates of change.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef temperatureTrend_h
+#define temperatureTrend_h
+
+#include <Arduino.h>
+
+/*
+  Alongside the temperature filters, each temperature read from a thermistor (before
+  filtering) is given to a two-state Kalman estimator whose state is the temperature and
+  its rate of change. The model is that the temperature changes at the estimated rate and
+  the rate itself drifts randomly, by about TREND_RATE_CHANGE_C_PER_HOUR over an hour.
+  Because the estimator knows the rate, its temperature estimate follows a steady rise or
+  fall without the lag of an average, while the noise of the reads is still smoothed out.
+  The time between reads is measured, so it need not be constant. A read far from the
+  estimate (an ADC spike) is ignored, unless TREND_MAX_GATED reads in a row are.
+
+  The arithmetic is in float. It is only done once per read per thermistor.
+*/
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Set this to 1 to estimate the temperature trends. Set this to 0 to remove all of it.
+#define USE_TEMPERATURE_TREND 1
+
+// Standard deviation of the noise of one temperature read, °C.
+#define TREND_READ_SD_C 0.07
+
+// Typical change of the rate of change of temperature over an hour, °C/hour. Larger values
+// follow changes of rate more quickly but smooth less.
+#define TREND_RATE_CHANGE_C_PER_HOUR 4.0
+
+// Standard deviation of the rate assumed at reset, °C/hour.
+#define TREND_INITIAL_RATE_SD_C_PER_HOUR 10.0
+
+// A read more than this many standard deviations from the estimate is ignored, unless the
+// previous TREND_MAX_GATED reads were ignored.
+#define TREND_GATE_SD 5
+#define TREND_MAX_GATED 3
+
+// Set this to 1 to have updateSmartVentOnOff() use the trend temperature estimates instead
+// of the filtered temperatures (curIndoorTemperature and curOutdoorTemperature), and 0 to
+// use the filtered temperatures.
+#define USE_TREND_FOR_CONTROL 1
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// State of the Kalman estimator of one temperature.
+struct temperatureTrend {
+  float Tc;               // Estimated temperature, °C.
+  float rate;             // Estimated rate of change, °C/second.
+  float P00, P01, P11;    // Covariance of the estimate errors of Tc and rate.
+  uint32_t MSlastUpdate;  // millis() time of the last update.
+  uint8_t numGated;       // Number of reads in a row that were ignored.
+};
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+#if USE_TEMPERATURE_TREND
+// Trend estimates of the indoor and outdoor temperatures.
+extern temperatureTrend IndoorTrend;
+extern temperatureTrend OutdoorTrend;
+#endif
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Reset Trend to temperature Tc (°C) read at millis() time MS, with an unknown rate.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void resetTemperatureTrend(temperatureTrend& Trend, float Tc, uint32_t MS);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Update Trend with temperature Tc (°C) read at millis() time MS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void updateTemperatureTrend(temperatureTrend& Trend, float Tc, uint32_t MS);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the estimated temperature of Trend in °F.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline float getTrendTf(const temperatureTrend& Trend) {
+  return(Trend.Tc*9.0f/5.0f + 32.0f);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the estimated rate of change of temperature of Trend in °F/hour.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline float getTrendTfPerHour(const temperatureTrend& Trend) {
+  return(Trend.rate*(3600.0f*9.0f/5.0f));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write the estimated temperature and rate of Trend to the serial monitor, with a prefix
+// description string.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void showTemperatureTrend(const temperatureTrend& Trend, const char* Desc);
+
+#endif // temperatureTrend_h
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+#
+# decodeTelemetry.py - Decode SmartVent Thermostat binary telemetry into CSV files.
+# Released into the public domain.
+#
+# Reads the telemetry stream sent when USE_TELEMETRY is 1 in telemetry.h, from a file, from
+# standard input, or from a serial port (requires pyserial), and writes one CSV file per
+# record type into an output directory. Frames that fail their CRC, and any text output
+# mixed into the stream, are counted and skipped. Gaps in the sequence numbers, which are
+# records dropped by the thermostat or lost in transit, are counted.
+#
+# Usage:
+#   decodeTelemetry.py [-o OUTDIR] FILE          Decode a captured stream.
+#   decodeTelemetry.py [-o OUTDIR] -             Decode standard input.
+#   decodeTelemetry.py [-o OUTDIR] -p /dev/ttyACM0  Decode live from a serial port.
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+HEADER = struct.Struct('<BBI')  # type, sequence, millis()
+
+# Record types, as eTelemetryRecord in telemetry.h: name, body layout, CSV columns.
+RECORDS = {
+    1: ('temperatures', struct.Struct('<hhHHHH'),
+        ['indoorC', 'outdoorC', 'indoorADC', 'outdoorADC', 'indoorR', 'outdoorR']),
+    2: ('relay', struct.Struct('<B'), ['on']),
+    3: ('armState', struct.Struct('<B'), ['armState']),
+    4: ('statistics', struct.Struct('<9I'),
+        ['relayOnSecs', 'relayCycles', 'aboveSetpointSecs'] +
+        ['armState%dSecs' % i for i in range(6)]),
+    5: ('loopPhase', struct.Struct('<B5I'),
+        ['phase', 'count', 'minUS', 'meanUS', 'maxUS', 'p99US']),
+}
+
+# Columns holding hundredths of a degree, written as degrees.
+CENTI_COLUMNS = {'indoorC', 'outdoorC'}
+
+LOOP_PHASES = ['touch', 'timers', 'temps', 'onoff', 'screen', 'loop']
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as crc16() in crc16.cpp."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decode_cobs(data):
+    """Return the COBS-decoded data, or None if it is not valid COBS."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    """Split a byte stream into frames and decode them into CSV rows."""
+
+    def __init__(self, outdir):
+        self.outdir = outdir
+        self.writers = {}
+        self.files = []
+        self.buf = bytearray()
+        self.records = 0
+        self.bad_frames = 0
+        self.missing = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            end = self.buf.find(b'\0')
+            if end < 0:
+                return
+            frame = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if frame:
+                self.frame(frame)
+
+    def frame(self, frame):
+        rec = decode_cobs(frame)
+        if rec is None or len(rec) < HEADER.size + 2 or \
+                crc16(rec[:-2]) != struct.unpack('<H', rec[-2:])[0]:
+            self.bad_frames += 1
+            return
+        rec_type, seq, ms = HEADER.unpack_from(rec)
+        body = rec[HEADER.size:-2]
+        if rec_type not in RECORDS or len(body) != RECORDS[rec_type][1].size:
+            self.bad_frames += 1
+            return
+        if self.last_seq is not None:
+            self.missing += (seq - self.last_seq - 1) & 0xFF
+        self.last_seq = seq
+        self.records += 1
+
+        name, layout, columns = RECORDS[rec_type]
+        values = list(layout.unpack(body))
+        for i, col in enumerate(columns):
+            if col in CENTI_COLUMNS:
+                values[i] = '%.2f' % (values[i] / 100)
+        if name == 'loopPhase' and values[0] < len(LOOP_PHASES):
+            values[0] = LOOP_PHASES[values[0]]
+        self.writer(name, columns).writerow([ms, seq] + values)
+
+    def writer(self, name, columns):
+        if name not in self.writers:
+            f = open(os.path.join(self.outdir, name + '.csv'), 'w', newline='')
+            self.files.append(f)
+            self.writers[name] = csv.writer(f)
+            self.writers[name].writerow(['ms', 'seq'] + columns)
+        return self.writers[name]
+
+    def close(self):
+        for f in self.files:
+            f.close()
+        print('%d records, %d bad frames or text lines, %d records missing' %
+              (self.records, self.bad_frames, self.missing), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode SmartVent Thermostat binary telemetry into CSV files.')
+    parser.add_argument('input', nargs='?', default='-',
+                        help='captured telemetry file, or - for standard input')
+    parser.add_argument('-p', '--port', help='serial port to read live telemetry from')
+    parser.add_argument('-o', '--outdir', default='.', help='directory for the CSV files')
+    args = parser.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    decoder = Decoder(args.outdir)
+    try:
+        if args.port:
+            import serial
+            with serial.Serial(args.port, 115200, timeout=1) as port:
+                while True:
+                    decoder.feed(port.read(256))
+                    for f in decoder.files:
+                        f.flush()
+        else:
+            stream = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb')
+            with stream:
+                while True:
+                    data = stream.read(65536)
+                    if not data:
+                        break
+                    decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+    decoder.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,202 @@
+/*
+  controlSim.cpp - Run the SmartVent Thermostat control and temperature modules on the
+  simulated hardware of hostSim.h, the way SmartVentThermostat.ino does.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <calibSAMD_ADC_withPWM.h>
+#include "pinSettings.h"
+#include "nonvolatileSettings.h"
+#include "temperature.h"
+#include "smartVentControl.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "deferredLog.h"
+#include "temperatureHistory.h"
+#include "controlSim.h"
+
+// *************************************************************************************** //
+// Variables.
+// *************************************************************************************** //
+
+// Scheduler timer that starts each temperature read, as in SmartVentThermostat.ino.
+static timerID temperatureReadTimer = NO_TIMER;
+
+// The delay in ms with which temperatureReadTimer was last started.
+static uint32_t temperatureReadDelayMS;
+
+// Number of reads started by temperatureReadTimer.
+static uint32_t readsStarted;
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Start temperatureReadTimer to expire in delayMS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startTemperatureReadTimer(uint32_t delayMS) {
+  temperatureReadDelayMS = delayMS;
+  startTimer(temperatureReadTimer, delayMS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Temperature read timer callback. Count the read and start it.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void startTemperatureRead(void) {
+  readsStarted++;
+  startReadCurrentTemperatures();
+}
+
+#if USE_TEMPERATURE_HISTORY
+/////////////////////////////////////////////////////////////////////////////////////////////
+// History timer callback, as recordHistory() in SmartVentThermostat.ino.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void recordHistory(void) {
+  historySample S;
+  S.indoorTenthsF = lroundf((curIndoorTemperature.Tf + activeSettings.IndoorOffsetF) * 10);
+  S.outdoorTenthsF = lroundf((curOutdoorTemperature.Tf + activeSettings.OutdoorOffsetF) * 10);
+  S.relayOn = getSmartVent();
+  S.armState = ArmState;
+  addHistorySample(S);
+}
+#endif
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the ADC reading of Thermistor at Celsius temperature Tc, without rounding.
+/////////////////////////////////////////////////////////////////////////////////////////////
+float thermistorADC(const thermistor& Thermistor, float Tc) {
+  // Solve 1/T = A + B*x + C*x^3 for x = ln(R) with Cardano's formula. As B/C > 0, the cubic
+  // has one real root.
+  double p = (double)Thermistor.B / Thermistor.C;
+  double q = ((double)Thermistor.A - 1.0/(Tc + 273.15)) / Thermistor.C;
+  double s = sqrt(q*q/4 + p*p*p/27);
+  double R = exp(cbrt(-q/2 + s) + cbrt(-q/2 - s));
+  // temperature.cpp computes R = seriesResistor * (ADC_MAX/Vo - 1).
+  return((float)(ADC_MAX * Thermistor.seriesResistor / (R + Thermistor.seriesResistor)));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the simulated ADC input of Thermistors[sensor] for Celsius temperature Tc.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void setSensorTemperatureC(uint8_t sensor, float Tc) {
+  const thermistor& T = Thermistors[sensor];
+  hostSetADCinput(g_APinDescription[T.inputPin].ulADCChannelNumber,
+    (uint16_t) lroundf(thermistorADC(T, Tc)));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set all indoor thermistors to indoorC and the outdoor one to outdoorC.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void setTemperaturesC(float indoorC, float outdoorC) {
+  for (uint8_t i = 0; i < NUM_INDOOR_SENSORS; i++)
+    setSensorTemperatureC(i, indoorC);
+  setSensorTemperatureC(OUTDOOR_SENSOR, outdoorC);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize as setup() in SmartVentThermostat.ino does, without the screens.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void setupControlSim(const nonvolatileSettings& settings, const controlSimOptions& options) {
+  monitor.begin(options.monitor ? &hostMonitorPort : NULL);
+  #if USE_DEFERRED_LOG
+  initDeferredLog(options.monitor);
+  #endif
+  #if USE_TELEMETRY
+  if (options.monitor)
+    initTelemetry(&hostMonitorPort);
+  #endif
+
+  initPins();
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+
+  temperatureReadTimer = addTimer(startTemperatureRead);
+  startTemperatureReadTimer(TEMPERATURE_READ_TIME_MS);
+  #if USE_TEMPERATURE_HISTORY
+  if (options.history)
+    startTimer(addTimer(recordHistory, HISTORY_INTERVAL_MS), HISTORY_INTERVAL_MS);
+  #endif
+  initSmartVentControl();
+
+  activeSettings = userSettings = settings;
+  updateArmState();
+  #if USE_DEFERRED_LOG
+  flushDeferredLog();
+  #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Make settings the active settings, as activateUserSettings() in SmartVentThermostat.ino,
+// moving the next read up as hurryTemperatureRead() does if they changed.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void activateSettingsControlSim(const nonvolatileSettings& settings) {
+  bool changed = memcmp(&activeSettings, &settings, sizeof(nonvolatileSettings)) != 0;
+  activeSettings = userSettings = settings;
+  updateArmState();
+  if (changed && temperatureReadDelayMS > TEMPERATURE_READ_TIME_MS &&
+      isTimerRunning(temperatureReadTimer))
+    startTemperatureReadTimer(TEMPERATURE_READ_TIME_MS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Do one pass of loop() and advance the clock to the next one. The screen is taken to be
+// dark, so the read interval is always getTemperatureReadIntervalMS().
+/////////////////////////////////////////////////////////////////////////////////////////////
+void loopControlSim(void) {
+  runDueTimers();
+  if (serviceReadCurrentTemperatures())
+    startTemperatureReadTimer(getTemperatureReadIntervalMS());
+  updateSmartVentOnOff();
+  #if USE_DEFERRED_LOG
+  serviceDeferredLog();
+  #endif
+
+  if (isReadCurrentTemperaturesBusy())
+    hostAdvanceUS(CONTROL_SIM_LOOP_US);
+  else
+    hostAdvanceUS((uint64_t) min(msUntilNextTimer(), (uint32_t) CONTROL_SIM_MAX_IDLE_MS) * 1000);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of temperature reads started by the read timer.
+/////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t controlSimReads(void) {
+  return(readsStarted);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
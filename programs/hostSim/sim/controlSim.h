@@ -0,0 +1,119 @@
+/*
+  controlSim.h - Run the SmartVent Thermostat control and temperature modules on the
+  simulated hardware of hostSim.h, the way SmartVentThermostat.ino does.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef controlSim_h
+#define controlSim_h
+
+#include <Arduino.h>
+#include "nonvolatileSettings.h"
+#include "temperature.h"
+#include "smartVentControl.h"
+#include "hostSim.h"
+
+// *************************************************************************************** //
+// Constants.
+// *************************************************************************************** //
+
+// Simulated time in us taken by one pass through loop() while a temperature read is in
+// progress. When no read is in progress, loop() sleeps until the next timer, as with
+// USE_IDLE_SLEEP.
+#define CONTROL_SIM_LOOP_US 200
+
+// Longest time in ms loopControlSim() advances the clock while idle, so that the caller can
+// update the temperatures at least this often.
+#define CONTROL_SIM_MAX_IDLE_MS 1000
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Options for setupControlSim().
+struct controlSimOptions {
+  bool monitor = false;     // True to have the serial monitor output go to hostMonitorPort.
+  bool history = true;      // True to record the temperature history, as setup() does.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the simulated ADC input of thermistor Thermistors[sensor] to the value it reads at
+// Celsius temperature Tc, by inverting the Steinhart-Hart equation that temperature.cpp
+// uses. Noise set by hostSetADCnoise() is added to each conversion.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void setSensorTemperatureC(uint8_t sensor, float Tc);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set all indoor thermistors to indoorC and the outdoor one to outdoorC.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void setTemperaturesC(float indoorC, float outdoorC);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the ADC reading of Thermistor at Celsius temperature Tc, without rounding.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern float thermistorADC(const thermistor& Thermistor, float Tc);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Initialize the firmware modules as setup() in SmartVentThermostat.ino does, except for the
+// screens, and make settings the active settings. Set the temperatures first, as they are
+// read here. This can be called only once per process, as the scheduler timers it adds are
+// never removed.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void setupControlSim(const nonvolatileSettings& settings,
+  const controlSimOptions& options = controlSimOptions());
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Make settings the active settings, as the settings activation timer does after the user
+// changes them.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void activateSettingsControlSim(const nonvolatileSettings& settings);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Do one pass of loop() in SmartVentThermostat.ino, except for the screens and touches, and
+// then advance the clock until the next pass: by CONTROL_SIM_LOOP_US while a temperature
+// read is in progress, else to the next timer, but by at most CONTROL_SIM_MAX_IDLE_MS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void loopControlSim(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the simulated time in ms.
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline uint64_t controlSimMS(void) { return(hostNowUS() / 1000); }
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of temperature reads started by the read timer since setup.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t controlSimReads(void);
+
+#endif // controlSim_h
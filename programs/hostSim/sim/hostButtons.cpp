@@ -0,0 +1,291 @@
+/*
+  hostButtons.cpp - Host stand-in for the Button_TT library's buttons, and functions for
+  tests to find them.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <Font_TT.h>
+#include <Button_TT.h>
+#include <Button_TT_label.h>
+#include <Button_TT_arrow.h>
+#include <Button_TT_collection.h>
+#include <string.h>
+#include "hostButtons.h"
+
+// *************************************************************************************** //
+// Font_TT.
+// *************************************************************************************** //
+
+void Font_TT::getTextBounds(const char* str, int16_t x, int16_t y, int16_t* x1,
+    int16_t* y1, uint16_t* w, uint16_t* h, int16_t* xf, int16_t* yf) const {
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -0x7FFF, maxy = -0x7FFF;
+  for (; *str != 0; str++) {
+    uint8_t c = *str;
+    if (c < Font->first || c > Font->last)
+      continue;
+    const GFXglyph& G = Font->glyph[c - Font->first];
+    if (G.width > 0 && G.height > 0) {
+      minx = min(minx, (int16_t) (x + G.xOffset));
+      miny = min(miny, (int16_t) (y + G.yOffset));
+      maxx = max(maxx, (int16_t) (x + G.xOffset + G.width - 1));
+      maxy = max(maxy, (int16_t) (y + G.yOffset + G.height - 1));
+    }
+    x += G.xAdvance;
+  }
+  if (maxx < minx) {
+    *x1 = x;
+    *y1 = y;
+    *w = *h = 0;
+  } else {
+    *x1 = minx;
+    *y1 = miny;
+    *w = maxx - minx + 1;
+    *h = maxy - miny + 1;
+  }
+  if (xf != NULL) *xf = x;
+  if (yf != NULL) *yf = y;
+}
+
+// *************************************************************************************** //
+// Button_TT.
+// *************************************************************************************** //
+
+Button_TT* Button_TT::First = NULL;
+
+Button_TT::Button_TT(const char* name) : Name(name) {
+  Next = First;
+  First = this;
+}
+
+void Button_TT::initButton(Adafruit_GFX* gfx, const char* align, int16_t x, int16_t y,
+    int16_t w, int16_t h, uint16_t outlineColor, uint16_t fillColor, uint8_t rCorner,
+    uint8_t expU, uint8_t expD, uint8_t expL, uint8_t expR) {
+  this->gfx = gfx;
+  this->w = w;
+  this->h = h;
+  OutlineColor = outlineColor;
+  FillColor = fillColor;
+  this->rCorner = rCorner;
+  this->expU = expU;
+  this->expD = expD;
+  this->expL = expL;
+  this->expR = expR;
+  this->align(align, x, y);
+}
+
+void Button_TT::align(const char* align, int16_t x, int16_t y) {
+  char V = align[0], H = (align[0] != 0 && align[1] != 0) ? align[1] : align[0];
+  xL = (H == 'L') ? x : (H == 'R') ? x - w : x - w/2;
+  yT = (V == 'T') ? y : (V == 'B') ? y - h : y - h/2;
+}
+
+void Button_TT::drawButton(void) {
+  if (FillColor != TRANSPARENT_COLOR) {
+    if (rCorner > 0)
+      gfx->fillRoundRect(xL, yT, w, h, rCorner, FillColor);
+    else
+      gfx->fillRect(xL, yT, w, h, FillColor);
+  }
+  if (OutlineColor != TRANSPARENT_COLOR) {
+    if (rCorner > 0)
+      gfx->drawRoundRect(xL, yT, w, h, rCorner, OutlineColor);
+    else
+      gfx->drawRect(xL, yT, w, h, OutlineColor);
+  }
+}
+
+bool Button_TT::contains(int16_t x, int16_t y) const {
+  return(x >= xL - expL && x < xL + w + expR && y >= yT - expU && y < yT + h + expD);
+}
+
+Button_TT* hostFindButton(const char* name) {
+  for (Button_TT* B = Button_TT::First; B != NULL; B = B->Next)
+    if (strcmp(B->Name, name) == 0)
+      return(B);
+  return(NULL);
+}
+
+bool hostButtonCenter(const char* name, int16_t& x, int16_t& y) {
+  Button_TT* B = hostFindButton(name);
+  if (B == NULL)
+    return(false);
+  x = B->getLeft() + B->getWidth()/2;
+  y = B->getTop() + B->getHeight()/2;
+  return(true);
+}
+
+// *************************************************************************************** //
+// Button_TT_label.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the height of the digits of font, and the radius of its degree sign.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int16_t digitHeight(const Font_TT* font) {
+  int16_t x1, y1;
+  uint16_t w, h;
+  font->getTextBounds("0", 0, 0, &x1, &y1, &w, &h);
+  return(h);
+}
+static int16_t degreeRadius(const Font_TT* font) {
+  return(max(1, digitHeight(font) / 8));
+}
+
+void Button_TT_label::initButton(Adafruit_GFX* gfx, const char* align, int16_t x,
+    int16_t y, int16_t w, int16_t h, uint16_t outlineColor, uint16_t fillColor,
+    uint16_t textColor, const char* textAlign, const char* label, bool degreeChar,
+    Font_TT* font, uint8_t rCorner, uint8_t expU, uint8_t expD, uint8_t expL,
+    uint8_t expR) {
+  Font = font;
+  DegreeChar = degreeChar;
+  TextColor = textColor;
+  TextAlignV = textAlign[0];
+  TextAlignH = textAlign[1] != 0 ? textAlign[1] : textAlign[0];
+  Label = label;
+  if (w <= 0)
+    w = labelWidth(label) - 2*w;
+  if (h <= 0)
+    h = digitHeight(font) - 2*h;
+  Button_TT::initButton(gfx, align, x, y, w, h, outlineColor, fillColor, rCorner, expU,
+    expD, expL, expR);
+}
+
+int16_t Button_TT_label::labelWidth(const char* label) const {
+  int16_t x1, y1;
+  uint16_t w, h;
+  Font->getTextBounds(label, 0, 0, &x1, &y1, &w, &h);
+  if (DegreeChar)
+    w += 2*degreeRadius(Font) + 3;
+  return(w);
+}
+
+void Button_TT_label::drawButton(void) {
+  Button_TT::drawButton();
+
+  // Place the label's pixels within the button as aligned, with a pixel of margin.
+  int16_t x1, y1;
+  uint16_t tw, th;
+  Font->getTextBounds(Label.c_str(), 0, 0, &x1, &y1, &tw, &th);
+  int16_t r = degreeRadius(Font), W = labelWidth(Label.c_str());
+  int16_t px = (TextAlignH == 'L') ? xL + 1 : (TextAlignH == 'R') ? xL + w - W - 1 :
+    xL + (w - W)/2;
+  int16_t py = (TextAlignV == 'T') ? yT + 1 : (TextAlignV == 'B') ? yT + h - th - 1 :
+    yT + (h - th)/2;
+  gfx->setFont(Font->getFont());
+  gfx->setTextSize(1);
+  gfx->setTextColor(TextColor);
+  gfx->setCursor(px - x1, py - y1);
+  gfx->print(Label.c_str());
+  if (DegreeChar)
+    gfx->drawCircle(px + tw + 1 + r, py + r, r, TextColor);
+}
+
+bool Button_TT_label::setLabelAndDrawIfChanged(const char* label, bool forceDraw) {
+  if (Label == label && !forceDraw)
+    return(false);
+  Label = label;
+  drawButton();
+  return(true);
+}
+
+// *************************************************************************************** //
+// Button_TT_arrow.
+// *************************************************************************************** //
+
+void Button_TT_arrow::initButton(Adafruit_GFX* gfx, char orient, const char* align,
+    int16_t x, int16_t y, int16_t w, int16_t h, uint16_t outlineColor, uint16_t fillColor,
+    uint8_t expU, uint8_t expD, uint8_t expL, uint8_t expR) {
+  Orient = orient;
+  Button_TT::initButton(gfx, align, x, y, w, h, outlineColor, fillColor, 0, expU, expD,
+    expL, expR);
+}
+
+void Button_TT_arrow::drawButton(void) {
+  Button_TT::drawButton();
+  // The triangle fills the button less a fifth of its size on each side.
+  int16_t x0 = xL + w/5, x1 = xL + w - 1 - w/5, xc = xL + w/2;
+  int16_t y0 = yT + h/5, y1 = yT + h - 1 - h/5, yc = yT + h/2;
+  switch (Orient) {
+  case 'L': gfx->fillTriangle(x1, y0, x1, y1, x0, yc, OutlineColor); break;
+  case 'U': gfx->fillTriangle(x0, y1, x1, y1, xc, y0, OutlineColor); break;
+  case 'D': gfx->fillTriangle(x0, y0, x1, y0, xc, y1, OutlineColor); break;
+  default: gfx->fillTriangle(x0, y0, x0, y1, x1, yc, OutlineColor); break;
+  }
+}
+
+// *************************************************************************************** //
+// Button_TT_collection.
+// *************************************************************************************** //
+
+bool Button_TT_collection::registerButton(Button_TT& btn, void (*func)(Button_TT& btn)) {
+  if (NumButtons == BUTTON_TT_COLLECTION_SIZE)
+    return(false);
+  Buttons[NumButtons++] = entry{ &btn, func };
+  return(true);
+}
+
+bool Button_TT_collection::unregisterButton(Button_TT& btn) {
+  for (uint8_t i = 0; i < NumButtons; i++) {
+    if (Buttons[i].btn == &btn) {
+      memmove(&Buttons[i], &Buttons[i+1], (NumButtons - i - 1) * sizeof(entry));
+      NumButtons--;
+      return(true);
+    }
+  }
+  return(false);
+}
+
+bool Button_TT_collection::press(int16_t x, int16_t y) {
+  for (uint8_t i = 0; i < NumButtons; i++) {
+    if (Buttons[i].btn->contains(x, y)) {
+      Pressed = true;
+      if (MasterFunc != NULL)
+        MasterFunc(true);
+      if (Buttons[i].func != NULL)
+        Buttons[i].func(*Buttons[i].btn);
+      return(true);
+    }
+  }
+  return(false);
+}
+
+bool Button_TT_collection::release(void) {
+  if (!Pressed)
+    return(false);
+  Pressed = false;
+  if (MasterFunc != NULL)
+    MasterFunc(false);
+  return(true);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,625 @@
+/*
+  hostGFX.cpp - Drawing functions of the host stand-in for the Adafruit GFX library, and
+  the stand-in fonts.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Fonts/hostFont.h>
+
+// *************************************************************************************** //
+// 5x7 dot matrix characters.
+// *************************************************************************************** //
+
+// Width and height of the dot matrix.
+#define DOTS_W 5
+#define DOTS_H 7
+
+// A character's dots, rows top to bottom, '#' for set.
+struct dotChar {
+  char c;
+  const char* dots;
+};
+
+// The characters the screens show. Lower case letters use the upper case ones, and other
+// characters are drawn as a box.
+static const dotChar dotChars[] = {
+  { ' ', "....." "....." "....." "....." "....." "....." "....." },
+  { '0', ".###." "#...#" "#..##" "#.#.#" "##..#" "#...#" ".###." },
+  { '1', "..#.." ".##.." "..#.." "..#.." "..#.." "..#.." ".###." },
+  { '2', ".###." "#...#" "....#" "...#." "..#.." ".#..." "#####" },
+  { '3', "#####" "...#." "..#.." "...#." "....#" "#...#" ".###." },
+  { '4', "...#." "..##." ".#.#." "#..#." "#####" "...#." "...#." },
+  { '5', "#####" "#...." "####." "....#" "....#" "#...#" ".###." },
+  { '6', "..##." ".#..." "#...." "####." "#...#" "#...#" ".###." },
+  { '7', "#####" "....#" "...#." "..#.." ".#..." ".#..." ".#..." },
+  { '8', ".###." "#...#" "#...#" ".###." "#...#" "#...#" ".###." },
+  { '9', ".###." "#...#" "#...#" ".####" "....#" "...#." ".##.." },
+  { '-', "....." "....." "....." "#####" "....." "....." "....." },
+  { ':', "....." ".##.." ".##.." "....." ".##.." ".##.." "....." },
+  { '.', "....." "....." "....." "....." "....." ".##.." ".##.." },
+  { ',', "....." "....." "....." "....." ".##.." "..#.." ".#..." },
+  { '+', "....." "..#.." "..#.." "#####" "..#.." "..#.." "....." },
+  { '=', "....." "....." "#####" "....." "#####" "....." "....." },
+  { '/', "....." "....#" "...#." "..#.." ".#..." "#...." "....." },
+  { '%', "##..." "##..#" "...#." "..#.." ".#..." "#..##" "...##" },
+  { '(', "...#." "..#.." ".#..." ".#..." ".#..." "..#.." "...#." },
+  { ')', ".#..." "..#.." "...#." "...#." "...#." "..#.." ".#..." },
+  { '!', "..#.." "..#.." "..#.." "..#.." "..#.." "....." "..#.." },
+  { '?', ".###." "#...#" "....#" "...#." "..#.." "....." "..#.." },
+  { 'A', ".###." "#...#" "#...#" "#####" "#...#" "#...#" "#...#" },
+  { 'B', "####." "#...#" "#...#" "####." "#...#" "#...#" "####." },
+  { 'C', ".###." "#...#" "#...." "#...." "#...." "#...#" ".###." },
+  { 'D', "###.." "#..#." "#...#" "#...#" "#...#" "#..#." "###.." },
+  { 'E', "#####" "#...." "#...." "####." "#...." "#...." "#####" },
+  { 'F', "#####" "#...." "#...." "####." "#...." "#...." "#...." },
+  { 'G', ".###." "#...#" "#...." "#.###" "#...#" "#...#" ".####" },
+  { 'H', "#...#" "#...#" "#...#" "#####" "#...#" "#...#" "#...#" },
+  { 'I', ".###." "..#.." "..#.." "..#.." "..#.." "..#.." ".###." },
+  { 'J', "..###" "...#." "...#." "...#." "...#." "#..#." ".##.." },
+  { 'K', "#...#" "#..#." "#.#.." "##..." "#.#.." "#..#." "#...#" },
+  { 'L', "#...." "#...." "#...." "#...." "#...." "#...." "#####" },
+  { 'M', "#...#" "##.##" "#.#.#" "#.#.#" "#...#" "#...#" "#...#" },
+  { 'N', "#...#" "#...#" "##..#" "#.#.#" "#..##" "#...#" "#...#" },
+  { 'O', ".###." "#...#" "#...#" "#...#" "#...#" "#...#" ".###." },
+  { 'P', "####." "#...#" "#...#" "####." "#...." "#...." "#...." },
+  { 'Q', ".###." "#...#" "#...#" "#...#" "#.#.#" "#..#." ".##.#" },
+  { 'R', "####." "#...#" "#...#" "####." "#.#.." "#..#." "#...#" },
+  { 'S', ".####" "#...." "#...." ".###." "....#" "....#" "####." },
+  { 'T', "#####" "..#.." "..#.." "..#.." "..#.." "..#.." "..#.." },
+  { 'U', "#...#" "#...#" "#...#" "#...#" "#...#" "#...#" ".###." },
+  { 'V', "#...#" "#...#" "#...#" "#...#" "#...#" ".#.#." "..#.." },
+  { 'W', "#...#" "#...#" "#...#" "#.#.#" "#.#.#" "#.#.#" ".#.#." },
+  { 'X', "#...#" "#...#" ".#.#." "..#.." ".#.#." "#...#" "#...#" },
+  { 'Y', "#...#" "#...#" "#...#" ".#.#." "..#.." "..#.." "..#.." },
+  { 'Z', "#####" "....#" "...#." "..#.." ".#..." "#...." "#####" },
+};
+
+// Dots of characters not in dotChars.
+static const char* boxDots = "#####" "#...#" "#...#" "#...#" "#...#" "#...#" "#####";
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the dots of character c.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static const char* charDots(unsigned char c) {
+  if (c >= 'a' && c <= 'z')
+    c -= 'a' - 'A';
+  for (const dotChar& D : dotChars)
+    if (D.c == c)
+      return(D.dots);
+  return(boxDots);
+}
+
+// *************************************************************************************** //
+// Fonts.
+// *************************************************************************************** //
+
+int hostMakeFont(uint8_t* bitmap, GFXglyph* glyphs, uint8_t w, uint8_t h,
+    uint8_t xAdvance) {
+  uint16_t offset = 0;
+  for (uint8_t i = 0; i < HOST_FONT_CHARS; i++) {
+    unsigned char c = ' ' + i;
+    GFXglyph& G = glyphs[i];
+    G.bitmapOffset = offset;
+    G.xAdvance = xAdvance;
+    if (c == ' ') {
+      G.width = G.height = 0;
+      G.xOffset = G.yOffset = 0;
+      continue;
+    }
+    G.width = w;
+    G.height = h;
+    G.xOffset = (xAdvance - w) / 2;
+    G.yOffset = -h;
+    // Sample the dots at the glyph's pixels, packing the bits as Adafruit_GFX expects.
+    const char* dots = charDots(c);
+    uint16_t bit = 0;
+    for (uint8_t y = 0; y < h; y++) {
+      for (uint8_t x = 0; x < w; x++, bit++) {
+        if (!(bit & 7))
+          bitmap[offset + bit/8] = 0;
+        if (dots[(y * DOTS_H / h) * DOTS_W + x * DOTS_W / w] == '#')
+          bitmap[offset + bit/8] |= 0x80 >> (bit & 7);
+      }
+    }
+    offset += (bit + 7) / 8;
+  }
+  return(0);
+}
+
+// *************************************************************************************** //
+// Adafruit_GFX.
+// *************************************************************************************** //
+
+#define swapInt16(a, b) { int16_t t = a; a = b; b = t; }
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
+  _width = WIDTH;
+  _height = HEIGHT;
+  rotation = 0;
+  cursor_y = cursor_x = 0;
+  textsize_x = textsize_y = 1;
+  textcolor = textbgcolor = 0xFFFF;
+  wrap = true;
+  gfxFont = NULL;
+}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixel(x, y, color);
+}
+
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+    uint16_t color) {
+  fillRect(x, y, w, h, color);
+}
+
+void Adafruit_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  drawFastVLine(x, y, h, color);
+}
+
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+}
+
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+    uint16_t color) {
+  // Bresenham's algorithm.
+  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    swapInt16(x0, y0);
+    swapInt16(x1, y1);
+  }
+  if (x0 > x1) {
+    swapInt16(x0, x1);
+    swapInt16(y0, y1);
+  }
+  int16_t dx = x1 - x0, dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep)
+      writePixel(y0, x0, color);
+    else
+      writePixel(x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+  rotation = (r & 3);
+  if (rotation & 1) {
+    _width = HEIGHT;
+    _height = WIDTH;
+  } else {
+    _width = WIDTH;
+    _height = HEIGHT;
+  }
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  startWrite();
+  writeLine(x, y, x, y + h - 1, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  startWrite();
+  writeLine(x, y, x + w - 1, y, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  for (int16_t i = x; i < x + w; i++)
+    writeFastVLine(i, y, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+    uint16_t color) {
+  if (x0 == x1) {
+    if (y0 > y1)
+      swapInt16(y0, y1);
+    drawFastVLine(x0, y0, y1 - y0 + 1, color);
+  } else if (y0 == y1) {
+    if (x0 > x1)
+      swapInt16(x0, x1);
+    drawFastHLine(x0, y0, x1 - x0 + 1, color);
+  } else {
+    startWrite();
+    writeLine(x0, y0, x1, y1, color);
+    endWrite();
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  writeFastHLine(x, y, w, color);
+  writeFastHLine(x, y + h - 1, w, color);
+  writeFastVLine(x, y, h, color);
+  writeFastVLine(x + w - 1, y, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+  startWrite();
+  writePixel(x0, y0 + r, color);
+  writePixel(x0, y0 - r, color);
+  writePixel(x0 + r, y0, color);
+  writePixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    writePixel(x0 + x, y0 + y, color);
+    writePixel(x0 - x, y0 + y, color);
+    writePixel(x0 + x, y0 - y, color);
+    writePixel(x0 - x, y0 - y, color);
+    writePixel(x0 + y, y0 + x, color);
+    writePixel(x0 - y, y0 + x, color);
+    writePixel(x0 + y, y0 - x, color);
+    writePixel(x0 - y, y0 - x, color);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
+    uint16_t color) {
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (cornername & 0x4) {
+      writePixel(x0 + x, y0 + y, color);
+      writePixel(x0 + y, y0 + x, color);
+    }
+    if (cornername & 0x2) {
+      writePixel(x0 + x, y0 - y, color);
+      writePixel(x0 + y, y0 - x, color);
+    }
+    if (cornername & 0x8) {
+      writePixel(x0 - y, y0 + x, color);
+      writePixel(x0 - x, y0 + y, color);
+    }
+    if (cornername & 0x1) {
+      writePixel(x0 - y, y0 - x, color);
+      writePixel(x0 - x, y0 - y, color);
+    }
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  startWrite();
+  writeFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners,
+    int16_t delta, uint16_t color) {
+  int16_t f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r, px = x, py = y;
+  delta++;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    // Avoid drawing the same lines twice, which matters for inverted displays.
+    if (x < (y + 1)) {
+      if (corners & 1)
+        writeFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+      if (corners & 2)
+        writeFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+    }
+    if (y != py) {
+      if (corners & 1)
+        writeFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+      if (corners & 2)
+        writeFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+    int16_t y2, uint16_t color) {
+  drawLine(x0, y0, x1, y1, color);
+  drawLine(x1, y1, x2, y2, color);
+  drawLine(x2, y2, x0, y0, color);
+}
+
+void Adafruit_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+    int16_t y2, uint16_t color) {
+  int16_t a, b, y, last;
+
+  // Sort the corners by y (y2 >= y1 >= y0).
+  if (y0 > y1) {
+    swapInt16(y0, y1);
+    swapInt16(x0, x1);
+  }
+  if (y1 > y2) {
+    swapInt16(y2, y1);
+    swapInt16(x2, x1);
+  }
+  if (y0 > y1) {
+    swapInt16(y0, y1);
+    swapInt16(x0, x1);
+  }
+
+  startWrite();
+  if (y0 == y2) {
+    // All on the same line.
+    a = b = x0;
+    if (x1 < a) a = x1; else if (x1 > b) b = x1;
+    if (x2 < a) a = x2; else if (x2 > b) b = x2;
+    writeFastHLine(a, y0, b - a + 1, color);
+    endWrite();
+    return;
+  }
+
+  int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1,
+    dy12 = y2 - y1;
+  int32_t sa = 0, sb = 0;
+
+  // Upper part, including the y1 line unless it is flat at the bottom.
+  last = (y1 == y2) ? y1 : y1 - 1;
+  for (y = y0; y <= last; y++) {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b)
+      swapInt16(a, b);
+    writeFastHLine(a, y, b - a + 1, color);
+  }
+
+  // Lower part.
+  sa = (int32_t) dx12 * (y - y1);
+  sb = (int32_t) dx02 * (y - y0);
+  for (; y <= y2; y++) {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b)
+      swapInt16(a, b);
+    writeFastHLine(a, y, b - a + 1, color);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+    uint16_t color) {
+  int16_t max_radius = ((w < h) ? w : h) / 2;
+  if (r > max_radius)
+    r = max_radius;
+  startWrite();
+  writeFastHLine(x + r, y, w - 2 * r, color);
+  writeFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  writeFastVLine(x, y + r, h - 2 * r, color);
+  writeFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+    uint16_t color) {
+  int16_t max_radius = ((w < h) ? w : h) / 2;
+  if (r > max_radius)
+    r = max_radius;
+  startWrite();
+  writeFillRect(x + r, y, w - 2 * r, h, color);
+  fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+    uint16_t bg, uint8_t size_x, uint8_t size_y) {
+  startWrite();
+  if (gfxFont == NULL) {
+    // Built-in font: a 6x8 cell with the cursor at its upper left.
+    const char* dots = charDots(c);
+    for (int8_t j = 0; j < DOTS_H; j++) {
+      for (int8_t i = 0; i < DOTS_W; i++) {
+        if (dots[j * DOTS_W + i] != '#')
+          continue;
+        if (size_x == 1 && size_y == 1)
+          writePixel(x + i, y + j, color);
+        else
+          writeFillRect(x + i * size_x, y + j * size_y, size_x, size_y, color);
+      }
+    }
+    endWrite();
+    return;
+  }
+
+  // Custom font: the bitmap is placed relative to the cursor, on the baseline. The
+  // background color is not drawn, as in the library.
+  c -= (uint8_t) gfxFont->first;
+  const GFXglyph* glyph = &gfxFont->glyph[c];
+  const uint8_t* bitmap = gfxFont->bitmap;
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t w = glyph->width, h = glyph->height;
+  int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+  uint8_t bits = 0, bit = 0;
+  for (uint8_t yy = 0; yy < h; yy++) {
+    for (uint8_t xx = 0; xx < w; xx++) {
+      if (!(bit++ & 7))
+        bits = bitmap[bo++];
+      if (bits & 0x80) {
+        if (size_x == 1 && size_y == 1)
+          writePixel(x + xo + xx, y + yo + yy, color);
+        else
+          writeFillRect(x + (xo + xx) * size_x, y + (yo + yy) * size_y, size_x, size_y,
+            color);
+      }
+      bits <<= 1;
+    }
+  }
+  endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (gfxFont == NULL) {
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+      if (wrap && ((cursor_x + textsize_x * 6) > _width)) {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+      cursor_x += textsize_x * 6;
+    }
+    return(1);
+  }
+
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += (int16_t) textsize_y * gfxFont->yAdvance;
+  } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+    const GFXglyph* glyph = &gfxFont->glyph[c - gfxFont->first];
+    if (glyph->width > 0 && glyph->height > 0) {
+      if (wrap && ((cursor_x + textsize_x * (glyph->xOffset + glyph->width)) > _width)) {
+        cursor_x = 0;
+        cursor_y += (int16_t) textsize_y * gfxFont->yAdvance;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+    }
+    cursor_x += glyph->xAdvance * (int16_t) textsize_x;
+  }
+  return(1);
+}
+
+void Adafruit_GFX::setFont(const GFXfont* f) {
+  // The built-in font's cursor is at the top of the characters and a custom font's at the
+  // baseline, so move the cursor when switching between them, as the library does.
+  if (f != NULL && gfxFont == NULL)
+    cursor_y += 6;
+  else if (f == NULL && gfxFont != NULL)
+    cursor_y -= 6;
+  gfxFont = (GFXfont*) f;
+}
+
+void Adafruit_GFX::charBounds(unsigned char c, int16_t* x, int16_t* y, int16_t* minx,
+    int16_t* miny, int16_t* maxx, int16_t* maxy) {
+  if (gfxFont == NULL) {
+    if (c == '\n') {
+      *x = 0;
+      *y += textsize_y * 8;
+    } else if (c != '\r') {
+      if (wrap && ((*x + textsize_x * 6) > _width)) {
+        *x = 0;
+        *y += textsize_y * 8;
+      }
+      int16_t x2 = *x + textsize_x * 6 - 1, y2 = *y + textsize_y * 8 - 1;
+      if (x2 > *maxx) *maxx = x2;
+      if (y2 > *maxy) *maxy = y2;
+      if (*x < *minx) *minx = *x;
+      if (*y < *miny) *miny = *y;
+      *x += textsize_x * 6;
+    }
+    return;
+  }
+
+  if (c == '\n') {
+    *x = 0;
+    *y += textsize_y * gfxFont->yAdvance;
+  } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+    const GFXglyph* glyph = &gfxFont->glyph[c - gfxFont->first];
+    uint8_t gw = glyph->width, gh = glyph->height, xa = glyph->xAdvance;
+    int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+    if (wrap && ((*x + (((int16_t) xo + gw) * textsize_x)) > _width)) {
+      *x = 0;
+      *y += textsize_y * gfxFont->yAdvance;
+    }
+    int16_t x1 = *x + xo * textsize_x, y1 = *y + yo * textsize_y,
+      x2 = x1 + gw * textsize_x - 1, y2 = y1 + gh * textsize_y - 1;
+    if (x1 < *minx) *minx = x1;
+    if (y1 < *miny) *miny = y1;
+    if (x2 > *maxx) *maxx = x2;
+    if (y2 > *maxy) *maxy = y2;
+    *x += xa * textsize_x;
+  }
+}
+
+void Adafruit_GFX::getTextBounds(const char* str, int16_t x, int16_t y, int16_t* x1,
+    int16_t* y1, uint16_t* w, uint16_t* h) {
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+  unsigned char c;
+  while ((c = *str++) != 0)
+    charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
+  if (maxx >= minx) {
+    *x1 = minx;
+    *w = maxx - minx + 1;
+  }
+  if (maxy >= miny) {
+    *y1 = miny;
+    *h = maxy - miny + 1;
+  }
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
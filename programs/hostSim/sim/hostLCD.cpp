@@ -0,0 +1,450 @@
+/*
+  hostLCD.cpp - Host simulation of the ILI9341 LCD controller on the SPI bus, standing in
+  for Adafruit_ILI9341, and its SPI and DMA traffic.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <Adafruit_ILI9341.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+#include "hostSim.h"
+#include "hostLCD.h"
+
+// *************************************************************************************** //
+// Controller state.
+// *************************************************************************************** //
+
+// ILI9341 commands used.
+#define ILI9341_SWRESET 0x01
+#define ILI9341_SLPOUT 0x11
+#define ILI9341_DISPON 0x29
+#define ILI9341_CASET 0x2A
+#define ILI9341_PASET 0x2B
+#define ILI9341_RAMWR 0x2C
+#define ILI9341_VSCRDEF 0x33
+#define ILI9341_MADCTL 0x36
+#define ILI9341_VSCRSADD 0x37
+#define ILI9341_PIXFMT 0x3A
+
+// Frame memory size: columns and pages (rows).
+#define LCD_COLS ILI9341_TFTWIDTH
+#define LCD_PAGES ILI9341_TFTHEIGHT
+
+// Most errors reported on stderr.
+#define MAX_REPORTED_ERRORS 10
+
+// Frame memory.
+static uint16_t frame[LCD_PAGES][LCD_COLS];
+
+// Rotation set with MADCTL, which maps the coordinates of writes to the frame memory.
+static uint8_t lcdRotation;
+
+// Vertical scrolling: top fixed area, scroll area lines and scroll start page.
+static uint16_t scrollTop;
+static uint16_t scrollLines = LCD_PAGES;
+static uint16_t scrollStart;
+
+// Address window in the coordinates of the rotation, and the next pixel written.
+static int16_t winX0, winY0, winX1, winY1;
+static int16_t winX, winY;
+
+// True while CS is low, the time at which the DMA bytes sent so far are out, and leftover
+// nanoseconds of CPU sends not yet added to the clock.
+static bool selected;
+static uint64_t dmaBusyUntilUS;
+static uint32_t cpuLeftNS;
+
+// The first byte of a pixel sent by DMA, or -1 if none.
+static int dmaFirstByte = -1;
+
+// Traffic counts, and errors reported on stderr.
+static hostLCDcounts counts;
+static uint32_t reportedErrors;
+
+// SERCOM1 registers. The SPI receiver is enabled, as left by the SPI library.
+static SercomRegs sercom1 = []() {
+  SercomRegs R = {};
+  R.SPI.CTRLB.bit.RXEN = 1;
+  R.SPI.INTFLAG.bit.DRE = 1;
+  R.SPI.INTFLAG.bit.TXC = 1;
+  return(R);
+}();
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Count an error, and report it on stderr if not too many have been.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void lcdError(const char* format, ...) {
+  counts.errors++;
+  if (++reportedErrors > MAX_REPORTED_ERRORS)
+    return;
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "LCD error at %.3f s: ", hostNowUS() / 1e6);
+  vfprintf(stderr, format, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if DMA is still sending bytes.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool dmaBusy(void) {
+  return(hostNowUS() < dmaBusyUntilUS);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send N bytes from the CPU. If ownCS is false, CS must already be low.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void cpuSend(uint32_t N, bool ownCS = false) {
+  if (!ownCS && !selected)
+    lcdError("%u bytes sent with CS high", N);
+  if (dmaBusy())
+    lcdError("%u bytes sent by the CPU while DMA is sending", N);
+  counts.bytes += N;
+  uint64_t NS = cpuLeftNS + (uint64_t) N * HOST_LCD_CPU_NS_PER_BYTE;
+  cpuLeftNS = NS % 1000;
+  hostAdvanceUS(NS / 1000);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send command cmd with N parameter bytes, with its own CS as Adafruit_SPITFT's
+// sendCommand() does.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void sendCommand(uint8_t cmd, uint32_t N) {
+  counts.commands++;
+  cpuSend(1 + N, true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the logical screen size for the rotation.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int16_t lcdWidth(void) {
+  return((lcdRotation & 1) ? LCD_PAGES : LCD_COLS);
+}
+static int16_t lcdHeight(void) {
+  return((lcdRotation & 1) ? LCD_COLS : LCD_PAGES);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Map (x,y) in the coordinates of the rotation to a frame memory column and page, as MADCTL
+// does. Returns false if it is off the screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool mapToFrame(int16_t x, int16_t y, int16_t& col, int16_t& page) {
+  if (x < 0 || y < 0 || x >= lcdWidth() || y >= lcdHeight())
+    return(false);
+  switch (lcdRotation) {
+  case 0: col = LCD_COLS-1 - x; page = y; break;
+  case 1: col = y; page = x; break;
+  case 2: col = x; page = LCD_PAGES-1 - y; break;
+  default: col = LCD_COLS-1 - y; page = LCD_PAGES-1 - x; break;
+  }
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write color at the window's next pixel and advance it, wrapping to the next line at the
+// right edge of the window and to the top at the bottom.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void writeWindowPixel(uint16_t color) {
+  int16_t col, page;
+  if (mapToFrame(winX, winY, col, page))
+    frame[page][col] = color;
+  if (++winX > winX1) {
+    winX = winX0;
+    if (++winY > winY1)
+      winY = winY0;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send N pixels of color from the CPU.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void cpuSendPixels(uint16_t color, uint32_t N) {
+  cpuSend(2 * N);
+  counts.pixels += N;
+  while (N-- > 0)
+    writeWindowPixel(color);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Clip the rectangle at (x,y) of size w x h, either of which may be negative, to the screen.
+// Returns false if nothing is left.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static bool clipRect(int16_t& x, int16_t& y, int16_t& w, int16_t& h) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+  int16_t x2 = min((int16_t) (x + w - 1), (int16_t) (lcdWidth() - 1));
+  int16_t y2 = min((int16_t) (y + h - 1), (int16_t) (lcdHeight() - 1));
+  x = max(x, (int16_t) 0);
+  y = max(y, (int16_t) 0);
+  if (x > x2 || y > y2)
+    return(false);
+  w = x2 - x + 1;
+  h = y2 - y + 1;
+  return(true);
+}
+
+// *************************************************************************************** //
+// Adafruit_ILI9341.
+// *************************************************************************************** //
+
+Adafruit_ILI9341::Adafruit_ILI9341(int8_t cs, int8_t dc, int8_t rst) :
+  Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {
+}
+
+void Adafruit_ILI9341::begin(uint32_t freq) {
+  sendCommand(ILI9341_SWRESET, 0);
+  delay(150);
+  memset(frame, 0, sizeof(frame));
+  lcdRotation = 0;
+  scrollTop = scrollStart = 0;
+  scrollLines = LCD_PAGES;
+  sendCommand(ILI9341_MADCTL, 1);
+  sendCommand(ILI9341_PIXFMT, 1);
+  sendCommand(ILI9341_SLPOUT, 0);
+  delay(150);
+  sendCommand(ILI9341_DISPON, 0);
+  delay(150);
+}
+
+void Adafruit_ILI9341::setRotation(uint8_t r) {
+  Adafruit_GFX::setRotation(r);
+  lcdRotation = rotation;
+  sendCommand(ILI9341_MADCTL, 1);
+}
+
+void Adafruit_ILI9341::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  counts.commands += 3;
+  counts.windows++;
+  cpuSend(11);
+  winX = winX0 = x;
+  winY = winY0 = y;
+  winX1 = x + w - 1;
+  winY1 = y + h - 1;
+}
+
+void Adafruit_ILI9341::setScrollMargins(uint16_t top, uint16_t bottom) {
+  if (top + bottom > LCD_PAGES)
+    return;
+  sendCommand(ILI9341_VSCRDEF, 6);
+  scrollTop = top;
+  scrollLines = LCD_PAGES - top - bottom;
+}
+
+void Adafruit_ILI9341::scrollTo(uint16_t y) {
+  sendCommand(ILI9341_VSCRSADD, 2);
+  scrollStart = y;
+}
+
+void Adafruit_ILI9341::startWrite(void) {
+  selected = true;
+}
+
+void Adafruit_ILI9341::endWrite(void) {
+  selected = false;
+}
+
+void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return;
+  startWrite();
+  setAddrWindow(x, y, 1, 1);
+  cpuSendPixels(color, 1);
+  endWrite();
+}
+
+void Adafruit_ILI9341::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height)
+    return;
+  setAddrWindow(x, y, 1, 1);
+  cpuSendPixels(color, 1);
+}
+
+void Adafruit_ILI9341::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+    uint16_t color) {
+  if (clipRect(x, y, w, h))
+    writeFillRectPreclipped(x, y, w, h, color);
+}
+
+void Adafruit_ILI9341::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  int16_t h = 1;
+  if (clipRect(x, y, w, h))
+    writeFillRectPreclipped(x, y, w, 1, color);
+}
+
+void Adafruit_ILI9341::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  int16_t w = 1;
+  if (clipRect(x, y, w, h))
+    writeFillRectPreclipped(x, y, 1, h, color);
+}
+
+void Adafruit_ILI9341::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+    uint16_t color) {
+  if (!clipRect(x, y, w, h))
+    return;
+  startWrite();
+  writeFillRectPreclipped(x, y, w, h, color);
+  endWrite();
+}
+
+void Adafruit_ILI9341::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  int16_t h = 1;
+  if (!clipRect(x, y, w, h))
+    return;
+  startWrite();
+  writeFillRectPreclipped(x, y, w, 1, color);
+  endWrite();
+}
+
+void Adafruit_ILI9341::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  int16_t w = 1;
+  if (!clipRect(x, y, w, h))
+    return;
+  startWrite();
+  writeFillRectPreclipped(x, y, 1, h, color);
+  endWrite();
+}
+
+void Adafruit_ILI9341::writeColor(uint16_t color, uint32_t len) {
+  cpuSendPixels(color, len);
+}
+
+void Adafruit_ILI9341::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h,
+    uint16_t color) {
+  setAddrWindow(x, y, w, h);
+  cpuSendPixels(color, (uint32_t) w * h);
+}
+
+// *************************************************************************************** //
+// SERCOM1 and DMA.
+// *************************************************************************************** //
+
+volatile SercomRegs* hostSERCOM1(void) {
+  hostAdvanceUS(1);
+  sercom1.SPI.INTFLAG.bit.TXC = !dmaBusy();
+  sercom1.SPI.SYNCBUSY.reg = 0;
+  return(&sercom1);
+}
+
+void hostLCDsendDMA(const DmacDescriptor& D) {
+  if (D.dst != (void*) &sercom1.SPI.DATA.reg) {
+    lcdError("DMA to SERCOM1 with another destination");
+    return;
+  }
+  if (!selected)
+    lcdError("DMA of %u bytes with CS high", D.count);
+  if (sercom1.SPI.CTRLB.bit.RXEN)
+    lcdError("DMA of %u bytes with the SPI receiver enabled", D.count);
+
+  // Pixels are sent most significant byte first.
+  const volatile uint8_t* src = (const volatile uint8_t*) D.src;
+  for (uint32_t i = 0; i < D.count; i++) {
+    uint8_t b = D.srcInc ? src[i] : src[0];
+    if (dmaFirstByte < 0)
+      dmaFirstByte = b;
+    else {
+      writeWindowPixel((uint16_t) (dmaFirstByte << 8 | b));
+      dmaFirstByte = -1;
+      counts.pixels++;
+      counts.dmaPixels++;
+    }
+  }
+  counts.bytes += D.count;
+  dmaBusyUntilUS = max(dmaBusyUntilUS, hostNowUS()) +
+    ((uint64_t) D.count * HOST_LCD_DMA_NS_PER_BYTE + 999) / 1000;
+}
+
+void hostLCDcheckBusFree(const char* user) {
+  if (dmaBusy())
+    lcdError("%s used the SPI bus while LCD DMA is sending", user);
+  else if (selected)
+    lcdError("%s used the SPI bus while LCD CS is low", user);
+}
+
+// *************************************************************************************** //
+// Counts and screen contents.
+// *************************************************************************************** //
+
+void getHostLCDcounts(hostLCDcounts& C) {
+  C = counts;
+}
+
+void clearHostLCDcounts(void) {
+  counts = hostLCDcounts();
+}
+
+uint16_t hostLCDpixel(int16_t x, int16_t y) {
+  int16_t col, page;
+  if (!mapToFrame(x, y, col, page))
+    return(0);
+  // The scroll area shows the frame memory from page scrollStart on, wrapping around to the
+  // top of the area.
+  if (page >= scrollTop && page < scrollTop + scrollLines &&
+      scrollStart >= scrollTop && scrollStart < scrollTop + scrollLines)
+    page = scrollTop + (scrollStart - scrollTop + page - scrollTop) % scrollLines;
+  return(frame[page][col]);
+}
+
+uint32_t hostLCDcountColor(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  uint32_t N = 0;
+  for (int16_t j = y; j < y + h; j++)
+    for (int16_t i = x; i < x + w; i++)
+      if (hostLCDpixel(i, j) == color)
+        N++;
+  return(N);
+}
+
+bool hostSaveLCDimage(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (f == NULL)
+    return(false);
+  fprintf(f, "P6\n%d %d\n255\n", lcdWidth(), lcdHeight());
+  for (int16_t y = 0; y < lcdHeight(); y++) {
+    for (int16_t x = 0; x < lcdWidth(); x++) {
+      uint16_t c = hostLCDpixel(x, y);
+      uint8_t rgb[3] = { (uint8_t) ((c >> 11) * 255 / 31),
+        (uint8_t) (((c >> 5) & 0x3F) * 255 / 63), (uint8_t) ((c & 0x1F) * 255 / 31) };
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  return(fclose(f) == 0);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,96 @@
+/*
+  hostLCD.h - Host simulation of the ILI9341 LCD controller on the SPI bus, standing in
+  for Adafruit_ILI9341, and its SPI and DMA traffic.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef hostLCD_h
+#define hostLCD_h
+
+#include <Arduino.h>
+#include <Adafruit_ZeroDMA.h>
+
+// The simulated controller keeps the 240x320 frame memory and its address window, rotation
+// and vertical scrolling as the ILI9341 does, so that what the screens show can be read
+// back with hostLCDpixel(). Each SPI byte advances the simulated clock: bytes sent by the
+// CPU take HOST_LCD_CPU_NS_PER_BYTE, because the library waits for each one, and bytes sent
+// by DMA take HOST_LCD_DMA_NS_PER_BYTE (24 MHz SPI) while the CPU goes on, SERCOM1's
+// INTFLAG.TXC being 0 until they are out.
+#define HOST_LCD_CPU_NS_PER_BYTE 500
+#define HOST_LCD_DMA_NS_PER_BYTE 333
+
+// LCD traffic counts.
+struct hostLCDcounts {
+  uint32_t commands;        // Commands sent, including the three of each address window.
+  uint32_t windows;         // Address windows set.
+  uint32_t pixels;          // Pixels written, by the CPU or DMA.
+  uint32_t dmaPixels;       // Pixels written by DMA.
+  uint32_t bytes;           // SPI bytes sent, including commands and their parameters.
+  uint32_t errors;          // Misuse of the SPI bus: sends with CS high, CPU sends or
+                            // touchscreen reads while DMA is sending, and DMA with the SPI
+                            // receiver enabled. Each is reported on stderr.
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get and clear the LCD traffic counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getHostLCDcounts(hostLCDcounts& C);
+extern void clearHostLCDcounts(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the color shown at (x,y), in the coordinates of the current rotation, including
+// the effect of vertical scrolling. Returns 0 outside the screen.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint16_t hostLCDpixel(int16_t x, int16_t y);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of pixels shown in the rectangle at (x,y) of size w x h that have color.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t hostLCDcountColor(int16_t x, int16_t y, int16_t w, int16_t h,
+  uint16_t color);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write what the screen shows to a binary PPM file at path. Returns false if the file could
+// not be written.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool hostSaveLCDimage(const char* path);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Report an error if the LCD is using the SPI bus, for the touchscreen stand-in to call
+// before it reads the touchscreen controller, which shares the bus.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostLCDcheckBusFree(const char* user);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Send the bytes of DMA descriptor D to the LCD, for the DMA stand-in in hostSim.cpp.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostLCDsendDMA(const DmacDescriptor& D);
+
+#endif // hostLCD_h
@@ -0,0 +1,575 @@
+/*
+  hostSim.cpp - Simulated SAMD21 hardware for running SmartVent Thermostat firmware
+  modules on a desktop computer.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <wiring_private.h>
+#include <wiring_analog_SAMD_TT.h>
+#include <calibSAMD_ADC_withPWM.h>
+#include <monitor_printf.h>
+#include <Adafruit_ZeroDMA.h>
+#include <FlashStorage_SAMD.h>
+#include <wdt_samd21.h>
+#include <stdarg.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <map>
+#include "hostSim.h"
+#include "hostLCD.h"
+
+// *************************************************************************************** //
+// Clock.
+// *************************************************************************************** //
+
+// Simulated time in microseconds.
+static uint64_t nowUS;
+
+// True while the ADC and DMA are being advanced, so that register accesses made by the DMA
+// callback don't advance them again.
+static bool inADCupdate;
+
+static void updateADC(void);
+static uint64_t nextConversionDoneUS(void);
+
+uint64_t hostNowUS(void) {
+  return(nowUS);
+}
+
+void hostAdvanceUS(uint64_t US) {
+  // Start the conversions requested since the last update now, and stop at the end of each
+  // one finished in this time, so that the DMA callback sees the time at which it would
+  // have run.
+  uint64_t endUS = nowUS + US;
+  updateADC();
+  while (!inADCupdate && nextConversionDoneUS() < endUS) {
+    nowUS = max(nowUS, nextConversionDoneUS());
+    updateADC();
+  }
+  nowUS = max(nowUS, endUS);
+  updateADC();
+}
+
+uint32_t micros(void) {
+  hostAdvanceUS(HOST_CLOCK_READ_US);
+  return((uint32_t) nowUS);
+}
+
+uint32_t millis(void) {
+  hostAdvanceUS(HOST_CLOCK_READ_US);
+  return((uint32_t) (nowUS / 1000));
+}
+
+void delay(uint32_t ms) {
+  hostAdvanceUS((uint64_t) ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  hostAdvanceUS(us);
+}
+
+// *************************************************************************************** //
+// Sleep and watchdog.
+// *************************************************************************************** //
+
+ScbRegs hostSCB;
+PmRegs hostPM;
+
+// Watchdog period in ms (0 if not initialized), time of the last reset, and longest time
+// between resets.
+static uint32_t wdtPeriodMS;
+static uint64_t wdtLastResetUS;
+static uint32_t wdtLongestMS;
+
+void __WFI(void) {
+  hostAdvanceUS(1000 - nowUS % 1000);
+}
+
+void wdt_init(uint8_t period) {
+  wdtPeriodMS = 8u << period;
+  wdtLastResetUS = nowUS;
+  wdtLongestMS = 0;
+}
+
+void wdt_reset(void) {
+  if (wdtPeriodMS == 0)
+    return;
+  wdtLongestMS = max(wdtLongestMS, (uint32_t) ((nowUS - wdtLastResetUS) / 1000));
+  wdtLastResetUS = nowUS;
+}
+
+uint32_t hostWatchdogPeriodMS(void) {
+  return(wdtPeriodMS);
+}
+
+uint32_t hostWatchdogLongestMS(void) {
+  return(wdtLongestMS);
+}
+
+// *************************************************************************************** //
+// Pins.
+// *************************************************************************************** //
+
+// Levels last written to the pins, and functions giving the levels of input pins.
+static uint8_t pinLevels[NUM_HOST_PINS];
+static int (*pinInputs[NUM_HOST_PINS])(void);
+
+// PWM duty cycles of the pins, in percent.
+static float pinDuty[NUM_HOST_PINS];
+
+// Pin descriptions. The ADC inputs are those of the Arduino Nano 33 IoT, plus pins
+// HOST_EXTRA_PIN+k on inputs A1's+k, for extra thermistors.
+#define HOST_EXTRA_PIN 40
+PinDescription g_APinDescription[NUM_HOST_PINS];
+
+static struct pinDescriptionInit {
+  pinDescriptionInit() {
+    const uint8_t analogInputs[] = { 0, 10, 19, 18, 2, 3, 17, 11 };
+    for (uint8_t i = 0; i < sizeof(analogInputs); i++)
+      g_APinDescription[A0+i].ulADCChannelNumber = analogInputs[i];
+    g_APinDescription[4].ulADCChannelNumber = 7;
+    g_APinDescription[7].ulADCChannelNumber = 6;
+    for (uint8_t k = 1; HOST_EXTRA_PIN+k < NUM_HOST_PINS && k < 8; k++)
+      g_APinDescription[HOST_EXTRA_PIN+k].ulADCChannelNumber = analogInputs[1] + k;
+  }
+} pinDescriptionInitializer;
+
+void pinMode(pin_size_t pin, int mode) {
+}
+
+void digitalWrite(pin_size_t pin, int value) {
+  if (pin < NUM_HOST_PINS)
+    pinLevels[pin] = value;
+}
+
+int digitalRead(pin_size_t pin) {
+  if (pin >= NUM_HOST_PINS)
+    return(LOW);
+  return(pinInputs[pin] != nullptr ? pinInputs[pin]() : pinLevels[pin]);
+}
+
+int hostPinLevel(pin_size_t pin) {
+  return(digitalRead(pin));
+}
+
+void hostSetPinInput(pin_size_t pin, int (*level)(void)) {
+  if (pin < NUM_HOST_PINS)
+    pinInputs[pin] = level;
+}
+
+void hostSetPWM(pin_size_t pin, float frequency, float duty) {
+  if (pin < NUM_HOST_PINS)
+    pinDuty[pin] = frequency > 0 ? duty : 0;
+}
+
+float hostPWMduty(pin_size_t pin) {
+  return(pin < NUM_HOST_PINS ? pinDuty[pin] : 0);
+}
+
+int pinPeripheral(uint32_t pin, int type) {
+  return(0);
+}
+
+// *************************************************************************************** //
+// ADC and DMA.
+// *************************************************************************************** //
+
+// Number of ADC inputs.
+#define NUM_ADC_INPUTS 32
+
+// The ADC registers.
+static AdcRegs adcRegs;
+
+// Values of the ADC inputs.
+static uint16_t adcInputs[NUM_ADC_INPUTS];
+static struct adcInputsInit {
+  adcInputsInit() {
+    for (uint8_t i = 0; i < NUM_ADC_INPUTS; i++)
+      adcInputs[i] = ADC_MAX/2;
+  }
+} adcInputsInitializer;
+
+// Conversion time, and whether a conversion is in progress and when it finishes.
+static uint32_t conversionUS = 400;
+static bool converting;
+static uint64_t conversionDoneUS;
+
+// True if the next result is the first one after enabling the ADC or changing its input,
+// which the hardware does not guarantee to be valid, and is returned as 0 here.
+static bool wasEnabled;
+static bool firstResult;
+static uint8_t lastMuxPos;
+
+// Noise standard deviation and generator state.
+static float noiseSD;
+static uint64_t noiseState;
+static bool haveSpareNoise;
+static float spareNoise;
+
+// Usage counts.
+static hostADCcounts adcCounts;
+
+// Number of DMA channels that can be allocated, and the allocated channels.
+#define HOST_DMA_CHANNELS 4
+static Adafruit_ZeroDMA* dmaChannels[HOST_DMA_CHANNELS];
+static uint8_t numDMAchannels;
+
+// True while SPI DMA jobs are being run, so that a job started by a callback is run after
+// the callback returns rather than recursively.
+static bool inSPIdma;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return a uniformly distributed value in (0, 1) from a xorshift64* generator. This is used
+// rather than <random> so that runs give the same results with any standard library.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static double uniformNoise(void) {
+  noiseState ^= noiseState >> 12;
+  noiseState ^= noiseState << 25;
+  noiseState ^= noiseState >> 27;
+  return(((noiseState * 2685821657736338717ULL) >> 11) * (1.0/9007199254740992.0) +
+    0.5/9007199254740992.0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the value of ADC input, plus noise, clamped to the ADC range.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint16_t convertInput(uint8_t input) {
+  adcCounts.conversions++;
+  float value = adcInputs[input % NUM_ADC_INPUTS];
+  if (noiseSD > 0) {
+    // Box-Muller transform, using both of the values it gives.
+    if (haveSpareNoise)
+      value += noiseSD * spareNoise;
+    else {
+      double r = sqrt(-2*log(uniformNoise())), a = 2*M_PI*uniformNoise();
+      value += noiseSD * (float)(r*cos(a));
+      spareNoise = (float)(r*sin(a));
+    }
+    haveSpareNoise = !haveSpareNoise;
+  }
+  value = floor(value + 0.5f);
+  return((uint16_t) (value < 0 ? 0 : value > ADC_MAX ? ADC_MAX : value));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the allocated DMA channel with an active job and the given trigger, or nullptr.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static Adafruit_ZeroDMA* activeDMAchannel(uint8_t trigger) {
+  for (uint8_t i = 0; i < numDMAchannels; i++)
+    if (dmaChannels[i]->Active && dmaChannels[i]->Trigger == trigger)
+      return(dmaChannels[i]);
+  return(nullptr);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Finish the conversion in progress: store the result, set RESRDY, advance the input scan,
+// and let DMA copy the result if it is triggered by RESRDY.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void finishConversion(void) {
+  uint8_t input = adcRegs.INPUTCTRL.bit.MUXPOS + adcRegs.INPUTCTRL.bit.INPUTOFFSET;
+  uint16_t result = convertInput(input);
+  adcRegs.RESULT.reg = firstResult ? 0 : result;
+  firstResult = false;
+  if (adcRegs.INPUTCTRL.bit.INPUTSCAN > 0) {
+    adcCounts.scanConversions++;
+    uint8_t offset = adcRegs.INPUTCTRL.bit.INPUTOFFSET + 1;
+    adcRegs.INPUTCTRL.bit.INPUTOFFSET = offset > adcRegs.INPUTCTRL.bit.INPUTSCAN ? 0 : offset;
+  }
+  adcRegs.INTFLAG.bit.RESRDY = 1;
+
+  Adafruit_ZeroDMA* dma = activeDMAchannel(ADC_DMAC_ID_RESRDY);
+  if (dma != nullptr) {
+    ((uint16_t*) dma->Desc.dst)[dma->Beats++] = adcRegs.RESULT.reg;
+    adcRegs.INTFLAG.bit.RESRDY = 0;
+    if (dma->Beats == dma->Desc.count) {
+      dma->Active = false;
+      adcCounts.dmaTransfers++;
+      if (dma->Callback != nullptr)
+        dma->Callback(dma);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Bring the ADC up to the current time: start the conversions requested by SWTRIG.START or
+// FREERUN, and finish those whose conversion time has passed.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void updateADC(void) {
+  if (inADCupdate)
+    return;
+  inADCupdate = true;
+  for (;;) {
+    if (!adcRegs.CTRLA.bit.ENABLE) {
+      wasEnabled = converting = false;
+      adcRegs.SWTRIG.bit.START = 0;
+      break;
+    }
+    if (!wasEnabled || adcRegs.INPUTCTRL.bit.MUXPOS != lastMuxPos) {
+      wasEnabled = firstResult = true;
+      lastMuxPos = adcRegs.INPUTCTRL.bit.MUXPOS;
+    }
+    if (!converting && (adcRegs.SWTRIG.bit.START || adcRegs.CTRLB.bit.FREERUN)) {
+      adcRegs.SWTRIG.bit.START = 0;
+      converting = true;
+      conversionDoneUS = nowUS + conversionUS;
+    }
+    if (!converting || nowUS < conversionDoneUS)
+      break;
+    converting = false;
+    finishConversion();
+    // A free-running ADC starts the next conversion when this one finishes.
+    if (adcRegs.CTRLB.bit.FREERUN && adcRegs.CTRLA.bit.ENABLE) {
+      converting = true;
+      conversionDoneUS += conversionUS;
+    }
+  }
+  inADCupdate = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the time at which the conversion in progress finishes, or UINT64_MAX if none is.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static uint64_t nextConversionDoneUS(void) {
+  return((converting && adcRegs.CTRLA.bit.ENABLE) ? conversionDoneUS : UINT64_MAX);
+}
+
+volatile AdcRegs* hostADC(void) {
+  hostAdvanceUS(1);
+  return(&adcRegs);
+}
+
+uint16_t analogRead_SAMD_TT(pin_size_t pin) {
+  // The Arduino core discards the first conversion after selecting the input, so two are
+  // done and counted.
+  hostAdvanceUS(2*conversionUS);
+  adcCounts.conversions++;
+  return(convertInput(g_APinDescription[pin].ulADCChannelNumber));
+}
+
+int analogRead(pin_size_t pin) {
+  return(analogRead_SAMD_TT(pin));
+}
+
+void hostSetADCinput(uint8_t input, uint16_t value) {
+  adcInputs[input % NUM_ADC_INPUTS] = value > ADC_MAX ? ADC_MAX : value;
+}
+
+void hostSetADCnoise(float sdCodes, uint32_t seed) {
+  noiseSD = sdCodes;
+  noiseState = 0x9E3779B97F4A7C15ULL ^ seed;
+  haveSpareNoise = false;
+}
+
+void hostSetADCconversionUS(uint32_t US) {
+  conversionUS = US;
+}
+
+void getHostADCcounts(hostADCcounts& C) {
+  C = adcCounts;
+}
+
+void clearHostADCcounts(void) {
+  memset(&adcCounts, 0, sizeof(adcCounts));
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::allocate(void) {
+  if (Allocated || numDMAchannels == HOST_DMA_CHANNELS)
+    return(DMA_STATUS_ERR_NOT_FOUND);
+  dmaChannels[numDMAchannels++] = this;
+  Allocated = true;
+  return(DMA_STATUS_OK);
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::startJob(void) {
+  if (!Allocated)
+    return(DMA_STATUS_ERR_NOT_INITIALIZED);
+  Beats = 0;
+  Active = true;
+
+  // Send SPI jobs to the LCD now. The firmware waits for them by spinning on a flag set by
+  // the callback, which it could not do if they finished later on the simulated clock.
+  if (Trigger == SERCOM1_DMAC_ID_TX && !inSPIdma) {
+    inSPIdma = true;
+    Adafruit_ZeroDMA* dma;
+    while ((dma = activeDMAchannel(SERCOM1_DMAC_ID_TX)) != nullptr) {
+      dma->Active = false;
+      hostLCDsendDMA(dma->Desc);
+      if (dma->Callback != nullptr)
+        dma->Callback(dma);
+    }
+    inSPIdma = false;
+  }
+  return(DMA_STATUS_OK);
+}
+
+void Adafruit_ZeroDMA::abort(void) {
+  Active = false;
+}
+
+// *************************************************************************************** //
+// Flash and EEPROM emulation.
+// *************************************************************************************** //
+
+// Bytes that may still be written, or < 0 for no limit.
+static long flashWriteBudget = -1;
+
+// Number of erases of each row, by address, and of writes.
+static std::map<uintptr_t, uint32_t> rowErases;
+static uint32_t flashWrites;
+
+// EEPROM emulation contents and number of commits.
+static uint8_t eepromData[EEPROM_EMULATION_SIZE];
+static uint32_t eepromCommits;
+static struct eepromInit {
+  eepromInit() { memset(eepromData, 0xFF, sizeof(eepromData)); }
+} eepromInitializer;
+
+EEPROMClass EEPROM;
+
+FlashClass::FlashClass(const void* flash_addr, uint32_t size) {
+  if (flash_addr == nullptr)
+    return;
+  uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t) flash_addr & ~(page-1);
+  uintptr_t end = ((uintptr_t) flash_addr + size + page-1) & ~(page-1);
+  if (mprotect((void*) start, end - start, PROT_READ | PROT_WRITE) != 0)
+    perror("FlashClass: mprotect");
+}
+
+void FlashClass::write(const volatile void* flash_ptr, const void* data, uint32_t size) {
+  // The flash is written in 32-bit words.
+  flashWrites++;
+  volatile uint8_t* dst = (volatile uint8_t*) flash_ptr;
+  const uint8_t* src = (const uint8_t*) data;
+  size = (size + 3) & ~3u;
+  for (uint32_t i = 0; i < size; i++) {
+    if (flashWriteBudget == 0)
+      return;
+    if (flashWriteBudget > 0)
+      flashWriteBudget--;
+    dst[i] &= src[i];
+  }
+}
+
+void FlashClass::erase(const volatile void* flash_ptr, uint32_t size) {
+  uintptr_t row = (uintptr_t) flash_ptr & ~(uintptr_t)(HOST_FLASH_ROW_SIZE-1);
+  uintptr_t end = (uintptr_t) flash_ptr + size;
+  for (; row < end; row += HOST_FLASH_ROW_SIZE) {
+    memset((void*) row, 0xFF, HOST_FLASH_ROW_SIZE);
+    rowErases[row]++;
+  }
+}
+
+void FlashClass::read(const volatile void* flash_ptr, void* data, uint32_t size) {
+  memcpy(data, (const void*) flash_ptr, size);
+}
+
+void hostSetFlashWriteBudget(long bytes) {
+  flashWriteBudget = bytes;
+}
+
+void getHostFlashCounts(hostFlashCounts& C) {
+  memset(&C, 0, sizeof(C));
+  for (const auto& row : rowErases) {
+    C.erases += row.second;
+    C.rowsErased++;
+    C.maxRowErases = max(C.maxRowErases, row.second);
+  }
+  C.writes = flashWrites;
+}
+
+void clearHostFlashCounts(void) {
+  rowErases.clear();
+  flashWrites = 0;
+}
+
+uint8_t EEPROMClass::read(int address) {
+  return(address >= 0 && address < EEPROM_EMULATION_SIZE ? eepromData[address] : 0xFF);
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+  if (address >= 0 && address < EEPROM_EMULATION_SIZE)
+    eepromData[address] = value;
+}
+
+bool EEPROMClass::isValid(void) {
+  return(true);
+}
+
+void EEPROMClass::commit(void) {
+  eepromCommits++;
+}
+
+void hostSetEEPROM(const void* data, size_t len) {
+  memset(eepromData, 0xFF, sizeof(eepromData));
+  if (data != NULL)
+    memcpy(eepromData, data, min(len, sizeof(eepromData)));
+}
+
+uint32_t hostEEPROMcommits(void) {
+  return(eepromCommits);
+}
+
+// *************************************************************************************** //
+// Serial port and monitor.
+// *************************************************************************************** //
+
+hostSerialPort hostMonitorPort;
+
+size_t hostSerialPort::write(uint8_t c) {
+  return(write(&c, 1));
+}
+
+size_t hostSerialPort::write(const uint8_t* buf, size_t len) {
+  if (keep)
+    output.append((const char*) buf, len);
+  if (echo)
+    fwrite(buf, 1, len, stdout);
+  return(len);
+}
+
+monitorPrintf monitor;
+
+void monitorPrintf::printf(const char* fmt, ...) {
+  if (Port == nullptr)
+    return;
+  char S[512];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(S, sizeof(S), fmt, args);
+  va_end(args);
+  if (n > 0)
+    Port->write((const uint8_t*) S, min((size_t) n, sizeof(S)-1));
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
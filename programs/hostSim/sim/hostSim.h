@@ -0,0 +1,187 @@
+/*
+  hostSim.h - Simulated SAMD21 hardware for running SmartVent Thermostat firmware modules
+  on a desktop computer.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef hostSim_h
+#define hostSim_h
+
+#include <Arduino.h>
+#include <string>
+
+// *************************************************************************************** //
+// Simulated clock.
+// *************************************************************************************** //
+
+// The clock starts at 0 and advances only when the firmware calls millis(), micros(),
+// delay() or delayMicroseconds(), accesses the ADC or SERCOM1 registers, sends to the LCD,
+// reads the touchscreen or sleeps with __WFI(), or when hostAdvanceUS() is called.
+// millis() and micros() each take HOST_CLOCK_READ_US, so that loops that wait on them
+// finish.
+#define HOST_CLOCK_READ_US 1
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the simulated time in microseconds.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint64_t hostNowUS(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Advance the simulated clock by US microseconds, running the ADC conversions and DMA
+// transfers that finish in that time.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostAdvanceUS(uint64_t US);
+
+// *************************************************************************************** //
+// Simulated pins and ADC.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the level last written to digital pin with digitalWrite().
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern int hostPinLevel(pin_size_t pin);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Make digitalRead() of pin return the value of function level, such as the touchscreen's
+// TOUCH_IRQ output, instead of the level last written. nullptr undoes it.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetPinInput(pin_size_t pin, int (*level)(void));
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set and return the PWM duty cycle in percent of pin, as set by SAMD_PWM. 0 = off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetPWM(pin_size_t pin, float frequency, float duty);
+extern float hostPWMduty(pin_size_t pin);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the value the ADC returns when converting ADC input (AIN) number input. All inputs
+// read ADC_MAX/2 until set.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetADCinput(uint8_t input, uint16_t value);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Add Gaussian noise with standard deviation sdCodes to each ADC result, from a generator
+// seeded with seed. sdCodes = 0 (the default) turns it off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetADCnoise(float sdCodes, uint32_t seed);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the time in microseconds one ADC conversion takes. The default is 400 us, the time of
+// a 12-bit conversion with the averaging set by CFG_ADC_MULT_SAMP_AVG.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetADCconversionUS(uint32_t US);
+
+// ADC usage counts.
+struct hostADCcounts {
+  uint32_t conversions;     // All ADC conversions, including those of analogRead_SAMD_TT().
+  uint32_t scanConversions; // Conversions done as part of an input scan.
+  uint32_t dmaTransfers;    // DMA jobs that completed and called their callback.
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get and clear the ADC usage counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getHostADCcounts(hostADCcounts& C);
+extern void clearHostADCcounts(void);
+
+// *************************************************************************************** //
+// Simulated watchdog.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the watchdog period in ms set by wdt_init(), or 0 if it was not called.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t hostWatchdogPeriodMS(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the longest time in ms from wdt_init() or a wdt_reset() to the next wdt_reset().
+// The watchdog would have reset the CPU if this is hostWatchdogPeriodMS() or more.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t hostWatchdogLongestMS(void);
+
+// *************************************************************************************** //
+// Simulated flash and EEPROM emulation.
+// *************************************************************************************** //
+
+// Size in bytes of a flash row, the unit of erasing.
+#define HOST_FLASH_ROW_SIZE 256
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Let only the next bytes bytes written by FlashClass::write() reach the flash, as though
+// power was lost after that. bytes < 0 (the default) lets all writes through.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetFlashWriteBudget(long bytes);
+
+// Flash erase counts.
+struct hostFlashCounts {
+  uint32_t erases;          // Rows erased.
+  uint32_t rowsErased;      // Different rows erased at least once.
+  uint32_t maxRowErases;    // Largest number of erases of one row.
+  uint32_t writes;          // Calls to FlashClass::write().
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get and clear the flash erase and write counts.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void getHostFlashCounts(hostFlashCounts& C);
+extern void clearHostFlashCounts(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Set the contents of the emulated EEPROM, as though they were written by an earlier
+// version of the firmware. The rest of it reads as 0xFF.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostSetEEPROM(const void* data, size_t len);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of calls to EEPROM.commit().
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t hostEEPROMcommits(void);
+
+// *************************************************************************************** //
+// Simulated serial port.
+// *************************************************************************************** //
+
+// A serial port that keeps what is written to it, and optionally copies it to stdout.
+class hostSerialPort : public Print {
+public:
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  int availableForWrite() override { return(room); }
+
+  std::string output;       // Everything written since output was last cleared.
+  bool echo = false;        // True to also write it to stdout.
+  bool keep = true;         // False to not keep it in output.
+  int room = 256;           // Value returned by availableForWrite().
+};
+
+// The port used as the serial monitor.
+extern hostSerialPort hostMonitorPort;
+
+#endif // hostSim_h
@@ -0,0 +1,208 @@
+/*
+  hostTouch.cpp - Host simulation of touches of the XPT2046 touchscreen, standing in for
+  XPT2046_Touchscreen_TT and TS_Display.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <XPT2046_Touchscreen_TT.h>
+#include <TS_Display.h>
+#include <vector>
+#include "hostSim.h"
+#include "hostLCD.h"
+#include "hostTouch.h"
+
+// *************************************************************************************** //
+// Touch script.
+// *************************************************************************************** //
+
+// Minimum time between reads of the touchscreen controller, as in the library.
+#define TS_READ_INTERVAL_US 3000
+
+// A scripted touch.
+struct scriptedTouch {
+  uint32_t startMS;
+  uint32_t durationMS;
+  int16_t x, y;
+};
+
+// The scripted touches, and the number of controller reads.
+static std::vector<scriptedTouch> touches;
+static uint32_t touchReads;
+
+void hostTouchAt(uint32_t startMS, uint32_t durationMS, int16_t x, int16_t y) {
+  touches.push_back(scriptedTouch{ startMS, durationMS, x, y });
+}
+
+void hostClearTouches(void) {
+  touches.clear();
+}
+
+bool hostTouching(int16_t* x, int16_t* y) {
+  uint64_t nowMS = hostNowUS() / 1000;
+  for (const scriptedTouch& T : touches) {
+    if (nowMS >= T.startMS && nowMS < (uint64_t) T.startMS + T.durationMS) {
+      if (x != NULL) *x = T.x;
+      if (y != NULL) *y = T.y;
+      return(true);
+    }
+  }
+  return(false);
+}
+
+uint32_t hostTouchReads(void) {
+  return(touchReads);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the level of the controller's TOUCH_IRQ output, LOW while touched.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static int touchIRQlevel(void) {
+  return(hostTouching() ? LOW : HIGH);
+}
+
+// *************************************************************************************** //
+// XPT2046_Touchscreen.
+// *************************************************************************************** //
+
+XPT2046_Touchscreen::XPT2046_Touchscreen(uint8_t cspin, uint8_t tirq) {
+  if (tirq != 255)
+    hostSetPinInput(tirq, touchIRQlevel);
+}
+
+bool XPT2046_Touchscreen::begin(void) {
+  return(true);
+}
+
+TS_Point XPT2046_Touchscreen::getPoint(void) {
+  update();
+  return(Point);
+}
+
+bool XPT2046_Touchscreen::touched(void) {
+  update();
+  return(Point.z >= Threshold);
+}
+
+void XPT2046_Touchscreen::update(void) {
+  // Like the library, read the controller over SPI only while TOUCH_IRQ shows a touch, and
+  // at most every TS_READ_INTERVAL_US.
+  int16_t x, y;
+  if (!hostTouching(&x, &y)) {
+    Point = TS_Point();
+    return;
+  }
+  uint32_t nowUS = (uint32_t) hostNowUS();
+  if (HaveRead && nowUS - LastReadUS < TS_READ_INTERVAL_US)
+    return;
+  hostLCDcheckBusFree("Touchscreen read");
+  hostAdvanceUS(HOST_TS_READ_US);
+  touchReads++;
+  LastReadUS = nowUS;
+  HaveRead = true;
+  Point = TS_Point(
+    HOST_TS_UL_X + (int32_t) x * (HOST_TS_LR_X - HOST_TS_UL_X) / (HOST_TS_WIDTH - 1),
+    HOST_TS_UL_Y + (int32_t) y * (HOST_TS_LR_Y - HOST_TS_UL_Y) / (HOST_TS_HEIGHT - 1),
+    HOST_TS_PRESSURE);
+}
+
+// *************************************************************************************** //
+// TS_Display.
+// *************************************************************************************** //
+
+void TS_Display::begin(XPT2046_Touchscreen* ts, Adafruit_GFX* disp) {
+  this->ts = ts;
+  this->disp = disp;
+  setTS_calibration(HOST_TS_LR_X, HOST_TS_LR_Y, HOST_TS_UL_X, HOST_TS_UL_Y);
+}
+
+void TS_Display::getTS_calibration(int16_t* TS_LR_X, int16_t* TS_LR_Y, int16_t* TS_UL_X,
+    int16_t* TS_UL_Y) {
+  *TS_LR_X = LR_X;
+  *TS_LR_Y = LR_Y;
+  *TS_UL_X = UL_X;
+  *TS_UL_Y = UL_Y;
+}
+
+void TS_Display::setTS_calibration(int16_t TS_LR_X, int16_t TS_LR_Y, int16_t TS_UL_X,
+    int16_t TS_UL_Y) {
+  LR_X = TS_LR_X;
+  LR_Y = TS_LR_Y;
+  UL_X = TS_UL_X;
+  UL_Y = TS_UL_Y;
+}
+
+void TS_Display::mapTStoDisplay(int16_t xTS, int16_t yTS, int16_t* pxDisp,
+    int16_t* pyDisp) {
+  *pxDisp = (LR_X == UL_X) ? 0 :
+    (int32_t) (xTS - UL_X) * (disp->width() - 1) / (LR_X - UL_X);
+  *pyDisp = (LR_Y == UL_Y) ? 0 :
+    (int32_t) (yTS - UL_Y) * (disp->height() - 1) / (LR_Y - UL_Y);
+}
+
+void TS_Display::GetCalibration_UL_LR(int16_t pad, int16_t* x_UL, int16_t* y_UL,
+    int16_t* x_LR, int16_t* y_LR) {
+  *x_UL = pad;
+  *y_UL = pad;
+  *x_LR = disp->width() - 1 - pad;
+  *y_LR = disp->height() - 1 - pad;
+}
+
+void TS_Display::findTS_calibration(int16_t x_UL, int16_t y_UL, int16_t x_LR, int16_t y_LR,
+    int16_t TSx_UL, int16_t TSy_UL, int16_t TSx_LR, int16_t TSy_LR, int16_t* TS_LR_X,
+    int16_t* TS_LR_Y, int16_t* TS_UL_X, int16_t* TS_UL_Y) {
+  // Extrapolate the line through the two points to the corner pixels.
+  float xScale = (float) (TSx_LR - TSx_UL) / (x_LR - x_UL);
+  float yScale = (float) (TSy_LR - TSy_UL) / (y_LR - y_UL);
+  *TS_UL_X = (int16_t) lroundf(TSx_UL - x_UL * xScale);
+  *TS_UL_Y = (int16_t) lroundf(TSy_UL - y_UL * yScale);
+  *TS_LR_X = (int16_t) lroundf(TSx_UL + (disp->width() - 1 - x_UL) * xScale);
+  *TS_LR_Y = (int16_t) lroundf(TSy_UL + (disp->height() - 1 - y_UL) * yScale);
+}
+
+eTouchEvent TS_Display::getTouchEvent(int16_t& x, int16_t& y, int16_t& pres, int16_t* rawX,
+    int16_t* rawY) {
+  bool touched = ts->touched();
+  if (touched) {
+    TS_Point p = ts->getPoint();
+    mapTStoDisplay(p.x, p.y, &x, &y);
+    pres = p.z;
+    if (rawX != NULL) *rawX = p.x;
+    if (rawY != NULL) *rawY = p.y;
+  }
+  eTouchEvent event = touched ? (Touched ? TS_TOUCH_PRESENT : TS_TOUCH_EVENT) :
+    (Touched ? TS_RELEASE_EVENT : TS_NO_TOUCH);
+  Touched = touched;
+  return(event);
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
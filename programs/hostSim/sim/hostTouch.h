@@ -0,0 +1,73 @@
+/*
+  hostTouch.h - Host simulation of touches of the XPT2046 touchscreen, standing in for
+  XPT2046_Touchscreen_TT and TS_Display.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef hostTouch_h
+#define hostTouch_h
+
+#include <Arduino.h>
+
+// Touches are scripted in display coordinates of the portrait (240x320) screen. The
+// touchscreen reports them in raw touchscreen coordinates given by this calibration, which
+// TS_Display uses by default, so default settings map touches back to the same points.
+#define HOST_TS_UL_X 3750
+#define HOST_TS_UL_Y 3800
+#define HOST_TS_LR_X 330
+#define HOST_TS_LR_Y 250
+#define HOST_TS_WIDTH 240
+#define HOST_TS_HEIGHT 320
+
+// Pressure of a touch, and the time a read of the touchscreen controller takes.
+#define HOST_TS_PRESSURE 1500
+#define HOST_TS_READ_US 40
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Touch the screen at (x,y) for durationMS ms from millis() startMS.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostTouchAt(uint32_t startMS, uint32_t durationMS, int16_t x, int16_t y);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Remove all scripted touches.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void hostClearTouches(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return true if the screen is being touched now, with the point in (*x,*y) if not NULL.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool hostTouching(int16_t* x = NULL, int16_t* y = NULL);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of reads of the touchscreen controller over the SPI bus.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t hostTouchReads(void);
+
+#endif // hostTouch_h
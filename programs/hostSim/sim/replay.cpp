@@ -0,0 +1,96 @@
+/*
+  replay.cpp - Replay a temperature trace through the SmartVent Thermostat control code
+  on the host.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "nonvolatileSettings.h"
+#include "pinSettings.h"
+#include "temperature.h"
+#include "smartVentControl.h"
+#include "controlSim.h"
+#include "replay.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Replay trace through the firmware.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void replayTrace(const temperatureTrace& trace, const nonvolatileSettings& settings,
+    const replayOptions& options, replayResult& result) {
+  memset(&result, 0, sizeof(result));
+  houseModel house = options.house;
+  float indoorC, outdoorC;
+  trace.at(0, indoorC, outdoorC);
+  house.indoorC = indoorC;
+  setTemperaturesC(indoorC, outdoorC);
+  hostSetADCnoise(options.noiseCodes, 1);
+  controlSimOptions simOptions;
+  simOptions.monitor = options.monitor;
+  setupControlSim(settings, simOptions);
+
+  uint64_t startMS = controlSimMS();
+  uint64_t endMS = startMS + trace.lengthMS();
+  uint64_t lastMS = startMS;
+  uint32_t readsAtWarmup = 0;
+  bool warmedUp = false;
+  result.maxIndoorF = -1000;
+  while (lastMS < endMS) {
+    uint64_t MS = controlSimMS();
+    trace.at(MS - startMS, indoorC, outdoorC);
+    if (options.closedLoop) {
+      house.advance(lastMS - startMS, MS - lastMS, outdoorC, getSmartVent());
+      indoorC = house.indoorC;
+    }
+    float indoorF = degCtoF(indoorC);
+
+    // Clear the statistics once the filters have settled.
+    if (!warmedUp && MS - startMS >= options.warmupMS) {
+      warmedUp = true;
+      clearSmartVentStatistics();
+      readsAtWarmup = controlSimReads();
+      result.statsMS = endMS - MS;
+    }
+    if (warmedUp) {
+      if (indoorF > options.comfortF)
+        result.discomfortFh += (indoorF - options.comfortF) * ((MS - lastMS) / 3600000.0f);
+      result.maxIndoorF = max(result.maxIndoorF, indoorF);
+    }
+
+    setTemperaturesC(indoorC, outdoorC);
+    lastMS = MS;
+    loopControlSim();
+  }
+  result.stats = SmartVentStats;
+  result.reads = controlSimReads() - readsAtWarmup;
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
@@ -0,0 +1,84 @@
+/*
+  replay.h - Replay a temperature trace through the SmartVent Thermostat control code on
+  the host.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef replay_h
+#define replay_h
+
+#include <Arduino.h>
+#include "nonvolatileSettings.h"
+#include "smartVentControl.h"
+#include "weather.h"
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// Options for replayTrace().
+struct replayOptions {
+  // Time in ms after which SmartVentStats are cleared, so that they leave out the start-up
+  // of the temperature filters. It must be less than the length of the trace.
+  uint32_t warmupMS = 60*60*1000UL;
+  // False to take the indoor temperature from the trace. True to take it from house, whose
+  // starting temperature is set from the trace, so that SmartVent cools the house.
+  bool closedLoop = false;
+  houseModel house;
+  // Indoor °F above which discomfort is accumulated, and standard deviation of the ADC noise
+  // in codes.
+  float comfortF = 76;
+  float noiseCodes = 0;
+  // True to write the serial monitor output to stdout.
+  bool monitor = false;
+};
+
+// Results of replayTrace(), for the time after the warm-up.
+struct replayResult {
+  smartVentStatistics stats;  // SmartVentStats at the end.
+  uint64_t statsMS;           // Time covered by stats.
+  uint32_t reads;             // Temperature reads.
+  float discomfortFh;         // Integral of the indoor temperature above comfortF, °F·hours.
+  float maxIndoorF;           // Highest indoor temperature.
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Run the firmware with settings from the start to the end of trace, setting the simulated
+// thermistors to its temperatures, and return the results in result. This calls
+// setupControlSim(), so it can be called only once per process.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void replayTrace(const temperatureTrace& trace, const nonvolatileSettings& settings,
+  const replayOptions& options, replayResult& result);
+
+#endif // replay_h
@@ -0,0 +1,59 @@
+/*
+  sketchSim.h - Run the SmartVent Thermostat sketch, with its screens, on the simulated
+  hardware.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef sketchSim_h
+#define sketchSim_h
+
+#include <Arduino.h>
+#include "hostSim.h"
+
+// sketchSim.cpp compiles SmartVentThermostat.ino itself, so its setup() and loop() are
+// those of the firmware. The LCD, touchscreen and buttons are simulated by hostLCD.cpp,
+// hostTouch.cpp and hostButtons.cpp.
+
+// Simulated time in us taken by one pass through loop() in addition to what the simulation
+// counts (clock reads, ADC, LCD and touchscreen traffic), for the CPU work in between.
+#define SKETCH_SIM_LOOP_US 50
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Call loop() until millis() reaches untilMS, advancing the clock by SKETCH_SIM_LOOP_US
+// after each pass.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void runSketchUntil(uint32_t untilMS);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return the number of passes through loop() made by runSketchUntil().
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern uint32_t sketchLoopPasses(void);
+
+#endif // sketchSim_h
@@ -0,0 +1,236 @@
+/*
+  weather.cpp - Temperature traces for the SmartVent Thermostat host simulation: CSV
+  files, synthetic summer weather, and a model of the house that SmartVent cools.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "weather.h"
+
+// *************************************************************************************** //
+// Local functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Split CSV line into its fields. Quoting is not supported.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static void splitCSV(const char* line, std::vector<std::string>& fields) {
+  fields.clear();
+  const char* p = line;
+  for (;;) {
+    size_t n = strcspn(p, ",\r\n");
+    fields.push_back(std::string(p, n));
+    if (p[n] != ',')
+      break;
+    p += n + 1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Return a uniformly distributed value in [0, 1) from a linear congruential generator, so
+// that a seed makes the same trace with any standard library.
+/////////////////////////////////////////////////////////////////////////////////////////////
+static double uniform(uint64_t& state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return((state >> 11) * (1.0/9007199254740992.0));
+}
+
+// *************************************************************************************** //
+// Global functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Get the temperatures of the trace at time ms.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void temperatureTrace::at(uint64_t ms, float& indoorC, float& outdoorC) const {
+  if (samples.empty()) {
+    indoorC = outdoorC = 0;
+    return;
+  }
+  // Find the first sample after ms.
+  size_t lo = 0, hi = samples.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (samples[mid].ms <= ms)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0 || lo == samples.size()) {
+    const traceSample& S = samples[lo == 0 ? 0 : lo-1];
+    indoorC = S.indoorC;
+    outdoorC = S.outdoorC;
+    return;
+  }
+  const traceSample& A = samples[lo-1];
+  const traceSample& B = samples[lo];
+  float f = (float)(ms - A.ms) / (float)(B.ms - A.ms);
+  indoorC = A.indoorC + f*(B.indoorC - A.indoorC);
+  outdoorC = A.outdoorC + f*(B.outdoorC - A.outdoorC);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Advance the house's indoor temperature by dtMS. The gain is taken to be constant over the
+// step, so the temperature moves exponentially towards its equilibrium.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void houseModel::advance(uint64_t ms, uint64_t dtMS, float outdoorC, bool ventOn) {
+  double hour = fmod(startHour + ms / 3600000.0, 24.0);
+  double gain = gainCperH * fmax(0.0, sin((hour - 8) * M_PI / 12));
+  double tau = ventOn ? tauOnH : tauOffH;
+  double equilibrium = outdoorC + gain*tau;
+  indoorC = (float)(equilibrium + (indoorC - equilibrium) * exp(-(dtMS / 3600000.0) / tau));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Read a trace from a CSV file.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool readTraceCSV(const char* path, temperatureTrace& trace, std::string& error) {
+  trace.samples.clear();
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    error = std::string("can't open ") + path;
+    return(false);
+  }
+
+  // Find the columns.
+  char line[1024];
+  std::vector<std::string> fields;
+  int msCol = -1, indoorCol = -1, outdoorCol = -1;
+  if (fgets(line, sizeof(line), f) != NULL) {
+    splitCSV(line, fields);
+    for (size_t i = 0; i < fields.size(); i++) {
+      if (fields[i] == "ms") msCol = i;
+      else if (fields[i] == "indoorC") indoorCol = i;
+      else if (fields[i] == "outdoorC") outdoorCol = i;
+    }
+  }
+  if (msCol < 0 || indoorCol < 0 || outdoorCol < 0) {
+    fclose(f);
+    error = std::string(path) + ": first line must name the ms, indoorC and outdoorC columns";
+    return(false);
+  }
+
+  // Read the samples, unwrapping millis().
+  int maxCol = std::max(msCol, std::max(indoorCol, outdoorCol));
+  uint64_t wraps = 0;
+  uint32_t lastMS = 0;
+  int lineNum = 1;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    lineNum++;
+    splitCSV(line, fields);
+    if (fields.size() == 1 && fields[0].empty())
+      continue;
+    char* end[3];
+    traceSample S;
+    uint32_t MS = 0;
+    if ((int) fields.size() > maxCol) {
+      MS = (uint32_t) strtoul(fields[msCol].c_str(), &end[0], 10);
+      S.indoorC = strtof(fields[indoorCol].c_str(), &end[1]);
+      S.outdoorC = strtof(fields[outdoorCol].c_str(), &end[2]);
+    }
+    if ((int) fields.size() <= maxCol || *end[0] != 0 || *end[1] != 0 || *end[2] != 0) {
+      fclose(f);
+      error = std::string(path) + ": bad line " + std::to_string(lineNum);
+      return(false);
+    }
+    if (!trace.samples.empty() && MS < lastMS)
+      wraps += 1ULL << 32;
+    lastMS = MS;
+    S.ms = wraps + MS;
+    trace.samples.push_back(S);
+  }
+  fclose(f);
+  if (trace.samples.empty()) {
+    error = std::string(path) + ": no samples";
+    return(false);
+  }
+
+  // Make the trace start at time 0.
+  uint64_t startMS = trace.samples[0].ms;
+  for (traceSample& S : trace.samples)
+    S.ms -= startMS;
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write a trace to a CSV file.
+/////////////////////////////////////////////////////////////////////////////////////////////
+bool writeTraceCSV(const char* path, const temperatureTrace& trace) {
+  FILE* f = fopen(path, "w");
+  if (f == NULL)
+    return(false);
+  fprintf(f, "ms,indoorC,outdoorC\n");
+  for (const traceSample& S : trace.samples)
+    fprintf(f, "%llu,%.2f,%.2f\n", (unsigned long long) S.ms, S.indoorC, S.outdoorC);
+  return(fclose(f) == 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Make a trace of days of summer weather. Each day's mean temperature and daily range are
+// set at its noon and interpolated in between.
+/////////////////////////////////////////////////////////////////////////////////////////////
+void makeSummerTrace(temperatureTrace& trace, uint32_t days, uint32_t seed, uint32_t stepS,
+    houseModel house) {
+  uint64_t state = seed;
+  std::vector<float> means, ranges;
+  for (uint32_t d = 0; d <= days + 1; d++) {
+    means.push_back((float)(22 + 6*uniform(state)));
+    ranges.push_back((float)(12 + 10*uniform(state)));
+  }
+
+  trace.samples.clear();
+  house.startHour = 0;
+  uint64_t stepMS = (uint64_t) stepS * 1000;
+  for (uint64_t ms = 0; ms <= days * 86400000ULL; ms += stepMS) {
+    double day = ms / 86400000.0 + 0.5;
+    uint32_t d = (uint32_t) day;
+    double f = day - d;
+    double mean = means[d] + f*(means[d+1] - means[d]);
+    double range = ranges[d] + f*(ranges[d+1] - ranges[d]);
+    double hour = fmod(ms / 3600000.0, 24.0);
+    traceSample S;
+    S.ms = ms;
+    S.outdoorC = (float)(mean + range/2 * sin((hour - 11) * M_PI / 12));
+    if (ms > 0)
+      house.advance(ms - stepMS, stepMS, S.outdoorC, false);
+    else
+      house.indoorC = (float) mean + 2;
+    S.indoorC = house.indoorC;
+    trace.samples.push_back(S);
+  }
+}
+
+// *************************************************************************************** //
+// End.
+// *************************************************************************************** //
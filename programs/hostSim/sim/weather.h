@@ -0,0 +1,105 @@
+/*
+  weather.h - Temperature traces for the SmartVent Thermostat host simulation: CSV
+  files, synthetic summer weather, and a model of the house that SmartVent cools.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef weather_h
+#define weather_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// *************************************************************************************** //
+// Structs.
+// *************************************************************************************** //
+
+// One sample of a temperature trace.
+struct traceSample {
+  uint64_t ms;              // Time since the start of the trace.
+  float indoorC;            // Indoor temperature in °C.
+  float outdoorC;           // Outdoor temperature in °C.
+};
+
+// A temperature trace, with samples in order of time.
+struct temperatureTrace {
+  std::vector<traceSample> samples;
+
+  // Return the length of the trace in ms.
+  uint64_t lengthMS() const { return(samples.empty() ? 0 : samples.back().ms); }
+
+  // Get the temperatures at time ms, interpolating between samples. Before the first or
+  // after the last sample, its temperatures are used.
+  void at(uint64_t ms, float& indoorC, float& outdoorC) const;
+};
+
+// A house whose indoor temperature approaches the outdoor one with time constant tauOffH
+// hours, or tauOnH hours while SmartVent is on, and is raised by internal and solar gains of
+// up to gainCperH °C per hour at mid-afternoon.
+struct houseModel {
+  float tauOffH = 6.0f;
+  float tauOnH = 0.4f;
+  float gainCperH = 0.25f;
+  float startHour = 0;      // Hour of the day at which time 0 falls.
+  float indoorC = 24.0f;    // Current indoor temperature.
+
+  // Advance the indoor temperature from time ms by dtMS with SmartVent on or off.
+  void advance(uint64_t ms, uint64_t dtMS, float outdoorC, bool ventOn);
+};
+
+// *************************************************************************************** //
+// Functions.
+// *************************************************************************************** //
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Read a trace from CSV file path. Its first line names the columns, which must include ms,
+// indoorC and outdoorC, as in the temperatures.csv file written by decodeTelemetry.py from
+// the thermostat's telemetry; other columns are ignored. A decrease in ms is taken to be a
+// wrap of millis(). Return false and set error if the file can't be read.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool readTraceCSV(const char* path, temperatureTrace& trace, std::string& error);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Write trace to CSV file path with columns ms, indoorC and outdoorC. Return false if the
+// file can't be written.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern bool writeTraceCSV(const char* path, const temperatureTrace& trace);
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Make a trace of days of summer weather starting at midnight, sampled every stepS seconds.
+// The outdoor temperature follows a daily cycle, lowest near dawn, whose mean and range
+// vary randomly from day to day with seed. The indoor temperature is that of house, with
+// SmartVent off.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern void makeSummerTrace(temperatureTrace& trace, uint32_t days, uint32_t seed,
+  uint32_t stepS = 60, houseModel house = houseModel());
+
+#endif // weather_h
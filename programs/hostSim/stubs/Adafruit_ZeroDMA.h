@@ -0,0 +1,100 @@
+/*
+  Adafruit_ZeroDMA.h - Host stand-in for the Adafruit_ZeroDMA library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Adafruit_ZeroDMA_h
+#define Adafruit_ZeroDMA_h
+
+#include <Arduino.h>
+
+// DMA channels, with a single descriptor each. The simulated ADC in hostSim.cpp services a
+// channel whose trigger is ADC_DMAC_ID_RESRDY, and one whose trigger is SERCOM1_DMAC_ID_TX
+// sends its bytes to the simulated LCD of hostLCD.cpp as soon as it is started. Up to
+// HOST_DMA_CHANNELS channels can be allocated.
+
+typedef enum {
+  DMA_STATUS_OK = 0,
+  DMA_STATUS_ERR_NOT_FOUND,
+  DMA_STATUS_ERR_NOT_INITIALIZED,
+  DMA_STATUS_ERR_INVALID_ARG,
+  DMA_STATUS_ERR_IO,
+  DMA_STATUS_ERR_TIMEOUT,
+  DMA_STATUS_BUSY,
+  DMA_STATUS_SUSPEND,
+  DMA_STATUS_ABORTED,
+  DMA_STATUS_JOBSTATUS = -1
+} ZeroDMAstatus;
+
+#define DMA_TRIGGER_ACTON_BEAT 2
+
+enum dma_beat_size {
+  DMA_BEAT_SIZE_BYTE,
+  DMA_BEAT_SIZE_HWORD,
+  DMA_BEAT_SIZE_WORD
+};
+
+struct DmacDescriptor {
+  const volatile void* src;
+  void* dst;
+  uint32_t count;
+  bool srcInc;
+  bool dstInc;
+};
+
+class Adafruit_ZeroDMA {
+public:
+  ZeroDMAstatus allocate(void);
+  void setTrigger(uint8_t trigger) { Trigger = trigger; }
+  void setAction(uint8_t action) {}
+  DmacDescriptor* addDescriptor(void* src, void* dst, uint32_t count,
+    dma_beat_size size = DMA_BEAT_SIZE_BYTE, bool srcInc = true, bool dstInc = true) {
+    Desc = DmacDescriptor{ src, dst, count, srcInc, dstInc };
+    return(&Desc);
+  }
+  void changeDescriptor(DmacDescriptor* d, void* src = NULL, void* dst = NULL,
+    uint32_t count = 0) {
+    if (src != NULL) d->src = src;
+    if (dst != NULL) d->dst = dst;
+    if (count != 0) d->count = count;
+  }
+  void setCallback(void (*callback)(Adafruit_ZeroDMA*)) { Callback = callback; }
+  ZeroDMAstatus startJob(void);
+  void abort(void);
+
+  uint8_t Trigger = 0;
+  DmacDescriptor Desc = { };
+  void (*Callback)(Adafruit_ZeroDMA*) = nullptr;
+  bool Allocated = false;
+  bool Active = false;      // True while a job is in progress.
+  uint32_t Beats = 0;       // Beats done by the job in progress.
+};
+
+#endif // Adafruit_ZeroDMA_h
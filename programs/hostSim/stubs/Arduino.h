@@ -0,0 +1,245 @@
+/*
+  Arduino.h - Host stand-in for the Arduino core, for building SmartVent Thermostat
+  firmware modules on a desktop computer.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+// Only what the firmware modules built by programs/hostSim use is declared here. The
+// functions are implemented by hostSim.cpp on a simulated clock: time advances only when
+// the firmware calls millis(), micros(), delay(), or touches the ADC or SPI registers, or
+// when the simulation advances it, so runs are exactly repeatable and much faster than real
+// time.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+// *************************************************************************************** //
+// Types and constants.
+// *************************************************************************************** //
+
+typedef uint8_t pin_size_t;
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+// Arduino Nano 33 IoT analog pin numbers.
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+// Number of entries in g_APinDescription[]. Pins beyond the board's are used by the
+// simulation for extra thermistors.
+#define NUM_HOST_PINS 64
+
+#define snprintf_P snprintf
+
+template<class T, class L> auto min(const T& a, const L& b) -> decltype((b < a) ? b : a)
+  { return((b < a) ? b : a); }
+template<class T, class L> auto max(const T& a, const L& b) -> decltype((b < a) ? b : a)
+  { return((a < b) ? b : a); }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// The sketch's functions.
+extern void setup(void);
+extern void loop(void);
+
+// *************************************************************************************** //
+// Time and pins.
+// *************************************************************************************** //
+
+extern uint32_t millis(void);
+extern uint32_t micros(void);
+extern void delay(uint32_t ms);
+extern void delayMicroseconds(uint32_t us);
+
+extern void pinMode(pin_size_t pin, int mode);
+extern void digitalWrite(pin_size_t pin, int value);
+extern int digitalRead(pin_size_t pin);
+extern int analogRead(pin_size_t pin);
+
+// *************************************************************************************** //
+// Print.
+// *************************************************************************************** //
+
+// Base class of the serial port, as in the Arduino core.
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len-- > 0)
+      n += write(*buf++);
+    return(n);
+  }
+  virtual int availableForWrite() { return(0); }
+  size_t print(const char* s) { return(write((const uint8_t*) s, strlen(s))); }
+};
+
+// *************************************************************************************** //
+// SAMD21 ADC registers.
+// *************************************************************************************** //
+
+// The ADC registers and bits the firmware uses, laid out as in the SAMD21 CMSIS headers.
+// Reading RESULT and writing INTFLAG behave as in the hardware only as far as the simulated
+// ADC in hostSim.cpp needs: writing ADC_INTFLAG_RESRDY (0 here) to INTFLAG.reg clears the
+// flags, the way writing 1 to them does in the hardware.
+struct AdcRegs {
+  union {
+    struct { uint8_t SWRST:1, ENABLE:1, RUNSTDBY:1, :5; } bit;
+    uint8_t reg;
+  } CTRLA;
+  union {
+    struct { uint16_t DIFFMODE:1, LEFTADJ:1, FREERUN:1, CORREN:1, RESSEL:2, :2, PRESCALER:3,
+      :5; } bit;
+    uint16_t reg;
+  } CTRLB;
+  union {
+    struct { uint32_t MUXPOS:5, :3, MUXNEG:5, :3, INPUTSCAN:4, INPUTOFFSET:4, GAIN:4, :4; } bit;
+    uint32_t reg;
+  } INPUTCTRL;
+  union {
+    struct { uint8_t FLUSH:1, START:1, :6; } bit;
+    uint8_t reg;
+  } SWTRIG;
+  union {
+    struct { uint8_t RESRDY:1, OVERRUN:1, WINMON:1, SYNCRDY:1, :4; } bit;
+    uint8_t reg;
+  } INTFLAG;
+  union {
+    struct { uint8_t :7, SYNCBUSY:1; } bit;
+    uint8_t reg;
+  } STATUS;
+  union {
+    uint16_t reg;
+  } RESULT;
+};
+
+// Each access to ADC advances the simulated clock by 1 us and lets the simulated ADC
+// progress, so that the firmware's register polling loops finish.
+extern volatile AdcRegs* hostADC(void);
+#define ADC (hostADC())
+
+#define ADC_INTFLAG_RESRDY 0
+#define ADC_INPUTCTRL_MUXPOS_Msk (0x1Fu << 0)
+#define ADC_INPUTCTRL_INPUTSCAN_Msk (0xFu << 16)
+#define ADC_INPUTCTRL_INPUTOFFSET_Msk (0xFu << 20)
+#define ADC_INPUTCTRL_MUXPOS(v) ((uint32_t)(v) << 0)
+#define ADC_INPUTCTRL_INPUTSCAN(v) ((uint32_t)(v) << 16)
+#define ADC_DMAC_ID_RESRDY 0x27
+
+// *************************************************************************************** //
+// SAMD21 SERCOM1 SPI registers.
+// *************************************************************************************** //
+
+// The SPI registers of SERCOM1, the SPI bus of the LCD and touchscreen, that screens.cpp
+// uses for LCD DMA transfers, laid out as in the SAMD21 CMSIS headers. DATA is only used as
+// the DMA destination, and INTFLAG.TXC is 1 when the simulated LCD in hostLCD.cpp has
+// finished shifting out the bytes sent to it.
+struct SercomSpiRegs {
+  union {
+    struct { uint32_t CHSIZE:3, :3, PLOADEN:1, :2, SSDE:1, :3, MSSEN:1, AMODE:2, :1, RXEN:1,
+      :14; } bit;
+    uint32_t reg;
+  } CTRLB;
+  union {
+    struct { uint8_t DRE:1, TXC:1, RXC:1, SSL:1, :3, ERROR:1; } bit;
+    uint8_t reg;
+  } INTFLAG;
+  union {
+    struct { uint32_t SWRST:1, ENABLE:1, CTRLB:1, :29; } bit;
+    uint32_t reg;
+  } SYNCBUSY;
+  union {
+    uint32_t reg;
+  } DATA;
+};
+struct SercomRegs {
+  SercomSpiRegs SPI;
+};
+
+// Each access to SERCOM1 advances the simulated clock by 1 us, like ADC.
+extern volatile SercomRegs* hostSERCOM1(void);
+#define SERCOM1 (hostSERCOM1())
+
+#define SERCOM1_DMAC_ID_TX 0x04
+
+// *************************************************************************************** //
+// SAMD21 sleep.
+// *************************************************************************************** //
+
+// The System Control Block and Power Manager registers that set the sleep mode.
+struct ScbRegs {
+  uint32_t SCR;
+};
+struct PmRegs {
+  union {
+    struct { uint8_t IDLE:2, :6; } bit;
+    uint8_t reg;
+  } SLEEP;
+};
+extern ScbRegs hostSCB;
+extern PmRegs hostPM;
+#define SCB (&hostSCB)
+#define PM (&hostPM)
+
+#define SCB_SCR_SLEEPDEEP_Msk (1u << 2)
+#define PM_SLEEP_IDLE_CPU 0x0u
+
+// Wait for interrupt: advance the simulated clock to the next 1 ms SysTick interrupt.
+extern void __WFI(void);
+
+// *************************************************************************************** //
+// Pin descriptions.
+// *************************************************************************************** //
+
+// Pin descriptions, of which only the ADC input number is used.
+struct PinDescription {
+  uint32_t ulADCChannelNumber;
+};
+extern PinDescription g_APinDescription[NUM_HOST_PINS];
+
+#endif // Arduino_h
@@ -0,0 +1,86 @@
+/*
+  Button_TT.h - Host stand-in for the Button_TT library's base button class.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_h
+#define Button_TT_h
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// Color that means "don't draw", for button outlines and fills.
+#define TRANSPARENT_COLOR 0x0120
+
+// A rectangular button on a GFX display, which responds to touches within it, expanded by
+// expU, expD, expL and expR pixels up, down, left and right. Implemented by hostButtons.cpp,
+// which keeps a list of all buttons by name for hostFindButton() (hostButtons.h).
+class Button_TT {
+public:
+  Button_TT(const char* name);
+  virtual ~Button_TT() {}
+
+  // Place the button with its align corner ("TL", "TC", "TR", "CC", "BL", "BC" or "BR" for
+  // top/center/bottom and left/center/right) at (x,y).
+  void initButton(Adafruit_GFX* gfx, const char* align, int16_t x, int16_t y, int16_t w,
+    int16_t h, uint16_t outlineColor, uint16_t fillColor, uint8_t rCorner = 0,
+    uint8_t expU = 0, uint8_t expD = 0, uint8_t expL = 0, uint8_t expR = 0);
+
+  // Draw the fill and then the outline.
+  virtual void drawButton(void);
+
+  const char* getName(void) const { return(Name); }
+  int16_t getLeft(void) const { return(xL); }
+  int16_t getTop(void) const { return(yT); }
+  int16_t getWidth(void) const { return(w); }
+  int16_t getHeight(void) const { return(h); }
+  void setPosition(int16_t x, int16_t y) { xL = x; yT = y; }
+  void setOutlineColor(uint16_t color) { OutlineColor = color; }
+  void setFillColor(uint16_t color) { FillColor = color; }
+
+  // Return true if (x,y) is within the expanded button.
+  bool contains(int16_t x, int16_t y) const;
+
+protected:
+  void align(const char* align, int16_t x, int16_t y);
+  Adafruit_GFX* gfx = NULL;
+  const char* Name;
+  int16_t xL = 0, yT = 0, w = 0, h = 0;
+  uint16_t OutlineColor = TRANSPARENT_COLOR, FillColor = TRANSPARENT_COLOR;
+  uint8_t rCorner = 0;
+  uint8_t expU = 0, expD = 0, expL = 0, expR = 0;
+
+private:
+  friend Button_TT* hostFindButton(const char* name);
+  Button_TT* Next;
+  static Button_TT* First;
+};
+
+#endif // Button_TT_h
@@ -0,0 +1,58 @@
+/*
+  Button_TT_arrow.h - Host stand-in for the Button_TT library's arrow button class.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_arrow_h
+#define Button_TT_arrow_h
+
+#include <Arduino.h>
+#include "Button_TT.h"
+
+// A button showing a triangle pointing left, right, up or down (orient 'L', 'R', 'U' or
+// 'D'), drawn in the outline color.
+class Button_TT_arrow : public Button_TT {
+public:
+  Button_TT_arrow(const char* name) : Button_TT(name) {}
+
+  void initButton(Adafruit_GFX* gfx, char orient, const char* align, int16_t x, int16_t y,
+    int16_t w, int16_t h, uint16_t outlineColor, uint16_t fillColor, uint8_t expU = 0,
+    uint8_t expD = 0, uint8_t expL = 0, uint8_t expR = 0);
+
+  // Draw the fill, outline and triangle.
+  void drawButton(void) override;
+
+  char getOrientation(void) const { return(Orient); }
+
+private:
+  char Orient = 'R';
+};
+
+#endif // Button_TT_arrow_h
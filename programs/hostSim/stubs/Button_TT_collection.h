@@ -0,0 +1,66 @@
+/*
+  Button_TT_collection.h - Host stand-in for the Button_TT library's button collection class.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_collection_h
+#define Button_TT_collection_h
+
+#include <Arduino.h>
+#include "Button_TT.h"
+
+// Maximum number of buttons in a collection.
+#define BUTTON_TT_COLLECTION_SIZE 40
+
+// The buttons of a screen and the functions that handle their presses. press() calls the
+// master function with true and then the function of the first registered button that
+// contains the point, and release() calls the master function with false if a button was
+// pressed. Implemented by hostButtons.cpp.
+class Button_TT_collection {
+public:
+  void clear(void) { NumButtons = 0; }
+  bool registerButton(Button_TT& btn, void (*func)(Button_TT& btn));
+  bool unregisterButton(Button_TT& btn);
+  void registerMasterProcessFunc(void (*func)(bool press)) { MasterFunc = func; }
+  bool press(int16_t x, int16_t y);
+  bool release(void);
+
+private:
+  struct entry {
+    Button_TT* btn;
+    void (*func)(Button_TT& btn);
+  };
+  entry Buttons[BUTTON_TT_COLLECTION_SIZE];
+  uint8_t NumButtons = 0;
+  void (*MasterFunc)(bool press) = NULL;
+  bool Pressed = false;
+};
+
+#endif // Button_TT_collection_h
@@ -0,0 +1,52 @@
+/*
+  Button_TT_int16.h - Host stand-in for the Button_TT library's int16_t field button class.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_int16_h
+#define Button_TT_int16_h
+
+#include "Button_TT_number.h"
+
+// A label button showing an int16_t value.
+class Button_TT_int16 : public Button_TT_number<int16_t> {
+public:
+  Button_TT_int16(const char* name) : Button_TT_number<int16_t>(name) {}
+
+  void initButton(Adafruit_GFX* gfx, const char* align, int16_t x, int16_t y, int16_t w,
+      int16_t h, uint16_t outlineColor, uint16_t fillColor, uint16_t textColor,
+      const char* textAlign, Font_TT* font, uint8_t rCorner, int16_t value, int16_t minValue,
+      int16_t maxValue, bool degreeChar, bool showPlus = false) {
+    initNumber(gfx, align, x, y, w, h, outlineColor, fillColor, textColor, textAlign, font,
+      rCorner, value, minValue, maxValue, degreeChar, showPlus, NULL);
+  }
+};
+
+#endif // Button_TT_int16_h
@@ -0,0 +1,75 @@
+/*
+  Button_TT_label.h - Host stand-in for the Button_TT library's label button class.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_label_h
+#define Button_TT_label_h
+
+#include <Arduino.h>
+#include <Font_TT.h>
+#include <string>
+#include "Button_TT.h"
+
+// A button with a text label, drawn in textColor with font, aligned within the button by
+// textAlign ("C" for centered, or two letters top/center/bottom and left/center/right). A w
+// or h of 0 or less sizes the button for the initial label, with -w or -h pixels added on
+// each side. If degreeChar is true, a small circle follows the label, as a degree sign.
+class Button_TT_label : public Button_TT {
+public:
+  Button_TT_label(const char* name) : Button_TT(name) {}
+
+  void initButton(Adafruit_GFX* gfx, const char* align, int16_t x, int16_t y, int16_t w,
+    int16_t h, uint16_t outlineColor, uint16_t fillColor, uint16_t textColor,
+    const char* textAlign, const char* label, bool degreeChar, Font_TT* font,
+    uint8_t rCorner = 0, uint8_t expU = 0, uint8_t expD = 0, uint8_t expL = 0,
+    uint8_t expR = 0);
+
+  // Draw the fill, outline and label.
+  void drawButton(void) override;
+
+  const char* getLabel(void) const { return(Label.c_str()); }
+  void setLabel(const char* label) { Label = label; }
+
+  // Set the label, and draw the button if it changed or forceDraw is true. Return true if
+  // it was drawn.
+  bool setLabelAndDrawIfChanged(const char* label, bool forceDraw = false);
+
+protected:
+  // Return the width of label drawn with the button's font, including the degree sign.
+  int16_t labelWidth(const char* label) const;
+  std::string Label;
+  uint16_t TextColor = 0;
+  char TextAlignV = 'C', TextAlignH = 'C';
+  bool DegreeChar = false;
+  Font_TT* Font = NULL;
+};
+
+#endif // Button_TT_label_h
@@ -0,0 +1,105 @@
+/*
+  Button_TT_number.h - Numeric field buttons of the host stand-in for the Button_TT library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Button_TT_number_h
+#define Button_TT_number_h
+
+#include <Arduino.h>
+#include "Button_TT_label.h"
+#include "Button_TT_arrow.h"
+
+// A label button showing an integer value between minValue and maxValue, with a leading
+// '+' on positive values if showPlus is true, and shown as zeroString when 0 if that is not
+// NULL. A sized button is sized for the widest value. This is the common part of
+// Button_TT_int16, Button_TT_int8 and Button_TT_uint8, which differ only in the type.
+template<typename T> class Button_TT_number : public Button_TT_label {
+public:
+  Button_TT_number(const char* name) : Button_TT_label(name) {}
+
+  T getValue(void) const { return(Value); }
+
+  // Set the value, and draw the button if it changed or forceDraw is true. Return true if
+  // it was drawn.
+  bool setValueAndDrawIfChanged(T value, bool forceDraw = false) {
+    Value = value;
+    return(setLabelAndDrawIfChanged(format(value).c_str(), forceDraw));
+  }
+
+  // Add n to the value, or subtract it if btn is an arrow pointing left or down, limit it
+  // to the value range, and draw the button if it changed. Return true if it changed.
+  bool valueIncDec(T n, Button_TT* btn = NULL) {
+    Button_TT_arrow* arrow = dynamic_cast<Button_TT_arrow*>(btn);
+    long v = (long) Value + ((arrow != NULL && (arrow->getOrientation() == 'L' ||
+      arrow->getOrientation() == 'D')) ? -(long) n : (long) n);
+    v = constrain(v, (long) MinValue, (long) MaxValue);
+    if (v == Value)
+      return(false);
+    setValueAndDrawIfChanged((T) v);
+    return(true);
+  }
+
+protected:
+  void initNumber(Adafruit_GFX* gfx, const char* align, int16_t x, int16_t y, int16_t w,
+      int16_t h, uint16_t outlineColor, uint16_t fillColor, uint16_t textColor,
+      const char* textAlign, Font_TT* font, uint8_t rCorner, T value, T minValue,
+      T maxValue, bool degreeChar, bool showPlus, const char* zeroString) {
+    MinValue = minValue;
+    MaxValue = maxValue;
+    ShowPlus = showPlus;
+    ZeroString = zeroString;
+    Font = font;
+    DegreeChar = degreeChar;
+    std::string widest = format(minValue);
+    for (T v : { maxValue, (T) 0 })
+      if (v >= minValue && v <= maxValue && labelWidth(format(v).c_str()) >
+          labelWidth(widest.c_str()))
+        widest = format(v);
+    Button_TT_label::initButton(gfx, align, x, y, w, h, outlineColor, fillColor, textColor,
+      textAlign, widest.c_str(), degreeChar, font, rCorner);
+    Value = value;
+    setLabel(format(value).c_str());
+  }
+
+  std::string format(T value) const {
+    if (value == 0 && ZeroString != NULL)
+      return(ZeroString);
+    char S[8];
+    snprintf(S, sizeof(S), (ShowPlus && value > 0) ? "+%ld" : "%ld", (long) value);
+    return(S);
+  }
+
+  T Value = 0, MinValue = 0, MaxValue = 0;
+  bool ShowPlus = false;
+  const char* ZeroString = NULL;
+};
+
+#endif // Button_TT_number_h
@@ -0,0 +1,78 @@
+/*
+  FlashStorage_SAMD.h - Host stand-in for the FlashStorage_SAMD library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FlashStorage_SAMD_h
+#define FlashStorage_SAMD_h
+
+#include <Arduino.h>
+
+// Flash and EEPROM emulation backed by RAM, implemented by hostSim.cpp. Erasing sets bytes to
+// 0xFF and writing can only clear bits, as in the flash, and erases are counted per row so
+// that wear can be measured. hostSim.h has the functions that set up and inspect them.
+
+#ifndef EEPROM_EMULATION_SIZE
+#define EEPROM_EMULATION_SIZE 1024
+#endif
+
+class FlashClass {
+public:
+  // The flash area is a const array of the firmware, which is made writable here.
+  FlashClass(const void* flash_addr = nullptr, uint32_t size = 0);
+  void write(const volatile void* flash_ptr, const void* data, uint32_t size);
+  void erase(const volatile void* flash_ptr, uint32_t size);
+  void read(const volatile void* flash_ptr, void* data, uint32_t size);
+};
+
+class EEPROMClass {
+public:
+  uint8_t read(int address);
+  void update(int address, uint8_t value);
+  void write(int address, uint8_t value) { update(address, value); }
+  template<class T> T& get(int address, T& t) {
+    for (size_t i = 0; i < sizeof(T); i++)
+      ((uint8_t*) &t)[i] = read(address + i);
+    return(t);
+  }
+  template<class T> const T& put(int address, const T& t) {
+    for (size_t i = 0; i < sizeof(T); i++)
+      update(address + i, ((const uint8_t*) &t)[i]);
+    return(t);
+  }
+  bool isValid(void);
+  void commit(void);
+  uint16_t length(void) { return(EEPROM_EMULATION_SIZE); }
+};
+
+// In the library, this is defined by the one file that includes FlashStorage_SAMD.h.
+extern EEPROMClass EEPROM;
+
+#endif // FlashStorage_SAMD_h
@@ -0,0 +1,54 @@
+/*
+  Font_TT.h - Host stand-in for the Font_TT library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef Font_TT_h
+#define Font_TT_h
+
+#include <Arduino.h>
+#include <gfxfont.h>
+
+// A GFX font, and the size of text drawn with it. Implemented by hostButtons.cpp.
+class Font_TT {
+public:
+  Font_TT(const GFXfont* font) : Font(font) {}
+  const GFXfont* getFont(void) const { return(Font); }
+
+  // Set (*x1,*y1) and (*w,*h) to the upper left corner and size of the pixels of str drawn
+  // with the cursor at (x,y), and (*xf,*yf) to the cursor position after drawing it.
+  void getTextBounds(const char* str, int16_t x, int16_t y, int16_t* x1, int16_t* y1,
+    uint16_t* w, uint16_t* h, int16_t* xf = NULL, int16_t* yf = NULL) const;
+
+private:
+  const GFXfont* Font;
+};
+
+#endif // Font_TT_h
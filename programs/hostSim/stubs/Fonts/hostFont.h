@@ -0,0 +1,63 @@
+/*
+  hostFont.h - Stand-in fonts for the Adafruit GFX library fonts.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef hostFont_h
+#define hostFont_h
+
+#include <gfxfont.h>
+
+// The stand-in fonts have the metrics of the library's fonts of the same names, measured
+// from their digits, but each glyph is a 5x7 dot matrix character scaled to the font's
+// glyph size, so that text has about the same size and number of pixels. The bitmaps are
+// built by hostMakeFont() in hostGFX.cpp when the program starts. Characters 0x20-0x7E.
+
+// Number of characters in a font, and bytes of bitmap of glyphs of size w x h.
+#define HOST_FONT_CHARS 95
+#define HOST_FONT_BITMAP_BYTES(w, h) (HOST_FONT_CHARS * (((w)*(h) + 7) / 8))
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Fill bitmap and glyphs with glyphs of width w and height h that advance the cursor by
+// xAdvance, and return 0.
+/////////////////////////////////////////////////////////////////////////////////////////////
+extern int hostMakeFont(uint8_t* bitmap, GFXglyph* glyphs, uint8_t w, uint8_t h,
+  uint8_t xAdvance);
+
+// Define font name, with glyphs of size w x h that advance by xAdvance, and line spacing
+// yAdvance.
+#define HOST_FONT(name, w, h, xAdvance, yAdvance) \
+  static uint8_t name##Bitmaps[HOST_FONT_BITMAP_BYTES(w, h)]; \
+  static GFXglyph name##Glyphs[HOST_FONT_CHARS]; \
+  static int name##Made __attribute__((unused)) = \
+    hostMakeFont(name##Bitmaps, name##Glyphs, w, h, xAdvance); \
+  const GFXfont name = { name##Bitmaps, name##Glyphs, 0x20, 0x7E, yAdvance }
+
+#endif // hostFont_h
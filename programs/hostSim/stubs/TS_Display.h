@@ -0,0 +1,87 @@
+/*
+  TS_Display.h - Host stand-in for the TS_Display library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef TS_Display_h
+#define TS_Display_h
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <XPT2046_Touchscreen_TT.h>
+
+// Touch events returned by getTouchEvent().
+typedef enum _eTouchEvent {
+  TS_NO_TOUCH,        // Not touched.
+  TS_UNCERTAIN,       // Not clear whether touched (not returned by the stand-in).
+  TS_TOUCH_PRESENT,   // Still touched.
+  TS_TOUCH_EVENT,     // Touched, not touched before.
+  TS_RELEASE_EVENT    // Not touched, touched before.
+} eTouchEvent;
+
+// Maps touchscreen coordinates to display coordinates with a linear calibration given by
+// the touchscreen coordinates of the display's upper left (UL) and lower right (LR)
+// pixels, and turns touches into touch and release events. Implemented by hostTouch.cpp.
+class TS_Display {
+public:
+  void begin(XPT2046_Touchscreen* ts, Adafruit_GFX* disp);
+
+  void getTS_calibration(int16_t* TS_LR_X, int16_t* TS_LR_Y, int16_t* TS_UL_X,
+    int16_t* TS_UL_Y);
+  void setTS_calibration(int16_t TS_LR_X, int16_t TS_LR_Y, int16_t TS_UL_X,
+    int16_t TS_UL_Y);
+
+  // Map touchscreen point (xTS,yTS) to display point (*pxDisp,*pyDisp).
+  void mapTStoDisplay(int16_t xTS, int16_t yTS, int16_t* pxDisp, int16_t* pyDisp);
+
+  // Get the display points pad pixels in from the upper left and lower right corners, for
+  // the user to touch to calibrate.
+  void GetCalibration_UL_LR(int16_t pad, int16_t* x_UL, int16_t* y_UL, int16_t* x_LR,
+    int16_t* y_LR);
+
+  // Find the calibration from the touchscreen points (TSx_UL,TSy_UL) and (TSx_LR,TSy_LR)
+  // touched at display points (x_UL,y_UL) and (x_LR,y_LR).
+  void findTS_calibration(int16_t x_UL, int16_t y_UL, int16_t x_LR, int16_t y_LR,
+    int16_t TSx_UL, int16_t TSy_UL, int16_t TSx_LR, int16_t TSy_LR, int16_t* TS_LR_X,
+    int16_t* TS_LR_Y, int16_t* TS_UL_X, int16_t* TS_UL_Y);
+
+  // Return the touch event, with the display point and pressure of a touch in (x,y) and
+  // pres, and its touchscreen point in (*rawX,*rawY).
+  eTouchEvent getTouchEvent(int16_t& x, int16_t& y, int16_t& pres, int16_t* rawX = NULL,
+    int16_t* rawY = NULL);
+
+private:
+  XPT2046_Touchscreen* ts = NULL;
+  Adafruit_GFX* disp = NULL;
+  int16_t LR_X, LR_Y, UL_X, UL_Y;
+  bool Touched = false;
+};
+
+#endif // TS_Display_h
@@ -0,0 +1,70 @@
+/*
+  XPT2046_Touchscreen_TT.h - Host stand-in for the XPT2046_Touchscreen_TT library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef _XPT2046_Touchscreen_TT_h_
+#define _XPT2046_Touchscreen_TT_h_
+
+#include <Arduino.h>
+
+// Default pressure threshold of a touch.
+#define Z_THRESHOLD 400
+
+// A touchscreen point in raw touchscreen coordinates, with pressure z.
+class TS_Point {
+public:
+  TS_Point(void) : x(0), y(0), z(0) {}
+  TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+  int16_t x, y, z;
+};
+
+// The XPT2046 touchscreen controller on the SPI bus, touched as scripted by hostTouchAt()
+// (hostTouch.h). Its TOUCH_IRQ output reads LOW while the screen is touched. Implemented by
+// hostTouch.cpp.
+class XPT2046_Touchscreen {
+public:
+  XPT2046_Touchscreen(uint8_t cspin, uint8_t tirq = 255);
+  bool begin(void);
+  TS_Point getPoint(void);
+  bool touched(void);
+  void setRotation(uint8_t n) { Rotation = n % 4; }
+  void setThresholds(int16_t z) { Threshold = z; }
+
+private:
+  void update(void);
+  uint8_t Rotation = 1;
+  int16_t Threshold = Z_THRESHOLD;
+  uint32_t LastReadUS = 0;
+  bool HaveRead = false;
+  TS_Point Point;
+};
+
+#endif // _XPT2046_Touchscreen_TT_h_
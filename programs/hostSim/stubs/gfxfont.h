@@ -0,0 +1,58 @@
+/*
+  gfxfont.h - Host stand-in for the Adafruit GFX library's font structures.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef gfxfont_h
+#define gfxfont_h
+
+#include <stdint.h>
+
+// A font glyph: its bitmap, packed 1 bit per pixel in rows from the most significant bit,
+// and its placement relative to the text cursor, which is at its baseline.
+typedef struct {
+  uint16_t bitmapOffset;    // Offset of the glyph's bitmap in GFXfont.bitmap.
+  uint8_t width;            // Bitmap size in pixels.
+  uint8_t height;
+  uint8_t xAdvance;         // Distance to advance the cursor.
+  int8_t xOffset;           // Position of the upper left corner of the bitmap.
+  int8_t yOffset;
+} GFXglyph;
+
+// A font: glyphs for characters first through last.
+typedef struct {
+  uint8_t* bitmap;          // Bitmaps of all glyphs.
+  GFXglyph* glyph;          // Glyphs.
+  uint16_t first;           // First and last character.
+  uint16_t last;
+  uint8_t yAdvance;         // Line spacing.
+} GFXfont;
+
+#endif // gfxfont_h
@@ -0,0 +1,69 @@
+/*
+  msToString.h - Host stand-in for the msToString library.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef msToString_h
+#define msToString_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Format ms as fields separated by ':', hours if showHours, minutes if showMinutes, seconds
+// if showSeconds, into S of size N, and return S. The first field has at least minDigits
+// digits and the others have 2, e.g. "00:12:48" for 768000 ms with all fields and
+// minDigits 2.
+inline char* msToString(uint32_t ms, char* S, size_t N, bool showHours, bool showMinutes,
+    bool showSeconds, uint8_t minDigits) {
+  uint32_t seconds = ms / 1000;
+  uint32_t fields[3] = { seconds / 3600, (seconds / 60) % 60, seconds % 60 };
+  bool show[3] = { showHours, showMinutes, showSeconds };
+  // A leading field holds everything above it, e.g. minutes without hours.
+  if (!showHours)
+    fields[1] += fields[0] * 60;
+  if (!showHours && !showMinutes)
+    fields[2] += fields[1] * 60;
+  size_t n = 0;
+  if (N > 0)
+    S[0] = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (!show[i])
+      continue;
+    int k = snprintf(S + n, N - n, n == 0 ? "%0*lu" : ":%0*lu", n == 0 ? minDigits : 2,
+      (unsigned long) fields[i]);
+    if (k < 0 || (size_t) k >= N - n)
+      break;
+    n += k;
+  }
+  return(S);
+}
+
+#endif // msToString_h
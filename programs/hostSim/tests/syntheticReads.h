@@ -0,0 +1,104 @@
+/*
+  syntheticReads.h - Synthetic thermistor reads for the host tests: the indoor thermistor on a
+  noisy 12-bit ADC, with occasional spikes.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef syntheticReads_h
+#define syntheticReads_h
+
+// Thermistors[0] with its series resistor, read with a 12-bit ADC. The noise is Gaussian
+// with an sd in ADC codes, and spikes add or subtract 80-160 codes (about 2-4°C near room
+// temperature). Included by test programs only, after temperature.h.
+
+#include <algorithm>
+#include <random>
+
+// Full scale of the 12-bit ADC.
+#define ADC_MAX 4095
+
+// Return temperature Tc in °C as a tempValue, and tempValue T in °C.
+static tempValue toTempValue(double Tc) {
+  #if USE_FIXED_POINT_TEMPS
+  return(floatToFixedTemp(Tc));
+  #else
+  return((tempValue) Tc);
+  #endif
+}
+static double toC(tempValue T) {
+  #if USE_FIXED_POINT_TEMPS
+  return(fixedTempToFloat(T));
+  #else
+  return(T);
+  #endif
+}
+
+// Return the Steinhart-Hart temperature in °C of thermistor resistance R.
+static double thermistorC(double R) {
+  const thermistor& th = Thermistors[0];
+  double lnR = log(R);
+  return(1 / (th.A + th.B * lnR + th.C * lnR * lnR * lnR) - 273.15);
+}
+
+// Return the thermistor resistance at temperature Tc in °C. Steinhart-Hart is a cubic in
+// ln R with no squared term, solved here with Cardano's formula.
+static double thermistorR(double Tc) {
+  const thermistor& th = Thermistors[0];
+  double p = th.B / th.C, q = (th.A - 1 / (Tc + 273.15)) / th.C;
+  double y = sqrt(p * p * p / 27 + q * q / 4);
+  return(exp(cbrt(-q / 2 + y) + cbrt(-q / 2 - y)));
+}
+
+// Random source of synthetic reads.
+struct syntheticReads {
+  std::mt19937 gen;
+  std::normal_distribution<double> noise{0, 1};
+  std::uniform_real_distribution<double> uniform{0, 1};
+
+  explicit syntheticReads(uint32_t seed) : gen(seed) {}
+
+  // Return a uniform random number in [0, 1).
+  double random() { return(uniform(gen)); }
+
+  // Return the temperature read at true temperature Tc °C, with noiseCodes (sd) of ADC
+  // noise and a spike in fraction spikes of the reads.
+  tempValue read(double Tc, double noiseCodes, double spikes) {
+    double Rs = Thermistors[0].seriesResistor;
+    double Vo = ADC_MAX * Rs / (Rs + thermistorR(Tc));
+    if (noiseCodes > 0)
+      Vo += noiseCodes * noise(gen);
+    if (spikes > 0 && random() < spikes)
+      Vo += (random() < 0.5 ? -1 : 1) * (80 + 80 * random());
+    long code = std::max(5L, std::min(lround(Vo), (long) ADC_MAX - 1));
+    return(toTempValue(thermistorC(Rs * ((double) ADC_MAX / code - 1))));
+  }
+};
+
+#endif // syntheticReads_h
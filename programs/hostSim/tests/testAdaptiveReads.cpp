@@ -0,0 +1,239 @@
+/*
+  testAdaptiveReads.cpp - Test of the adaptive temperature read interval: reads per day and
+  relay timing against fixed-rate reads, on synthetic days.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Each day (after a 2 hour warm-up) has a daily outdoor cycle with a random mean and swing,
+// and sometimes a cold front, and an indoor temperature driven by it and by solar gain. In
+// closed-loop runs the SmartVent fan pulls the indoor temperature toward the outdoor one.
+// The real updateSmartVentOnOff(), filter and trend code run at 1 s steps, with reads as in
+// syntheticReads.h made either every TEMPERATURE_READ_TIME_MS or at the interval returned
+// by getTemperatureReadIntervalMS(). The noise of each read depends only on the day and
+// second, so all runs see the same noise at the same instant. Their relay changes are
+// compared with those of a run that controls on the exact temperatures.
+
+#include <Arduino.h>
+#include <vector>
+#include "pinSettings.h"
+#include "nonvolatileSettings.h"
+#include "temperature.h"
+#include "temperatureTrend.h"
+#include "smartVentControl.h"
+#include "hostSim.h"
+#include "syntheticReads.h"
+#include "hostTest.h"
+
+// Number of days simulated.
+#define NUM_DAYS 30
+
+// Ways of reading the temperatures.
+enum readMode { FIXED_RATE, ADAPTIVE, EXACT };
+
+// Result of one day: number of reads, and the relay changes, in seconds, negative for off.
+struct dayResult {
+  long reads;
+  std::vector<double> changes;
+};
+
+// Set Temp to filtered temperature Tc.
+static void setTemperature(temperature& Temp, tempValue Tc) {
+  #if USE_FIXED_POINT_TEMPS
+  Temp.Tc_fixed = Tc;
+  #endif
+  Temp.Tc = toC(Tc);
+  Temp.Tf = degCtoF(Temp.Tc);
+}
+
+// Return the temperature read at Tc °C with the noise of read number seed.
+static tempValue readAt(uint32_t seed, double Tc) {
+  syntheticReads reads(seed);
+  return(reads.read(Tc, 3, 0.01));
+}
+
+// Simulate day with reads made as in mode, closed loop if closedLoop.
+static dayResult runDay(int day, readMode mode, bool closedLoop) {
+  syntheticReads weather(1000 + day);
+  double mean = 22 + 6 * weather.random(), swing = 6 + 5 * weather.random();
+  double front = (weather.random() < 0.3) ? -4 * weather.random() : 0;
+  double frontHour = 12 + 10 * weather.random();
+  auto outdoorAt = [&](double hour) {
+    return(mean + swing * sin((hour - 9) * M_PI / 12) + (hour > frontHour ? front : 0));
+  };
+
+  double indoor = 24;
+  uint32_t seedBase = day * 100000000u;
+  BoxcarFilter<NUM_TEMPS_RUNNING_AVG> indoorFilter, outdoorFilter;
+  tempValue readIn = readAt(seedBase, indoor), readOut = readAt(seedBase + 1, outdoorAt(0));
+  indoorFilter.reset(readIn);
+  outdoorFilter.reset(readOut);
+  setTemperature(curIndoorTemperature, readIn);
+  setTemperature(curOutdoorTemperature, readOut);
+  uint32_t startMS = millis();
+  resetTemperatureTrend(IndoorTrend, toC(readIn), startMS);
+  resetTemperatureTrend(OutdoorTrend, toC(readOut), startMS);
+  setSmartVent(false);
+  ArmState = ARM_AWAIT_ON;
+  RunTimeMS = 0;
+
+  dayResult result = { 0, {} };
+  bool recording = false, relayOn = false;
+  uint32_t nextReadMS = TEMPERATURE_READ_TIME_MS, lastReadMS = 0;
+  const uint32_t warmupMS = 2 * 3600000UL, endMS = warmupMS + 24 * 3600000UL;
+  for (uint32_t ms = 1000; ms <= endMS; ms += 1000) {
+    hostAdvanceUS(1000000);
+    double hour = ms / 3600000.0, outdoor = outdoorAt(hour);
+    double gain = 1.5 * std::max(0.0, sin((hour - 8) * M_PI / 12));
+    double tauHours = (closedLoop && relayOn) ? 0.4 : 6.0;
+    indoor += ((outdoor - indoor) / tauHours + gain / 6) / 3600;
+    if (ms == warmupMS) {
+      recording = true;
+      result.reads = 0;
+    }
+
+    if (mode == EXACT) {
+      IndoorTrend.Tc = indoor;
+      OutdoorTrend.Tc = outdoor;
+    } else if (ms >= nextReadMS) {
+      uint32_t periods = (ms - lastReadMS + TEMPERATURE_READ_TIME_MS / 2) /
+        TEMPERATURE_READ_TIME_MS;
+      if (periods == 0)
+        periods = 1;
+      lastReadMS = ms;
+      uint32_t seed = seedBase + 2 * (ms / 1000);
+      readIn = readAt(seed, indoor);
+      readOut = readAt(seed + 1, outdoor);
+      setTemperature(curIndoorTemperature, indoorFilter.update(readIn, periods));
+      setTemperature(curOutdoorTemperature, outdoorFilter.update(readOut, periods));
+      updateTemperatureTrend(IndoorTrend, toC(readIn), startMS + ms);
+      updateTemperatureTrend(OutdoorTrend, toC(readOut), startMS + ms);
+      result.reads++;
+      nextReadMS = ms + (mode == ADAPTIVE ? getTemperatureReadIntervalMS() :
+        TEMPERATURE_READ_TIME_MS);
+    }
+
+    updateSmartVentOnOff();
+    if (getSmartVent() != relayOn) {
+      relayOn = !relayOn;
+      if (recording)
+        result.changes.push_back(relayOn ? ms / 1000.0 : -(ms / 1000.0));
+    }
+  }
+  return(result);
+}
+
+// Relay changes of one read mode compared with those of the exact temperatures.
+struct changeTiming {
+  int matched = 0, extra = 0, missed = 0;
+  double sum = 0, sumSq = 0, minLate = 0, maxLate = 0;
+
+  // Match each change in ref to the nearest unmatched change in the same direction in R,
+  // within an hour.
+  void add(const dayResult& R, const dayResult& ref) {
+    std::vector<bool> used(R.changes.size());
+    for (double change : ref.changes) {
+      int best = -1;
+      double bestDist = 3600;
+      for (size_t i = 0; i < R.changes.size(); i++) {
+        double dist = fabs(fabs(R.changes[i]) - fabs(change));
+        if (!used[i] && (R.changes[i] > 0) == (change > 0) && dist <= bestDist) {
+          best = i;
+          bestDist = dist;
+        }
+      }
+      if (best < 0) {
+        missed++;
+        continue;
+      }
+      used[best] = true;
+      double late = fabs(R.changes[best]) - fabs(change);
+      matched++;
+      sum += late;
+      sumSq += late * late;
+      minLate = std::min(minLate, late);
+      maxLate = std::max(maxLate, late);
+    }
+    for (bool u : used)
+      if (!u)
+        extra++;
+  }
+
+  double mean() const { return(sum / matched); }
+  double sd() const { return(sqrt(std::max(0.0, sumSq / matched - mean() * mean()))); }
+
+  void print(const char* name) const {
+    printf("  %-9s %3d matched, late by %+6.1f s (sd %5.1f, %+5.0f to %+5.0f), "
+      "%d extra, %d missed\n", name, matched, mean(), sd(), minLate, maxLate, extra, missed);
+  }
+};
+
+int main() {
+  activeSettings = settingDefaults;
+  activeSettings.SmartVentMode = MODE_AUTO;
+  activeSettings.TempSetpointOn = 72;
+  activeSettings.DeltaTempForOn = 3;
+  activeSettings.Hysteresis = 1;
+  activeSettings.MaxRunTimeHours = 0;
+  activeSettings.DeltaNewDayTemp = 2;
+  activeSettings.IndoorOffsetF = 0;
+  activeSettings.OutdoorOffsetF = 0;
+
+  for (bool closedLoop : { false, true }) {
+    long readsFixed = 0, readsAdaptive = 0;
+    int changes = 0;
+    changeTiming fixedTiming, adaptiveTiming;
+    for (int day = 0; day < NUM_DAYS; day++) {
+      dayResult ref = runDay(day, EXACT, closedLoop);
+      dayResult fixed = runDay(day, FIXED_RATE, closedLoop);
+      dayResult adaptive = runDay(day, ADAPTIVE, closedLoop);
+      readsFixed += fixed.reads;
+      readsAdaptive += adaptive.reads;
+      changes += ref.changes.size();
+      fixedTiming.add(fixed, ref);
+      adaptiveTiming.add(adaptive, ref);
+    }
+    printf("%d days, %s: reads per day %ld fixed, %ld adaptive (%.1f%%), "
+      "%d relay changes\n", NUM_DAYS, closedLoop ? "closed loop" : "open loop",
+      readsFixed / NUM_DAYS, readsAdaptive / NUM_DAYS, 100.0 * readsAdaptive / readsFixed,
+      changes);
+    fixedTiming.print("fixed");
+    adaptiveTiming.print("adaptive");
+
+    // Adaptive reads cut the reads to under a third, with no more relay changes missed or
+    // added than fixed-rate reads, and about the same timing.
+    CHECK(readsFixed / NUM_DAYS == 24 * 3600000L / TEMPERATURE_READ_TIME_MS + 1);
+    CHECK(readsAdaptive * 3 < readsFixed);
+    CHECK(adaptiveTiming.missed <= fixedTiming.missed);
+    CHECK(adaptiveTiming.extra <= fixedTiming.extra);
+    CHECK(fabs(adaptiveTiming.mean() - fixedTiming.mean()) < 10);
+    CHECK(adaptiveTiming.sd() < fixedTiming.sd() + 10);
+  }
+  return(checkResult());
+}
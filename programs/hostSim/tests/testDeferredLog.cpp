@@ -0,0 +1,405 @@
+/*
+  testDeferredLog.cpp - Test of the deferred log ring buffer, and of the time logging takes
+  in loop().
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Checks the deferred log's output against snprintf() of the same messages: a message
+// stored at the start of the ring because it doesn't fit at the end, string arguments
+// copied and cut, messages dropped when the ring is full and the "messages dropped" line,
+// no storing with the port disabled, and a long random run of messages with random
+// servicing. Then times the logging of a temperature read cycle, as loop() does it, and of
+// one message with integer arguments, with monitor.printf() as before the deferred log and
+// with logPrintf(). Times are host ns, not Cortex-M0+ cycles.
+
+#include <Arduino.h>
+#include <monitor_printf.h>
+#include <floatToString.h>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "temperature.h"
+#include "temperatureTrend.h"
+#include "deferredLog.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Messages in the random run.
+#define NUM_RANDOM_MESSAGES 200000
+
+// Logging calls timed, in batches that fit in the ring buffer.
+#define NUM_TIMED_CYCLES 20000
+#define CYCLES_PER_BATCH 4
+
+// *************************************************************************************** //
+// Expected output.
+// *************************************************************************************** //
+
+// The output expected from the messages stored so far: written, and still in the ring.
+static std::string expected;
+static std::deque<std::string> pending;
+static uint32_t pendingDropped;
+
+// Format a message like monitor.printf().
+template<typename... Args> static std::string format(const char* fmt, Args... args) {
+  char S[512];
+  snprintf(S, sizeof(S), fmt, args...);
+  return(S);
+}
+
+// Return string s cut to the length logPrintf() copies.
+static std::string cut(const char* s) {
+  return(std::string(s, strnlen(s, LOG_MAX_STRING)));
+}
+
+// Log a message with logPrintf(), and add what it should write to pending, or count it as
+// dropped.
+template<typename... Args> static void logAndExpect(const std::string& text, const char* fmt,
+    Args... args) {
+  deferredLogStats before, after;
+  getDeferredLogStats(before);
+  logPrintf(fmt, args...);
+  getDeferredLogStats(after);
+  if (after.dropped != before.dropped)
+    pendingDropped++;
+  else
+    pending.push_back(text);
+}
+
+// Add to expected what servicing the log writes, up to maxWrites messages.
+static void expectWrites(size_t maxWrites) {
+  if (pendingDropped > 0) {
+    expected += format("*** %lu log messages dropped\n", (unsigned long) pendingDropped);
+    pendingDropped = 0;
+  }
+  for (size_t n = 0; n < maxWrites && !pending.empty(); n++) {
+    expected += pending.front();
+    pending.pop_front();
+  }
+}
+
+static void service(void) {
+  serviceDeferredLog();
+  expectWrites(LOG_MAX_WRITES_PER_SERVICE);
+}
+
+static void flush(void) {
+  flushDeferredLog();
+  expectWrites(SIZE_MAX);
+}
+
+// Start with an empty log and no output.
+static void restart(bool enabled) {
+  initDeferredLog(enabled);
+  hostMonitorPort.output.clear();
+  expected.clear();
+  pending.clear();
+  pendingDropped = 0;
+}
+
+// Log a message of 8 integer arguments, which takes 10 words.
+static void logTenWords(int k) {
+  logAndExpect(format("%d %d %d %d %d %d %d %d\n", k, k+1, k+2, k+3, k+4, k+5, k+6, k+7),
+    "%d %d %d %d %d %d %d %d\n", k, k+1, k+2, k+3, k+4, k+5, k+6, k+7);
+}
+
+// *************************************************************************************** //
+// Tests.
+// *************************************************************************************** //
+
+// A message that doesn't fit before the end of the ring is stored at its start.
+static void testWrap(void) {
+  restart(true);
+  for (int k = 0; k < 20; k++)
+    logTenWords(k);
+  flush();
+  for (int k = 20; k < 25; k++)
+    logTenWords(k);
+  // The ring now holds words 200-249. The next message doesn't fit in words 250-255.
+  logTenWords(25);
+  logTenWords(26);
+  flush();
+  deferredLogStats S;
+  getDeferredLogStats(S);
+  CHECK(S.stored == 27);
+  CHECK(S.dropped == 0);
+  CHECK(S.maxUsedWords == 200);
+  CHECK(hostMonitorPort.output == expected);
+}
+
+// String arguments are copied when stored, and cut to LOG_MAX_STRING characters.
+static void testStrings(void) {
+  restart(true);
+  char S[80];
+  strcpy(S, "before");
+  logAndExpect("before|\n", "%s|%s\n", S, "");
+  memset(S, 'x', 70);
+  S[70] = 0;
+  logAndExpect(cut(S) + "\n", "%s\n", S);
+  memset(S, 'y', 70);
+  flush();
+  CHECK(hostMonitorPort.output == expected);
+  CHECK(hostMonitorPort.output == "before|\n" + std::string(LOG_MAX_STRING, 'x') + "\n");
+}
+
+// When the ring is full, messages are dropped and counted, and the count is written once,
+// before the messages that were stored.
+static void testDropped(void) {
+  restart(true);
+  for (int k = 0; k < 100; k++)
+    logAndExpect(format("%d %d %d\n", k, -k, k*k), "%d %d %d\n", k, -k, k*k);
+  deferredLogStats S;
+  getDeferredLogStats(S);
+  printf("100 unserviced 5-word messages: %lu stored, %lu dropped\n",
+    (unsigned long) S.stored, (unsigned long) S.dropped);
+  CHECK(S.stored == (LOG_RING_WORDS - 1) / 5);
+  CHECK(S.stored + S.dropped == 100);
+  service();
+  CHECK(hostMonitorPort.output.find(format("*** %lu log messages dropped\n",
+    (unsigned long) S.dropped)) == 0);
+  flush();
+  logAndExpect("more\n", "more\n");
+  flush();
+  CHECK(hostMonitorPort.output == expected);
+  CHECK(std::count(expected.begin(), expected.end(), '*') == 3);
+}
+
+// With the port disabled, nothing is stored.
+static void testDisabled(void) {
+  restart(false);
+  logPrintf("discarded %d\n", 1);
+  flushDeferredLog();
+  deferredLogStats S;
+  getDeferredLogStats(S);
+  CHECK(S.stored == 0 && S.dropped == 0);
+  CHECK(hostMonitorPort.output.empty());
+}
+
+// Random messages with random servicing, at rates from keeping the ring nearly empty to
+// letting it overflow.
+static void testRandom(void) {
+  restart(true);
+  std::mt19937 gen(20);
+  std::uniform_int_distribution<uint32_t> u32;
+  static const char* names[] = { "Indoor", "Outdoor", "" };
+  static const double serviceRates[] = { 0.05, 0.3, 0.6 };
+  double serviceRate = serviceRates[0];
+  char S[3][80];
+  for (uint32_t i = 0; i < NUM_RANDOM_MESSAGES; i++) {
+    if (i % 1000 == 0)
+      serviceRate = serviceRates[u32(gen) % 3];
+    for (uint8_t j = 0; j < 3; j++) {
+      size_t len = u32(gen) % ((j == 0) ? 70 : 20);
+      for (size_t k = 0; k < len; k++)
+        S[j][k] = 'a' + u32(gen) % 26;
+      S[j][len] = 0;
+    }
+    int32_t a = (int32_t) u32(gen);
+    uint32_t b = u32(gen), c = u32(gen) % 1000;
+    switch (u32(gen) % 6) {
+    case 0:
+      logAndExpect("no arguments\n", "no arguments\n");
+      break;
+    case 1:
+      logAndExpect(format("int %d unsigned %u hex %x\n", a, b, c),
+        "int %d unsigned %u hex %x\n", a, b, c);
+      break;
+    case 2: {
+      const char* name = names[c % 3];
+      logAndExpect(format("%s: %lu\n", name, (unsigned long) b), "%s: %lu\n", name,
+        (unsigned long) b);
+      break;
+    }
+    case 3:
+      logAndExpect("[" + cut(S[0]) + "] " + format("%d\n", a), "[%s] %d\n", S[0], a);
+      break;
+    case 4:
+      logAndExpect(format("%d %d %d %d %d %d %d %d\n", a, -a, (int) b, (int) c, 0, 1, -1,
+        a/2), "%d %d %d %d %d %d %d %d\n", a, -a, (int) b, (int) c, 0, 1, -1, a/2);
+      break;
+    default:
+      logAndExpect(std::string(S[0]).substr(0, LOG_MAX_STRING) + "|" + S[1] + "|" + S[2] +
+        "\n", "%s|%s|%s\n", S[0], S[1], S[2]);
+      break;
+    }
+    double r = (u32(gen) & 0xFFFFFF) / (double) 0x1000000;
+    if (r < serviceRate)
+      service();
+    else if (r > 0.999)
+      flush();
+  }
+  flush();
+  deferredLogStats Q;
+  getDeferredLogStats(Q);
+  printf("%d random messages: %lu stored, %lu dropped, at most %u of %d words used, "
+    "%zu bytes written\n", NUM_RANDOM_MESSAGES, (unsigned long) Q.stored,
+    (unsigned long) Q.dropped, Q.maxUsedWords, LOG_RING_WORDS, expected.size());
+  CHECK(Q.stored + Q.dropped == NUM_RANDOM_MESSAGES);
+  CHECK(Q.dropped > 0);
+  CHECK(Q.maxUsedWords < LOG_RING_WORDS);
+  CHECK(hostMonitorPort.output == expected);
+}
+
+// *************************************************************************************** //
+// Timing.
+// *************************************************************************************** //
+
+// Temperatures logged by a read cycle.
+static temperature IndoorRead, OutdoorRead;
+
+// Log a read cycle's temperatures as readCurrentTemperatures() does.
+static void logReadCycle(void) {
+  showTemperature(IndoorRead, "Indoor");
+  showTemperature(OutdoorRead, "Outdoor");
+  showTemperatureTrend(IndoorTrend, "Indoor");
+  showTemperatureTrend(OutdoorTrend, "Outdoor");
+  logPrintf("ADC busy: %lu us  AREF on: %lu us\n", 2430UL, 5450UL);
+}
+
+// The same, formatted and written right away with monitor.printf(), as before the deferred
+// log.
+static void printTemperature(const temperature& Temp, const char* Desc) {
+  char TfS[9], TcS[9];
+  floatToString(Temp.Tf, TfS, sizeof(TfS), 1);
+  floatToString(Temp.Tc, TcS, sizeof(TcS), 1);
+  monitor.printf("%s Temperature: %s°F  %s°C   Rthermistor: %ld\n", Desc, TfS, TcS,
+    (long) Temp.Rthermistor);
+}
+static void printTemperatureTrend(const temperatureTrend& Trend, const char* Desc) {
+  char TfS[9], rateS[9];
+  floatToString(getTrendTf(Trend), TfS, sizeof(TfS), 1);
+  floatToString(getTrendTfPerHour(Trend), rateS, sizeof(rateS), 1);
+  monitor.printf("%s Trend: %s°F  %s°F/hour\n", Desc, TfS, rateS);
+}
+static void printADCtiming(void) {
+  monitor.printf("ADC busy: %lu us  AREF on: %lu us\n", 2430UL, 5450UL);
+}
+static void logADCtiming(void) {
+  logPrintf("ADC busy: %lu us  AREF on: %lu us\n", 2430UL, 5450UL);
+}
+static void printReadCycle(void) {
+  printTemperature(IndoorRead, "Indoor");
+  printTemperature(OutdoorRead, "Outdoor");
+  printTemperatureTrend(IndoorTrend, "Indoor");
+  printTemperatureTrend(OutdoorTrend, "Outdoor");
+  monitor.printf("ADC busy: %lu us  AREF on: %lu us\n", 2430UL, 5450UL);
+}
+
+// Return the host ns per call of logging (in loop()), and set *serviceNs to that of writing
+// what it stored (in idle time). Each of 5 runs times NUM_TIMED_CYCLES calls, and the
+// fastest run is used, as the one least disturbed by other processes.
+static double timeCycles(void (*logging)(void), double* serviceNs) {
+  std::vector<double> inLoop, idle;
+  for (int run = 0; run < 5; run++) {
+    double loopNs = 0, idleNs = 0;
+    for (int i = 0; i < NUM_TIMED_CYCLES; i += CYCLES_PER_BATCH) {
+      auto t0 = std::chrono::steady_clock::now();
+      for (int j = 0; j < CYCLES_PER_BATCH; j++)
+        logging();
+      auto t1 = std::chrono::steady_clock::now();
+      flushDeferredLog();
+      auto t2 = std::chrono::steady_clock::now();
+      loopNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      idleNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    }
+    inLoop.push_back(loopNs / NUM_TIMED_CYCLES);
+    idle.push_back(idleNs / NUM_TIMED_CYCLES);
+  }
+  std::sort(inLoop.begin(), inLoop.end());
+  std::sort(idle.begin(), idle.end());
+  *serviceNs = idle[0];
+  return(inLoop[0]);
+}
+
+static void testTiming(void) {
+  memset(&IndoorRead, 0, sizeof(IndoorRead));
+  memset(&OutdoorRead, 0, sizeof(OutdoorRead));
+  IndoorRead.Tc = 23.4f;
+  IndoorRead.Tf = 74.1f;
+  IndoorRead.Rthermistor = 9123;
+  OutdoorRead.Tc = 15.2f;
+  OutdoorRead.Tf = 59.4f;
+  OutdoorRead.Rthermistor = 15210;
+  resetTemperatureTrend(IndoorTrend, IndoorRead.Tc, 0);
+  resetTemperatureTrend(OutdoorTrend, OutdoorRead.Tc, 0);
+
+  // Both ways write the same text.
+  restart(true);
+  printReadCycle();
+  std::string before = hostMonitorPort.output;
+  hostMonitorPort.output.clear();
+  logReadCycle();
+  flushDeferredLog();
+  CHECK(hostMonitorPort.output == before);
+
+  hostMonitorPort.keep = false;
+  double idleNs, printNs, logNs, logIdleNs, disabledNs;
+  double printOneNs, logOneNs, logOneIdleNs, disabledOneNs;
+  restart(true);
+  printNs = timeCycles(printReadCycle, &idleNs);
+  logNs = timeCycles(logReadCycle, &logIdleNs);
+  printOneNs = timeCycles(printADCtiming, &idleNs);
+  logOneNs = timeCycles(logADCtiming, &logOneIdleNs);
+  restart(false);
+  disabledNs = timeCycles(logReadCycle, &idleNs);
+  disabledOneNs = timeCycles(logADCtiming, &idleNs);
+  hostMonitorPort.keep = true;
+  deferredLogStats S;
+  restart(true);
+  getDeferredLogStats(S);
+
+  // The read cycle's time includes converting 8 floats to strings, which logPrintf() does
+  // not defer. The ADC timing message has only integer arguments.
+  printf("Host ns spent logging in loop(), and later in idle time:\n");
+  printf("                              read cycle (5 messages)   ADC timing message\n");
+  printf("  before, monitor.printf():   %6.0f                    %6.0f\n", printNs,
+    printOneNs);
+  printf("  now, logPrintf():           %6.0f + %4.0f idle        %6.0f + %4.0f idle\n",
+    logNs, logIdleNs, logOneNs, logOneIdleNs);
+  printf("  now, port disabled:         %6.0f                    %6.0f\n", disabledNs,
+    disabledOneNs);
+  CHECK(logNs < printNs);
+  CHECK(logOneNs < printOneNs);
+  CHECK(disabledOneNs < logOneNs);
+}
+
+int main() {
+  monitor.begin(&hostMonitorPort);
+  testWrap();
+  testStrings();
+  testDropped();
+  testDisabled();
+  testRandom();
+  testTiming();
+  return(checkResult());
+}
@@ -0,0 +1,134 @@
+/*
+  testFixedPoint.cpp - Test that the fixed-point temperature pipeline gives the same
+  displayed temperatures as the float one.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: testFixedPoint --write FILE | --compare FILE
+//
+// Reads the thermistors NUM_READS times, 2 s apart, through readCurrentTemperatures() with
+// noisy ADC readings of slowly changing temperatures. The float build (--write) writes the
+// rounded temperatures and goingUp flags of each read to FILE, and the fixed-point build
+// (--compare) checks that its own match them. Both see the same ADC readings. The filtered
+// temperatures of the two differ by float round-off and the 1/4096 degree resolution of
+// the fixed-point table, so their rounding differs only when an average lies that close to
+// a rounding threshold. Slowly changing temperatures can stay that close for many reads.
+
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "controlSim.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Number of reads.
+#define NUM_READS 200000
+
+// The results of one read: the rounded indoor and outdoor temperatures and their goingUp
+// flags, and the unrounded Celsius temperatures.
+struct readResult {
+  int Tc[2], Tf[2], upC[2], upF[2];
+  float TcExact[2];
+};
+
+static void usage(void) {
+  fprintf(stderr, "usage: testFixedPoint --write FILE | --compare FILE\n");
+  exit(2);
+}
+
+// Do read i and return its results in R.
+static void doRead(uint32_t i, readResult& R) {
+  float hours = i * (TEMPERATURE_READ_TIME_MS / 3600000.0f);
+  setTemperaturesC(24 + 3 * sinf(hours * (float) M_PI / 12) + 0.5f * sinf(hours * 1.3f),
+    20 + 8 * sinf((hours - 9) * (float) M_PI / 12));
+  hostAdvanceUS(TEMPERATURE_READ_TIME_MS * 1000UL);
+  readCurrentTemperatures();
+  const temperature* T[2] = { &curIndoorTemperature, &curOutdoorTemperature };
+  for (int k = 0; k < 2; k++) {
+    R.Tc[k] = T[k]->Tc_int16;
+    R.Tf[k] = T[k]->Tf_int16;
+    R.upC[k] = T[k]->goingUpC;
+    R.upF[k] = T[k]->goingUpF;
+    R.TcExact[k] = T[k]->Tc;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3 || (strcmp(argv[1], "--write") != 0 && strcmp(argv[1], "--compare") != 0))
+    usage();
+  bool write = strcmp(argv[1], "--write") == 0;
+  FILE* f = fopen(argv[2], write ? "w" : "r");
+  if (f == NULL) {
+    fprintf(stderr, "testFixedPoint: can't open %s\n", argv[2]);
+    return(1);
+  }
+
+  initPins();
+  setTemperaturesC(24, 20);
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+  hostSetADCnoise(3, 1);
+  uint32_t differ = 0, lines = 0;
+  float maxDiffC = 0;
+  for (uint32_t i = 0; i < NUM_READS; i++) {
+    readResult R;
+    doRead(i, R);
+    if (write) {
+      fprintf(f, "%d %d %d %d %d %d %d %d %.6f %.6f\n", R.Tc[0], R.Tf[0], R.upC[0], R.upF[0],
+        R.Tc[1], R.Tf[1], R.upC[1], R.upF[1], R.TcExact[0], R.TcExact[1]);
+      continue;
+    }
+    readResult W;
+    if (fscanf(f, "%d %d %d %d %d %d %d %d %f %f", &W.Tc[0], &W.Tf[0], &W.upC[0], &W.upF[0],
+        &W.Tc[1], &W.Tf[1], &W.upC[1], &W.upF[1], &W.TcExact[0], &W.TcExact[1]) != 10)
+      break;
+    lines++;
+    bool same = true;
+    for (int k = 0; k < 2; k++) {
+      same = same && R.Tc[k] == W.Tc[k] && R.Tf[k] == W.Tf[k] && R.upC[k] == W.upC[k] &&
+        R.upF[k] == W.upF[k];
+      maxDiffC = max(maxDiffC, fabsf(R.TcExact[k] - W.TcExact[k]));
+    }
+    if (!same)
+      differ++;
+  }
+  fclose(f);
+  if (write) {
+    printf("Wrote %d reads of the %s pipeline to %s\n", NUM_READS,
+      USE_FIXED_POINT_TEMPS ? "fixed-point" : "float", argv[2]);
+    return(0);
+  }
+  printf("%lu reads: %lu (%.3f%%) differ in rounded temperatures or goingUp flags,\n"
+    "  largest difference in filtered Celsius temperatures %.6f C\n", (unsigned long) lines,
+    (unsigned long) differ, 100.0 * differ / max(lines, 1u), maxDiffC);
+  CHECK(lines == NUM_READS);
+  CHECK(differ <= NUM_READS / 50);
+  CHECK(maxDiffC < 0.001f);
+  return(checkResult());
+}
@@ -0,0 +1,97 @@
+/*
+  testIdlePasses.cpp - Test of idle sleep: run the sketch for simulated time
+  without touches and count the passes through loop() per hour.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: testIdlePasses --write FILE | --compare FILE
+//
+// Runs the sketch untouched, with the backlight going off after a while, as it is for most
+// of a day. The build that spins loop() (--write) writes its loop() passes per simulated
+// hour to FILE, and the build that sleeps in idleUntilNextEvent() (--compare) checks that
+// it makes at most 1/MIN_REDUCTION as many.
+
+#include "pinSettings.h"
+#include "lowPowerIdle.h"
+#include "sketchSim.h"
+#include "controlSim.h"
+#include "hostTest.h"
+
+// Simulated time to run before counting, so that setup's screen drawing is done and the
+// backlight is off.
+#define SETTLE_MINUTES 5
+
+// Least factor by which sleeping must reduce the loop() passes.
+#define MIN_REDUCTION 100
+
+// Return the current millis() time without advancing the clock.
+static uint32_t nowMS(void) {
+  return((uint32_t) (hostNowUS() / 1000));
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: testIdlePasses --write FILE | --compare FILE\n");
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3 || (strcmp(argv[1], "--write") != 0 && strcmp(argv[1], "--compare") != 0))
+    usage();
+  bool write = strcmp(argv[1], "--write") == 0;
+  FILE* f = fopen(argv[2], write ? "w" : "r");
+  if (f == NULL) {
+    fprintf(stderr, "testIdlePasses: can't open %s\n", argv[2]);
+    return(2);
+  }
+  CHECK(write == !USE_IDLE_SLEEP);
+
+  setTemperaturesC(24, 18);
+  setup();
+  runSketchUntil(SETTLE_MINUTES*60000UL);
+  CHECK(!getBacklight());
+
+  uint32_t startPasses = sketchLoopPasses();
+  runSketchUntil(nowMS() + 3600000UL);
+  uint32_t perHour = sketchLoopPasses() - startPasses;
+  CHECK(hostWatchdogLongestMS() < hostWatchdogPeriodMS());
+
+  if (write) {
+    fprintf(f, "%lu\n", (unsigned long) perHour);
+    printf("%lu loop() passes per hour spinning\n", (unsigned long) perHour);
+  } else {
+    unsigned long spinPerHour = 0;
+    CHECK(fscanf(f, "%lu", &spinPerHour) == 1);
+    CHECK(perHour > 0 && perHour <= spinPerHour / MIN_REDUCTION);
+    printf("%lu loop() passes per hour sleeping, %lu spinning\n", (unsigned long) perHour,
+      spinPerHour);
+  }
+  fclose(f);
+  return(checkResult());
+}
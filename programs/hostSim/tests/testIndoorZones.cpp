@@ -0,0 +1,140 @@
+/*
+  testIndoorZones.cpp - Test of multiple indoor zone thermistors: the combined indoor
+  temperature under each INDOOR_REDUCTION policy, and the read cost against sensor count.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Built against firmware variants with extra indoor thermistors (see add_firmware()'s
+// EXTRA_INDOOR_THERMISTORS). The zones are given different, changing temperatures, and after
+// every read curIndoorTemperature must equal the combination of the zones' filtered
+// temperatures computed here. Each variant prints one row of the read cost table.
+
+#include <Arduino.h>
+#include <chrono>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "controlSim.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Number of reads, and the time loop() spends between calls of the state machine.
+#define NUM_READS 200
+#define LOOP_US 300
+
+// Return the filtered Celsius temperature of Temp.
+static tempValue filteredC(const temperature& Temp) {
+  #if USE_FIXED_POINT_TEMPS
+  return(Temp.Tc_fixed);
+  #else
+  return(Temp.Tc);
+  #endif
+}
+
+// Return the indoor temperature that INDOOR_REDUCTION should give for the zones in Temps[].
+static tempValue expectedIndoor(const temperature* Temps) {
+  tempValue sum = 0, warmest = filteredC(Temps[0]), coolest = filteredC(Temps[0]);
+  for (uint8_t k = 0; k < NUM_INDOOR_SENSORS; k++) {
+    sum += filteredC(Temps[k]);
+    warmest = max(warmest, filteredC(Temps[k]));
+    coolest = min(coolest, filteredC(Temps[k]));
+  }
+  switch (INDOOR_REDUCTION) {
+  case 0: return(sum / NUM_INDOOR_SENSORS);
+  case 1: return(warmest);
+  case 2: return(coolest);
+  default: return(filteredC(Temps[INDOOR_CONTROL_ZONE]));
+  }
+}
+
+int main() {
+  static const char* policies[] = { "mean", "warmest", "coolest", "one zone" };
+  initPins();
+  setTemperaturesC(22, 15);
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+
+  clearHostADCcounts();
+  uint64_t sumBusyUS = 0, sumArefOnUS = 0;
+  double finishNS = 0;
+  bool sameIndoor = true, sameADC = true, ownInput = true;
+  for (uint32_t i = 0; i < NUM_READS; i++) {
+    // The zones swing out of phase, so that the warmest and coolest zones change.
+    float Tc[NUM_TEMP_SENSORS];
+    for (uint8_t k = 0; k < NUM_INDOOR_SENSORS; k++)
+      Tc[k] = 20 + 0.5f * k + 3 * sinf(0.05f * i + 2.0f * k);
+    Tc[OUTDOOR_SENSOR] = 15 - 0.02f * i;
+    for (uint8_t k = 0; k < NUM_TEMP_SENSORS; k++)
+      setSensorTemperatureC(k, Tc[k]);
+    hostAdvanceUS(TEMPERATURE_READ_TIME_MS * 1000UL);
+
+    startReadCurrentTemperatures();
+    for (;;) {
+      auto t0 = std::chrono::steady_clock::now();
+      bool done = serviceReadCurrentTemperatures();
+      if (done) {
+        finishNS += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+          t0).count();
+        break;
+      }
+      hostAdvanceUS(LOOP_US);
+    }
+    tempReadTiming T;
+    getTempReadTiming(T);
+    sumBusyUS += T.lastBusyUS;
+    sumArefOnUS += T.lastArefOnUS;
+
+    sameIndoor = sameIndoor &&
+      filteredC(curIndoorTemperature) == expectedIndoor(TempSensors.curTemperature);
+    bool fromZone = false;
+    for (uint8_t k = 0; k < NUM_INDOOR_SENSORS; k++)
+      fromZone = fromZone || curIndoorTemperature.ADCvalue == TempSensors.ADClastRead[k];
+    sameADC = sameADC && fromZone;
+    for (uint8_t k = 0; k < NUM_TEMP_SENSORS; k++)
+      ownInput = ownInput &&
+        TempSensors.ADClastRead[k] == lroundf(thermistorADC(Thermistors[k], Tc[k]));
+    CHECK(hostPinLevel(PIN_AREF_OUT) == LOW);
+  }
+  CHECK(sameIndoor);
+  CHECK(sameADC);
+  CHECK(ownInput);
+
+  hostADCcounts C;
+  getHostADCcounts(C);
+  printf("%d sensors, %s indoor, %s: %.1f conversions, ADC busy %.2f ms, AREF on %.2f ms, "
+    "finish %.1f us\n", NUM_TEMP_SENSORS, policies[INDOOR_REDUCTION < 3 ? INDOOR_REDUCTION : 3],
+    USE_ADC_INPUT_SCAN ? "input scan" : "one at a time", (double) C.conversions / NUM_READS,
+    sumBusyUS / 1000.0 / NUM_READS, sumArefOnUS / 1000.0 / NUM_READS,
+    finishNS / 1000 / NUM_READS);
+  #if USE_ADC_INPUT_SCAN
+  CHECK(C.dmaTransfers == NUM_READS);
+  #else
+  CHECK(C.conversions == 2 * NUM_TEMP_SENSORS * NUM_READS);
+  #endif
+  return(checkResult());
+}
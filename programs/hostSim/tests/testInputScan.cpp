@@ -0,0 +1,150 @@
+/*
+  testInputScan.cpp - Test of reading the thermistors one at a time and with an ADC input
+  scan: values, conversions, and ADC busy time against loop() latency.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Built against the firmware as configured (one thermistor at a time) and against
+// firmware_scan (USE_ADC_INPUT_SCAN = 1). Each thermistor's ADC input, and every input
+// between them, returns a different value on each read, so a result taken from the wrong
+// scan position is caught. With --adjacent, the outdoor thermistor is moved to the ADC
+// input after the indoor one, so that a scan converts only the thermistors' inputs.
+
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Number of reads at each loop() latency.
+#define NUM_READS 200
+
+// Number of ADC inputs.
+#define NUM_ADC_INPUTS 32
+
+// Return the value of ADC input on read number i. Thermistor inputs read 1000-2000, others
+// 3000 and up.
+static uint16_t inputValue(uint8_t input, uint32_t i, bool thermistor) {
+  return((thermistor ? 1000 : 3000) + input * 30 + (i * 37 + input * 11) % 50);
+}
+
+// Return the ADC input of Thermistors[s].
+static uint8_t sensorInput(uint8_t s) {
+  return(g_APinDescription[Thermistors[s].inputPin].ulADCChannelNumber);
+}
+
+// Do NUM_READS reads with loopUS of other loop() work between state machine calls. Return
+// the mean ADC busy time in us, and set conversions to the ADC conversions per read and
+// dmaJobs to the DMA jobs per read.
+static double readAll(uint32_t loopUS, double& conversions, double& dmaJobs) {
+  static uint32_t i;
+  uint64_t sumBusyUS = 0;
+  bool correct = true, unscanned = true;
+  clearHostADCcounts();
+  for (uint32_t n = 0; n < NUM_READS; n++, i++) {
+    bool thermistor[NUM_ADC_INPUTS] = { false };
+    for (uint8_t s = 0; s < NUM_TEMP_SENSORS; s++)
+      thermistor[sensorInput(s)] = true;
+    for (uint8_t input = 0; input < NUM_ADC_INPUTS; input++)
+      hostSetADCinput(input, inputValue(input, i, thermistor[input]));
+    hostAdvanceUS(TEMPERATURE_READ_TIME_MS * 1000UL);
+
+    startReadCurrentTemperatures();
+    while (!serviceReadCurrentTemperatures())
+      hostAdvanceUS(loopUS);
+    tempReadTiming T;
+    getTempReadTiming(T);
+    sumBusyUS += T.lastBusyUS;
+
+    for (uint8_t s = 0; s < NUM_TEMP_SENSORS; s++)
+      correct = correct && TempSensors.ADClastRead[s] == inputValue(sensorInput(s), i, true);
+    unscanned = unscanned && ADC->INPUTCTRL.bit.INPUTSCAN == 0 &&
+      ADC->INPUTCTRL.bit.INPUTOFFSET == 0;
+    CHECK(hostPinLevel(PIN_AREF_OUT) == LOW);
+  }
+  CHECK(correct);
+  CHECK(unscanned);
+
+  hostADCcounts C;
+  getHostADCcounts(C);
+  conversions = (double) C.conversions / NUM_READS;
+  dmaJobs = (double) C.dmaTransfers / NUM_READS;
+  double busyUS = (double) sumBusyUS / NUM_READS;
+  printf("  loop() latency %4lu us: ADC busy %5.2f ms, %.1f conversions (%.1f in scans), "
+    "%.1f DMA jobs per read\n", (unsigned long) loopUS, busyUS / 1000, conversions,
+    (double) C.scanConversions / NUM_READS, dmaJobs);
+  return(busyUS);
+}
+
+int main(int argc, char** argv) {
+  bool adjacent = argc > 1 && strcmp(argv[1], "--adjacent") == 0;
+  if (adjacent)
+    g_APinDescription[Thermistors[NUM_TEMP_SENSORS - 1].inputPin].ulADCChannelNumber =
+      sensorInput(0) + 1;
+
+  initPins();
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+
+  uint8_t lo = NUM_ADC_INPUTS, hi = 0;
+  for (uint8_t s = 0; s < NUM_TEMP_SENSORS; s++) {
+    lo = min(lo, sensorInput(s));
+    hi = max(hi, sensorInput(s));
+  }
+  printf("%d thermistors on ADC inputs %d-%d, %s:\n", NUM_TEMP_SENSORS, lo, hi,
+    USE_ADC_INPUT_SCAN ? "input scan" : "one at a time");
+  double conversions, dmaJobs;
+  double fastUS = readAll(300, conversions, dmaJobs);
+  double slowUS = readAll(3000, conversions, dmaJobs);
+
+  #if USE_ADC_INPUT_SCAN
+  // One scan of every input from the lowest to the highest, plus the discarded first
+  // result, copied by one DMA job, and finished without waiting on loop().
+  CHECK(conversions == hi - lo + 2);
+  CHECK(dmaJobs == 1);
+  CHECK(slowUS - fastUS < 1000);
+
+  // A scan that takes too long is given up, and the thermistors are converted one at a time
+  // with the correct results.
+  if (hi - lo + 2 > 3) {
+    printf("with %d us conversions, so the scan times out:\n", 3000);
+    hostSetADCconversionUS(3000);
+    double timeoutUS = readAll(300, conversions, dmaJobs);
+    CHECK(dmaJobs == 0);
+    CHECK(timeoutUS > 20000);
+  }
+  #else
+  // Each thermistor converted twice, with the first result discarded, each conversion
+  // started by loop(), so a slower loop() adds to the busy time.
+  CHECK(conversions == 2 * NUM_TEMP_SENSORS);
+  CHECK(dmaJobs == 0);
+  CHECK(slowUS - fastUS > 2 * NUM_TEMP_SENSORS * 1000);
+  #endif
+  return(checkResult());
+}
@@ -0,0 +1,105 @@
+/*
+  testNonblockingRead.cpp - Test of the non-blocking thermistor read state machine
+  against blocking reads, and of how long it holds up loop().
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// The state machine converts through the ADC registers, the blocking readTemperature()
+// through analogRead_SAMD_TT(). Both must give the same ADC values. Between calls to
+// serviceReadCurrentTemperatures() the simulated loop() spends LOOP_US on other work, and
+// the longest single call is compared with the time a blocking read of all the thermistors
+// holds up loop().
+
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "controlSim.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Number of reads, and the time loop() spends between calls of the state machine.
+#define NUM_READS 200
+#define LOOP_US 300
+
+int main() {
+  initPins();
+  setTemperaturesC(24, 20);
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+
+  tempReadTiming T;
+  getTempReadTiming(T);
+  uint32_t initReads = T.count;
+  uint64_t maxCallUS = 0, sumReadUS = 0, sumBlockingUS = 0;
+  uint32_t calls = 0;
+  bool sameADC = true;
+  for (uint32_t i = 0; i < NUM_READS; i++) {
+    setTemperaturesC(15 + 0.05f * i, 35 - 0.1f * i);
+    hostAdvanceUS(TEMPERATURE_READ_TIME_MS * 1000UL);
+
+    // Non-blocking read, one step per pass through loop().
+    uint64_t startUS = hostNowUS();
+    startReadCurrentTemperatures();
+    for (;;) {
+      uint64_t callUS = hostNowUS();
+      bool done = serviceReadCurrentTemperatures();
+      maxCallUS = max(maxCallUS, hostNowUS() - callUS);
+      calls++;
+      if (done)
+        break;
+      hostAdvanceUS(LOOP_US);
+    }
+    sumReadUS += hostNowUS() - startUS;
+
+    // Blocking read of the same temperatures.
+    startUS = hostNowUS();
+    for (uint8_t s = 0; s < NUM_TEMP_SENSORS; s++) {
+      temperature T;
+      memset(&T, 0, sizeof(T));
+      readTemperature(Thermistors[s], T, s == NUM_TEMP_SENSORS - 1);
+      sameADC = sameADC && T.ADCvalue == TempSensors.ADClastRead[s];
+    }
+    sumBlockingUS += hostNowUS() - startUS;
+    CHECK(hostPinLevel(PIN_AREF_OUT) == LOW);
+  }
+  CHECK(sameADC);
+
+  getTempReadTiming(T);
+  printf("%d reads of %d thermistors, %d us of other loop() work between calls:\n", NUM_READS,
+    NUM_TEMP_SENSORS, LOOP_US);
+  printf("  state machine: %.1f calls per read, longest call %lu us, read takes %.2f ms,\n"
+    "    ADC busy %.2f ms, AREF on up to %.2f ms\n", (double) calls / NUM_READS,
+    (unsigned long) maxCallUS, sumReadUS / 1000.0 / NUM_READS, T.meanBusyUS / 1000.0,
+    T.maxArefOnUS / 1000.0);
+  printf("  blocking read: holds up loop() for %.2f ms\n", sumBlockingUS / 1000.0 / NUM_READS);
+  CHECK(T.count == initReads + NUM_READS);
+  CHECK(maxCallUS < 100);
+  CHECK(sumBlockingUS / NUM_READS > AREF_STABLE_DELAY * 1000UL);
+  return(checkResult());
+}
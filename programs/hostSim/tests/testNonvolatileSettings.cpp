@@ -0,0 +1,118 @@
+/*
+  testNonvolatileSettings.cpp - Test of the settings log: migration of the settings
+  stored by earlier versions, flash wear, and recovery from a torn write.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "nonvolatileSettings.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Signature written by earlier versions at EEPROM address 0, ahead of the settings.
+#define LEGACY_SIGNATURE 0xBEEFDEED
+
+// Return true if settings a and b are the same.
+static bool sameSettings(const nonvolatileSettings& a, const nonvolatileSettings& b) {
+  return(memcmp(&a, &b, sizeof(nonvolatileSettings)) == 0);
+}
+
+int main() {
+  // Settings stored by an earlier version with EEPROM emulation, and an empty log. They are
+  // read, and written as the first record of the log without touching the EEPROM.
+  nonvolatileSettings legacy = settingDefaults;
+  legacy.SmartVentMode = MODE_AUTO;
+  legacy.TempSetpointOn = 73;
+  legacy.MaxRunTimeHours = 6;
+  legacy.IndoorOffsetF = -2;
+  uint8_t eeprom[4 + sizeof(nonvolatileSettings)];
+  uint32_t signature = LEGACY_SIGNATURE;
+  memcpy(eeprom, &signature, 4);
+  memcpy(eeprom + 4, &legacy, sizeof(legacy));
+  hostSetEEPROM(eeprom, sizeof(eeprom));
+  nonvolatileSettings S;
+  readNonvolatileSettings(S, settingDefaults);
+  CHECK(sameSettings(S, legacy));
+  hostFlashCounts C;
+  getHostFlashCounts(C);
+  CHECK(C.writes == 1);
+  CHECK(hostEEPROMcommits() == 0);
+
+  // Once they are in the log, the log is used even if the EEPROM changes.
+  hostSetEEPROM(NULL, 0);
+  readNonvolatileSettings(S, settingDefaults);
+  CHECK(sameSettings(S, legacy));
+  CHECK(!writeNonvolatileSettingsIfChanged(S));
+
+  // Ten years of 20 changes a day. The old EEPROM emulation erased its one row for every
+  // change; the log spreads the erases over its rows.
+  clearHostFlashCounts();
+  srand(2);
+  uint32_t changes = 0;
+  bool readsOK = true;
+  for (uint32_t i = 0; i < 3650 * 20; i++) {
+    S.TempSetpointOn = 60 + rand() % 30;
+    S.TS_LR_X = rand();
+    if (writeNonvolatileSettingsIfChanged(S))
+      changes++;
+    if (rand() % 500 == 0) {
+      nonvolatileSettings R;
+      readNonvolatileSettings(R, settingDefaults);
+      readsOK = readsOK && sameSettings(R, S);
+    }
+  }
+  CHECK(readsOK);
+  getHostFlashCounts(C);
+  printf("%lu changes: %lu row erases, %lu rows, at most %lu erases of a row\n",
+    (unsigned long) changes, (unsigned long) C.erases, (unsigned long) C.rowsErased,
+    (unsigned long) C.maxRowErases);
+  CHECK(changes > 70000);
+  CHECK(C.rowsErased == 8);
+  CHECK(C.maxRowErases <= changes / 32 + 1);
+
+  // Power lost 10 bytes into writing a record: the torn record is ignored, and the next
+  // write goes past it and is found on the next read.
+  nonvolatileSettings previous = S;
+  S.TempSetpointOn = S.TempSetpointOn == 70 ? 71 : 70;
+  hostSetFlashWriteBudget(10);
+  writeNonvolatileSettingsIfChanged(S);
+  hostSetFlashWriteBudget(-1);
+  nonvolatileSettings R;
+  readNonvolatileSettings(R, settingDefaults);
+  CHECK(sameSettings(R, previous));
+  S = R;
+  S.TempSetpointOn = 77;
+  CHECK(writeNonvolatileSettingsIfChanged(S));
+  readNonvolatileSettings(R, settingDefaults);
+  CHECK(R.TempSetpointOn == 77);
+  CHECK(!writeNonvolatileSettingsIfChanged(R));
+
+  return(checkResult());
+}
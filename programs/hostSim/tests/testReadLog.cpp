@@ -0,0 +1,100 @@
+/*
+  testReadLog.cpp - Test that logging the temperatures of a read costs no extra ADC
+  conversions.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Each read cycle used to end with readAndShowCurrentTemperatures(), a second blocking read
+// of all the thermistors just to log them. Now the read logs the samples it took. This
+// counts the conversions and time of a read cycle, checks that its log line shows the
+// thermistor resistance just read, and compares with the old cycle.
+
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "deferredLog.h"
+#include "controlSim.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Number of read cycles.
+#define NUM_READS 100
+
+int main() {
+  monitor.begin(&hostMonitorPort);
+  initDeferredLog(true);
+  initPins();
+  setTemperaturesC(24, 20);
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+  flushDeferredLog();
+
+  uint64_t newUS = 0, oldUS = 0;
+  uint32_t newConversions = 0, oldConversions = 0, logged = 0;
+  hostADCcounts C;
+  for (uint32_t i = 0; i < NUM_READS; i++) {
+    setTemperaturesC(20 + 0.1f * i, 30 - 0.1f * i);
+    hostAdvanceUS(TEMPERATURE_READ_TIME_MS * 1000UL);
+
+    // The read cycle as it is now.
+    hostMonitorPort.output.clear();
+    clearHostADCcounts();
+    uint64_t startUS = hostNowUS();
+    readCurrentTemperatures();
+    newUS += hostNowUS() - startUS;
+    getHostADCcounts(C);
+    newConversions += C.conversions;
+    flushDeferredLog();
+    char R[24];
+    snprintf(R, sizeof(R), "Rthermistor: %u\n", TempSensors.RlastRead[0]);
+    if (hostMonitorPort.output.find(R) != std::string::npos)
+      logged++;
+
+    // The old cycle's second read, to log the temperatures.
+    clearHostADCcounts();
+    startUS = hostNowUS();
+    readAndShowCurrentTemperatures();
+    oldUS += hostNowUS() - startUS;
+    getHostADCcounts(C);
+    oldConversions += C.conversions;
+    flushDeferredLog();
+  }
+
+  printf("Per read cycle of %d thermistors, logging every %d reads:\n", NUM_TEMP_SENSORS,
+    TEMPERATURE_LOG_INTERVAL);
+  printf("  now:    %.1f ADC conversions, %.2f ms\n", (double) newConversions / NUM_READS,
+    newUS / 1000.0 / NUM_READS);
+  printf("  before: %.1f ADC conversions, %.2f ms (with the second read)\n",
+    (double) (newConversions + oldConversions) / NUM_READS,
+    (newUS + oldUS) / 1000.0 / NUM_READS);
+  CHECK(newConversions == NUM_READS * 2 * NUM_TEMP_SENSORS);
+  CHECK(oldConversions == newConversions);
+  CHECK(logged == NUM_READS / TEMPERATURE_LOG_INTERVAL);
+  return(checkResult());
+}
@@ -0,0 +1,97 @@
+/*
+  testReplay.cpp - Test of reading temperature traces and replaying them through the
+  SmartVent control.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <stdio.h>
+#include <string>
+#include "pinSettings.h"
+#include "smartVentControl.h"
+#include "weather.h"
+#include "replay.h"
+#include "hostTest.h"
+
+// Return true if a and b differ by at most tolerance.
+static bool near(float a, float b, float tolerance) {
+  return(fabsf(a - b) <= tolerance);
+}
+
+int main() {
+  // A trace with the columns in another order, an extra column, and a wrap of millis().
+  const char* path = "testReplay.csv";
+  FILE* f = fopen(path, "w");
+  fprintf(f, "seq,outdoorC,ms,indoorC\n1,10,4294960000,20\n2,20,4294967000,30\n"
+    "3,30,2000,40\n");
+  fclose(f);
+  temperatureTrace trace;
+  std::string error;
+  CHECK(readTraceCSV(path, trace, error));
+  CHECK(trace.samples.size() == 3);
+  CHECK(trace.lengthMS() == 9296);
+  float indoorC, outdoorC;
+  trace.at(3500, indoorC, outdoorC);
+  CHECK(near(indoorC, 25, 0.001f) && near(outdoorC, 15, 0.001f));
+  trace.at(8148, indoorC, outdoorC);
+  CHECK(near(indoorC, 35, 0.001f) && near(outdoorC, 25, 0.001f));
+  trace.at(20000, indoorC, outdoorC);
+  CHECK(indoorC == 40 && outdoorC == 30);
+
+  // A trace without the indoorC column is refused.
+  f = fopen(path, "w");
+  fprintf(f, "ms,outdoorC\n0,10\n");
+  fclose(f);
+  CHECK(!readTraceCSV(path, trace, error));
+  remove(path);
+
+  // Six hours at 80 °F inside and 60 °F outside: AUTO turns SmartVent on at once, and with
+  // no run time limit it stays on. The statistics cleared after the warm-up hour show no
+  // relay cycles and 5 hours with the relay on and indoors above the setpoint.
+  trace.samples.clear();
+  trace.samples.push_back({0, (80 - 32) / 1.8f, (60 - 32) / 1.8f});
+  trace.samples.push_back({6*3600000ULL, (80 - 32) / 1.8f, (60 - 32) / 1.8f});
+  nonvolatileSettings S = settingDefaults;
+  S.SmartVentMode = MODE_AUTO;
+  S.MaxRunTimeHours = 0;
+  replayOptions options;
+  replayResult result;
+  replayTrace(trace, S, options, result);
+  CHECK(getSmartVent());
+  CHECK(result.statsMS == 5*3600000ULL);
+  CHECK(result.stats.relayCycles == 0);
+  CHECK(near(result.stats.relayOnSecs, 5*3600, 2));
+  CHECK(near(result.stats.aboveSetpointSecs, 5*3600, 2));
+  CHECK(near(result.discomfortFh, (80 - 76) * 5, 0.05f));
+  CHECK(near(result.maxIndoorF, 80, 0.01f));
+  CHECK(result.reads > 0);
+
+  return(checkResult());
+}
@@ -0,0 +1,136 @@
+/*
+  testRunningSum.cpp - Test of the boxcar filter's running sum against sums computed
+  from scratch, with its cost per read.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Built against the firmware as configured (fixed-point temperatures, whose running sum
+// must be exact), and against float configurations with and without USE_RUNNING_SUM,
+// whose error is reported and must stay within float round-off of the exact average.
+
+#include <Arduino.h>
+#include <chrono>
+#include "temperature.h"
+#include "hostTest.h"
+
+// Number of reads.
+#define NUM_READS 1000000
+
+// Return a random temperature in °C: a slow daily swing between 15 and 35 plus noise.
+static float randomTemperature(uint32_t i) {
+  return(25 + 10 * sinf(i * (2 * (float) M_PI / 43200)) + (rand() % 2001 - 1000) * 0.0005f);
+}
+
+// Filter NUM_READS temperatures with BoxcarFilter<N> and compare each output with the
+// average of the last N inputs, summed exactly. Return the largest difference in °C.
+template<uint16_t N> static double checkBoxcar(void) {
+  static tempValue inputs[N];
+  BoxcarFilter<N> filter;
+  srand(1);
+  tempValue T0;
+  #if USE_FIXED_POINT_TEMPS
+  T0 = floatToFixedTemp(25);
+  #else
+  T0 = 25;
+  #endif
+  filter.reset(T0);
+  for (uint16_t i = 0; i < N; i++)
+    inputs[i] = T0;
+  double maxError = 0;
+  for (uint32_t i = 0; i < NUM_READS; i++) {
+    tempValue Tc;
+    #if USE_FIXED_POINT_TEMPS
+    Tc = floatToFixedTemp(randomTemperature(i));
+    #else
+    Tc = randomTemperature(i);
+    #endif
+    inputs[i % N] = Tc;
+    tempValue out = filter.update(Tc);
+    #if USE_FIXED_POINT_TEMPS
+    int64_t sum = 0;
+    for (uint16_t j = 0; j < N; j++)
+      sum += inputs[j];
+    double error = fabs((double) (out - (tempValue) (sum / N))) / FIXED_TEMP_ONE;
+    #else
+    double sum = 0;
+    for (uint16_t j = 0; j < N; j++)
+      sum += inputs[j];
+    double error = fabs(out - sum / N);
+    #endif
+    if (error > maxError)
+      maxError = error;
+  }
+  return(maxError);
+}
+
+// Return the time in ns of one update of BoxcarFilter<N>.
+template<uint16_t N> static double timeBoxcar(void) {
+  BoxcarFilter<N> filter;
+  static tempValue inputs[1024];
+  srand(2);
+  for (uint16_t i = 0; i < 1024; i++) {
+    #if USE_FIXED_POINT_TEMPS
+    inputs[i] = floatToFixedTemp(randomTemperature(i));
+    #else
+    inputs[i] = randomTemperature(i);
+    #endif
+  }
+  filter.reset(inputs[0]);
+  volatile tempValue sink;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < NUM_READS; i++)
+    sink = filter.update(inputs[i & 1023]);
+  (void) sink;
+  return(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count()
+    / NUM_READS);
+}
+
+int main() {
+  printf("%s temperatures, %s, %d reads\n", USE_FIXED_POINT_TEMPS ? "fixed-point" : "float",
+    USE_RUNNING_SUM ? "running sum" : "sum from scratch", NUM_READS);
+  double error30 = checkBoxcar<NUM_TEMPS_RUNNING_AVG>();
+  double error300 = checkBoxcar<300>();
+  printf("  largest error: Boxcar<%d> %.3g C, Boxcar<300> %.3g C\n", NUM_TEMPS_RUNNING_AVG,
+    error30, error300);
+  printf("  update: Boxcar<%d> %.1f ns, Boxcar<300> %.1f ns\n", NUM_TEMPS_RUNNING_AVG,
+    timeBoxcar<NUM_TEMPS_RUNNING_AVG>(), timeBoxcar<300>());
+
+  // Fixed-point sums are exact. A float running sum gathers round-off on every read, and
+  // resumming every RUNNING_SUM_RESUM_INTERVAL reads keeps it far below the 0.1 degree
+  // resolution of the display.
+  #if USE_FIXED_POINT_TEMPS
+  CHECK(error30 == 0);
+  CHECK(error300 == 0);
+  #else
+  CHECK(error30 < 5e-4);
+  CHECK(error300 < 5e-4);
+  #endif
+  return(checkResult());
+}
@@ -0,0 +1,178 @@
+/*
+  testScheduler.cpp - Test of the timer scheduler, across the millis() wrap.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include <vector>
+#include "scheduler.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Set the simulated clock to the start of millis() time ms, in the current wrap of millis()
+// or the next one if ms has passed.
+static void setMillis(uint32_t ms) {
+  uint64_t nowUS = hostNowUS();
+  uint64_t targetUS = (nowUS / 1000 - (uint32_t) (nowUS / 1000) + ms) * 1000;
+  if (targetUS < nowUS)
+    targetUS += 1000ULL << 32;
+  hostAdvanceUS(targetUS - nowUS);
+}
+
+// Return the current millis() time without advancing the clock.
+static uint32_t nowMS(void) {
+  return((uint32_t) (hostNowUS() / 1000));
+}
+
+// Callback counts, and the times at which timer A's and B's callbacks were called.
+static timerID A, B, C, D;
+static int countA, countB, countC;
+static std::vector<uint32_t> timesA, timesB;
+
+static void callbackA(void) { countA++; timesA.push_back(nowMS()); }
+static void callbackB(void) { countB++; timesB.push_back(nowMS()); }
+static void callbackC(void) { countC++; stopTimer(A); }
+static void callbackD(void) { }
+
+int main() {
+  // Start 2.5 s before millis() wraps.
+  uint32_t startMS = 0xFFFFFFFFu - 2500;
+  setMillis(startMS);
+  A = addTimer(callbackA, 1000);
+  B = addTimer(callbackB);
+  C = addTimer(callbackC);
+  CHECK(A != NO_TIMER && B != NO_TIMER && C != NO_TIMER);
+  CHECK(msUntilNextTimer() == UINT32_MAX);
+  startTimer(A, 1000);
+  startTimer(B, 3000);
+  CHECK(msUntilNextTimer() == 1000);
+
+  // Periodic A expires on each deadline and one-shot B once, across the wrap.
+  for (uint32_t t = 1; t <= 10000; t++) {
+    setMillis(startMS + t);
+    runDueTimers();
+  }
+  CHECK(countA == 10);
+  CHECK(countB == 1);
+  bool onTime = true;
+  for (uint32_t t : timesA)
+    onTime = onTime && (t - startMS) % 1000 == 0;
+  CHECK(onTime);
+  CHECK(timesB.size() == 1 && timesB[0] - startMS == 3000);
+  CHECK(nowMS() < startMS);
+
+  // Restarting a one-shot pushes it back.
+  countB = 0;
+  for (int i = 0; i < 50; i++) {
+    setMillis(nowMS() + 100);
+    startTimer(B, 3000);
+    runDueTimers();
+  }
+  CHECK(countB == 0);
+  uint32_t restartMS = nowMS();
+  setMillis(restartMS + 2999);
+  runDueTimers();
+  CHECK(countB == 0);
+  setMillis(restartMS + 3000);
+  CHECK(msUntilNextTimer() == 0);
+  runDueTimers();
+  CHECK(countB == 1);
+  CHECK(!isTimerRunning(B));
+
+  // That last wait fell behind A. Once it has caught up, stall for 3.5 periods: A expires
+  // once per call until it has expired once for each deadline missed, and then keeps to its
+  // original deadlines.
+  while (runDueTimers() == 0)
+    ;
+  uint32_t nextA = nowMS() + msUntilNextTimer();
+  int countBefore = countA;
+  setMillis(nowMS() + 3500);
+  uint32_t missed = (nowMS() - nextA) / 1000 + 1;
+  CHECK(runDueTimers() == 0);
+  CHECK(countA == countBefore + 1);
+  uint32_t msUntil;
+  while ((msUntil = runDueTimers()) == 0)
+    ;
+  CHECK(countA == countBefore + (int) missed);
+  CHECK((nowMS() + msUntil - startMS) % 1000 == 0);
+
+  // A callback stopping another timer that is due in the same call.
+  startTimer(C, 0);
+  setMillis(nowMS() + 1000);
+  runDueTimers();
+  CHECK(countC == 1);
+  CHECK(!isTimerRunning(A));
+
+  // Invalid timer IDs are ignored, and addTimer() refuses more than MAX_TIMERS.
+  startTimer(NO_TIMER, 10);
+  stopTimer(MAX_TIMERS);
+  CHECK(!isTimerRunning(NO_TIMER));
+  D = addTimer(callbackD);
+  timerID extra = D;
+  for (int i = 4; i <= MAX_TIMERS; i++)
+    extra = addTimer(callbackD);
+  CHECK(extra == NO_TIMER);
+
+  // msUntilNextTimer() against a brute-force minimum while timers are randomly started and
+  // stopped.
+  timerID T[3] = { A, B, C };
+  uint32_t deadline[3];
+  bool running[3] = { false, false, false };
+  stopTimer(A);
+  stopTimer(B);
+  stopTimer(C);
+  srand(1);
+  uint32_t mismatches = 0;
+  for (int i = 0; i < 200000; i++) {
+    int k = rand() % 3, op = rand() % 3;
+    if (op == 0) {
+      uint32_t delayMS = rand() % 5000;
+      startTimer(T[k], delayMS);
+      deadline[k] = nowMS() + delayMS;
+      running[k] = true;
+    } else if (op == 1) {
+      stopTimer(T[k]);
+      running[k] = false;
+    }
+    setMillis(nowMS() + rand() % 3);
+    uint32_t best = UINT32_MAX;
+    for (int j = 0; j < 3; j++)
+      if (running[j]) {
+        int32_t left = (int32_t) (deadline[j] - nowMS());
+        best = min(best, (uint32_t) (left < 0 ? 0 : left));
+      }
+    if (msUntilNextTimer() != best)
+      mismatches++;
+  }
+  CHECK(mismatches == 0);
+  printf("Ran from millis() %lu across the wrap to %lu\n", (unsigned long) startMS,
+    (unsigned long) nowMS());
+  return(checkResult());
+}
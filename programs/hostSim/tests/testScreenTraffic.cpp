@@ -0,0 +1,170 @@
+/*
+  testScreenTraffic.cpp - Test of the SPI traffic of screen transitions: switch
+  screens with scripted touches and measure the LCD bytes each switch takes.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: testScreenTraffic --write FILE | --compare FILE
+//
+// Goes from screen to screen by tapping buttons, and records the LCD bytes sent by each
+// tap and a hash of the screen it leads to. The build that erases each region by itself
+// (--write) writes them to FILE, and the build that coalesces the regions (--compare)
+// checks that it shows the same screens with no more bytes per tap, and fewer in all. The
+// History screen shows its drawing time, so only the total includes its taps.
+
+#include "pinSettings.h"
+#include "fontsAndColors.h"
+#include "screens.h"
+#include "sketchSim.h"
+#include "controlSim.h"
+#include "hostLCD.h"
+#include "hostTouch.h"
+#include "hostButtons.h"
+#include "hostTest.h"
+
+// How long each tap lasts, and how long to run after it before measuring.
+#define TAP_MS 150
+#define SETTLE_MS 500
+
+// Buttons to tap, in order, the screen each tap leads to, and true if that screen shows
+// how long its drawing took, which differs between the builds.
+struct step {
+  const char* button;
+  eScreen screen;
+  bool timed;
+};
+static const step steps[] = {
+  { "Settings",          SCREEN_SETTINGS,    false },
+  { "SettingsCancel",    SCREEN_MAIN,        false },
+  { "Advanced",          SCREEN_ADVANCED,    false },
+  { "AdvancedCancel",    SCREEN_MAIN,        false },
+  { "Advanced",          SCREEN_ADVANCED,    false },
+  { "Special",           SCREEN_SPECIAL,     false },
+  { "History",           SCREEN_HISTORY,     true },
+  { "HistoryDone",       SCREEN_SPECIAL,     false },
+  { "SpecialDone",       SCREEN_ADVANCED,    false },
+  { "AdvancedCancel",    SCREEN_MAIN,        false },
+  { "Settings",          SCREEN_SETTINGS,    false },
+  { "SettingsCancel",    SCREEN_MAIN,        false }
+};
+#define NUM_STEPS (sizeof(steps)/sizeof(steps[0]))
+
+// Return the current millis() time without advancing the clock.
+static uint32_t nowMS(void) {
+  return((uint32_t) (hostNowUS() / 1000));
+}
+
+// Return a hash of what the screen shows.
+static uint32_t screenHash(void) {
+  uint32_t hash = 2166136261u;
+  for (int16_t y = 0; y < lcd->height(); y++)
+    for (int16_t x = 0; x < lcd->width(); x++)
+      hash = (hash ^ hostLCDpixel(x, y)) * 16777619u;
+  return(hash);
+}
+
+// Return the number of LCD bytes sent so far.
+static uint32_t lcdBytes(void) {
+  hostLCDcounts C;
+  getHostLCDcounts(C);
+  return(C.bytes);
+}
+
+// Touch the center of button name and run the sketch until SETTLE_MS after the release.
+// Return false if there is no such button.
+static bool tap(const char* name) {
+  int16_t x, y;
+  if (!hostButtonCenter(name, x, y)) {
+    printf("No button %s\n", name);
+    return(false);
+  }
+  uint32_t startMS = nowMS() + 10;
+  hostTouchAt(startMS, TAP_MS, x, y);
+  runSketchUntil(startMS + TAP_MS + SETTLE_MS);
+  return(true);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: testScreenTraffic --write FILE | --compare FILE\n");
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3 || (strcmp(argv[1], "--write") != 0 && strcmp(argv[1], "--compare") != 0))
+    usage();
+  bool write = strcmp(argv[1], "--write") == 0;
+  FILE* f = fopen(argv[2], write ? "w" : "r");
+  if (f == NULL) {
+    fprintf(stderr, "testScreenTraffic: can't open %s\n", argv[2]);
+    return(2);
+  }
+
+  setTemperaturesC(24, 18);
+  setup();
+  runSketchUntil(nowMS() + 2000);
+  CHECK(currentScreen == SCREEN_MAIN);
+
+  uint32_t total = 0, otherTotal = 0;
+  for (uint8_t i = 0; i < NUM_STEPS; i++) {
+    uint32_t startBytes = lcdBytes();
+    CHECK(tap(steps[i].button));
+    CHECK(currentScreen == steps[i].screen);
+    uint32_t bytes = lcdBytes() - startBytes;
+    uint32_t hash = screenHash();
+    total += bytes;
+    if (write) {
+      fprintf(f, "%lu %lu\n", (unsigned long) bytes, (unsigned long) hash);
+      printf("%-18s %7lu LCD bytes\n", steps[i].button, (unsigned long) bytes);
+    } else {
+      unsigned long otherBytes, otherHash;
+      CHECK(fscanf(f, "%lu %lu", &otherBytes, &otherHash) == 2);
+      if (!steps[i].timed) {
+        CHECK(hash == otherHash);
+        CHECK(bytes <= otherBytes);
+      }
+      otherTotal += otherBytes;
+      printf("%-18s %7lu LCD bytes, %7lu without coalescing\n", steps[i].button,
+        (unsigned long) bytes, otherBytes);
+    }
+  }
+  fclose(f);
+
+  hostLCDcounts C;
+  getHostLCDcounts(C);
+  CHECK(C.errors == 0);
+  if (write)
+    printf("%lu LCD bytes in all\n", (unsigned long) total);
+  else {
+    CHECK(total < otherTotal);
+    printf("%lu LCD bytes in all, %lu without coalescing\n", (unsigned long) total,
+      (unsigned long) otherTotal);
+  }
+  return(checkResult());
+}
@@ -0,0 +1,144 @@
+/*
+  testSketch.cpp - Test of the sketch with its screens: run setup() and loop() on the
+  simulated LCD and touch the screen's buttons as a user would.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "pinSettings.h"
+#include "fontsAndColors.h"
+#include "screens.h"
+#include "sketchSim.h"
+#include "controlSim.h"
+#include "hostLCD.h"
+#include "hostTouch.h"
+#include "hostButtons.h"
+#include "hostTest.h"
+
+// How long each tap lasts, and how long to run after it before checking its effect.
+#define TAP_MS 150
+#define SETTLE_MS 200
+
+// Time without touches after which the sketch activates the user settings, which is
+// USER_ACTIVITY_DELAY_MS in SmartVentThermostat.ino, plus a second.
+#define ACTIVATION_MS (11*1000)
+
+// Return the current millis() time without advancing the clock.
+static uint32_t nowMS(void) {
+  return((uint32_t) (hostNowUS() / 1000));
+}
+
+// Return a hash of what the screen shows.
+static uint32_t screenHash(void) {
+  uint32_t hash = 2166136261u;
+  for (int16_t y = 0; y < lcd->height(); y++)
+    for (int16_t x = 0; x < lcd->width(); x++)
+      hash = (hash ^ hostLCDpixel(x, y)) * 16777619u;
+  return(hash);
+}
+
+// Return the number of pixels of button name that show color.
+static uint32_t buttonPixels(const char* name, uint16_t color) {
+  Button_TT* B = hostFindButton(name);
+  if (B == NULL)
+    return(0);
+  return(hostLCDcountColor(B->getLeft(), B->getTop(), B->getWidth(), B->getHeight(),
+    color));
+}
+
+// Touch the center of button name for TAP_MS, and run the sketch until SETTLE_MS after the
+// release. Return true if the beeper sounded during the touch and not after it.
+static bool tap(const char* name) {
+  int16_t x, y;
+  if (!hostButtonCenter(name, x, y)) {
+    printf("No button %s\n", name);
+    return(false);
+  }
+  uint32_t startMS = nowMS() + 10;
+  hostTouchAt(startMS, TAP_MS, x, y);
+  runSketchUntil(startMS + TAP_MS/2);
+  bool beeped = hostPWMduty(BEEPER_PIN) > 0;
+  runSketchUntil(startMS + TAP_MS + SETTLE_MS);
+  return(beeped && hostPWMduty(BEEPER_PIN) == 0);
+}
+
+int main() {
+  setTemperaturesC(24, 18);
+  setup();
+  CHECK(currentScreen == SCREEN_MAIN);
+  CHECK(hostWatchdogPeriodMS() == 4096);
+  CHECK(buttonPixels("Settings", PINK) > 0);
+  CHECK(buttonPixels("Advanced", PINK) > 0);
+  runSketchUntil(nowMS() + 2000);
+  uint32_t mainHash = screenHash();
+
+  // Settings: raise the setpoint by 2 and save it.
+  uint8_t setpoint = userSettings.TempSetpointOn;
+  CHECK(tap("Settings"));
+  CHECK(currentScreen == SCREEN_SETTINGS);
+  CHECK(screenHash() != mainHash);
+  CHECK(tap("SetpointRight"));
+  CHECK(tap("SetpointRight"));
+  CHECK(userSettings.TempSetpointOn == setpoint);
+  CHECK(tap("SettingsSave"));
+  CHECK(currentScreen == SCREEN_MAIN);
+  CHECK(userSettings.TempSetpointOn == setpoint + 2);
+
+  // Advanced and back without changes.
+  CHECK(tap("Advanced"));
+  CHECK(currentScreen == SCREEN_ADVANCED);
+  CHECK(tap("AdvancedCancel"));
+  CHECK(currentScreen == SCREEN_MAIN);
+
+  // The user settings become active after a while without touches, and the backlight goes
+  // off later.
+  CHECK(getBacklight());
+  runSketchUntil(nowMS() + ACTIVATION_MS);
+  CHECK(activeSettings.TempSetpointOn == setpoint + 2);
+  runSketchUntil(nowMS() + LCD_BACKLIGHT_AUTO_OFF_MS);
+  CHECK(!getBacklight());
+
+  // A touch with the backlight off only turns it on.
+  CHECK(!tap("Settings"));
+  CHECK(getBacklight());
+  CHECK(currentScreen == SCREEN_MAIN);
+
+  // The SPI bus was used correctly, large fills went by DMA, and the watchdog was reset in
+  // time.
+  hostLCDcounts C;
+  getHostLCDcounts(C);
+  CHECK(C.errors == 0);
+  CHECK(C.dmaPixels > 0);
+  CHECK(hostWatchdogLongestMS() < hostWatchdogPeriodMS());
+  printf("%lu loop() passes in %lu ms, %lu touchscreen reads, %lu LCD bytes, %lu pixels "
+    "by DMA, longest watchdog reset interval %lu ms\n", (unsigned long) sketchLoopPasses(),
+    (unsigned long) nowMS(), (unsigned long) hostTouchReads(), (unsigned long) C.bytes,
+    (unsigned long) C.dmaPixels, (unsigned long) hostWatchdogLongestMS());
+  return(checkResult());
+}
@@ -0,0 +1,147 @@
+/*
+  testSmartVentControl.cpp - Test updateSmartVentOnOff() and the SmartVent run timer on
+  the host, driving them with thermistor temperatures read through the simulated ADC.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "nonvolatileSettings.h"
+#include "smartVentControl.h"
+#include "controlSim.h"
+#include "hostTest.h"
+
+// Convert °F to °C.
+static float FtoC(float F) {
+  return((F - 32) * 5 / 9);
+}
+
+// Run the firmware with indoor and outdoor temperatures indoorF and outdoorF for minutes.
+static void runFor(float minutes, float indoorF, float outdoorF) {
+  setTemperaturesC(FtoC(indoorF), FtoC(outdoorF));
+  uint64_t endMS = controlSimMS() + (uint64_t)(minutes * 60000);
+  while (controlSimMS() < endMS)
+    loopControlSim();
+}
+
+// Return true if the relay is on, checking that getSmartVent() agrees with the relay pin.
+static bool relayOn(void) {
+  bool on = hostPinLevel(SMARTVENT_RELAY) == SMARTVENT_ON;
+  CHECK(on == getSmartVent());
+  return(on);
+}
+
+int main() {
+  nonvolatileSettings S = settingDefaults;
+  S.SmartVentMode = MODE_AUTO;
+  S.TempSetpointOn = 76;
+  S.DeltaTempForOn = 6;
+  S.Hysteresis = 1;
+  S.MaxRunTimeHours = 4;
+  S.DeltaNewDayTemp = 1;
+
+  // Start warm inside and out: AUTO waits to turn on.
+  setTemperaturesC(FtoC(80), FtoC(80));
+  setupControlSim(S);
+  CHECK(ArmState == ARM_AWAIT_ON);
+  runFor(10, 80, 80);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_AWAIT_ON);
+
+  // Outdoors cools to 74 °F, above indoor - DeltaTempForOn - Hysteresis = 73 °F: still off.
+  runFor(20, 80, 74);
+  CHECK(!relayOn());
+
+  // At 72 °F it turns on.
+  runFor(20, 80, 72);
+  CHECK(relayOn());
+  CHECK(ArmState == ARM_AUTO_ON);
+  CHECK(SmartVentStats.relayCycles == 1);
+
+  // It stays on while indoors cools to 76 °F, within the hysteresis of the setpoint...
+  runFor(20, 76, 68);
+  CHECK(relayOn());
+
+  // ...and turns off below TempSetpointOn - Hysteresis.
+  runFor(20, 74, 68);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_AWAIT_ON);
+  CHECK(RunTimeMS > 0);
+
+  // Turned on again, it runs until the run time reaches MaxRunTimeHours, then waits for a
+  // new day.
+  runFor(5 * 60, 80, 70);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_AWAIT_HOT);
+  CHECK(RunTimeMS == 4 * 3600000UL);
+  CHECK(SmartVentStats.relayCycles == 2);
+  // The statistics sample the relay once a second, so each of the two on periods may be
+  // counted a second short or long.
+  CHECK(SmartVentStats.relayOnSecs >= 4 * 3600 - 2 &&
+    SmartVentStats.relayOnSecs <= 4 * 3600 + 2);
+  runFor(60, 80, 70);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_AWAIT_HOT);
+
+  // A new day starts when outdoors is DeltaNewDayTemp warmer than indoors. That clears the
+  // run time, and the next cool evening turns it on again.
+  runFor(60, 80, 82);
+  CHECK(RunTimeMS == 0);
+  CHECK(ArmState == ARM_AWAIT_ON);
+  CHECK(!relayOn());
+  runFor(60, 80, 70);
+  CHECK(relayOn());
+  CHECK(SmartVentStats.relayCycles == 3);
+
+  // Every second is counted in exactly one arm state.
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < NUM_ARM_STATES; i++)
+    total += SmartVentStats.armStateSecs[i];
+  CHECK(total + 1 >= controlSimMS() / 1000 && total <= controlSimMS() / 1000);
+
+  // ON mode runs regardless of the temperatures, until MaxRunTimeHours.
+  S.SmartVentMode = MODE_ON;
+  activateSettingsControlSim(S);
+  runFor(1, 70, 90);
+  CHECK(relayOn());
+  CHECK(ArmState == ARM_ON);
+  runFor(4 * 60, 70, 90);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_ON_TIMEOUT);
+
+  // OFF mode turns it off and keeps it off.
+  S.SmartVentMode = MODE_OFF;
+  activateSettingsControlSim(S);
+  runFor(30, 80, 60);
+  CHECK(!relayOn());
+  CHECK(ArmState == ARM_OFF);
+
+  return(checkResult());
+}
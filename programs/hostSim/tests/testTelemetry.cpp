@@ -0,0 +1,132 @@
+/*
+  testTelemetry.cpp - Test of the serial output of the control loop, as text or as
+  binary telemetry decoded by decodeTelemetry.py.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: testTelemetry [PYTHON DECODER OUTDIR]
+//
+// Runs the firmware for SIM_HOURS with temperatures that make SmartVent switch, with text
+// written to the serial monitor every 10 minutes and the serial port out of room for a
+// minute, and reports the serial output per temperature read. With USE_TELEMETRY, the
+// output is also decoded by running PYTHON DECODER, writing CSV files into OUTDIR, and the
+// decoded records, and records found missing, are checked against the telemetry counts.
+
+#include <Arduino.h>
+#include <string>
+#include "nonvolatileSettings.h"
+#include "deferredLog.h"
+#include "telemetry.h"
+#include "controlSim.h"
+#include "hostSim.h"
+#include "weather.h"
+#include "hostTest.h"
+
+// Simulated time.
+#define SIM_HOURS 6
+
+int main(int argc, char** argv) {
+  if (argc != 1 && argc != 4) {
+    fprintf(stderr, "usage: testTelemetry [PYTHON DECODER OUTDIR]\n");
+    return(2);
+  }
+  nonvolatileSettings S = settingDefaults;
+  S.SmartVentMode = MODE_AUTO;
+  controlSimOptions options;
+  options.monitor = true;
+  setTemperaturesC(27, 27);
+  setupControlSim(S, options);
+  hostMonitorPort.output.clear();
+  uint32_t reads0 = controlSimReads();
+  #if USE_TELEMETRY
+  telemetryStats T0;
+  getTelemetryStats(T0);
+  #endif
+
+  // Outdoors cools from 27 °C in the evening, switching SmartVent on, and indoors follows.
+  uint64_t startMS = controlSimMS(), lastTextMS = startMS;
+  uint64_t endMS = startMS + SIM_HOURS * 3600000ULL;
+  while (controlSimMS() < endMS) {
+    float hours = (controlSimMS() - startMS) / 3600000.0f;
+    setTemperaturesC(27 - hours, 27 - 3 * sinf(hours * (float) M_PI / SIM_HOURS));
+    if (controlSimMS() - lastTextMS >= 10 * 60000) {
+      lastTextMS = controlSimMS();
+      logPrintf("Screen 0 -> 1: 1234 LCD bytes\n");
+    }
+    hostMonitorPort.room = (hours >= 3 && hours < 3 + 1 / 60.0f) ? 10 : 256;
+    loopControlSim();
+  }
+  flushDeferredLog();
+  uint32_t reads = controlSimReads() - reads0;
+  printf("%s, %d simulated hours, %lu temperature reads: %lu bytes, %.1f per read\n",
+    USE_TELEMETRY ? "Binary telemetry" : "Text", SIM_HOURS, (unsigned long) reads,
+    (unsigned long) hostMonitorPort.output.size(), (double) hostMonitorPort.output.size() / reads);
+
+  #if USE_TELEMETRY
+  telemetryStats T;
+  getTelemetryStats(T);
+  T.records -= T0.records;
+  T.dropped -= T0.dropped;
+  printf("  %lu records, %lu dropped\n", (unsigned long) T.records, (unsigned long) T.dropped);
+  CHECK(T.dropped > 0);
+  if (argc == 4) {
+    std::string capture = std::string(argv[3]) + ".bin";
+    FILE* f = fopen(capture.c_str(), "wb");
+    fwrite(hostMonitorPort.output.data(), 1, hostMonitorPort.output.size(), f);
+    fclose(f);
+    std::string command = std::string(argv[1]) + " " + argv[2] + " -o " + argv[3] + " " +
+      capture + " 2>&1";
+    FILE* p = popen(command.c_str(), "r");
+    unsigned long records = 0, bad = 0, missing = 0;
+    char line[200];
+    bool parsed = false;
+    while (fgets(line, sizeof(line), p) != NULL) {
+      printf("  decoder: %s", line);
+      parsed = parsed || sscanf(line, "%lu records, %lu bad frames or text lines, %lu records "
+        "missing", &records, &bad, &missing) == 3;
+    }
+    CHECK(pclose(p) == 0);
+    CHECK(parsed);
+    CHECK(records == T.records);
+    CHECK(missing == T.dropped);
+    CHECK(bad > 0);
+
+    // The decoded temperatures can be replayed.
+    temperatureTrace trace;
+    std::string error;
+    CHECK(readTraceCSV((std::string(argv[3]) + "/temperatures.csv").c_str(), trace, error));
+    printf("  temperatures.csv: %zu samples over %.2f hours\n", trace.samples.size(),
+      trace.lengthMS() / 3600000.0);
+    CHECK(trace.samples.size() > reads / 2);
+  }
+  #endif
+  CHECK(reads > 0);
+  return(checkResult());
+}
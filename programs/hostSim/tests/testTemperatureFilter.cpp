@@ -0,0 +1,158 @@
+/*
+  testTemperatureFilter.cpp - Benchmark of the thermistor filter stages: RAM, time, step lag,
+  noise reduction, and spike rejection.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// The traces are synthetic, not recorded (see syntheticReads.h): 2 s reads with 3-code ADC
+// noise and, for the spike test, 1% spikes. Times are host ns per read, not Cortex-M0+
+// cycles. Built against fixed-point and float temperatures.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "temperature.h"
+#include "syntheticReads.h"
+#include "hostTest.h"
+
+// Return n reads of temperature T0 °C changing to T1 °C at read stepAt, with ADC noise of
+// noiseCodes (sd) and spikes in fraction spikes of the reads, from random seed.
+static std::vector<tempValue> makeTrace(int n, int stepAt, double T0, double T1,
+    double noiseCodes, double spikes, uint32_t seed) {
+  syntheticReads reads(seed);
+  std::vector<tempValue> trace;
+  for (int i = 0; i < n; i++)
+    trace.push_back(reads.read((i < stepAt) ? T0 : T1, noiseCodes, spikes));
+  return(trace);
+}
+
+// Figures measured for one filter.
+struct filterFigures {
+  int lag50, lag90;       // Reads after a 2°C step until the output is 50% and 90% there.
+  double noiseFactor;     // Output noise divided by input noise (rms).
+  double spikeMax;        // Largest output error with spikes, °C.
+  double ns;              // Host time per read.
+};
+
+// Measure and print the figures of filter F.
+template<typename F> static filterFigures bench(const char* name) {
+  filterFigures fig;
+
+  // Lag: a noiseless 2°C step at read 100.
+  std::vector<tempValue> step = makeTrace(400, 100, 20, 22, 0, 0, 1);
+  F f;
+  f.reset(step[0]);
+  double T0 = toC(step[0]), T1 = toC(step.back());
+  fig.lag50 = fig.lag90 = -1;
+  for (int i = 0; i < (int) step.size(); i++) {
+    double Tc = toC(f.update(step[i]));
+    if (i >= 100 && fig.lag50 < 0 && Tc >= T0 + 0.5 * (T1 - T0))
+      fig.lag50 = i - 99;
+    if (i >= 100 && fig.lag90 < 0 && Tc >= T0 + 0.9 * (T1 - T0))
+      fig.lag90 = i - 99;
+  }
+
+  // Noise: 20000 reads at 21°C, skipping the first 100 while the filter settles.
+  std::vector<tempValue> steady = makeTrace(20000, 20000, 21, 21, 3, 0, 2);
+  F g;
+  g.reset(toTempValue(21));
+  double sumIn = 0, sumOut = 0;
+  for (int i = 0; i < (int) steady.size(); i++) {
+    double Tc = toC(g.update(steady[i]));
+    if (i < 100)
+      continue;
+    sumIn += pow(toC(steady[i]) - 21, 2);
+    sumOut += pow(Tc - 21, 2);
+  }
+  fig.noiseFactor = sqrt(sumOut / sumIn);
+
+  // Spikes: the same noise plus spikes.
+  std::vector<tempValue> spiky = makeTrace(20000, 20000, 21, 21, 3, 0.01, 3);
+  F h;
+  h.reset(toTempValue(21));
+  fig.spikeMax = 0;
+  for (int i = 0; i < (int) spiky.size(); i++) {
+    double Tc = toC(h.update(spiky[i]));
+    if (i >= 100)
+      fig.spikeMax = std::max(fig.spikeMax, fabs(Tc - 21));
+  }
+
+  // Time per read.
+  F k;
+  k.reset(spiky[0]);
+  volatile tempValue sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < 50; rep++)
+    for (tempValue T : spiky)
+      sink = sink + k.update(T);
+  fig.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).
+    count() / (50.0 * spiky.size());
+
+  printf("%-18s %4u B %6.1f ns %4d / %-4d %8.2f %7.2f C\n", name, (unsigned) sizeof(F),
+    fig.ns, fig.lag50, fig.lag90, fig.noiseFactor, fig.spikeMax);
+  return(fig);
+}
+
+int main() {
+  printf("%-18s %6s %9s %11s %8s %9s\n", "filter", "RAM", "time", "lag50/90",
+    "noise x", "spike max");
+  filterFigures boxcar = bench<BoxcarFilter<30>>("Boxcar<30>");
+  bench<BoxcarFilter<10>>("Boxcar<10>");
+  bench<EMAFilter<15>>("EMA<15>");
+  filterFigures ema = bench<EMAFilter<8>>("EMA<8>");
+  filterFigures median = bench<MedianFilter<5>>("Median<5>");
+  bench<HampelFilter<5>>("Hampel<5>");
+  bench<FilterCascade<MedianFilter<5>, EMAFilter<8>>>("Median<5>+EMA<8>");
+  filterFigures hampel = bench<FilterCascade<HampelFilter<5>, EMAFilter<8>>>("Hampel<5>+EMA<8>");
+
+  // The default boxcar averages over 30 reads, so a step takes 15 and 27-28 reads to pass
+  // through (one more with float round-off at exactly 50%), and it cuts the noise by about
+  // sqrt(30).
+  CHECK(boxcar.lag50 >= 15 && boxcar.lag50 <= 16);
+  CHECK(boxcar.lag90 >= 27 && boxcar.lag90 <= 28);
+  CHECK(boxcar.noiseFactor < 0.25);
+
+  // EMA<8> averages about as much as a 16-read boxcar, with less lag than Boxcar<30>.
+  CHECK(ema.lag50 < boxcar.lag50);
+  CHECK(ema.noiseFactor < 0.35);
+
+  // The median delays a step by (N+1)/2 reads and removes single spikes.
+  CHECK(median.lag50 == 3 && median.lag90 == 3);
+  CHECK(median.spikeMax < boxcar.spikeMax);
+
+  // Hampel+EMA rejects spikes best, and smooths as well as the EMA alone.
+  CHECK(hampel.spikeMax < median.spikeMax);
+  CHECK(hampel.spikeMax < 0.15);
+  CHECK(hampel.noiseFactor < ema.noiseFactor + 0.02);
+  CHECK(sizeof(FilterCascade<HampelFilter<5>, EMAFilter<8>>) <
+    sizeof(BoxcarFilter<30>) / 4);
+  return(checkResult());
+}
@@ -0,0 +1,159 @@
+/*
+  testTemperatureHistory.cpp - Test of the compressed temperature history: round trip,
+  compression, speed, and readers overtaken by new samples.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// The traces are synthetic 1-minute samples: the 30-read running average of noisy 2 s reads
+// of a daily indoor and outdoor cycle, with the relay on for part of each evening.
+
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "temperatureHistory.h"
+#include "hostTest.h"
+
+// Return n samples of a trace with read noise of noiseF °F (sd), from random seed.
+static std::vector<historySample> makeTrace(uint32_t n, uint32_t seed, double noiseF) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<double> noise(0, noiseF);
+  std::vector<historySample> trace;
+  double indoor[30] = { 0 }, outdoor[30] = { 0 };
+  int k = 0;
+  for (uint32_t m = 0; m < n; m++) {
+    for (int r = 0; r < 30; r++) {
+      double days = (m * 60.0 + r * 2) / 86400;
+      indoor[k] = 74 + 3 * sin(2 * M_PI * (days - 0.3)) + noise(gen);
+      outdoor[k] = 65 + 12 * sin(2 * M_PI * (days - 0.35)) + 1.5 * sin(2 * M_PI * days * 7.3) +
+        noise(gen);
+      k = (k + 1) % 30;
+    }
+    double sumIndoor = 0, sumOutdoor = 0;
+    for (int r = 0; r < 30; r++) {
+      sumIndoor += indoor[r];
+      sumOutdoor += outdoor[r];
+    }
+    historySample S;
+    S.indoorTenthsF = (int16_t) lround(sumIndoor / 30 * 10);
+    S.outdoorTenthsF = (int16_t) lround(sumOutdoor / 30 * 10);
+    double dayFraction = m / 1440.0 - floor(m / 1440.0);
+    S.relayOn = dayFraction > 0.8 && dayFraction < 0.95;
+    S.armState = S.relayOn ? 4 : 3;
+    trace.push_back(S);
+  }
+  return(trace);
+}
+
+// Return true if history sample S matches trace sample E.
+static bool sameSample(const historySample& S, const historySample& E) {
+  return(S.indoorTenthsF == E.indoorTenthsF && S.outdoorTenthsF == E.outdoorTenthsF &&
+    S.relayOn == E.relayOn && S.armState == E.armState);
+}
+
+int main() {
+  // Compression and speed at three noise levels, with every sample checked.
+  const double noiseLevels[] = { 0.1, 0.3, 1.0 };
+  for (double noiseF : noiseLevels) {
+    std::vector<historySample> trace = makeTrace(20000, 1, noiseF);
+    clearHistory();
+    auto t0 = std::chrono::steady_clock::now();
+    for (historySample& S : trace)
+      addHistorySample(S);
+    auto t1 = std::chrono::steady_clock::now();
+    historyStats stats;
+    getHistoryStats(stats);
+    historyIterator it;
+    startHistoryIterator(it);
+    historySample S;
+    uint32_t n = 0;
+    bool same = true;
+    while (nextHistorySample(it, S)) {
+      same = same && sameSample(S, trace[S.index]);
+      n++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    CHECK(same);
+    CHECK(n == stats.numSamples);
+    CHECK(stats.oldestIndex + n == trace.size());
+    printf("noise %.1f F: %lu samples (%.1f days) in %lu bytes, %.2f bytes/sample, "
+      "add %.0f ns, iterate %.0f ns/sample\n", noiseF, (unsigned long) stats.numSamples,
+      stats.numSamples / 1440.0, (unsigned long) stats.bytesUsed,
+      (double) stats.bytesUsed / stats.numSamples,
+      std::chrono::duration<double, std::nano>(t1 - t0).count() / trace.size(),
+      std::chrono::duration<double, std::nano>(t2 - t1).count() / n);
+  }
+
+  // A reader that takes one sample for every two added is overtaken as blocks are reused,
+  // and skips ahead, still getting correct samples.
+  std::vector<historySample> trace = makeTrace(40000, 2, 0.3);
+  clearHistory();
+  size_t i = 0;
+  for (; i < 15000; i++)
+    addHistorySample(trace[i]);
+  historyIterator it;
+  startHistoryIterator(it);
+  historySample S;
+  uint32_t last = 0, skips = 0;
+  bool first = true, same = true;
+  while (i + 1 < trace.size()) {
+    addHistorySample(trace[i++]);
+    addHistorySample(trace[i++]);
+    if (nextHistorySample(it, S)) {
+      same = same && sameSample(S, trace[S.index]);
+      if (!first && S.index != last + 1)
+        skips++;
+      last = S.index;
+      first = false;
+    }
+  }
+  CHECK(same);
+  CHECK(skips > 0);
+  printf("slow reader: skipped ahead %lu times, all samples correct\n", (unsigned long) skips);
+
+  // Extreme values go through the escape code.
+  clearHistory();
+  const int16_t values[] = { -32768, 32767, 0, -1, 1, 200, -200, 32767, -32768 };
+  for (int16_t v : values) {
+    historySample E = { 0, v, (int16_t) -v, true, 7 };
+    addHistorySample(E);
+  }
+  startHistoryIterator(it);
+  int j = 0;
+  same = true;
+  while (nextHistorySample(it, S)) {
+    same = same && S.indoorTenthsF == values[j] && S.outdoorTenthsF == (int16_t) -values[j] &&
+      S.relayOn && S.armState == 7;
+    j++;
+  }
+  CHECK(same);
+  CHECK(j == 9);
+  return(checkResult());
+}
@@ -0,0 +1,91 @@
+/*
+  testTemperatureTable.cpp - Test of the accuracy of the ADC to temperature conversion
+  against the Steinhart-Hart equation in double precision.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Every ADC code is read through readTemperature() from each thermistor, and the result is
+// compared with the exact temperature over the range the thermostat is used in. Built
+// against the firmware as configured (interpolated table, fixed point) and with the table
+// off (the Steinhart-Hart equation in float on every read).
+
+#include <Arduino.h>
+#include "pinSettings.h"
+#include "temperature.h"
+#include "hostSim.h"
+#include "hostTest.h"
+
+// Range of temperatures checked, °C.
+#define MIN_CHECK_C -20
+#define MAX_CHECK_C 60
+
+// Return the exact temperature of Thermistor in °C at ADC reading Vo.
+static double exactTemperature(const thermistor& Thermistor, uint16_t Vo) {
+  double R = Thermistor.seriesResistor * (4095.0 / Vo - 1);
+  double logR = log(R);
+  return(1 / (Thermistor.A + Thermistor.B*logR + Thermistor.C*logR*logR*logR) - 273.15);
+}
+
+int main() {
+  initPins();
+  initReadTemperature(PIN_ADC_CALIB, PIN_PWM_CALIB, PIN_AREF_OUT, CFG_ADC_MULT_SAMP_AVG, NULL);
+  printf("%s, %s temperatures\n", USE_TEMPERATURE_TABLE ? "interpolated table" :
+    "Steinhart-Hart on every read", USE_FIXED_POINT_TEMPS ? "fixed-point" : "float");
+  #if USE_TEMPERATURE_TABLE
+  printf("  table: %d entries, %u bytes per thermistor\n", TEMP_TABLE_SIZE,
+    (unsigned) (TEMP_TABLE_SIZE * sizeof(tempValue)));
+  #endif
+
+  for (uint8_t s = 0; s < NUM_TEMP_SENSORS; s++) {
+    const thermistor& Th = Thermistors[s];
+    uint8_t input = g_APinDescription[Th.inputPin].ulADCChannelNumber;
+    double maxError = 0, sumError = 0;
+    uint32_t n = 0;
+    temperature T;
+    memset(&T, 0, sizeof(T));
+    for (uint16_t Vo = 6; Vo < 4095; Vo++) {
+      double exact = exactTemperature(Th, Vo);
+      if (exact < MIN_CHECK_C || exact > MAX_CHECK_C)
+        continue;
+      hostSetADCinput(input, Vo);
+      readTemperature(Th, T);
+      CHECK(T.ADCvalue == Vo);
+      double error = fabs(T.Tc - exact);
+      maxError = max(maxError, error);
+      sumError += error;
+      n++;
+    }
+    printf("  thermistor %u: %lu codes from %d to %d C, error mean %.4f C, max %.4f C\n", s,
+      (unsigned long) n, MIN_CHECK_C, MAX_CHECK_C, sumError / n, maxError);
+    CHECK(n > 2000);
+    CHECK(maxError < 0.015);
+  }
+  return(checkResult());
+}
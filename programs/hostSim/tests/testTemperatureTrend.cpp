@@ -0,0 +1,221 @@
+/*
+  testTemperatureTrend.cpp - Test of the Kalman temperature trend estimator: relay timing
+  against the boxcar filter on synthetic evening cool-downs, and long-run stability.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Each cool-down is 8 hours of 2 s reads of an indoor temperature falling slowly and an
+// outdoor temperature decaying exponentially toward 10-18°C, read as in syntheticReads.h.
+// The relay turns on when outdoor <= indoor - 2 - 1 °F and stays on while outdoor <=
+// indoor - 2 + 1 °F, as updateSmartVentOnOff() does. Its first turn-on time from filtered
+// temperatures is compared with that from the true temperatures.
+
+#include <Arduino.h>
+#include <chrono>
+#include "temperature.h"
+#include "temperatureTrend.h"
+#include "syntheticReads.h"
+#include "hostTest.h"
+
+// Number of cool-downs, their length, and the read interval.
+#define NUM_COOLDOWNS 40
+#define COOLDOWN_HOURS 8
+#define READ_MS 2000
+
+// Relay turn-on and turn-off conditions, °F.
+#define DELTA_F 2.0
+#define HYSTERESIS_F 1.0
+
+// Estimators compared.
+enum { BOXCAR, HAMPEL_EMA, KALMAN, NUM_ESTIMATORS };
+static const char* estimatorNames[NUM_ESTIMATORS] = { "Boxcar<30>", "Hampel<5>+EMA<8>",
+  "Kalman" };
+
+// Relay driven by one estimator.
+struct relay {
+  bool on = false;
+  int turnOns = 0;
+  double firstOnSec = -1;
+
+  void update(double indoorF, double outdoorF, double sec) {
+    if (!on && outdoorF <= indoorF - DELTA_F - HYSTERESIS_F) {
+      on = true;
+      if (turnOns++ == 0)
+        firstOnSec = sec;
+    } else if (on && outdoorF > indoorF - DELTA_F + HYSTERESIS_F)
+      on = false;
+  }
+};
+
+// Relay timing of one estimator over all cool-downs.
+struct timing {
+  double meanSec, sdSec, minSec, maxSec; // First turn-on time minus the true one.
+  int turnOns;
+};
+
+static double toF(double Tc) { return(degCtoF(Tc)); }
+
+// Run all cool-downs with ADC noise and spikes if noisy, with outdoor time constants of
+// 1.5-4 hours divided by speedup, and put the relay timing of each estimator in T[]. Return
+// the average Kalman update time in ns.
+static double runCooldowns(bool noisy, double speedup, timing T[NUM_ESTIMATORS]) {
+  double sum[NUM_ESTIMATORS] = { 0 }, sumSq[NUM_ESTIMATORS] = { 0 };
+  for (int k = 0; k < NUM_ESTIMATORS; k++) {
+    T[k].minSec = 1e9;
+    T[k].maxSec = -1e9;
+    T[k].turnOns = 0;
+  }
+  double noiseCodes = noisy ? 3 : 0, spikes = noisy ? 0.01 : 0;
+  double kalmanNs = 0;
+  long kalmanUpdates = 0;
+
+  for (int c = 0; c < NUM_COOLDOWNS; c++) {
+    syntheticReads reads(100 + c);
+    double indoor0 = 25 + 2 * reads.random(), indoorPerHour = 0.2 + 0.4 * reads.random();
+    double outdoor0 = 28 + 6 * reads.random(), outdoorEnd = 10 + 8 * reads.random();
+    double tauHours = (1.5 + 2.5 * reads.random()) / speedup;
+
+    BoxcarFilter<30> boxcarIn, boxcarOut;
+    FilterCascade<HampelFilter<5>, EMAFilter<8>> hampelIn, hampelOut;
+    temperatureTrend trendIn, trendOut;
+    boxcarIn.reset(toTempValue(indoor0));
+    boxcarOut.reset(toTempValue(outdoor0));
+    hampelIn.reset(toTempValue(indoor0));
+    hampelOut.reset(toTempValue(outdoor0));
+    resetTemperatureTrend(trendIn, indoor0, 0);
+    resetTemperatureTrend(trendOut, outdoor0, 0);
+
+    relay relays[NUM_ESTIMATORS], truth;
+    for (uint32_t i = 1; i <= COOLDOWN_HOURS * 3600000UL / READ_MS; i++) {
+      uint32_t ms = i * READ_MS;
+      double hours = ms / 3600000.0;
+      double indoor = indoor0 - indoorPerHour * hours;
+      double outdoor = outdoorEnd + (outdoor0 - outdoorEnd) * exp(-hours / tauHours);
+      tempValue readIn = reads.read(indoor, noiseCodes, spikes);
+      tempValue readOut = reads.read(outdoor, noiseCodes, spikes);
+
+      double inF[NUM_ESTIMATORS], outF[NUM_ESTIMATORS];
+      inF[BOXCAR] = toF(toC(boxcarIn.update(readIn)));
+      outF[BOXCAR] = toF(toC(boxcarOut.update(readOut)));
+      inF[HAMPEL_EMA] = toF(toC(hampelIn.update(readIn)));
+      outF[HAMPEL_EMA] = toF(toC(hampelOut.update(readOut)));
+      auto t0 = std::chrono::steady_clock::now();
+      updateTemperatureTrend(trendIn, toC(readIn), ms);
+      updateTemperatureTrend(trendOut, toC(readOut), ms);
+      kalmanNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+        t0).count();
+      kalmanUpdates += 2;
+      inF[KALMAN] = getTrendTf(trendIn);
+      outF[KALMAN] = getTrendTf(trendOut);
+
+      truth.update(toF(indoor), toF(outdoor), ms / 1000.0);
+      for (int k = 0; k < NUM_ESTIMATORS; k++)
+        relays[k].update(inF[k], outF[k], ms / 1000.0);
+    }
+
+    for (int k = 0; k < NUM_ESTIMATORS; k++) {
+      double late = relays[k].firstOnSec - truth.firstOnSec;
+      sum[k] += late;
+      sumSq[k] += late * late;
+      T[k].minSec = std::min(T[k].minSec, late);
+      T[k].maxSec = std::max(T[k].maxSec, late);
+      T[k].turnOns += relays[k].turnOns;
+    }
+  }
+
+  printf("%s, outdoor time constant %.1f-%.1f h:\n", noisy ? "noisy reads with spikes" :
+    "noise-free reads", 1.5 / speedup, 4 / speedup);
+  for (int k = 0; k < NUM_ESTIMATORS; k++) {
+    T[k].meanSec = sum[k] / NUM_COOLDOWNS;
+    T[k].sdSec = sqrt(std::max(0.0, sumSq[k] / NUM_COOLDOWNS - T[k].meanSec * T[k].meanSec));
+    printf("  %-18s on %+6.1f s (sd %5.1f, %+6.1f to %+6.1f), %d turn-ons\n",
+      estimatorNames[k], T[k].meanSec, T[k].sdSec, T[k].minSec, T[k].maxSec, T[k].turnOns);
+  }
+  return(kalmanNs / kalmanUpdates);
+}
+
+int main() {
+  timing T[NUM_ESTIMATORS];
+  double ns = 0;
+
+  // Without noise, the boxcar's ~30 s group delay shows directly, and the Kalman estimate
+  // has almost none.
+  for (double speedup : { 1.0, 4.0 }) {
+    ns = runCooldowns(false, speedup, T);
+    CHECK(T[BOXCAR].meanSec > 20);
+    CHECK(fabs(T[KALMAN].meanSec) < 5);
+    CHECK(T[KALMAN].turnOns == NUM_COOLDOWNS);
+  }
+
+  // With noise and spikes, the boxcar turns on early or late as spikes leak into its
+  // average, while the Kalman estimate gates them out.
+  for (double speedup : { 1.0, 4.0 }) {
+    ns = runCooldowns(true, speedup, T);
+    CHECK(fabs(T[KALMAN].meanSec) < 10);
+    CHECK(T[KALMAN].sdSec < T[BOXCAR].sdSec / 2);
+    CHECK(T[KALMAN].turnOns == NUM_COOLDOWNS);
+  }
+  printf("Kalman update: %.1f ns (host)\n", ns);
+
+  // A week of steady noisy reads keeps the float covariance positive definite.
+  syntheticReads reads(7);
+  temperatureTrend trend;
+  resetTemperatureTrend(trend, 21, 0);
+  bool positive = true;
+  for (uint32_t i = 1; i <= 7 * 24 * 3600000UL / READ_MS; i++) {
+    updateTemperatureTrend(trend, toC(reads.read(21, 3, 0.01)), i * READ_MS);
+    positive = positive && trend.P00 > 0 && trend.P11 > 0 &&
+      trend.P00 * trend.P11 >= trend.P01 * trend.P01 * 0.999f;
+  }
+  CHECK(positive);
+  CHECK(fabs(trend.Tc - 21) < 0.1);
+  printf("week of steady reads: P00 %.3g P01 %.3g P11 %.3g, Tc %.3f C, rate %.3f C/h\n",
+    trend.P00, trend.P01, trend.P11, trend.Tc, trend.rate * 3600);
+
+  // Reads 2-60 s apart still track a cool-down.
+  syntheticReads irregular(8);
+  resetTemperatureTrend(trend, 30, 0);
+  uint32_t ms = 0;
+  double sumSq = 0;
+  int n = 0;
+  while (ms < 4 * 3600000UL) {
+    ms += 2000 + (uint32_t) (58000 * irregular.random());
+    double hours = ms / 3600000.0, Tc = 14 + 16 * exp(-hours / 2);
+    updateTemperatureTrend(trend, toC(irregular.read(Tc, 3, 0.01)), ms);
+    if (hours > 0.5) {
+      sumSq += (trend.Tc - Tc) * (trend.Tc - Tc);
+      n++;
+    }
+  }
+  double rms = sqrt(sumSq / n);
+  CHECK(rms < 0.1);
+  printf("reads 2-60 s apart: error %.3f C rms over %d reads\n", rms, n);
+  return(checkResult());
+}
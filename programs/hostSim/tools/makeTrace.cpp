@@ -0,0 +1,87 @@
+/*
+  makeTrace.cpp - Write a synthetic summer temperature trace for replaySmartVent and
+  sweepSettings.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: makeTrace [--days N] [--seed S] [--step SECS] OUT.csv
+//
+// Writes N days (92, a summer) of outdoor temperatures with a daily cycle whose mean and
+// range vary from day to day, and the indoor temperatures of the simulated house with
+// SmartVent off, sampled every SECS seconds (60). The same seed gives the same trace.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "weather.h"
+
+static void usage(void) {
+  fprintf(stderr, "usage: makeTrace [--days N] [--seed S] [--step SECS] OUT.csv\n");
+  exit(2);
+}
+
+// Return the value of option argv[i], advancing i, and check it is at least 1.
+static uint32_t optionValue(int argc, char** argv, int& i) {
+  char* end;
+  if (++i >= argc)
+    usage();
+  unsigned long v = strtoul(argv[i], &end, 10);
+  if (*end != 0 || v < 1)
+    usage();
+  return((uint32_t) v);
+}
+
+int main(int argc, char** argv) {
+  uint32_t days = 92, seed = 1, stepS = 60;
+  const char* path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--days") == 0)
+      days = optionValue(argc, argv, i);
+    else if (strcmp(argv[i], "--seed") == 0)
+      seed = optionValue(argc, argv, i);
+    else if (strcmp(argv[i], "--step") == 0)
+      stepS = optionValue(argc, argv, i);
+    else if (argv[i][0] == '-' || path != NULL)
+      usage();
+    else
+      path = argv[i];
+  }
+  if (path == NULL)
+    usage();
+
+  temperatureTrace trace;
+  makeSummerTrace(trace, days, seed, stepS);
+  if (!writeTraceCSV(path, trace)) {
+    fprintf(stderr, "makeTrace: can't write %s\n", path);
+    return(1);
+  }
+  printf("Wrote %zu samples, %u days, to %s\n", trace.samples.size(), days, path);
+  return(0);
+}
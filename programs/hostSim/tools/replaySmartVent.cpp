@@ -0,0 +1,179 @@
+/*
+  replaySmartVent.cpp - Replay a temperature trace through the SmartVent Thermostat
+  control code and report how SmartVent ran.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: replaySmartVent [options] TRACE.csv
+//
+// TRACE.csv has columns ms, indoorC and outdoorC, as written by makeTrace or, from the
+// thermostat's telemetry, by decodeTelemetry.py (its temperatures.csv). The firmware's
+// temperature reading, filtering and AUTO control run on the simulated clock with the
+// thermistors set to the trace's temperatures, and SmartVentStats, cleared after the
+// warm-up, are reported. Settings not given are those of settingDefaults.
+//
+// Options:
+//   --mode off|on|auto   SmartVentMode (auto)
+//   --setpoint F         TempSetpointOn
+//   --delta F            DeltaTempForOn
+//   --hysteresis F       Hysteresis
+//   --max-run H          MaxRunTimeHours, 0 = no limit
+//   --new-day F          DeltaNewDayTemp
+//   --warmup MIN         minutes before the statistics are cleared (60)
+//   --house              take only the outdoor temperature from the trace, and simulate the
+//                        indoor one with a house that SmartVent cools
+//   --start-hour H       hour of the day at the start of the trace, for the house (0)
+//   --comfort F          indoor °F above which discomfort is counted (76)
+//   --noise CODES        standard deviation of ADC noise (0)
+//   --monitor            show the serial monitor output
+
+#include <Arduino.h>
+#include <chrono>
+#include "nonvolatileSettings.h"
+#include "smartVentControl.h"
+#include "hostSim.h"
+#include "replay.h"
+
+// Names of the arm states, in eArmState order.
+static const char* armStateNames[NUM_ARM_STATES] = {
+  "OFF", "ON", "ON_TIMEOUT", "AUTO_ON", "AWAIT_HOT", "AWAIT_ON"
+};
+
+// Names of the modes, in eSmartVentMode order.
+static const char* modeNames[] = { "off", "on", "auto" };
+
+static void usage(void) {
+  fprintf(stderr, "usage: replaySmartVent [--mode off|on|auto] [--setpoint F] [--delta F]\n"
+    "  [--hysteresis F] [--max-run H] [--new-day F] [--warmup MIN] [--house]\n"
+    "  [--start-hour H] [--comfort F] [--noise CODES] [--monitor] TRACE.csv\n");
+  exit(2);
+}
+
+// Return the value of option argv[i], advancing i, and check it is within lo..hi.
+static float optionValue(int argc, char** argv, int& i, float lo, float hi) {
+  char* end;
+  if (++i >= argc)
+    usage();
+  float v = strtof(argv[i], &end);
+  if (*end != 0 || v < lo || v > hi) {
+    fprintf(stderr, "%s: %s must be from %g to %g\n", argv[i-1], argv[i], lo, hi);
+    exit(2);
+  }
+  return(v);
+}
+
+int main(int argc, char** argv) {
+  nonvolatileSettings S = settingDefaults;
+  S.SmartVentMode = MODE_AUTO;
+  replayOptions options;
+  const char* path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    if (strcmp(a, "--mode") == 0) {
+      if (++i >= argc)
+        usage();
+      int m = 0;
+      while (m < 3 && strcmp(argv[i], modeNames[m]) != 0)
+        m++;
+      if (m == 3)
+        usage();
+      S.SmartVentMode = (eSmartVentMode) m;
+    } else if (strcmp(a, "--setpoint") == 0)
+      S.TempSetpointOn = optionValue(argc, argv, i, MIN_TEMP_SETPOINT, MAX_TEMP_SETPOINT);
+    else if (strcmp(a, "--delta") == 0)
+      S.DeltaTempForOn = optionValue(argc, argv, i, MIN_TEMP_DIFFERENTIAL, MAX_TEMP_DIFFERENTIAL);
+    else if (strcmp(a, "--hysteresis") == 0)
+      S.Hysteresis = optionValue(argc, argv, i, MIN_TEMP_HYSTERESIS, MAX_TEMP_HYSTERESIS);
+    else if (strcmp(a, "--max-run") == 0)
+      S.MaxRunTimeHours = optionValue(argc, argv, i, 0, MAX_RUN_TIME_IN_HOURS);
+    else if (strcmp(a, "--new-day") == 0)
+      S.DeltaNewDayTemp = optionValue(argc, argv, i, 0, MAX_DELTA_ARM_TEMP);
+    else if (strcmp(a, "--warmup") == 0)
+      options.warmupMS = (uint32_t) (optionValue(argc, argv, i, 0, 24*60) * 60000);
+    else if (strcmp(a, "--house") == 0)
+      options.closedLoop = true;
+    else if (strcmp(a, "--start-hour") == 0)
+      options.house.startHour = optionValue(argc, argv, i, 0, 24);
+    else if (strcmp(a, "--comfort") == 0)
+      options.comfortF = optionValue(argc, argv, i, 0, 150);
+    else if (strcmp(a, "--noise") == 0)
+      options.noiseCodes = optionValue(argc, argv, i, 0, 1000);
+    else if (strcmp(a, "--monitor") == 0)
+      options.monitor = hostMonitorPort.echo = true;
+    else if (a[0] == '-' || path != NULL)
+      usage();
+    else
+      path = a;
+  }
+  if (path == NULL)
+    usage();
+  hostMonitorPort.keep = false;
+
+  temperatureTrace trace;
+  std::string error;
+  if (!readTraceCSV(path, trace, error)) {
+    fprintf(stderr, "replaySmartVent: %s\n", error.c_str());
+    return(1);
+  }
+  if (trace.lengthMS() <= options.warmupMS) {
+    fprintf(stderr, "replaySmartVent: %s is not longer than the warm-up\n", path);
+    return(1);
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  replayResult R;
+  replayTrace(trace, S, options, R);
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  double hours = R.statsMS / 3600000.0;
+  printf("Trace %s: %.2f days, %zu samples, indoor temperature %s\n", path,
+    trace.lengthMS() / 86400000.0, trace.samples.size(),
+    options.closedLoop ? "from the house model" : "from the trace");
+  printf("Settings: mode %s, setpoint %d F, delta %d F, hysteresis %d F, max run %d h, "
+    "new day %d F\n", modeNames[S.SmartVentMode], S.TempSetpointOn, S.DeltaTempForOn,
+    S.Hysteresis, S.MaxRunTimeHours, S.DeltaNewDayTemp);
+  printf("Over %.2f days after a %.0f min warm-up:\n", hours / 24, options.warmupMS / 60000.0);
+  printf("  relay on          %9.1f h (%.1f%%)\n", R.stats.relayOnSecs / 3600.0,
+    100 * R.stats.relayOnSecs / 3600.0 / hours);
+  printf("  relay cycles      %9lu\n", (unsigned long) R.stats.relayCycles);
+  printf("  above setpoint    %9.1f h\n", R.stats.aboveSetpointSecs / 3600.0);
+  printf("  discomfort        %9.1f F*h above %.0f F, highest indoor %.1f F\n", R.discomfortFh,
+    options.comfortF, R.maxIndoorF);
+  printf("  temperature reads %9lu (%.0f per day)\n", (unsigned long) R.reads,
+    R.reads / (hours / 24));
+  printf("  arm state hours  ");
+  for (uint8_t i = 0; i < NUM_ARM_STATES; i++)
+    printf(" %s %.1f", armStateNames[i], R.stats.armStateSecs[i] / 3600.0);
+  printf("\n");
+  printf("Simulated %.2f days in %.2f s, %.0f times real time\n",
+    trace.lengthMS() / 86400000.0, secs, trace.lengthMS() / 1000.0 / secs);
+  return(0);
+}
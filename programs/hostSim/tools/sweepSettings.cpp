@@ -0,0 +1,294 @@
+/*
+  sweepSettings.cpp - Replay a temperature trace with every combination of ranges of
+  SmartVent settings and show which combinations are best.
+  Released into the public domain.
+
+
+  Software License Agreement (BSD License)
+
+  Copyright (c) 2023 Ted Toal
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+  3. Neither the name of the copyright holders nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Usage: sweepSettings [options] TRACE.csv
+//
+// Each combination of the settings ranges is replayed through the firmware as by
+// replaySmartVent --house: the indoor temperature is that of the simulated house, which
+// SmartVent cools, so that settings can be compared by the comfort they give. Comfort is
+// measured against a fixed temperature (--comfort), not against each combination's
+// setpoint. A combination is on the Pareto front if no other one is at least as good in
+// discomfort, relay cycles and relay run time and better in one of them. The front is
+// shown, sorted by discomfort, or with --all every combination, with the front marked *.
+//
+// The firmware keeps its state in globals, so each combination is replayed in a child
+// process of its own. Up to --jobs children run at once, and whenever one finishes the
+// next combination is started, so that a slow combination doesn't hold up the others.
+// Results are returned in shared memory. The wall-clock time is reported with the CPU time
+// of the children, whose ratio is the speedup over replaying the combinations one by one.
+//
+// A range is LO:HI[:STEP] or a single value. Settings not given are those of
+// settingDefaults.
+//
+// Options:
+//   --setpoint RANGE     TempSetpointOn
+//   --delta RANGE        DeltaTempForOn
+//   --hysteresis RANGE   Hysteresis
+//   --max-run RANGE      MaxRunTimeHours, 0 = no limit
+//   --new-day RANGE      DeltaNewDayTemp
+//   --warmup MIN         minutes before the statistics are cleared (60)
+//   --start-hour H       hour of the day at the start of the trace, for the house (0)
+//   --comfort F          indoor °F above which discomfort is counted (76)
+//   --jobs N             combinations replayed at once (the number of processors)
+//   --all                show every combination
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "nonvolatileSettings.h"
+#include "smartVentControl.h"
+#include "replay.h"
+
+// Most combinations allowed.
+#define MAX_COMBINATIONS 100000
+
+// A swept setting: its option name, where it is in nonvolatileSettings, its limits, and
+// the range given.
+struct sweptSetting {
+  const char* option;
+  uint8_t nonvolatileSettings::* field;
+  int lo, hi;
+  int first, last, step;
+};
+
+static sweptSetting swept[] = {
+  { "--setpoint", &nonvolatileSettings::TempSetpointOn, MIN_TEMP_SETPOINT, MAX_TEMP_SETPOINT },
+  { "--delta", &nonvolatileSettings::DeltaTempForOn, MIN_TEMP_DIFFERENTIAL,
+    MAX_TEMP_DIFFERENTIAL },
+  { "--hysteresis", &nonvolatileSettings::Hysteresis, MIN_TEMP_HYSTERESIS, MAX_TEMP_HYSTERESIS },
+  { "--max-run", &nonvolatileSettings::MaxRunTimeHours, 0, MAX_RUN_TIME_IN_HOURS },
+  { "--new-day", &nonvolatileSettings::DeltaNewDayTemp, 0, MAX_DELTA_ARM_TEMP },
+};
+#define NUM_SWEPT (sizeof(swept) / sizeof(swept[0]))
+
+// Result of one combination, in shared memory.
+struct sweepResult {
+  bool done;
+  replayResult R;
+};
+
+static void usage(void) {
+  fprintf(stderr, "usage: sweepSettings [--setpoint RANGE] [--delta RANGE]\n"
+    "  [--hysteresis RANGE] [--max-run RANGE] [--new-day RANGE] [--warmup MIN]\n"
+    "  [--start-hour H] [--comfort F] [--jobs N] [--all] TRACE.csv\n"
+    "RANGE is LO:HI[:STEP] or a single value\n");
+  exit(2);
+}
+
+// Return the value of option argv[i], advancing i, and check it is within lo..hi.
+static float optionValue(int argc, char** argv, int& i, float lo, float hi) {
+  char* end;
+  if (++i >= argc)
+    usage();
+  float v = strtof(argv[i], &end);
+  if (*end != 0 || v < lo || v > hi) {
+    fprintf(stderr, "%s: %s must be from %g to %g\n", argv[i-1], argv[i], lo, hi);
+    exit(2);
+  }
+  return(v);
+}
+
+// Parse the range option argv[i] for setting W, advancing i.
+static void rangeValue(int argc, char** argv, int& i, sweptSetting& W) {
+  if (++i >= argc)
+    usage();
+  int n = sscanf(argv[i], "%d:%d:%d", &W.first, &W.last, &W.step);
+  if (n == 1)
+    W.last = W.first;
+  if (n < 3)
+    W.step = 1;
+  if (n < 1 || W.first < W.lo || W.last > W.hi || W.first > W.last || W.step < 1) {
+    fprintf(stderr, "%s: %s must be LO:HI[:STEP] with %d <= LO <= HI <= %d, STEP >= 1\n",
+      argv[i-1], argv[i], W.lo, W.hi);
+    exit(2);
+  }
+}
+
+// Return true if result A dominates result B: it is no worse in discomfort, relay cycles and
+// relay run time, and better in at least one.
+static bool dominates(const replayResult& A, const replayResult& B) {
+  if (A.discomfortFh > B.discomfortFh || A.stats.relayCycles > B.stats.relayCycles ||
+      A.stats.relayOnSecs > B.stats.relayOnSecs)
+    return(false);
+  return(A.discomfortFh < B.discomfortFh || A.stats.relayCycles < B.stats.relayCycles ||
+    A.stats.relayOnSecs < B.stats.relayOnSecs);
+}
+
+int main(int argc, char** argv) {
+  nonvolatileSettings S = settingDefaults;
+  S.SmartVentMode = MODE_AUTO;
+  for (sweptSetting& W : swept)
+    W.first = W.last = S.*W.field, W.step = 1;
+  replayOptions options;
+  options.closedLoop = true;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  bool all = false;
+  const char* path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    size_t w = 0;
+    while (w < NUM_SWEPT && strcmp(a, swept[w].option) != 0)
+      w++;
+    if (w < NUM_SWEPT)
+      rangeValue(argc, argv, i, swept[w]);
+    else if (strcmp(a, "--warmup") == 0)
+      options.warmupMS = (uint32_t) (optionValue(argc, argv, i, 0, 24*60) * 60000);
+    else if (strcmp(a, "--start-hour") == 0)
+      options.house.startHour = optionValue(argc, argv, i, 0, 24);
+    else if (strcmp(a, "--comfort") == 0)
+      options.comfortF = optionValue(argc, argv, i, 0, 150);
+    else if (strcmp(a, "--jobs") == 0)
+      jobs = (long) optionValue(argc, argv, i, 1, 1024);
+    else if (strcmp(a, "--all") == 0)
+      all = true;
+    else if (a[0] == '-' || path != NULL)
+      usage();
+    else
+      path = a;
+  }
+  if (path == NULL)
+    usage();
+  if (jobs < 1)
+    jobs = 1;
+
+  temperatureTrace trace;
+  std::string error;
+  if (!readTraceCSV(path, trace, error)) {
+    fprintf(stderr, "sweepSettings: %s\n", error.c_str());
+    return(1);
+  }
+  if (trace.lengthMS() <= options.warmupMS) {
+    fprintf(stderr, "sweepSettings: %s is not longer than the warm-up\n", path);
+    return(1);
+  }
+
+  // Make the combinations, the last setting varying fastest.
+  std::vector<nonvolatileSettings> combos(1, S);
+  for (const sweptSetting& W : swept) {
+    std::vector<nonvolatileSettings> next;
+    for (const nonvolatileSettings& C : combos)
+      for (int v = W.first; v <= W.last; v += W.step) {
+        next.push_back(C);
+        next.back().*W.field = (uint8_t) v;
+      }
+    combos.swap(next);
+    if (combos.size() > MAX_COMBINATIONS) {
+      fprintf(stderr, "sweepSettings: more than %d combinations\n", MAX_COMBINATIONS);
+      return(1);
+    }
+  }
+  size_t N = combos.size();
+
+  // Replay each combination in a child process, keeping up to jobs of them running.
+  sweepResult* results = (sweepResult*) mmap(NULL, N * sizeof(sweepResult),
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (results == MAP_FAILED) {
+    perror("sweepSettings: mmap");
+    return(1);
+  }
+  fflush(stdout);
+  auto t0 = std::chrono::steady_clock::now();
+  size_t started = 0, failed = 0;
+  long running = 0;
+  while (started < N || running > 0) {
+    if (started < N && running < jobs) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        perror("sweepSettings: fork");
+        return(1);
+      }
+      if (pid == 0) {
+        replayTrace(trace, combos[started], options, results[started].R);
+        results[started].done = true;
+        _exit(0);
+      }
+      started++;
+      running++;
+      continue;
+    }
+    int status;
+    if (wait(&status) > 0) {
+      running--;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        failed++;
+    }
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (failed > 0) {
+    fprintf(stderr, "sweepSettings: %zu combinations failed\n", failed);
+    return(1);
+  }
+
+  // Find the Pareto front.
+  std::vector<bool> front(N, true);
+  for (size_t i = 0; i < N; i++)
+    for (size_t j = 0; j < N && front[i]; j++)
+      if (j != i && dominates(results[j].R, results[i].R))
+        front[i] = false;
+  std::vector<size_t> order;
+  for (size_t i = 0; i < N; i++)
+    if (all || front[i])
+      order.push_back(i);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return(results[a].R.discomfortFh < results[b].R.discomfortFh); });
+
+  double days = results[0].R.statsMS / 86400000.0;
+  printf("Trace %s: %.2f days; %zu combinations, %zu on the Pareto front\n", path,
+    trace.lengthMS() / 86400000.0, N, (size_t) std::count(front.begin(), front.end(), true));
+  printf("Over %.2f days after a %.0f min warm-up, discomfort above %.0f F:\n", days,
+    options.warmupMS / 60000.0, options.comfortF);
+  printf("   setpoint delta hyst maxrun newday | discomfort  max F  cycles  relay h  "
+    "above h\n");
+  for (size_t i : order) {
+    const nonvolatileSettings& C = combos[i];
+    const replayResult& R = results[i].R;
+    printf(" %c %8d %5d %4d %6d %6d | %10.1f %6.1f %7lu %8.1f %8.1f\n", front[i] ? '*' : ' ',
+      C.TempSetpointOn, C.DeltaTempForOn, C.Hysteresis, C.MaxRunTimeHours, C.DeltaNewDayTemp,
+      R.discomfortFh, R.maxIndoorF, (unsigned long) R.stats.relayCycles,
+      R.stats.relayOnSecs / 3600.0, R.stats.aboveSetpointSecs / 3600.0);
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_CHILDREN, &usage);
+  double cpuSecs = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+  printf("Replayed %zu combinations in %.2f s with %ld jobs, %.2f s of CPU, speedup %.2f\n",
+    N, secs, jobs, cpuSecs, cpuSecs / secs);
+  munmap(results, N * sizeof(sweepResult));
+  return(0);
+}